@@ -0,0 +1,97 @@
+// Compares the fused scaled_dot_product_attention op with attention composed
+// from matmul and softmax, over sequence lengths from 128 up to 8192 (or the
+// length given as the first argument).
+//
+// Each row reports the time of a forward and backward pass, and the size of
+// the (queries, keys) matrices the composed version materializes, which the
+// fused op never allocates. The composed version is skipped beyond 2048 keys,
+// where its matrices alone would take gigabytes.
+
+#include <ember/tensor.h>
+
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmanipulation.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+using namespace ember;
+
+namespace {
+
+constexpr std::size_t kDim = 64;
+constexpr std::size_t kMaxComposedLength = 2048;
+
+// Returns the fastest of a few runs of `fn`, in milliseconds.
+double time_ms(const std::function<void()>& fn) {
+  double best = INFINITY;
+  for (int run = 0; run < 3; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+void reset(Tensor& t) {
+  delete t.gradient;
+  t.gradient = nullptr;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_length = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8192;
+  std::printf("%8s %14s %14s %18s\n", "length", "fused (ms)", "composed (ms)",
+              "T x T matrices");
+  for (std::size_t length = 128; length <= max_length; length *= 2) {
+    Tensor q = Tensor::randn({length, kDim});
+    Tensor k = Tensor::randn({length, kDim});
+    Tensor v = Tensor::randn({length, kDim});
+    for (Tensor* t : {&q, &k, &v}) {
+      t->requires_grad(true);
+    }
+
+    double fused = time_ms([&] {
+      ember::scaled_dot_product_attention(q, k, v, true).sum().backward();
+      reset(q);
+      reset(k);
+      reset(v);
+    });
+
+    // The scores, their softmax and the gradients of both are (T, T).
+    double matrix_mb = 4.0 * length * length * sizeof(double) / (1 << 20);
+    if (length > kMaxComposedLength) {
+      std::printf("%8zu %14.2f %14s %15.1f MB\n", length, fused, "-",
+                  matrix_mb);
+      continue;
+    }
+    Tensor k_t = Tensor::from_xarray(xt::transpose(k.data_));
+    k_t.requires_grad(true);
+    xt::xarray<double> causal = xt::zeros<double>({length, length});
+    for (std::size_t i = 0; i < length; ++i) {
+      for (std::size_t j = i + 1; j < length; ++j) {
+        causal(i, j) = -INFINITY;
+      }
+    }
+    Tensor bias = Tensor::from_xarray(causal);
+    Tensor scale(1.0 / std::sqrt(static_cast<double>(kDim)));
+    double composed = time_ms([&] {
+      Tensor scores = ember::matmul(q, k_t) * scale + bias;
+      ember::matmul(scores.softmax(), v).sum().backward();
+      reset(q);
+      reset(k_t);
+      reset(v);
+    });
+    std::printf("%8zu %14.2f %14.2f %15.1f MB\n", length, fused, composed,
+                matrix_mb);
+  }
+  return 0;
+}
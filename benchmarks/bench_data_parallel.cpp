@@ -0,0 +1,84 @@
+// Measures how data-parallel training scales with the number of threads, by
+// timing a forward and backward pass of a two-layer perceptron over a batch
+// of 512 examples split across 1, 2, 4, ... replicas, up to the number of
+// hardware threads (or the count given as the first argument).
+//
+// Each row reports the time of a step, the speedup over one replica and the
+// parallel efficiency, i.e. the speedup divided by the number of replicas.
+
+#include <ember/distributed/data_parallel.h>
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+constexpr std::size_t kBatch = 512;
+constexpr std::size_t kIn = 256;
+constexpr std::size_t kHidden = 512;
+constexpr std::size_t kOut = 10;
+
+// Returns the fastest of a few runs of `fn`, in milliseconds.
+double time_ms(const std::function<void()>& fn) {
+  double best = INFINITY;
+  for (int run = 0; run < 3; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t max_threads =
+      argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+               : std::max(1u, std::thread::hardware_concurrency());
+  Tensor w1 = Tensor::randn({kIn, kHidden}, 0.0, 0.05);
+  Tensor b1 = Tensor::from_shape({kHidden});
+  Tensor w2 = Tensor::randn({kHidden, kOut}, 0.0, 0.05);
+  Tensor b2 = Tensor::from_shape({kOut});
+  for (Tensor* t : {&w1, &b1, &w2, &b2}) {
+    t->requires_grad(true);
+  }
+  Tensor x = Tensor::randn({kBatch, kIn});
+  Tensor y = Tensor::randn({kBatch, kOut});
+
+  std::printf("%8s %12s %10s %12s\n", "threads", "step (ms)", "speedup",
+              "efficiency");
+  double baseline = 0.0;
+  for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+    set_num_threads(threads);
+    std::vector<Tensor> x_shards = ember::chunk(x, threads);
+    std::vector<Tensor> y_shards = ember::chunk(y, threads);
+    distributed::DataParallel trainer({&w1, &b1, &w2, &b2}, threads);
+    double ms = time_ms([&] {
+      trainer.forward_backward(
+          [&](const std::vector<Tensor*>& p, std::size_t replica) {
+            Tensor h = ember::linear(x_shards[replica], *p[0], *p[1],
+                                     Activation::ReLU);
+            Tensor error = ember::linear(h, *p[2], *p[3]) - y_shards[replica];
+            return (error * error).mean();
+          });
+    });
+    baseline = threads == 1 ? ms : baseline;
+    double speedup = baseline / ms;
+    std::printf("%8zu %12.2f %10.2f %12.2f\n", threads, ms, speedup,
+                speedup / static_cast<double>(threads));
+  }
+  return 0;
+}
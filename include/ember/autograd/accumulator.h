@@ -4,6 +4,7 @@
 #include <ember/autograd/node.h>
 #include <ember/tensor.h>
 
+#include <functional>
 #include <vector>
 
 namespace ember::autograd {
@@ -30,12 +31,23 @@ public:
    */
   std::vector<ember::Tensor> operator()(ember::Tensor output_grad) override;
 
+  /**
+   * @brief Adds a function that is called with the target after each
+   * gradient is accumulated into it.
+   *
+   * The engine evaluates each node once per backward pass, so the hooks are
+   * called once the target's gradient for that pass is complete, while the
+   * rest of the graph may still be running.
+   */
+  void add_post_hook(std::function<void(ember::Tensor &)> hook);
+
   // Prevent copying and assignment
   Accumulator(const Accumulator &) = delete;
   Accumulator &operator=(const Accumulator &) = delete;
 
 private:
   ember::Tensor *target;
+  std::vector<std::function<void(ember::Tensor &)>> post_hooks;
 };
 
 }  // namespace ember::autograd
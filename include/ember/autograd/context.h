@@ -3,6 +3,9 @@
 
 #include <ember/tensor_snapshot.h>
 
+#include <any>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace ember::autograd {
@@ -17,6 +20,14 @@ struct Context {
    */
   std::vector<ember::TensorSnapshot> saved_tensors;
 
+  /**
+   * @brief Non-tensor values captured during the forward pass, keyed by name.
+   *
+   * This holds the arguments and intermediate results that the backward pass
+   * needs besides tensors (e.g., the axes a reduction was applied over).
+   */
+  std::unordered_map<std::string, std::any> saved_data;
+
   template <typename... Tensors>
   void save_for_backward(Tensors&... tensors) {
     auto _save_for_backward = [this](auto& tensor) {
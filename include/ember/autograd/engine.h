@@ -25,6 +25,16 @@ private:
   void evaluate_fn(Node* func, Tensor gradient);
 };
 
+/**
+ * Adds `gradient` to `total`, where both are gradients of the same tensor.
+ * Two row-sparse gradients are added by appending the rows of one to the
+ * other, so their sum stays sparse (an index may then appear more than once,
+ * until the sum is coalesced), and two CSR gradients by merging their
+ * sparsity patterns. A sparse gradient
+ * is added to a dense one by scattering its elements.
+ */
+void accumulate_gradient(Tensor& total, const Tensor& gradient);
+
 }  // namespace ember::autograd
 
 #endif  // !EMBER_AUTOGRAD_ENGINE_H
@@ -0,0 +1,126 @@
+#ifndef EMBER_AUTOGRAD_GRAD_MODE_H
+#define EMBER_AUTOGRAD_GRAD_MODE_H
+
+#include <cstddef>
+
+namespace ember::autograd {
+
+/**
+ * @brief Returns whether ops called on this thread record the nodes of the
+ * backward graph. It is enabled by default.
+ *
+ * When it is disabled, the outputs of ops don't require gradients, even if
+ * their inputs do, so no node (and none of the values it saves for the
+ * backward pass) outlives the op.
+ */
+bool is_grad_enabled();
+
+/**
+ * @brief Enables or disables recording the backward graph on this thread.
+ */
+void set_grad_enabled(bool enabled);
+
+/**
+ * @brief Returns the number of nodes ops on this thread have discarded
+ * because recording was disabled, i.e. how many ops had an input that
+ * required gradients.
+ *
+ * Comparing it before and after running a function without recording tells
+ * whether the function would have recorded a graph, e.g. because it used a
+ * parameter that requires gradients.
+ */
+std::size_t num_discarded_nodes();
+
+// Called by `Tensor::set_gradient_fn` when it discards a node.
+void count_discarded_node();
+
+/**
+ * @brief Returns the number of bytes the nodes recorded on this thread have
+ * saved for the backward pass, as measured by `saved_bytes` when each node
+ * was recorded.
+ *
+ * The difference before and after running a function is how much memory its
+ * graph holds until the backward pass, e.g. to decide what to checkpoint.
+ */
+std::size_t num_saved_bytes();
+
+// Called by `Tensor::set_gradient_fn` when it records a node.
+void count_saved_bytes(std::size_t bytes);
+
+/**
+ * @brief Sets whether the backward graph is recorded on this thread until
+ * the guard goes out of scope, when the previous setting is restored.
+ */
+class GradModeGuard {
+public:
+  explicit GradModeGuard(bool enabled);
+  ~GradModeGuard();
+
+  GradModeGuard(const GradModeGuard&) = delete;
+  GradModeGuard& operator=(const GradModeGuard&) = delete;
+
+private:
+  bool previous_;
+};
+
+/**
+ * @brief Disables recording the backward graph on this thread until the
+ * guard goes out of scope, e.g. for inference or to update parameters.
+ */
+class NoGradGuard : public GradModeGuard {
+public:
+  NoGradGuard() : GradModeGuard(false) {}
+};
+
+/**
+ * @brief Returns whether ops called on this thread give their outputs
+ * tangents when their inputs have tangents (forward-mode AD). It is enabled
+ * by default, and disabled while an op computes a tangent, so tangents don't
+ * get tangents of their own.
+ */
+bool is_forward_grad_enabled();
+
+/**
+ * @brief Sets whether ops propagate tangents on this thread until the guard
+ * goes out of scope, when the previous setting is restored.
+ */
+class ForwardGradGuard {
+public:
+  explicit ForwardGradGuard(bool enabled);
+  ~ForwardGradGuard();
+
+  ForwardGradGuard(const ForwardGradGuard&) = delete;
+  ForwardGradGuard& operator=(const ForwardGradGuard&) = delete;
+
+private:
+  bool previous_;
+};
+
+/**
+ * @brief Returns whether a checkpointed segment is being recomputed in the
+ * backward pass on this thread. Ops with effects beyond their outputs, like
+ * the running statistics of `batch_norm`, skip them then, so they happen once
+ * whether or not the segment is checkpointed.
+ */
+bool is_recomputing();
+
+/**
+ * @brief Marks the ops called on this thread as recomputing a checkpointed
+ * segment until the guard goes out of scope, when the previous setting is
+ * restored.
+ */
+class RecomputeGuard {
+public:
+  RecomputeGuard();
+  ~RecomputeGuard();
+
+  RecomputeGuard(const RecomputeGuard&) = delete;
+  RecomputeGuard& operator=(const RecomputeGuard&) = delete;
+
+private:
+  bool previous_;
+};
+
+}  // namespace ember::autograd
+
+#endif  // !EMBER_AUTOGRAD_GRAD_MODE_H
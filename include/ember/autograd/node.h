@@ -5,6 +5,7 @@
 #include <ember/autograd/edge.h>
 #include <ember/tensor_snapshot.h>
 
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -97,6 +98,14 @@ struct Node {
   std::size_t get_num_inputs() { return edges.size(); }
 };
 
+/**
+ * @brief Returns the number of bytes of the values `node` keeps for the
+ * backward pass: its saved tensors and the arrays among its saved data.
+ *
+ * Small values, like shapes and flags, aren't counted.
+ */
+std::size_t saved_bytes(const Node& node);
+
 }  // namespace ember::autograd
 
 #endif  // EMBER_AUTOGRAD_NODE_H
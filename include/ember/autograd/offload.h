@@ -0,0 +1,140 @@
+#ifndef EMBER_AUTOGRAD_OFFLOAD_H
+#define EMBER_AUTOGRAD_OFFLOAD_H
+
+#include <any>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ember {
+struct TensorSnapshot;  // Forward declaration
+}
+
+namespace ember::autograd {
+
+struct Node;             // Forward declaration
+struct OffloadedTensor;  // Forward declaration
+
+/**
+ * @brief Spills the large tensors that recorded nodes save for the backward
+ * pass to a scratch file, and reads them back while the backward pass runs.
+ *
+ * While an `OffloadGuard` for it is in scope, every node recorded on that
+ * thread hands its saved tensors of at least `min_bytes` to the offloader,
+ * along with the arrays of its saved data that are as large (the ones
+ * `saved_bytes` counts, like the gate activations of `lstm`). While one of
+ * those is offloaded, its entry of the saved data holds a handle to it
+ * instead. They are written with `pwrite` by a background I/O thread, and
+ * their memory is freed once written. During the backward pass, the engine reads them back
+ * with `pread` in the order it will evaluate their nodes, keeping up to
+ * `prefetch_depth` tensors loading ahead of the node being evaluated, so it
+ * only waits for a tensor (a stall) when the disk falls behind.
+ *
+ * The scratch file is created in `directory` (the system's temporary
+ * directory if empty) and removed as soon as it is opened, so nothing is
+ * left behind, and the space of tensors read back is reused. If a write
+ * fails, the tensor is simply kept in memory. Destroying the offloader reads
+ * back every tensor still on disk, so graphs whose backward pass hasn't run
+ * stay usable.
+ */
+class SavedTensorOffloader {
+public:
+  /**
+   * @throws std::system_error if the scratch file can't be created.
+   */
+  explicit SavedTensorOffloader(std::size_t min_bytes = 1 << 20,
+                                std::size_t prefetch_depth = 4,
+                                const std::string& directory = "");
+  ~SavedTensorOffloader();
+
+  SavedTensorOffloader(const SavedTensorOffloader&) = delete;
+  SavedTensorOffloader& operator=(const SavedTensorOffloader&) = delete;
+
+  /**
+   * @brief Queues the saved tensors and saved arrays of `node` of at least
+   * `min_bytes` to be written to the scratch file. Called when a node is
+   * recorded under an `OffloadGuard`.
+   */
+  void offload(Node& node);
+
+  /**
+   * @brief Waits until every tensor queued so far is written to the scratch
+   * file (or kept in memory, if its write failed or it was wanted first).
+   */
+  void wait_for_writes();
+
+  // The number of tensors and bytes written to the scratch file so far.
+  std::size_t num_offloaded() const;
+  std::size_t bytes_offloaded() const;
+
+  // The number of times the backward pass had to wait for a tensor that
+  // wasn't read back yet.
+  std::size_t num_stalls() const;
+
+  std::size_t min_bytes() const { return min_bytes_; }
+  std::size_t prefetch_depth() const { return prefetch_depth_; }
+
+  struct State;  // The state shared with the I/O thread and the tensors
+
+private:
+  std::size_t min_bytes_;
+  std::size_t prefetch_depth_;
+  std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Offloads the saved tensors of the nodes recorded on this thread
+ * through `offloader` until the guard goes out of scope.
+ */
+class OffloadGuard {
+public:
+  explicit OffloadGuard(SavedTensorOffloader& offloader);
+  ~OffloadGuard();
+
+  OffloadGuard(const OffloadGuard&) = delete;
+  OffloadGuard& operator=(const OffloadGuard&) = delete;
+
+private:
+  SavedTensorOffloader* previous_;
+};
+
+// Returns the offloader of the innermost `OffloadGuard` on this thread, if
+// any. Used by `Tensor::set_gradient_fn`.
+SavedTensorOffloader* current_offloader();
+
+/**
+ * @brief Reads the offloaded saved tensors of a backward pass back into
+ * memory, ahead of the nodes that need them. Used by the engine.
+ */
+class SavedTensorLoader {
+public:
+  // `nodes` are in the order the engine evaluates them.
+  explicit SavedTensorLoader(const std::vector<Node*>& nodes);
+
+  /**
+   * @brief Starts reading the tensors of the next nodes and waits for those
+   * of `nodes[index]`, which are then back in its snapshots and saved data.
+   *
+   * @throws std::system_error if one of them couldn't be read back.
+   */
+  void load(std::size_t index);
+
+private:
+  // An offloaded tensor and where it goes back: a snapshot, or an entry of
+  // the saved data if `snapshot` is null.
+  struct Entry {
+    std::size_t node;
+    std::shared_ptr<OffloadedTensor> tensor;
+    TensorSnapshot* snapshot;
+    std::any* value;
+  };
+
+  std::vector<Entry> entries_;
+  std::size_t loaded_ = 0;
+  std::size_t prefetched_ = 0;
+};
+
+}  // namespace ember::autograd
+
+#endif  // !EMBER_AUTOGRAD_OFFLOAD_H
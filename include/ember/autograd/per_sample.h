@@ -0,0 +1,46 @@
+#ifndef EMBER_AUTOGRAD_PER_SAMPLE_H
+#define EMBER_AUTOGRAD_PER_SAMPLE_H
+
+#include <ember/tensor.h>
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace ember::autograd {
+
+/**
+ * @brief A backward pass that keeps the gradients of each sample of a batch
+ * apart, as used by `ember::per_sample_grad`.
+ *
+ * While it is current, ops whose gradients would sum over the samples of the
+ * batch (the first axis of their inputs) keep a leading axis of
+ * `batch_size` samples instead, and leaves put their gradient in
+ * `gradients` rather than accumulating it into their `gradient`.
+ */
+struct PerSampleState {
+  std::size_t batch_size;
+  std::unordered_map<const Tensor*, Tensor> gradients;
+};
+
+// Returns the state of the innermost `PerSampleGuard` on this thread, if any.
+PerSampleState* current_per_sample();
+
+/**
+ * @brief Makes `state` current on this thread until the guard goes out of
+ * scope.
+ */
+class PerSampleGuard {
+public:
+  explicit PerSampleGuard(PerSampleState& state);
+  ~PerSampleGuard();
+
+  PerSampleGuard(const PerSampleGuard&) = delete;
+  PerSampleGuard& operator=(const PerSampleGuard&) = delete;
+
+private:
+  PerSampleState* previous_;
+};
+
+}  // namespace ember::autograd
+
+#endif  // !EMBER_AUTOGRAD_PER_SAMPLE_H
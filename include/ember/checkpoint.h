@@ -0,0 +1,177 @@
+#ifndef EMBER_CHECKPOINT_H
+#define EMBER_CHECKPOINT_H
+
+#include <ember/tensor_refs.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ember {
+
+struct Tensor;  // Forward declaration
+
+// A segment of a model, computed from the tensors passed to `checkpoint`.
+using CheckpointFn = std::function<Tensor(const TensorRefs& inputs)>;
+
+/**
+ * Computes `fn(inputs)` without keeping the values its ops save for the
+ * backward pass, and computes it again when the backward pass reaches it.
+ *
+ * The forward pass runs `fn` with recording disabled, so only a copy of the
+ * inputs is kept until the backward pass. There, `fn` is run again with
+ * recording enabled on new leaves holding those copies, and a backward pass
+ * through the recomputed graph accumulates the gradients of the parameters
+ * `fn` uses and gives the gradients of the inputs. This trades a second
+ * forward pass of the segment for the memory of its activations, e.g. by
+ * checkpointing every few layers of a deep model.
+ *
+ * The random sources are returned to their state at the forward pass while
+ * `fn` is recomputed, so ops like `dropout` draw the same values, and are
+ * then restored. `fn` must therefore be deterministic otherwise, and must not
+ * modify its inputs or the parameters it uses between the two passes.
+ *
+ * If no input requires gradients and `fn` records nothing (e.g. it uses no
+ * parameters that require gradients), the output is returned as is.
+ *
+ * @throws std::invalid_argument if `fn` returns a row-sparse or CSR tensor
+ * that would need a gradient.
+ */
+Tensor checkpoint(const CheckpointFn& fn, const TensorRefs& inputs);
+
+/**
+ * Calls `checkpoint` with a function of the inputs themselves, e.g.
+ * `checkpoint([&](const Tensor& x) { return ember::relu(linear(x, w, b)); },
+ * x)`.
+ */
+template <typename Fn, typename... Inputs,
+          std::enable_if_t<(std::is_same_v<Inputs, Tensor> && ...), int> = 0>
+std::invoke_result_t<Fn&, const Inputs&...> checkpoint(
+    Fn fn, const Inputs&... inputs) {
+  return checkpoint(
+      CheckpointFn([fn](const TensorRefs& refs) {
+        return [&]<std::size_t... I>(std::index_sequence<I...>) {
+          return fn(refs[I].get()...);
+        }(std::index_sequence_for<Inputs...>{});
+      }),
+      TensorRefs{inputs...});
+}
+
+/**
+ * @brief The peak memory a `CheckpointPlanner` predicted for an iteration,
+ * and the peak its graph actually reached.
+ *
+ * Both count the bytes the recorded nodes saved for the backward pass (see
+ * `autograd::saved_bytes`): those of the whole forward graph, plus the most
+ * any checkpointed segment recorded while it was recomputed.
+ */
+struct MemoryReport {
+  std::size_t predicted_peak_bytes = 0;
+  // Only complete once the backward pass of the iteration has run.
+  std::size_t actual_peak_bytes = 0;
+};
+
+/**
+ * @brief Runs a model given as a sequence of layers, and decides which runs
+ * of consecutive layers to checkpoint so the memory held for the backward
+ * pass stays within a budget.
+ *
+ * The first forward pass is a profiling iteration: every layer is recorded
+ * as usual, and the planner measures the bytes its nodes saved, the size of
+ * its input, and how long it took. From these it derives the segments to
+ * checkpoint, each a run of layers checkpointed as one, that keep the
+ * predicted peak within the budget at the least total time spent recomputing
+ * them, and every later forward pass applies that plan. Checkpointing a
+ * segment replaces what its layers saved with a copy of its input, but adds
+ * what they save while it is recomputed, so the predicted peak is that of the
+ * layers kept, the inputs of the segments, and the largest segment. Longer
+ * segments keep fewer inputs but recompute more at once, so the layers can be
+ * as fine as the model allows, e.g. one per op.
+ *
+ * When no plan fits the budget, the planner picks the one with the lowest
+ * predicted peak, which `report` then shows is over the budget. Layers must
+ * take the same time and save the same sizes on every iteration for the plan
+ * to stay accurate.
+ */
+class CheckpointPlanner {
+public:
+  // Computes the output of a layer from the output of the previous one (or
+  // from the input of the model, for the first layer).
+  using Layer = std::function<Tensor(const Tensor& input)>;
+
+  // The layers [begin, end), checkpointed as one.
+  struct Segment {
+    std::size_t begin;
+    std::size_t end;
+
+    bool operator==(const Segment&) const = default;
+  };
+
+  /**
+   * @throws std::invalid_argument if there are no layers.
+   */
+  CheckpointPlanner(std::vector<Layer> layers,
+                    std::size_t memory_budget_bytes);
+
+  /**
+   * @brief Runs the layers on `input`, profiling them on the first call and
+   * checkpointing the segments the plan picked on later calls.
+   *
+   * Without grad mode the layers are just run, and nothing is measured.
+   */
+  Tensor forward(const Tensor& input);
+
+  // Whether the profiling iteration has run and a plan was made.
+  bool planned() const { return !checkpointed_.empty(); }
+
+  // Which layers the plan checkpoints, empty until the plan is made.
+  const std::vector<bool>& checkpointed() const { return checkpointed_; }
+
+  // The segments the plan checkpoints, in order.
+  const std::vector<Segment>& segments() const { return segments_; }
+
+  // The time the plan expects to spend recomputing segments per iteration.
+  double predicted_recompute_seconds() const { return recompute_seconds_; }
+
+  /**
+   * @brief Returns the predicted and actual peak memory of the latest
+   * iteration. For the profiling iteration, which checkpoints nothing, the
+   * prediction is the sum of what every layer saved.
+   */
+  MemoryReport report() const;
+
+  std::size_t memory_budget_bytes() const { return memory_budget_bytes_; }
+  std::size_t num_layers() const { return layers_.size(); }
+
+private:
+  struct LayerProfile {
+    std::size_t saved_bytes = 0;
+    std::size_t input_bytes = 0;
+    double seconds = 0.0;
+  };
+
+  std::size_t predict_peak(const std::vector<Segment>& segments) const;
+  void plan();
+
+  std::vector<Layer> layers_;
+  std::size_t memory_budget_bytes_;
+  std::vector<LayerProfile> profiles_;
+  std::vector<bool> checkpointed_;
+  std::vector<Segment> segments_;
+  double recompute_seconds_ = 0.0;
+  std::size_t predicted_peak_bytes_ = 0;
+
+  // The latest iteration. Its checkpointed segments raise the recompute peak
+  // during the backward pass, possibly after this planner is gone.
+  std::size_t predicted_bytes_ = 0;
+  std::size_t forward_bytes_ = 0;
+  std::shared_ptr<std::size_t> recompute_peak_bytes_ =
+      std::make_shared<std::size_t>(0);
+};
+
+}  // namespace ember
+
+#endif  // !EMBER_CHECKPOINT_H
@@ -0,0 +1,107 @@
+#ifndef EMBER_DISTRIBUTED_DATA_PARALLEL_H
+#define EMBER_DISTRIBUTED_DATA_PARALLEL_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace ember {
+struct Tensor;  // Forward declaration
+}
+
+namespace ember::distributed {
+
+/**
+ * @brief Trains a model on several threads at once by running a replica of
+ * it on each shard of a batch.
+ *
+ * Each replica has its own copy of the parameters, on which it builds its own
+ * graph and runs its own backward pass, so the replicas never share a tensor.
+ * Their gradients are then averaged into the gradients of the parameters,
+ * which is the gradient of the mean loss over the batch when the shards are
+ * the same size.
+ *
+ * The averaging overlaps with the backward passes: the parameters are grouped
+ * into buckets of about `bucket_size` elements, in reverse order since the
+ * last parameters of a model usually get their gradients first, and a bucket
+ * is reduced by whichever replica completes it last, as soon as it does,
+ * while the other replicas carry on with the rest of their graphs. Buckets
+ * holding a parameter that some replica didn't use are reduced at the end.
+ * Each bucket sums the replicas in the same order, so the result doesn't
+ * depend on timing.
+ *
+ * The replicas run on the shared thread pool (see `set_num_threads`), one
+ * per thread, and the ops each replica calls run on its thread only.
+ */
+class DataParallel {
+public:
+  // The default number of elements in each bucket (2 MiB of gradients).
+  static constexpr std::size_t kDefaultBucketSize = 1 << 18;
+
+  /**
+   * Computes the loss of replica `replica` on its shard of the batch, from
+   * the replica's copies of the parameters (in the order they were given).
+   * It is called on all replicas at once, so it must not modify shared state.
+   */
+  using LossFn = std::function<Tensor(const std::vector<Tensor*>& parameters,
+                                      std::size_t replica)>;
+
+  /**
+   * @throws std::invalid_argument if there are no replicas, the bucket size
+   * is 0, or a parameter is null, isn't dense, doesn't require gradients or
+   * appears twice.
+   */
+  DataParallel(const std::vector<Tensor*>& parameters,
+               std::size_t num_replicas,
+               std::size_t bucket_size = kDefaultBucketSize);
+  ~DataParallel();
+
+  // The replicas' hooks refer to the trainer, so it can't be moved.
+  DataParallel(const DataParallel&) = delete;
+  DataParallel& operator=(const DataParallel&) = delete;
+
+  /**
+   * @brief Copies the parameters to every replica, runs `loss` and its
+   * backward pass on each of them in parallel, and adds the mean of the
+   * replicas' gradients to the gradients of the parameters.
+   *
+   * A parameter's gradient stays row-sparse if every replica's is.
+   *
+   * @return the mean of the replicas' losses
+   */
+  double forward_backward(const LossFn& loss);
+
+  std::size_t num_replicas() const { return replicas_.size(); }
+
+  const std::vector<Tensor*>& parameters() const { return parameters_; }
+
+  // The number of buckets the parameters are grouped into.
+  std::size_t num_buckets() const { return buckets_.size(); }
+
+private:
+  struct Bucket {
+    std::vector<std::size_t> parameters;
+    // The number of (replica, parameter) gradients not accumulated yet.
+    std::atomic<std::size_t> pending{0};
+    std::atomic<bool> reduced{false};
+  };
+
+  // Called by a replica when the gradient of parameter p is complete.
+  void on_gradient(std::size_t p);
+  // Adds the mean of the replicas' gradients to those of the bucket.
+  void reduce(Bucket& bucket);
+
+  std::vector<Tensor*> parameters_;
+  // The copies of the parameters of each replica, which never move.
+  std::vector<std::unique_ptr<Tensor[]>> replicas_;
+  std::vector<std::vector<Tensor*>> replica_parameters_;
+  std::vector<std::unique_ptr<Bucket>> buckets_;
+  // The bucket of each parameter.
+  std::vector<std::size_t> bucket_of_;
+};
+
+}  // namespace ember::distributed
+
+#endif  // !EMBER_DISTRIBUTED_DATA_PARALLEL_H
@@ -0,0 +1,89 @@
+#ifndef EMBER_DISTRIBUTED_DISTRIBUTED_DATA_PARALLEL_H
+#define EMBER_DISTRIBUTED_DISTRIBUTED_DATA_PARALLEL_H
+
+#include <ember/distributed/data_parallel.h>
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace ember {
+struct Tensor;  // Forward declaration
+}
+
+namespace ember::distributed {
+
+class ProcessGroup;
+
+/**
+ * @brief Averages the gradients of a model over the processes of a group,
+ * each of which runs its own backward pass on its own shard of a batch.
+ *
+ * Every process constructs one with the same parameters (in the same order),
+ * runs its forward and backward pass as usual, and calls `synchronize`
+ * before updating the parameters, after which every process holds the mean
+ * of the processes' gradients.
+ *
+ * The averaging overlaps with the backward pass. The parameters are grouped
+ * into buckets of about `bucket_size` elements, in reverse order as
+ * `DataParallel` groups them, and a post-accumulate hook on each parameter
+ * marks its bucket ready once every gradient in it is complete. A background
+ * thread all-reduces the ready buckets over the group while the backward pass
+ * carries on. The buckets are all-reduced in the same order on every process,
+ * waiting for a bucket if a later one is ready first, since the processes
+ * must call the collectives in the same order.
+ *
+ * Each bucket is all-reduced as one dense buffer, so row-sparse gradients
+ * become dense ones, and parameters without a gradient count as zeros.
+ */
+class DistributedDataParallel {
+public:
+  /**
+   * @throws std::invalid_argument if the bucket size is 0, or a parameter is
+   * null, isn't dense, doesn't require gradients or appears twice.
+   */
+  DistributedDataParallel(
+      ProcessGroup& group, const std::vector<Tensor*>& parameters,
+      std::size_t bucket_size = DataParallel::kDefaultBucketSize);
+  ~DistributedDataParallel();
+
+  DistributedDataParallel(const DistributedDataParallel&) = delete;
+  DistributedDataParallel& operator=(const DistributedDataParallel&) = delete;
+
+  /**
+   * @brief Replaces the parameters with those of process `root`, so that
+   * every process starts from the same model.
+   */
+  void broadcast_parameters(std::size_t root = 0);
+
+  /**
+   * @brief Waits until every bucket has been all-reduced, after which the
+   * gradient of each parameter is the mean of its gradients over the group.
+   *
+   * It must be called once after each backward pass, and the group must not
+   * be used for anything else between the backward pass and this call.
+   *
+   * @throws std::system_error if another process has left the group.
+   * @throws std::runtime_error if a parameter's gradient was accumulated
+   * twice before the call.
+   */
+  void synchronize();
+
+  const std::vector<Tensor*>& parameters() const;
+
+  // The number of buckets the parameters are grouped into.
+  std::size_t num_buckets() const;
+
+private:
+  // The state shared with the communication thread and the hooks on the
+  // parameters, which outlive the trainer and do nothing once it is gone.
+  struct State;
+
+  std::shared_ptr<State> state_;
+  std::thread communication_;
+};
+
+}  // namespace ember::distributed
+
+#endif  // !EMBER_DISTRIBUTED_DISTRIBUTED_DATA_PARALLEL_H
@@ -0,0 +1,92 @@
+#ifndef EMBER_DISTRIBUTED_PIPELINE_H
+#define EMBER_DISTRIBUTED_PIPELINE_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace ember {
+struct Tensor;  // Forward declaration
+}
+
+namespace ember::distributed {
+
+/**
+ * @brief The order in which each stage of a pipeline runs the forward and
+ * backward passes of the micro-batches.
+ */
+enum class Schedule {
+  // Every stage runs the forward passes of all the micro-batches, then their
+  // backward passes, so each stage holds the graphs of every micro-batch at
+  // once.
+  GPipe,
+  // After a warm-up of forward passes, which is shorter for later stages,
+  // each stage alternates one forward and one backward pass, so stage s
+  // holds the graphs of at most (number of stages - s) micro-batches.
+  OneForwardOneBackward,
+};
+
+/**
+ * @brief Trains a model split into consecutive stages with each stage on its
+ * own thread, so that different micro-batches of a batch run through
+ * different stages at the same time.
+ *
+ * The batch is split along its first axis into micro-batches of near-equal
+ * size. A stage receives the output of the previous one as a new leaf tensor
+ * that requires gradients, so each stage builds and runs backward on its own
+ * graph: the gradient of a stage's input is what the previous stage starts
+ * its backward pass from. The loss of each micro-batch is weighted by its
+ * share of the rows of the batch, so when the loss is a mean over rows the
+ * gradients accumulated into the parameters are those of the mean loss over
+ * the whole batch.
+ *
+ * Each stage's parameters are only used by its own thread, so stages must not
+ * share parameters. The input of the first stage is treated as data, and
+ * gets no gradient.
+ */
+class Pipeline {
+public:
+  // Computes the output of a stage from the output of the previous one (or
+  // from a micro-batch, for the first stage).
+  using Stage = std::function<Tensor(const Tensor& input)>;
+
+  // Computes the loss of a micro-batch from the output of the last stage and
+  // the rows of the target that match it.
+  using LossFn =
+      std::function<Tensor(const Tensor& output, const Tensor& target)>;
+
+  /**
+   * @throws std::invalid_argument if there are no stages or no
+   * micro-batches.
+   */
+  Pipeline(std::vector<Stage> stages, std::size_t num_micro_batches,
+           Schedule schedule = Schedule::OneForwardOneBackward);
+
+  /**
+   * @brief Runs the forward and backward passes of every micro-batch of
+   * `input` through the stages, accumulating the gradients of the stages'
+   * parameters.
+   *
+   * @return the weighted sum of the micro-batches' losses, i.e. the mean loss
+   * over the batch when the loss is a mean over rows
+   * @throws std::invalid_argument if the input and target have different
+   * numbers of rows, or fewer rows than micro-batches.
+   * Exceptions thrown by a stage or the loss function are rethrown once every
+   * stage has stopped.
+   */
+  double forward_backward(const Tensor& input, const Tensor& target,
+                          const LossFn& loss);
+
+  std::size_t num_stages() const { return stages_.size(); }
+  std::size_t num_micro_batches() const { return num_micro_batches_; }
+  Schedule schedule() const { return schedule_; }
+
+private:
+  std::vector<Stage> stages_;
+  std::size_t num_micro_batches_;
+  Schedule schedule_;
+};
+
+}  // namespace ember::distributed
+
+#endif  // !EMBER_DISTRIBUTED_PIPELINE_H
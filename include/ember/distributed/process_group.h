@@ -0,0 +1,138 @@
+#ifndef EMBER_DISTRIBUTED_PROCESS_GROUP_H
+#define EMBER_DISTRIBUTED_PROCESS_GROUP_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ember {
+struct Tensor;  // Forward declaration
+}
+
+namespace ember::distributed {
+
+/**
+ * @brief A group of processes on the same machine that run collective
+ * operations (all-reduce, broadcast and barrier) together, e.g. one process
+ * per NUMA socket training replicas of the same model.
+ *
+ * The processes form a ring. Each one owns a POSIX shared memory mailbox of a
+ * few slots of `chunk_size` doubles, into which the previous process in the
+ * ring copies its data, and a Unix-domain socket connection to each neighbour
+ * that carries only small messages: "slot i holds n values" in the direction
+ * of the ring and "slot i is free again" back. The data is therefore copied
+ * once per hop, and large buffers are split into chunks that are pipelined
+ * around the ring, so a process sends one chunk while its neighbour is still
+ * reducing the previous one.
+ *
+ * All-reduce uses the ring algorithm (a reduce-scatter followed by an
+ * all-gather), which moves 2 (p - 1) / p times the buffer through each
+ * process regardless of the number of processes p. Every process must call
+ * the same collectives in the same order, with buffers of the same size.
+ *
+ * This is a stand-in for a multi-node backend on a single machine, and is
+ * only available on POSIX systems.
+ */
+class ProcessGroup {
+public:
+  // The default number of doubles in each chunk (256 KiB).
+  static constexpr std::size_t kDefaultChunkSize = 1 << 15;
+
+  /**
+   * @brief Joins the group `name` as process `rank` of `world_size`, waiting
+   * up to `timeout` for the other processes to join.
+   *
+   * Each process of the group must be constructed with the same name, world
+   * size and chunk size, and a different rank. The name must be unique among
+   * the groups running on the machine, and is used to name the mailboxes and
+   * sockets (under the system's temporary directory).
+   *
+   * @throws std::invalid_argument if the rank isn't less than the world size,
+   * the chunk size is 0, or the name is empty or contains '/'.
+   * @throws std::system_error if the mailboxes or sockets can't be set up, or
+   * the other processes don't join in time.
+   */
+  ProcessGroup(const std::string& name, std::size_t rank,
+               std::size_t world_size,
+               std::size_t chunk_size = kDefaultChunkSize,
+               std::chrono::milliseconds timeout = std::chrono::seconds(30));
+  ~ProcessGroup();
+
+  ProcessGroup(const ProcessGroup&) = delete;
+  ProcessGroup& operator=(const ProcessGroup&) = delete;
+
+  std::size_t rank() const { return rank_; }
+  std::size_t world_size() const { return world_size_; }
+
+  /**
+   * @brief Replaces `data` with the element-wise sum of the `n` values of
+   * every process.
+   *
+   * The sum of each element is taken in an order that depends only on its
+   * position and the world size, so every process gets the same result.
+   *
+   * @throws std::system_error if another process has left the group.
+   */
+  void all_reduce(double* data, std::size_t n);
+
+  /**
+   * @brief Replaces the values of a dense tensor with their sum over every
+   * process.
+   */
+  void all_reduce(Tensor& tensor);
+
+  /**
+   * @brief Replaces `data` with the `n` values of process `root`.
+   *
+   * @throws std::invalid_argument if the root isn't a rank of the group.
+   * @throws std::system_error if another process has left the group.
+   */
+  void broadcast(double* data, std::size_t n, std::size_t root);
+
+  /**
+   * @brief Replaces the values of a dense tensor with those of process
+   * `root`.
+   */
+  void broadcast(Tensor& tensor, std::size_t root);
+
+  /**
+   * @brief Waits until every process of the group has called `barrier`.
+   */
+  void barrier();
+
+private:
+  // Sets up the mailboxes and connects to the neighbours in the ring.
+  void join(const std::string& name, std::chrono::milliseconds timeout);
+  // Unmaps the mailboxes and closes the connections.
+  void close();
+  // Copies `count` values into the next process's mailbox.
+  void send(const double* data, std::size_t count);
+  // Waits for the previous process to fill a slot of this process's
+  // mailbox, and returns it. The slot must be released once it is read.
+  const double* receive(std::size_t count, std::size_t& slot);
+  void release(std::size_t slot);
+  // Sends one segment while receiving another, each split into `chunks`
+  // chunks. Received chunks are added to `recv_data` if `add` is true, and
+  // copied otherwise.
+  void exchange(const double* send_data, std::size_t send_count,
+                double* recv_data, std::size_t recv_count,
+                std::size_t chunks, bool add);
+
+  std::size_t rank_;
+  std::size_t world_size_;
+  std::size_t chunk_size_;
+  // The shared memory of this process's mailbox and of the next process's.
+  double* mailbox_ = nullptr;
+  double* next_mailbox_ = nullptr;
+  std::size_t mailbox_bytes_ = 0;
+  // The connections to the previous and next process in the ring.
+  int prev_socket_ = -1;
+  int next_socket_ = -1;
+  // The slots of the next process's mailbox that are free to write.
+  std::vector<std::size_t> free_slots_;
+};
+
+}  // namespace ember::distributed
+
+#endif  // !EMBER_DISTRIBUTED_PROCESS_GROUP_H
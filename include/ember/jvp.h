@@ -0,0 +1,43 @@
+#ifndef EMBER_JVP_H
+#define EMBER_JVP_H
+
+#include <ember/tensor_refs.h>
+
+#include <functional>
+#include <utility>
+
+namespace ember {
+
+struct Tensor;  // Forward declaration
+
+// A function of the primals passed to `jvp`.
+using JvpFn = std::function<Tensor(const TensorRefs& primals)>;
+
+/**
+ * Computes `fn(primals)` and its Jacobian-vector product with `tangents`
+ * (forward-mode AD), i.e. the derivative of the output in the direction of
+ * the tangents, in a single forward pass.
+ *
+ * `fn` is called on copies of the primals that carry their tangents, and
+ * every op it calls gives its output a tangent computed from those of its
+ * inputs along with the output itself. Nothing is recorded for a backward
+ * pass, so no graph is built and nothing is saved. Tensors `fn` uses besides
+ * the primals (e.g. parameters) are constants, unless they carry tangents
+ * of their own (see `Tensor::set_tangent`).
+ *
+ * This is the transpose of a backward pass: one `jvp` gives a column of the
+ * Jacobian, where one backward pass gives a row, so it is cheaper when there
+ * are fewer inputs than outputs.
+ *
+ * @return The output and its tangent, zeros if it doesn't depend on the
+ * primals.
+ * @throws std::invalid_argument if there isn't one tangent of the same shape
+ * for each primal, a primal or tangent is row-sparse or CSR, or `fn` returns
+ * a row-sparse or CSR tensor.
+ */
+std::pair<Tensor, Tensor> jvp(const JvpFn& fn, const TensorRefs& primals,
+                              const TensorRefs& tangents);
+
+}  // namespace ember
+
+#endif  // !EMBER_JVP_H
@@ -0,0 +1,191 @@
+#ifndef EMBER_KERNELS_DISPATCH_H
+#define EMBER_KERNELS_DISPATCH_H
+
+// This header is also included by the per-instruction-set kernel translation
+// units, so it must stay free of inline functions and templates (anything that
+// could be instantiated with wider instructions than the caller supports).
+#include <cstddef>
+
+namespace ember::kernels {
+
+/**
+ * @brief The instruction set levels Ember's kernels are compiled for, in
+ * increasing order of vector width.
+ */
+enum class Isa { Baseline, SSE42, AVX2, AVX512 };
+
+using UnaryKernel = void (*)(const double* x, double* out, std::size_t n);
+using BinaryKernel = void (*)(const double* a, const double* b, double* out,
+                              std::size_t n);
+using AxpyKernel = void (*)(double alpha, const double* x, double* y,
+                            std::size_t n);
+using SumKernel = double (*)(const double* x, std::size_t n);
+using MomentsKernel = void (*)(const double* x, std::size_t n, double* mean,
+                               double* m2);
+using ArgUpdateKernel = void (*)(const double* x, double* best,
+                                 std::size_t* index, std::size_t position,
+                                 std::size_t n);
+using ArgReduceKernel = std::size_t (*)(const double* x, std::size_t n);
+
+/**
+ * @brief The hyperparameters of one step of SGD.
+ *
+ * The gradient is g = grad + weight_decay * param. With momentum, the buffer
+ * b is updated to momentum * b + (1 - dampening) * g (or to g on the first
+ * step) and the update uses b, or g + momentum * b with Nesterov momentum.
+ */
+struct SgdStep {
+  double lr;
+  double momentum;
+  double dampening;
+  double weight_decay;
+  bool nesterov;
+  // Whether this is the first step, on which the buffer is set to g.
+  bool first;
+};
+
+/**
+ * @brief The hyperparameters of one step of Adam, or of AdamW when the
+ * weight decay is decoupled.
+ *
+ * With coupled weight decay, weight_decay * param is added to the gradient,
+ * and with decoupled weight decay the parameter is scaled by
+ * 1 - lr * weight_decay instead. The moments are then updated and the
+ * parameter moves by lr * m_hat / (sqrt(v_hat) + eps), where m_hat and v_hat
+ * are the moments divided by the bias corrections 1 - beta^t.
+ */
+struct AdamStep {
+  double lr;
+  double beta1;
+  double beta2;
+  double eps;
+  double weight_decay;
+  bool decoupled;
+  double bias_correction1;
+  double bias_correction2;
+};
+
+using SgdKernel = void (*)(double* param, const double* grad, double* buffer,
+                           std::size_t n, const SgdStep& step);
+using AdamKernel = void (*)(double* param, const double* grad, double* m,
+                            double* v, std::size_t n, const AdamStep& step);
+
+/**
+ * @brief The set of kernels compiled for a single instruction set.
+ *
+ * All kernels operate on contiguous buffers of `n` doubles. Outputs may alias
+ * inputs, so element-wise kernels can be used in place.
+ */
+struct KernelTable {
+  // The name of the instruction set these kernels were compiled for.
+  const char* name;
+
+  // out[i] = a[i] + b[i]
+  BinaryKernel add;
+  // out[i] = a[i] - b[i]
+  BinaryKernel sub;
+  // out[i] = a[i] * b[i]
+  BinaryKernel mul;
+  // out[i] = a[i] / b[i]
+  BinaryKernel div;
+  // y[i] += alpha * x[i]
+  AxpyKernel axpy;
+  // Returns the sum of x. The summation order depends only on `n`, so the
+  // result is identical for every instruction set.
+  SumKernel sum;
+  // Sets mean to the mean of x and m2 to the sum of the squared differences
+  // from it, in a single pass. Like sum, the result is identical for every
+  // instruction set. Both are 0 when `n` is 0.
+  MomentsKernel moments;
+  // Where x[i] is greater than best[i], sets best[i] = x[i] and
+  // index[i] = position. NaNs count as greater than any number, so that they
+  // propagate.
+  ArgUpdateKernel max_update;
+  // As max_update, but for x[i] less than best[i].
+  ArgUpdateKernel min_update;
+  // Returns the index of the largest element of x (or of its first NaN),
+  // taking the first one in case of ties. `n` must not be 0.
+  ArgReduceKernel argmax;
+  // As argmax, but for the smallest element.
+  ArgReduceKernel argmin;
+  // out[i] = sqrt(x[i])
+  UnaryKernel sqrt;
+  // out[i] = 1 / sqrt(x[i])
+  UnaryKernel rsqrt;
+  // out[i] = max(x[i], 0)
+  UnaryKernel relu;
+
+  // Fused optimizer steps, which read each gradient and update each
+  // parameter and its state in a single pass. The buffer of `sgd` is unused
+  // (and may be null) without momentum.
+  SgdKernel sgd;
+  AdamKernel adam;
+
+  // Polynomial approximations used in fast-math mode (see `set_fast_math`).
+  // out[i] = e^x[i]
+  UnaryKernel fast_exp;
+  // out[i] = log(x[i])
+  UnaryKernel fast_log;
+  // out[i] = tanh(x[i])
+  UnaryKernel fast_tanh;
+  // out[i] = 1 / (1 + e^-x[i])
+  UnaryKernel fast_sigmoid;
+};
+
+/**
+ * @brief Returns the widest instruction set that is both compiled into this
+ * build and supported by the CPU it is running on.
+ */
+Isa detect_isa();
+
+/**
+ * @brief Returns whether kernels for the given instruction set can run on this
+ * machine.
+ */
+bool is_supported(Isa isa);
+
+/**
+ * @brief Returns the instruction set whose kernels are currently in use.
+ */
+Isa active_isa();
+
+/**
+ * @brief Overrides the instruction set whose kernels are used, e.g. to compare
+ * results or timings across instruction sets.
+ *
+ * @throws std::invalid_argument if the instruction set is not supported.
+ */
+void set_isa(Isa isa);
+
+/**
+ * @brief Returns the kernels for the active instruction set.
+ */
+const KernelTable& active();
+
+/**
+ * @brief Enables or disables fast-math mode, which is off by default.
+ *
+ * In fast-math mode `exp`, `log`, `tanh` and `sigmoid` use vectorized
+ * polynomial approximations instead of the C library's functions. These are
+ * within 2 ULP of the exact result for `exp` and `log` and within 3 ULP for
+ * `tanh` and `sigmoid`, compared to the usual 1 ULP, except that results too
+ * small to be represented as normal numbers (below about 1e-308) are flushed
+ * to zero.
+ */
+void set_fast_math(bool enabled);
+
+/**
+ * @brief Returns whether fast-math mode is enabled.
+ */
+bool fast_math_enabled();
+
+/**
+ * @brief Returns the kernels compiled for the given instruction set.
+ *
+ * @throws std::invalid_argument if the instruction set is not supported.
+ */
+const KernelTable& table(Isa isa);
+
+}  // namespace ember::kernels
+
+#endif  // EMBER_KERNELS_DISPATCH_H
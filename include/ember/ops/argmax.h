@@ -0,0 +1,36 @@
+#ifndef EMBER_OPS_ARGMAX_H
+#define EMBER_OPS_ARGMAX_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Finds the position of the largest element of a tensor along the given axis.
+ *
+ * i.e. $y = \arg\max_{i} x_{i}$ along the axis
+ *
+ * The first position is returned when there are ties, and the position of the
+ * first NaN when there are NaNs. A negative axis counts back from the last
+ * axis. The reduced axis is removed from the output unless `keepdims` is true,
+ * in which case it is kept with size 1. The output is not differentiable, so it
+ * never requires gradients.
+ *
+ * @throws std::invalid_argument if the axis is out of range or empty.
+ */
+Tensor argmax(const Tensor& input, std::ptrdiff_t axis, bool keepdims = false);
+
+/**
+ * Finds the position of the largest element of a tensor, as an index into its
+ * flattened elements, returning a 0-dimensional tensor.
+ *
+ * @throws std::invalid_argument if the tensor is empty.
+ */
+Tensor argmax(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_ARGMAX_H
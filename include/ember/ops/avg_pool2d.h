@@ -0,0 +1,35 @@
+#ifndef EMBER_OPS_AVG_POOL2D_H
+#define EMBER_OPS_AVG_POOL2D_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+namespace ember {
+
+/**
+ * Takes the mean of each window sliding over the last two dimensions of a
+ * batch of images.
+ *
+ * i.e. $y_{n,c,i,j} = \frac{1}{k_0 k_1} \sum_{k,l}
+ * x_{n,c,i s_0 - p_0 + k,j s_1 - p_1 + l}$
+ *
+ * The input has shape (batch, channels, height, width). Each pair holds the
+ * value along the height and then the width, and the stride defaults to the
+ * kernel size. The padding can be at most half of the kernel size, and counts
+ * as zeros towards the mean, so every mean is over the whole kernel.
+ *
+ * @throws std::invalid_argument if the input isn't 4-dimensional, or the
+ * window doesn't fit the input.
+ */
+Tensor avg_pool2d(
+    const Tensor& input, const std::array<std::size_t, 2>& kernel_size,
+    const std::optional<std::array<std::size_t, 2>>& stride = std::nullopt,
+    const std::array<std::size_t, 2>& padding = {0, 0});
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_AVG_POOL2D_H
@@ -0,0 +1,37 @@
+#ifndef EMBER_OPS_BATCH_NORM_H
+#define EMBER_OPS_BATCH_NORM_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Normalizes each channel of a batch to zero mean and unit variance, then
+ * scales and shifts it.
+ *
+ * i.e. $y = \frac{x - \mu_{c}}{\sqrt{\sigma_{c}^2 + \epsilon}} w_{c} + b_{c}$
+ * for the elements $x$ of each channel $c$
+ *
+ * The input has shape (batch, channels, ...), and the statistics of a channel
+ * are taken over every dimension except the second. The weight, bias and
+ * running statistics have shape (channels).
+ *
+ * When `training` is true, the mean and (biased) variance of each channel are
+ * computed from the batch in a single pass, and `running_mean` and
+ * `running_var` are updated in place as
+ * `running = (1 - momentum) * running + momentum * batch`, using the unbiased
+ * variance, except when a checkpointed segment is recomputed in the backward
+ * pass. Otherwise, the running statistics are used to normalize and are left
+ * unchanged. The running statistics never receive gradients.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match, or
+ *         if training with a single value per channel.
+ */
+Tensor batch_norm(const Tensor& input, const Tensor& weight, const Tensor& bias,
+                  Tensor& running_mean, Tensor& running_var, bool training,
+                  double momentum = 0.1, double eps = 1e-5);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_BATCH_NORM_H
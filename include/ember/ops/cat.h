@@ -0,0 +1,64 @@
+#ifndef EMBER_OPS_CAT_H
+#define EMBER_OPS_CAT_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+#include <ember/tensor_refs.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Concatenates tensors along an axis.
+ *
+ * i.e. $y = [x_1, x_2, ..., x_n]$ along the axis
+ *
+ * The tensors must have the same shape except along the axis, and the output
+ * has their shape with the sizes along the axis summed. A negative axis counts
+ * back from the last axis.
+ *
+ * The output is allocated once and each input is copied straight into its
+ * slice of it, a contiguous run of elements per index of the axes before the
+ * concatenated one. The gradient of each input is the matching slice of the
+ * output's gradient.
+ *
+ * @throws std::invalid_argument if there are no tensors, the axis is out of
+ * range or the shapes of the tensors don't match.
+ */
+Tensor cat(const TensorRefs& inputs, std::ptrdiff_t axis = 0);
+
+/**
+ * Concatenates tensors along an axis into `out`, which must already have the
+ * shape of the result.
+ *
+ * Each input is copied into its slice of `out`'s data, so a destination that
+ * is reused, e.g. across training steps, is never reallocated. `out` then
+ * stands for the result as if it were returned by `cat`: its old values, node
+ * and tangent are replaced by those of the concatenation.
+ *
+ * @see ember::cat
+ * @return A reference to `out`
+ * @throws std::invalid_argument if `cat` would throw, `out` is sparse or has
+ * another shape, or `out` is one of the inputs.
+ */
+Tensor& cat_into(Tensor& out, const TensorRefs& inputs,
+                 std::ptrdiff_t axis = 0);
+
+/**
+ * Stacks tensors of the same shape along a new axis.
+ *
+ * i.e. $y_{..., k, ...} = x_k$ along the new axis
+ *
+ * The output has the shape of the tensors with an axis of size n inserted at
+ * `axis`, which may be any axis of the output. It is computed like `cat`.
+ *
+ * @see ember::cat
+ * @throws std::invalid_argument if there are no tensors, the axis is out of
+ * range or the shapes of the tensors differ.
+ */
+Tensor stack(const TensorRefs& inputs, std::ptrdiff_t axis = 0);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_CAT_H
@@ -0,0 +1,66 @@
+#ifndef EMBER_OPS_CONV2D_H
+#define EMBER_OPS_CONV2D_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <array>
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * The hyperparameters of a 2-dimensional convolution. Each pair holds the
+ * value along the height and then the width.
+ */
+struct Conv2dOptions {
+  // The step between successive positions of the kernel.
+  std::array<std::size_t, 2> stride = {1, 1};
+  // The number of implicit zeros added to each side of the input.
+  std::array<std::size_t, 2> padding = {0, 0};
+  // The step between the input elements seen by adjacent kernel elements.
+  std::array<std::size_t, 2> dilation = {1, 1};
+  // The number of groups the channels are split into, each of which is
+  // convolved with its own slice of the weight.
+  std::size_t groups = 1;
+};
+
+/**
+ * Applies a 2-dimensional convolution (strictly, a cross-correlation) to a
+ * batch of images.
+ *
+ * i.e. $y_{n,o,i,j} = b_{o} + \sum_{c,k,l} w_{o,c,k,l}
+ * x_{n,c,i s_0 - p_0 + k d_0,j s_1 - p_1 + l d_1}$
+ * where $c$ ranges over the input channels in the group of output channel $o$
+ *
+ * The input has shape (batch, in_channels, height, width), the weight has
+ * shape (out_channels, in_channels / groups, kernel_height, kernel_width) and
+ * the bias has shape (out_channels).
+ *
+ * Each group of each image is unfolded into a matrix of patches (im2col) and
+ * multiplied by the weight with the same matrix multiplication as `matmul`.
+ * 1x1 convolutions with no stride or padding multiply the input directly, and
+ * depthwise convolutions (one input channel per group) use a direct kernel, as
+ * neither benefits from unfolding.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match, or
+ * the options don't fit the input.
+ */
+Tensor conv2d(const Tensor& input, const Tensor& weight, const Tensor& bias,
+              const Conv2dOptions& options = {});
+
+/**
+ * Applies a 2-dimensional convolution without a bias to a batch of images.
+ *
+ * i.e. $y_{n,o,i,j} = \sum_{c,k,l} w_{o,c,k,l}
+ * x_{n,c,i s_0 - p_0 + k d_0,j s_1 - p_1 + l d_1}$
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match, or
+ * the options don't fit the input.
+ */
+Tensor conv2d(const Tensor& input, const Tensor& weight,
+              const Conv2dOptions& options = {});
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_CONV2D_H
@@ -0,0 +1,27 @@
+#ifndef EMBER_OPS_CROSS_ENTROPY_H
+#define EMBER_OPS_CROSS_ENTROPY_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes the mean cross-entropy loss between a batch of logits and the
+ * classes they should predict, returning a 0-dimensional tensor.
+ *
+ * i.e. $y = -\frac{1}{N} \sum_{n} \log softmax(x_{n})_{t_{n}}$
+ *
+ * The logits have shape (batch, classes) and the targets have shape (batch),
+ * holding the index of each example's class (e.g. as returned by `argmax`).
+ * Only the logits receive a gradient, which is computed directly as
+ * $(softmax(x_{n}) - onehot(t_{n})) / N$.
+ *
+ * @throws std::invalid_argument if the shapes don't match or a target isn't
+ *         the index of a class.
+ */
+Tensor cross_entropy(const Tensor& logits, const Tensor& targets);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_CROSS_ENTROPY_H
@@ -0,0 +1,28 @@
+#ifndef EMBER_OPS_DROPOUT_H
+#define EMBER_OPS_DROPOUT_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Zeroes each element of the tensor with probability `p` while training, and
+ * scales the rest so that the expected value of each element is unchanged.
+ *
+ * i.e. $y_i = \frac{m_i x_i}{1 - p}$ where $m_i \sim \text{Bernoulli}(1 - p)$
+ *
+ * The mask is drawn from a counter-based generator (Philox), so each element
+ * is drawn independently of the others and the output is the same for any
+ * number of threads. Only the position of the draws in the generator's
+ * stream is saved for the backward pass, which regenerates the mask instead
+ * of storing it. Call `manual_seed` for reproducible masks. Outside training,
+ * or for `p` of 0, the input is returned as is.
+ *
+ * @throws std::invalid_argument if `p` is outside [0, 1].
+ */
+Tensor dropout(const Tensor& input, double p = 0.5, bool training = true);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_DROPOUT_H
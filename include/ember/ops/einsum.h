@@ -0,0 +1,41 @@
+#ifndef EMBER_OPS_EINSUM_H
+#define EMBER_OPS_EINSUM_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+#include <ember/tensor_refs.h>
+
+#include <string>
+
+namespace ember {
+
+/**
+ * Computes a tensor contraction written in Einstein summation notation.
+ *
+ * i.e. $y_{bik} = \sum_j a_{bij} b_{bjk}$ for "bij,bjk->bik"
+ *
+ * The equation labels the axes of each operand with a letter, separated by
+ * commas, followed by "->" and the labels of the output's axes. The output's
+ * axes are the product of the operands' over every combination of labels,
+ * summed over the labels missing from the output. Without "->", the output
+ * has the labels that appear once, in alphabetical order (e.g. "ij,jk" is
+ * "ij,jk->ik"). Spaces are ignored.
+ *
+ * Labels that only one operand has and the output doesn't are summed first,
+ * and the operands are then contracted two at a time, each contraction
+ * lowered to a batched matrix multiplication. For three or more operands the
+ * order of the contractions minimizes the total number of multiplications.
+ * The plan for each equation and set of shapes is cached, so repeated calls
+ * (and the backward pass, whose gradients are contractions too) only pay for
+ * the multiplications.
+ *
+ * @throws std::invalid_argument if the equation is malformed, doesn't have a
+ * label for each axis of each operand, repeats a label within an operand or
+ * the output, uses a label in the output that no operand has, or labels axes
+ * of different sizes with the same letter.
+ */
+Tensor einsum(const std::string& equation, const TensorRefs& operands);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_EINSUM_H
@@ -0,0 +1,31 @@
+#ifndef EMBER_OPS_EMBEDDING_H
+#define EMBER_OPS_EMBEDDING_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Looks up the rows of a table (e.g. of word embeddings) at the given
+ * indices.
+ *
+ * i.e. $y_{i} = W_{idx_{i}}$
+ *
+ * The weight has shape (num_embeddings, ...), and the indices can have any
+ * shape and hold integers in [0, num_embeddings). The output has the shape of
+ * the indices followed by the shape of a row of the weight.
+ *
+ * The gradient of the weight is row-sparse (see `SparseRows`) and holds only
+ * the rows that were looked up, so its size is proportional to the number of
+ * lookups rather than to the size of the table. The weight isn't saved for
+ * the backward pass, and the indices don't get a gradient.
+ *
+ * @throws std::invalid_argument if the weight has no dimensions or an index
+ * is out of range.
+ */
+Tensor embedding(const Tensor& weight, const Tensor& indices);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_EMBEDDING_H
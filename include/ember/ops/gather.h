@@ -0,0 +1,32 @@
+#ifndef EMBER_OPS_GATHER_H
+#define EMBER_OPS_GATHER_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Gathers the elements of a tensor along an axis at the positions given by an
+ * index.
+ *
+ * i.e. $y_{i,j} = x_{idx_{i,j},j}$ for a 2-dimensional input and axis 0, and
+ * $y_{i,j} = x_{i,idx_{i,j}}$ for axis 1
+ *
+ * The index is a tensor of integers with as many dimensions as the input,
+ * which is no larger than the input along the other axes, and the output has
+ * the shape of the index. A negative axis counts back from the last axis.
+ *
+ * When the axis is the first, the gradient of the input is row-sparse (see
+ * `SparseRows`) and holds only the rows that were gathered from.
+ *
+ * @throws std::invalid_argument if the axis is out of range, the shape of the
+ * index doesn't fit the input or an index is out of range.
+ */
+Tensor gather(const Tensor& input, std::ptrdiff_t axis, const Tensor& index);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_GATHER_H
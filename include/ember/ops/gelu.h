@@ -0,0 +1,21 @@
+#ifndef EMBER_OPS_GELU_H
+#define EMBER_OPS_GELU_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Applies the Gaussian error linear unit to each element in the tensor.
+ *
+ * i.e. $y_{i} = x_i \Phi(x_i) = \frac{x_i}{2} (1 + erf(\frac{x_i}{\sqrt{2}}))$
+ *
+ * This is the exact form based on `erf`, not the tanh approximation, and is not
+ * affected by fast-math mode.
+ */
+Tensor gelu(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_GELU_H
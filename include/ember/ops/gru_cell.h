@@ -0,0 +1,37 @@
+#ifndef EMBER_OPS_GRU_CELL_H
+#define EMBER_OPS_GRU_CELL_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes one timestep of a GRU.
+ *
+ * i.e. $[x_r, x_z, x_n] = x W_{ih} + b_{ih}$,
+ * $[h_r, h_z, h_n] = h W_{hh} + b_{hh}$, $r = \sigma(x_r + h_r)$,
+ * $z = \sigma(x_z + h_z)$, $n = \tanh(x_n + r h_n)$ and
+ * $h' = (1 - z) n + z h$
+ *
+ * The input has shape (batch, input_size), the hidden state has shape
+ * (batch, hidden_size), the weights have shapes (input_size, 3 * hidden_size)
+ * and (hidden_size, 3 * hidden_size), and the biases have shape
+ * (3 * hidden_size), where each holds the reset, update and new gates in that
+ * order. The biases are separate because the reset gate scales the hidden
+ * state's contribution to the new gate, bias included.
+ *
+ * The pre-activations of all three gates are computed with one matrix
+ * multiplication per weight, and their nonlinearities and the new hidden
+ * state are computed in a single pass over each row. The cell is a single
+ * node in the graph, which saves the gate activations besides its inputs.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+Tensor gru_cell(const Tensor& input, const Tensor& hidden,
+                const Tensor& weight_ih, const Tensor& weight_hh,
+                const Tensor& bias_ih, const Tensor& bias_hh);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_GRU_CELL_H
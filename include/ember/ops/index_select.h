@@ -0,0 +1,31 @@
+#ifndef EMBER_OPS_INDEX_SELECT_H
+#define EMBER_OPS_INDEX_SELECT_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Selects the slices of a tensor at the given indices along an axis.
+ *
+ * i.e. $y_{..., k, ...} = x_{..., idx_{k}, ...}$ along the axis
+ *
+ * The index is a 1-dimensional tensor of integers, which may repeat, and the
+ * output has the shape of the input with the size of the axis replaced by the
+ * number of indices. A negative axis counts back from the last axis.
+ *
+ * When the axis is the first, the gradient of the input is row-sparse (see
+ * `SparseRows`) and holds only the selected rows.
+ *
+ * @throws std::invalid_argument if the axis is out of range, the index isn't
+ * 1-dimensional or an index is out of range.
+ */
+Tensor index_select(const Tensor& input, std::ptrdiff_t axis,
+                    const Tensor& index);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_INDEX_SELECT_H
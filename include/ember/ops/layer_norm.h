@@ -0,0 +1,28 @@
+#ifndef EMBER_OPS_LAYER_NORM_H
+#define EMBER_OPS_LAYER_NORM_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Normalizes each row of a tensor (i.e. its last dimension) to zero mean and
+ * unit variance, then scales and shifts it.
+ *
+ * i.e. $y_{i} = \frac{x_{i} - \mu}{\sqrt{\sigma^2 + \epsilon}} w_{i} + b_{i}$
+ * where $\mu$ and $\sigma^2$ are the mean and (biased) variance of the row
+ *
+ * The weight and bias have shape (features), where features is the size of
+ * the last dimension. The mean and variance of each row are computed in a
+ * single pass, and only they are saved for the backward pass besides the
+ * input and weight.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+Tensor layer_norm(const Tensor& input, const Tensor& weight, const Tensor& bias,
+                  double eps = 1e-5);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_LAYER_NORM_H
@@ -0,0 +1,46 @@
+#ifndef EMBER_OPS_LINEAR_H
+#define EMBER_OPS_LINEAR_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * The activation function applied by `linear` to its output.
+ */
+enum class Activation { None, ReLU, Sigmoid, Tanh, GELU };
+
+/**
+ * Applies a fully connected layer to a batch of inputs.
+ *
+ * i.e. $y = f(x W + b)$ where $f$ is the activation
+ *
+ * The input has shape (batch, in_features), the weight has shape
+ * (in_features, out_features) and the bias has shape (out_features). This gives
+ * the same result as `activation(matmul(input, weight) + bias)`, but the bias
+ * and activation are applied to the output of the matrix multiplication in
+ * place and the whole layer is a single node in the computational graph, so it
+ * uses less memory and makes fewer passes over the output.
+ *
+ * The activations are computed the same way as the corresponding ops (e.g.
+ * `sigmoid`), including in fast-math mode.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+Tensor linear(const Tensor& input, const Tensor& weight, const Tensor& bias,
+              Activation activation = Activation::None);
+
+/**
+ * Applies a fully connected layer without a bias to a batch of inputs.
+ *
+ * i.e. $y = f(x W)$ where $f$ is the activation
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+Tensor linear(const Tensor& input, const Tensor& weight,
+              Activation activation = Activation::None);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_LINEAR_H
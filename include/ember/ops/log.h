@@ -0,0 +1,21 @@
+#ifndef EMBER_OPS_LOG_H
+#define EMBER_OPS_LOG_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes the natural logarithm of each element in the tensor.
+ *
+ * i.e. $y_{i} = \ln(x_i)$
+ *
+ * Zeros map to negative infinity and negative numbers to NaN. In fast-math
+ * mode a vectorized approximation is used (see `kernels::set_fast_math`).
+ */
+Tensor log(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_LOG_H
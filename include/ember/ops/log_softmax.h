@@ -0,0 +1,25 @@
+#ifndef EMBER_OPS_LOG_SOFTMAX_H
+#define EMBER_OPS_LOG_SOFTMAX_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Computes the log of the softmax of a tensor along the given axis.
+ *
+ * i.e. $y_{i} = x_{i} - \log \sum_{j} e^{x_{j}}$ along the axis
+ *
+ * This is more accurate than taking the log of `softmax`, which rounds very
+ * small probabilities to 0. A negative axis counts back from the last axis.
+ *
+ * @throws std::invalid_argument if the axis is out of range.
+ */
+Tensor log_softmax(const Tensor& input, std::ptrdiff_t axis = -1);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_LOG_SOFTMAX_H
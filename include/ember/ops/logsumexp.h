@@ -0,0 +1,36 @@
+#ifndef EMBER_OPS_LOGSUMEXP_H
+#define EMBER_OPS_LOGSUMEXP_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+
+/**
+ * Computes the log of the sum of the exponents of the elements of a tensor over
+ * the given axes.
+ *
+ * i.e. $y = \log \sum_{i} e^{x_{i}}$ along each of the axes
+ *
+ * The largest element is subtracted before exponentiating, so the result is
+ * accurate even when $e^{x_{i}}$ would overflow. Negative axes count back from
+ * the last axis. The reduced axes are removed from the output unless
+ * `keepdims` is true, in which case they are kept with size 1.
+ *
+ * @throws std::invalid_argument if an axis is out of range or repeated.
+ */
+Tensor logsumexp(const Tensor& input, const std::vector<std::ptrdiff_t>& axes,
+                 bool keepdims = false);
+
+/**
+ * Computes the log of the sum of the exponents of all the elements of a
+ * tensor, returning a 0-dimensional tensor.
+ */
+Tensor logsumexp(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_LOGSUMEXP_H
@@ -0,0 +1,64 @@
+#ifndef EMBER_OPS_LSTM_H
+#define EMBER_OPS_LSTM_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <utility>
+
+namespace ember {
+
+/**
+ * The state an LSTM carries between timesteps: the hidden state, which is
+ * also the output of the timestep, and the cell state, in that order. Both
+ * have shape (batch, hidden_size).
+ */
+using LstmState = std::pair<Tensor, Tensor>;
+
+/**
+ * Computes one timestep of an LSTM.
+ *
+ * i.e. $[i, f, g, o] = x W_{ih} + h W_{hh} + b$,
+ * $c' = \sigma(f) c + \sigma(i) \tanh(g)$ and $h' = \sigma(o) \tanh(c')$
+ *
+ * The input has shape (batch, input_size), the weights have shapes
+ * (input_size, 4 * hidden_size) and (hidden_size, 4 * hidden_size), and the
+ * bias has shape (4 * hidden_size), where each holds the input, forget, cell
+ * and output gates in that order.
+ *
+ * The pre-activations of all four gates are computed with one matrix
+ * multiplication per weight, and their nonlinearities and the new state are
+ * computed in a single pass over each row. The cell is a single node in the
+ * graph, which saves the gate activations and the cell states besides its
+ * inputs, and the returned hidden and cell states each select their half of
+ * its output.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+LstmState lstm_cell(const Tensor& input, const LstmState& state,
+                    const Tensor& weight_ih, const Tensor& weight_hh,
+                    const Tensor& bias);
+
+/**
+ * Runs an LSTM over a sequence, as repeated applications of `lstm_cell`
+ * starting from `initial`, and returns the hidden state of every timestep,
+ * with shape (steps, batch, hidden_size), and the state after the last one.
+ *
+ * The input has shape (steps, batch, input_size). The whole sequence is a
+ * single node in the graph: the input's contribution to the gates of every
+ * timestep is computed with one matrix multiplication up front, the gates and
+ * states of every timestep are written to buffers allocated once, and the
+ * backward pass walks the timesteps in reverse, leaving the gradients of the
+ * weights to one matrix multiplication each at the end.
+ *
+ * @see ember::lstm_cell
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+std::pair<Tensor, LstmState> lstm(const Tensor& input,
+                                  const LstmState& initial,
+                                  const Tensor& weight_ih,
+                                  const Tensor& weight_hh, const Tensor& bias);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_LSTM_H
@@ -8,6 +8,16 @@ namespace ember {
 
 /**
  * Performs matrix multiplication of a and b.
+ *
+ * `a` may be a CSR matrix (see `Tensor::from_csr`) of shape (m, k), in which
+ * case `b` must be a dense matrix of shape (k, n) or a vector of size k. The
+ * product is computed from the nonzero elements only, with the rows of the
+ * output split across threads. The gradient of `b` is the product of a's
+ * transpose and the output's gradient, and the gradient of `a` is a CSR
+ * matrix with a's sparsity pattern.
+ *
+ * @throws std::invalid_argument if `b` is a CSR matrix, either is row-sparse,
+ * or `a` is a CSR matrix and the shape of `b` doesn't match it.
  */
 Tensor matmul(const Tensor& a, const Tensor& b);
 
@@ -0,0 +1,35 @@
+#ifndef EMBER_OPS_MAX_H
+#define EMBER_OPS_MAX_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Finds the largest element of a tensor along the given axis.
+ *
+ * i.e. $y = \max_{i} x_{i}$ along the axis
+ *
+ * A negative axis counts back from the last axis. The reduced axis is removed
+ * from the output unless `keepdims` is true, in which case it is kept with
+ * size 1. NaNs are propagated. Only the position of the first largest element
+ * is remembered for the backward pass, so when there are ties the whole
+ * gradient flows to that element.
+ *
+ * @throws std::invalid_argument if the axis is out of range or empty.
+ */
+Tensor max(const Tensor& input, std::ptrdiff_t axis, bool keepdims = false);
+
+/**
+ * Finds the largest element of a tensor, returning a 0-dimensional tensor.
+ *
+ * @throws std::invalid_argument if the tensor is empty.
+ */
+Tensor max(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_MAX_H
@@ -0,0 +1,34 @@
+#ifndef EMBER_OPS_MEAN_H
+#define EMBER_OPS_MEAN_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+
+/**
+ * Computes the mean of the elements of a tensor over the given axes.
+ *
+ * i.e. $y = \frac{1}{n} \sum_{i} x_{i}$ along each of the axes
+ *
+ * Negative axes count back from the last axis. The reduced axes are removed
+ * from the output unless `keepdims` is true, in which case they are kept with
+ * size 1. The mean of no elements is NaN.
+ *
+ * @throws std::invalid_argument if an axis is out of range or repeated.
+ */
+Tensor mean(const Tensor& input, const std::vector<std::ptrdiff_t>& axes,
+            bool keepdims = false);
+
+/**
+ * Computes the mean of all the elements of a tensor, returning a
+ * 0-dimensional tensor.
+ */
+Tensor mean(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_MEAN_H
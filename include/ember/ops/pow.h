@@ -0,0 +1,21 @@
+#ifndef EMBER_OPS_POW_H
+#define EMBER_OPS_POW_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Raises each element in the base tensor to the power of the corresponding
+ * element in the exponent tensor, broadcasting them against each other.
+ *
+ * i.e. $y_{i} = a_{i}^{b_{i}}$
+ *
+ * The gradient w.r.t. the exponent is taken to be 0 wherever the base is 0.
+ */
+Tensor pow(const Tensor& base, const Tensor& exponent);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_POW_H
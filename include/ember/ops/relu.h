@@ -0,0 +1,20 @@
+#ifndef EMBER_OPS_RELU_H
+#define EMBER_OPS_RELU_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Applies the rectified linear unit to each element in the tensor.
+ *
+ * i.e. $y_{i} = \max(x_i, 0)$
+ *
+ * The gradient at 0 is taken to be 0.
+ */
+Tensor relu(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_RELU_H
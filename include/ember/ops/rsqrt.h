@@ -0,0 +1,18 @@
+#ifndef EMBER_OPS_RSQRT_H
+#define EMBER_OPS_RSQRT_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes the reciprocal of the square root of each element in the tensor.
+ *
+ * i.e. $y_{i} = \frac{1}{\sqrt{x_i}}$
+ */
+Tensor rsqrt(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_RSQRT_H
@@ -0,0 +1,48 @@
+#ifndef EMBER_OPS_SCALED_DOT_PRODUCT_ATTENTION_H
+#define EMBER_OPS_SCALED_DOT_PRODUCT_ATTENTION_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes attention over a batch of sequences, where each query attends to
+ * the keys it isn't masked from.
+ *
+ * i.e. $y = softmax(\frac{Q K^T}{\sqrt{d}} + M) V$ where $M$ is 0 where
+ * the mask is nonzero and $-\infty$ elsewhere
+ *
+ * The query has shape (..., queries, d), the key has shape (..., keys, d), the
+ * value has shape (..., keys, d_v) and the output has shape (..., queries,
+ * d_v), where the leading dimensions (e.g. batch and heads) are the same for
+ * all of them. The mask has shape (queries, keys), or the leading dimensions
+ * followed by (queries, keys). A query that is masked from every key gets an
+ * output (and gradients) of zeros.
+ *
+ * The scores are computed one tile of queries and keys at a time, and the
+ * softmax is accumulated across the tiles of keys with a running maximum and
+ * sum (i.e. an online softmax), so the (queries, keys) matrices of scores and
+ * probabilities are never materialized. Only the output and the logsumexp of
+ * each query's scores are saved besides the inputs, and the backward pass
+ * recomputes each tile of probabilities from them.
+ *
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+Tensor scaled_dot_product_attention(const Tensor& query, const Tensor& key,
+                                    const Tensor& value, const Tensor& mask);
+
+/**
+ * Computes attention over a batch of sequences, optionally with a causal mask
+ * that lets query i attend to keys 0, ..., i only. Masked tiles are skipped
+ * entirely.
+ *
+ * @see ember::scaled_dot_product_attention
+ * @throws std::invalid_argument if the shapes of the tensors don't match.
+ */
+Tensor scaled_dot_product_attention(const Tensor& query, const Tensor& key,
+                                    const Tensor& value, bool causal = false);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SCALED_DOT_PRODUCT_ATTENTION_H
@@ -0,0 +1,35 @@
+#ifndef EMBER_OPS_SCATTER_ADD_H
+#define EMBER_OPS_SCATTER_ADD_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Adds the elements of a source tensor to a copy of the input at the
+ * positions given by an index along an axis, i.e. the reverse of `gather`.
+ *
+ * i.e. $y_{idx_{i,j},j} = x_{idx_{i,j},j} + \sum src_{i,j}$ for a
+ * 2-dimensional input and axis 0, where the sum is over the elements of the
+ * source with the same index
+ *
+ * The index and the source have the same shape, with as many dimensions as
+ * the input and no larger than it along the other axes, and the output has the
+ * shape of the input. A negative axis counts back from the last axis.
+ *
+ * The gradient of the source gathers the output's gradient at the same
+ * positions, and the gradient of the input is the output's gradient.
+ *
+ * @throws std::invalid_argument if the axis is out of range, the shapes of the
+ * index and source don't match or don't fit the input, or an index is out of
+ * range.
+ */
+Tensor scatter_add(const Tensor& input, std::ptrdiff_t axis,
+                   const Tensor& index, const Tensor& source);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SCATTER_ADD_H
@@ -0,0 +1,21 @@
+#ifndef EMBER_OPS_SIGMOID_H
+#define EMBER_OPS_SIGMOID_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes the logistic sigmoid of each element in the tensor.
+ *
+ * i.e. $y_{i} = \frac{1}{1 + e^{-x_i}}$
+ *
+ * In fast-math mode a vectorized approximation is used (see
+ * `kernels::set_fast_math`).
+ */
+Tensor sigmoid(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SIGMOID_H
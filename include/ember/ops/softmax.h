@@ -0,0 +1,27 @@
+#ifndef EMBER_OPS_SOFTMAX_H
+#define EMBER_OPS_SOFTMAX_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+
+namespace ember {
+
+/**
+ * Normalizes the exponents of the elements of a tensor along the given axis so
+ * that they sum to 1.
+ *
+ * i.e. $y_{i} = \frac{e^{x_{i}}}{\sum_{j} e^{x_{j}}}$ along the axis
+ *
+ * The largest element is subtracted before exponentiating, so the result is
+ * accurate even when $e^{x_{i}}$ would overflow. A negative axis counts back
+ * from the last axis.
+ *
+ * @throws std::invalid_argument if the axis is out of range.
+ */
+Tensor softmax(const Tensor& input, std::ptrdiff_t axis = -1);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SOFTMAX_H
@@ -0,0 +1,50 @@
+#ifndef EMBER_OPS_SPLIT_H
+#define EMBER_OPS_SPLIT_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+
+/**
+ * Splits a tensor along an axis into consecutive pieces of the given sizes.
+ *
+ * i.e. $[y_1, y_2, ..., y_n] = x$ along the axis
+ *
+ * The sizes must add up to the size of the axis, and may be zero. A negative
+ * axis counts back from the last axis.
+ *
+ * Each piece is its own node in the graph, whose gradient is written to its
+ * slice of a gradient of the input's shape. A piece is copied out of the input
+ * with one copy per index of the axes before the split one, so splitting along
+ * the first axis (or after axes of size 1) copies each piece in one go.
+ *
+ * @throws std::invalid_argument if the axis is out of range or the sizes
+ * don't add up to the size of the axis.
+ */
+std::vector<Tensor> split(const Tensor& input,
+                          const std::vector<std::size_t>& sizes,
+                          std::ptrdiff_t axis = 0);
+
+/**
+ * Splits a tensor along an axis into `chunks` pieces of the same size, except
+ * for the last, which is smaller if the size of the axis isn't divisible by
+ * the number of chunks.
+ *
+ * As in PyTorch, each piece has the size of the axis divided by `chunks`,
+ * rounded up, so there may be fewer than `chunks` pieces (e.g. chunking an
+ * axis of size 5 into 4 gives pieces of sizes 2, 2 and 1).
+ *
+ * @see ember::split
+ * @throws std::invalid_argument if `chunks` is zero or the axis is out of
+ * range.
+ */
+std::vector<Tensor> chunk(const Tensor& input, std::size_t chunks,
+                          std::ptrdiff_t axis = 0);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SPLIT_H
@@ -0,0 +1,18 @@
+#ifndef EMBER_OPS_SQRT_H
+#define EMBER_OPS_SQRT_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes the square root of each element in the tensor.
+ *
+ * i.e. $y_{i} = \sqrt{x_i}$
+ */
+Tensor sqrt(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SQRT_H
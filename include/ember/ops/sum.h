@@ -0,0 +1,33 @@
+#ifndef EMBER_OPS_SUM_H
+#define EMBER_OPS_SUM_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+
+/**
+ * Sums the elements of a tensor over the given axes.
+ *
+ * i.e. $y = \sum_{i} x_{i}$ along each of the axes
+ *
+ * Negative axes count back from the last axis. The reduced axes are removed
+ * from the output unless `keepdims` is true, in which case they are kept with
+ * size 1.
+ *
+ * @throws std::invalid_argument if an axis is out of range or repeated.
+ */
+Tensor sum(const Tensor& input, const std::vector<std::ptrdiff_t>& axes,
+           bool keepdims = false);
+
+/**
+ * Sums all the elements of a tensor, returning a 0-dimensional tensor.
+ */
+Tensor sum(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_SUM_H
@@ -0,0 +1,21 @@
+#ifndef EMBER_OPS_TANH_H
+#define EMBER_OPS_TANH_H
+
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+namespace ember {
+
+/**
+ * Computes the hyperbolic tangent of each element in the tensor.
+ *
+ * i.e. $y_{i} = \tanh(x_i)$
+ *
+ * In fast-math mode a vectorized approximation is used (see
+ * `kernels::set_fast_math`).
+ */
+Tensor tanh(const Tensor& input);
+
+}  // namespace ember
+
+#endif  // !EMBER_OPS_TANH_H
@@ -1,61 +1,564 @@
 #ifndef EMBER_OPS_UTILS_H
 #define EMBER_OPS_UTILS_H
 
+#include <ember/autograd/grad_mode.h>
+#include <ember/kernels/dispatch.h>
+#include <ember/parallel/parallel.h>
+#include <ember/sparse_rows.h>
+#include <ember/tensor.h>
+#include <ember/tensor_refs.h>
+
+#include "xtensor/xadapt.hpp"
 #include "xtensor/xarray.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 namespace ember {
 
 xt::xarray<double> reduce_broadcast(
     const xt::xarray<double>& source,
     const xt::xarray<double>::shape_type& target_shape);
 
+/**
+ * Returns the outer products of each row of `x`, of shape (batch, m), with the
+ * same row of `g`, of shape (batch, n), as an array of shape (batch, m, n).
+ * These are the gradients of each sample for the weight of `x W`.
+ */
+xt::xarray<double> per_sample_outer(const xt::xarray<double>& x,
+                                    const xt::xarray<double>& g);
+
+/**
+ * Applies an element-wise kernel to two arrays that are broadcast against each
+ * other following NumPy's rules, returning a new array with the broadcast
+ * shape.
+ */
+xt::xarray<double> apply_binary_kernel(kernels::BinaryKernel kernel,
+                                       const xt::xarray<double>& a,
+                                       const xt::xarray<double>& b);
+
+/**
+ * Adds `source` into `target` in place. Both arrays must have the same shape.
+ *
+ * @throws std::invalid_argument if the shapes differ.
+ */
+void accumulate(xt::xarray<double>& target, const xt::xarray<double>& source);
+
+/**
+ * Describes a reduction over a contiguous run of dimensions as a reduction over
+ * the middle dimension of an array of shape (outer, size, inner).
+ */
+struct ReductionBlock {
+  // The product of the dimensions before the reduced ones.
+  std::size_t outer;
+  // The product of the reduced dimensions.
+  std::size_t size;
+  // The product of the dimensions after the reduced ones.
+  std::size_t inner;
+};
+
+/**
+ * Returns the block for reducing an array of the given shape over the
+ * dimensions [first_axis, last_axis].
+ */
+ReductionBlock make_reduction_block(const xt::xarray<double>::shape_type& shape,
+                                    std::size_t first_axis,
+                                    std::size_t last_axis);
+
+/**
+ * Resolves the axes of a reduction over an array with `ndim` dimensions, where
+ * negative axes count back from the last dimension. The result is sorted.
+ *
+ * @throws std::invalid_argument if an axis is out of range or repeated.
+ */
+std::vector<std::size_t> normalize_axes(const std::vector<std::ptrdiff_t>& axes,
+                                        std::size_t ndim);
+
+/**
+ * Returns every axis of an array with `ndim` dimensions, i.e. 0, ..., ndim - 1.
+ */
+std::vector<std::ptrdiff_t> all_axes(std::size_t ndim);
+
+/**
+ * Returns the shape of the result of reducing an array of the given shape over
+ * `axes`. The reduced dimensions are kept with size 1 if `keepdims` is true and
+ * removed otherwise.
+ */
+xt::xarray<double>::shape_type reduced_shape(
+    const xt::xarray<double>::shape_type& shape,
+    const std::vector<std::size_t>& axes, bool keepdims);
+
+/**
+ * Writes the sum over the middle dimension of `in`, an array laid out as
+ * described by `block`, to the `outer * inner` elements of `out`.
+ */
+void sum_block(const double* in, double* out, const ReductionBlock& block);
+
+/**
+ * Writes the largest (or smallest) element over the middle dimension of `in`
+ * to `best`, and its position along that dimension to `index`. NaNs are
+ * propagated, and ties go to the first position.
+ *
+ * @throws std::invalid_argument if the middle dimension is empty.
+ */
+void extreme_block(const double* in, double* best, std::size_t* index,
+                   const ReductionBlock& block, bool largest);
+
+/**
+ * Reduces `input` over `axes` (as returned by `normalize_axes`), keeping the
+ * reduced dimensions with size 1. Each contiguous run of axes is reduced by a
+ * single call to `reduce_block`, starting from the last run.
+ */
+xt::xarray<double> reduce_over_axes(
+    const xt::xarray<double>& input, const std::vector<std::size_t>& axes,
+    const std::function<void(const double*, double*, const ReductionBlock&)>&
+        reduce_block);
+
+/**
+ * Sums `input` over `axes`, keeping the reduced dimensions with size 1.
+ */
+xt::xarray<double> sum_over_axes(const xt::xarray<double>& input,
+                                 const std::vector<std::size_t>& axes);
+
+/**
+ * Finds the largest (or smallest) elements of `input` over `axes`, which must
+ * be contiguous, keeping the reduced dimensions with size 1. The position of
+ * each within its reduced block is written to `indices`.
+ */
+xt::xarray<double> extreme_over_axes(const xt::xarray<double>& input,
+                                     const std::vector<std::size_t>& axes,
+                                     bool largest,
+                                     std::vector<std::size_t>& indices);
+
+/**
+ * Returns an array of shape `input_shape` holding `grad` at the positions found
+ * by `extreme_over_axes` and zeros everywhere else.
+ */
+xt::xarray<double> scatter_extremes(
+    const xt::xarray<double>& grad, const std::vector<std::size_t>& indices,
+    const std::vector<std::size_t>& axes,
+    const xt::xarray<double>::shape_type& input_shape);
+
+/**
+ * Returns the elements of `input` at the positions found by
+ * `extreme_over_axes` for an array of its shape, with the reduced dimensions
+ * kept with size 1. This is the tangent of the extremes for the tangent
+ * `input`.
+ */
+xt::xarray<double> gather_extremes(const xt::xarray<double>& input,
+                                   const std::vector<std::size_t>& indices,
+                                   const std::vector<std::size_t>& axes);
+
+/**
+ * Broadcasts the gradient of a reduction's output back to the shape of its
+ * input, where `kept_shape` is the output's shape with the reduced dimensions
+ * kept with size 1.
+ */
+xt::xarray<double> broadcast_reduced(
+    const xt::xarray<double>& grad,
+    const xt::xarray<double>::shape_type& kept_shape,
+    const xt::xarray<double>::shape_type& input_shape);
+
+/**
+ * The count, mean and sum of squared differences from the mean (M2) of a set
+ * of values, from which their variance is M2 / count.
+ */
+struct Moments {
+  double count = 0.0;
+  double mean = 0.0;
+  double m2 = 0.0;
+};
+
+/**
+ * Returns the moments of the n values at `x`, computed in a single pass with
+ * Welford's algorithm.
+ */
+Moments compute_moments(const double* x, std::size_t n);
+
+/**
+ * Returns the moments of the union of two sets of values, given the moments of
+ * each (i.e. Chan et al.'s parallel update).
+ */
+Moments merge_moments(const Moments& a, const Moments& b);
+
+/**
+ * Replaces the n values at `values` with their exponents, using the fast-math
+ * kernel when it is enabled.
+ */
+void exp_in_place(double* values, std::size_t n);
+
+/**
+ * Replaces the n values at `values` with their logistic sigmoids, using the
+ * fast-math kernel when it is enabled.
+ */
+void sigmoid_in_place(double* values, std::size_t n);
+
+/**
+ * Replaces the n values at `values` with their hyperbolic tangents, using the
+ * fast-math kernel when it is enabled.
+ */
+void tanh_in_place(double* values, std::size_t n);
+
+/**
+ * Writes the softmax of `in` over the middle dimension of the block to `out`,
+ * or the log-softmax if `log` is true. The largest element of each lane is
+ * subtracted before exponentiating, so the result doesn't overflow.
+ */
+void softmax_block(const double* in, double* out, const ReductionBlock& block,
+                   bool log);
+
+/**
+ * Writes the gradient of the input of `softmax_block` to `out`, given its
+ * `output` and the gradient `grad` of that output.
+ */
+void softmax_grad_block(const double* output, const double* grad,
+                        double* out, const ReductionBlock& block, bool log);
+
+/**
+ * The geometry of a 2-dimensional window (e.g. a convolution kernel) sliding
+ * over the last two dimensions of an array. Each pair holds the size along the
+ * height and then the width.
+ */
+struct Window2d {
+  std::array<std::size_t, 2> input;
+  std::array<std::size_t, 2> kernel;
+  std::array<std::size_t, 2> stride;
+  std::array<std::size_t, 2> padding;
+  std::array<std::size_t, 2> dilation;
+  std::array<std::size_t, 2> output;
+
+  // The number of elements in a (height, width) plane of the input.
+  std::size_t input_plane() const { return input[0] * input[1]; }
+  // The number of elements in a (height, width) plane of the output.
+  std::size_t output_plane() const { return output[0] * output[1]; }
+};
+
+/**
+ * Returns the geometry of a window sliding over an input with the given height
+ * and width, which is implicitly padded with `padding` elements on each side.
+ *
+ * @throws std::invalid_argument if the kernel, stride or dilation has a zero
+ * size, or if the dilated kernel doesn't fit in the padded input.
+ */
+Window2d make_window_2d(std::size_t height, std::size_t width,
+                        const std::array<std::size_t, 2>& kernel,
+                        const std::array<std::size_t, 2>& stride,
+                        const std::array<std::size_t, 2>& padding,
+                        const std::array<std::size_t, 2>& dilation);
+
+/**
+ * Returns the range [first, last) of output positions along `axis` of the
+ * window whose kernel offset `k` lands inside the input, i.e. for which
+ * `o * stride - padding + k * dilation` is in [0, input).
+ */
+std::array<std::size_t, 2> window_range(const Window2d& window,
+                                        std::size_t axis, std::size_t k);
+
+/**
+ * Returns the window of a pooling op over an input of shape (batch, channels,
+ * height, width). The stride defaults to the kernel size.
+ *
+ * @throws std::invalid_argument if the input isn't 4-dimensional, the padding
+ * is more than half of the kernel size, or the window doesn't fit the input.
+ */
+Window2d make_pool_window(
+    const xt::xarray<double>& input, const std::array<std::size_t, 2>& kernel,
+    const std::optional<std::array<std::size_t, 2>>& stride,
+    const std::array<std::size_t, 2>& padding);
+
+/**
+ * Returns the values of `index` as indices into a dimension of the given
+ * size.
+ *
+ * @throws std::invalid_argument if a value isn't an integer in [0, size).
+ */
+std::vector<std::size_t> index_values(const xt::xarray<double>& index,
+                                      std::size_t size);
+
+/**
+ * Returns the offset into a contiguous array of the given shape of the
+ * element that each element of `index` selects, i.e. the element at the same
+ * position as the index except along `axis`, where it's at the index's value.
+ *
+ * @throws std::invalid_argument if the index doesn't have as many dimensions
+ * as the array, is larger than it along an axis other than `axis`, or holds
+ * a value that isn't a valid index along `axis`.
+ */
+std::vector<std::size_t> gather_offsets(
+    const xt::xarray<double>::shape_type& shape, std::size_t axis,
+    const xt::xarray<double>& index);
+
+/**
+ * Returns the gradient of a tensor of the given shape whose rows `rows` were
+ * selected (e.g. by `embedding`), given the gradient of the selected rows, as
+ * coalesced sparse rows.
+ */
+SparseRows selected_rows_grad(const xt::xarray<double>::shape_type& shape,
+                              std::vector<std::size_t> rows,
+                              const xt::xarray<double>& grad);
+
+/**
+ * Calls `fn(col_index, input_index)` for each element of the input of
+ * `channels` planes unfolded by the window (i.e. im2col) that lands inside
+ * the input rather than the padding. The unfolded input is a matrix with a row
+ * for each (channel, kernel row, kernel column) and a column for each output
+ * position, and both indices are into contiguous, row-major arrays.
+ */
+template <typename Fn>
+void for_each_unfolded(const Window2d& w, std::size_t channels, Fn fn) {
+  std::size_t columns = w.output_plane();
+  for (std::size_t c = 0; c < channels; ++c) {
+    for (std::size_t ky = 0; ky < w.kernel[0]; ++ky) {
+      auto [y_first, y_last] = window_range(w, 0, ky);
+      for (std::size_t kx = 0; kx < w.kernel[1]; ++kx) {
+        auto [x_first, x_last] = window_range(w, 1, kx);
+        std::size_t row = (c * w.kernel[0] + ky) * w.kernel[1] + kx;
+        for (std::size_t oy = y_first; oy < y_last; ++oy) {
+          // Unsigned arithmetic wraps, so the offsets are exact once the
+          // padding is subtracted.
+          std::size_t iy =
+              oy * w.stride[0] + ky * w.dilation[0] - w.padding[0];
+          std::size_t col = row * columns + oy * w.output[1];
+          std::size_t in = (c * w.input[0] + iy) * w.input[1] +
+                           kx * w.dilation[1] - w.padding[1];
+          for (std::size_t ox = x_first; ox < x_last; ++ox) {
+            fn(col + ox, in + ox * w.stride[1]);
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Returns an array of the same shape as `input` whose elements are computed by
+ * `fn(in, out, n)`, which is called on contiguous chunks of `n` elements. Large
+ * arrays are split across threads.
+ */
+template <typename Fn>
+xt::xarray<double> map_elementwise(const xt::xarray<double>& input, Fn fn) {
+  auto output = xt::xarray<double>::from_shape(input.shape());
+  parallel::parallel_for(0, input.size(), parallel::kGrainSize,
+                         [&](std::size_t begin, std::size_t end) {
+                           fn(input.data() + begin, output.data() + begin,
+                              end - begin);
+                         });
+  return output;
+}
+
+/**
+ * Returns an array of the same shape as `input` holding `fn(input)`, where `fn`
+ * applies an element-wise xtensor function (e.g. `xt::log`) to an expression.
+ * The function is evaluated on contiguous chunks of `input`, so large arrays
+ * are split across threads.
+ */
+template <typename Fn>
+xt::xarray<double> map_expression(const xt::xarray<double>& input, Fn fn) {
+  return map_elementwise(
+      input, [&fn](const double* in, double* out, std::size_t n) {
+        std::array<std::size_t, 1> shape = {n};
+        auto out_chunk = xt::adapt(out, n, xt::no_ownership(), shape);
+        out_chunk = fn(xt::adapt(in, n, xt::no_ownership(), shape));
+      });
+}
+
+/**
+ * Returns a view of the `rows` x `cols` doubles at `data` as a matrix, without
+ * copying them.
+ */
+inline auto matrix(const double* data, std::size_t rows, std::size_t cols) {
+  return xt::adapt(const_cast<double*>(data), rows * cols, xt::no_ownership(),
+                   std::array<std::size_t, 2>{rows, cols});
+}
+
+// The sparse inputs an op computes on: none, but for `matmul`, which takes a
+// CSR matrix as its first operand.
+enum class SparseInputs { None, CsrFirst };
+
+/**
+ * Checks that none of `inputs` is row-sparse or CSR (but for the ones `sparse`
+ * allows), as `op` only computes on dense data. Ops check their inputs through
+ * `apply_op`.
+ *
+ * @throws std::invalid_argument if one of the inputs isn't dense.
+ */
+void check_dense(const TensorRefs& inputs, const std::string& op,
+                 SparseInputs sparse = SparseInputs::None);
+
+/**
+ * Returns whether an op should give its output a tangent (forward-mode AD),
+ * i.e. whether tangents are propagated on this thread and one of `inputs` has
+ * a tangent.
+ */
+bool needs_tangent(const TensorRefs& inputs);
+
+/**
+ * Returns the tangent of `input`, or zeros of its shape if it has none.
+ */
+Tensor tangent_of(const Tensor& input);
+
+/**
+ * Gives `output` the tangent `rule()` returns, if `needs_tangent(inputs)`.
+ *
+ * The rule runs with recording and tangent propagation disabled, so it can
+ * compute the tangent with other ops, on the inputs as well as on their
+ * tangents.
+ */
+template <typename Rule>
+void propagate_tangent(Tensor& output, const TensorRefs& inputs, Rule rule) {
+  if (!needs_tangent(inputs)) {
+    return;
+  }
+  Tensor tangent;
+  {
+    autograd::NoGradGuard no_grad;
+    autograd::ForwardGradGuard no_tangents(false);
+    tangent = rule();
+  }
+  output.set_tangent(std::move(tangent));
+}
+
+/**
+ * Returns the tangent of the product `x W`, i.e. tx W + x tW without the terms
+ * of inputs without a tangent, with `x` viewed as a matrix of rows of
+ * `W.shape()[0]` elements. Used by the recurrent cells for their gates.
+ */
+xt::xarray<double> product_tangent(const Tensor& x, const Tensor& w);
+
+/**
+ * Returns the sum of `term(i, tangent)` over the inputs that have a tangent,
+ * i.e. the tangent of an op that is linear in each of its inputs separately
+ * (like `matmul`), where `term` applies the op with input `i` replaced by its
+ * tangent. At least one of the inputs must have a tangent.
+ */
+template <typename Term>
+Tensor sum_tangent_terms(const TensorRefs& inputs, Term term) {
+  Tensor total;
+  bool empty = true;
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    if (const Tensor* tangent = inputs[i].get().tangent()) {
+      Tensor partial = term(i, *tangent);
+      total = empty ? partial : total + partial;
+      empty = false;
+    }
+  }
+  return total;
+}
+
+/**
+ * Runs the op `name` with its output written to `output`, replacing the values,
+ * tangent and node it had. This is what every op goes through, so that they
+ * all check their inputs and record their outputs the same way:
+ *
+ * - `inputs`, the tensors the op is differentiable in, and `others`, its
+ *   other tensor arguments (e.g. indices), must be dense (see `check_dense`).
+ * - `forward(ctx)` computes the output, saving what the backward pass needs in
+ *   `ctx`. It either returns the output or writes it to `output` itself.
+ * - `tangent(ctx, output)` computes the output's tangent, if one of `inputs`
+ *   has a tangent (see `propagate_tangent`).
+ * - A `Backward` node built from `ctx` and `inputs` becomes the output's
+ *   gradient function, if one of `inputs` requires gradients.
+ *
+ * @throws std::invalid_argument if an input isn't dense, or whatever
+ * `forward` throws.
+ */
+template <typename Backward, typename Forward, typename Tangent>
+void apply_op_into(Tensor& output, const std::string& name,
+                   const TensorRefs& inputs, Forward forward, Tangent tangent,
+                   const TensorRefs& others = {},
+                   SparseInputs sparse = SparseInputs::None) {
+  check_dense(inputs, name, sparse);
+  check_dense(others, name);
+  autograd::Context ctx;
+  if constexpr (std::is_void_v<std::invoke_result_t<Forward&,
+                                                    autograd::Context&>>) {
+    forward(ctx);
+  } else {
+    output.data_ = forward(ctx).data_;
+  }
+  if (output.tangent() != nullptr && !needs_tangent(inputs)) {
+    output.set_tangent(Tensor::zeros_like(output));
+  }
+  propagate_tangent(output, inputs, [&] { return tangent(ctx, output); });
+  output.set_gradient_fn(nullptr);
+  output.requires_grad(false);
+  if (std::any_of(inputs.begin(), inputs.end(),
+                  [](const Tensor& input) { return input.requires_grad(); })) {
+    output.requires_grad(true);
+    output.set_gradient_fn(new Backward(ctx, inputs));
+  }
+}
+
+/**
+ * Runs the op `name` and returns its output (see `apply_op_into`).
+ */
+template <typename Backward, typename Forward, typename Tangent>
+Tensor apply_op(const std::string& name, const TensorRefs& inputs,
+                Forward forward, Tangent tangent,
+                const TensorRefs& others = {},
+                SparseInputs sparse = SparseInputs::None) {
+  Tensor output;
+  apply_op_into<Backward>(output, name, inputs, forward, tangent, others,
+                          sparse);
+  return output;
+}
+
 }  // namespace ember
 
 #define REGISTER_OP_BACKWARD(name, backward_fn)                                \
   struct name##Backward : public autograd::Node {                              \
-    template <typename... Tensors>                                             \
-    name##Backward(autograd::Context ctx, Tensors... inputs)                   \
+    name##Backward(autograd::Context ctx, const TensorRefs& inputs)            \
         : autograd::Node() {                                                   \
       this->ctx = ctx;                                                         \
-      std::size_t input_ix = 0;                                                \
-      auto add_input = [this, &input_ix](auto& tensor) {                       \
-        if (tensor.requires_grad()) {                                          \
-          add_next_edge(autograd::Edge(input_ix, tensor.get_gradient_fn()));   \
+      for (std::size_t i = 0; i < inputs.size(); ++i) {                        \
+        const Tensor& input = inputs[i];                                       \
+        if (input.requires_grad()) {                                           \
+          add_next_edge(autograd::Edge(i, input.get_gradient_fn()));           \
         }                                                                      \
-        input_ix += 1;                                                         \
-      };                                                                       \
-      (add_input(inputs), ...);                                                \
+      }                                                                        \
     }                                                                          \
                                                                                \
     std::vector<Tensor> operator()(Tensor output_grad) override {              \
+      if (output_grad.is_sparse() || output_grad.is_csr()) {                   \
+        output_grad = output_grad.to_dense();                                  \
+      }                                                                        \
       return backward_fn(ctx, output_grad);                                    \
     }                                                                          \
   };
 
+// Unary ops are element-wise, so their Jacobian is diagonal and the tangent of
+// the output is the backward function applied to the input's tangent.
 #define REGISTER_UNARY_OP(name, forward_fn, backward_fn)                       \
   REGISTER_OP_BACKWARD(name, backward_fn)                                      \
                                                                                \
   Tensor name(const Tensor& input) {                                           \
-    autograd::Context ctx;                                                     \
-    Tensor output = forward_fn(ctx, input);                                    \
-    if (input.requires_grad()) {                                               \
-      output.requires_grad(true);                                              \
-      output.set_gradient_fn(new name##Backward(ctx, input));                  \
-    }                                                                          \
-    return output;                                                             \
+    return apply_op<name##Backward>(                                           \
+        #name, {input},                                                        \
+        [&](autograd::Context& ctx) { return forward_fn(ctx, input); },        \
+        [&](autograd::Context& ctx, const Tensor& /*output*/) {                \
+          return backward_fn(ctx, *input.tangent())[0];                        \
+        });                                                                    \
   }
 
-#define REGISTER_BINARY_OP(name, forward_fn, backward_fn)                      \
+// `tangent_fn(input1, input2, output)` computes the tangent of the output.
+#define REGISTER_BINARY_OP(name, forward_fn, backward_fn, tangent_fn)          \
   REGISTER_OP_BACKWARD(name, backward_fn)                                      \
                                                                                \
   Tensor name(const Tensor& input1, const Tensor& input2) {                    \
-    autograd::Context ctx;                                                     \
-    Tensor output = forward_fn(ctx, input1, input2);                           \
-    if (input1.requires_grad() || input2.requires_grad()) {                    \
-      output.requires_grad(true);                                              \
-      output.set_gradient_fn(new name##Backward(ctx, input1, input2));         \
-    }                                                                          \
-    return output;                                                             \
+    return apply_op<name##Backward>(                                           \
+        #name, {input1, input2},                                               \
+        [&](autograd::Context& ctx) {                                          \
+          return forward_fn(ctx, input1, input2);                              \
+        },                                                                     \
+        [&](autograd::Context& /*ctx*/, const Tensor& output) {                \
+          return tangent_fn(input1, input2, output);                           \
+        });                                                                    \
   }
 
 #endif  // EMBER_OPS_UTILS_H
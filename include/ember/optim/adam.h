@@ -0,0 +1,73 @@
+#ifndef EMBER_OPTIM_ADAM_H
+#define EMBER_OPTIM_ADAM_H
+
+#include <ember/optim/optimizer.h>
+
+#include <vector>
+
+namespace ember::optim {
+
+/**
+ * @brief The Adam optimizer of Kingma and Ba (2015), with weight decay added
+ * to the gradient.
+ *
+ * i.e. $m_t = \beta_1 m_{t-1} + (1 - \beta_1) g_t$,
+ * $v_t = \beta_2 v_{t-1} + (1 - \beta_2) g_t^2$ and
+ * $p_t = p_{t-1} - \eta \hat{m}_t / (\sqrt{\hat{v}_t} + \epsilon)$,
+ * where $g_t = \nabla p_{t-1} + \lambda p_{t-1}$ and the hats are the bias
+ * corrected moments $m_t / (1 - \beta_1^t)$ and $v_t / (1 - \beta_2^t)$
+ *
+ * The moments, bias correction, weight decay and update of each element are
+ * computed in a single pass. This matches PyTorch's `torch.optim.Adam`.
+ */
+class Adam : public Optimizer {
+public:
+  /**
+   * @throws std::invalid_argument if the learning rate, epsilon or weight
+   * decay is negative, a beta is outside [0, 1), or a parameter is invalid
+   * (see `Optimizer`).
+   */
+  Adam(const std::vector<Tensor*>& parameters, double lr = 1e-3,
+       double beta1 = 0.9, double beta2 = 0.999, double eps = 1e-8,
+       double weight_decay = 0.0);
+
+protected:
+  Adam(const std::vector<Tensor*>& parameters, double lr, double beta1,
+       double beta2, double eps, double weight_decay, bool decoupled);
+
+  void update(std::size_t index, std::size_t offset, double* values,
+              const double* grad, std::size_t n) override;
+
+private:
+  double lr_;
+  double beta1_;
+  double beta2_;
+  double eps_;
+  double weight_decay_;
+  bool decoupled_;
+  // The first and second moments of each parameter.
+  std::vector<std::vector<double>> m_;
+  std::vector<std::vector<double>> v_;
+};
+
+/**
+ * @brief Adam with decoupled weight decay (Loshchilov and Hutter, 2019).
+ *
+ * i.e. Adam without weight decay in $g_t$, where each step also scales the
+ * parameter by $1 - \eta \lambda$
+ *
+ * This matches PyTorch's `torch.optim.AdamW`.
+ */
+class AdamW final : public Adam {
+public:
+  /**
+   * @throws std::invalid_argument as `Adam` does.
+   */
+  AdamW(const std::vector<Tensor*>& parameters, double lr = 1e-3,
+        double beta1 = 0.9, double beta2 = 0.999, double eps = 1e-8,
+        double weight_decay = 1e-2);
+};
+
+}  // namespace ember::optim
+
+#endif  // !EMBER_OPTIM_ADAM_H
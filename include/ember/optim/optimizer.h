@@ -0,0 +1,91 @@
+#ifndef EMBER_OPTIM_OPTIMIZER_H
+#define EMBER_OPTIM_OPTIMIZER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+struct Tensor;  // Forward declaration
+}
+
+namespace ember::optim {
+
+/**
+ * @brief The base class of optimizers, which update a set of parameters from
+ * their gradients.
+ *
+ * Each step splits the parameters into contiguous slices of at most
+ * `parallel::kGrainSize` elements and updates the slices in parallel, so a
+ * model with many small parameters is spread across threads as well as one
+ * with a few large ones. Subclasses update each slice in a single fused pass
+ * (see `kernels::KernelTable::sgd` and `kernels::KernelTable::adam`).
+ *
+ * Parameters without a gradient are skipped. Row-sparse gradients are added
+ * to zeros first, so that every optimizer gives the same result for them as
+ * for the equivalent dense gradient. The values of a CSR parameter are its
+ * stored elements, and only those are updated.
+ *
+ * The optimizer refers to the tensors it was given, which must outlive it.
+ */
+class Optimizer {
+public:
+  /**
+   * @throws std::invalid_argument if a parameter is null or row-sparse, or
+   * appears twice.
+   */
+  explicit Optimizer(const std::vector<Tensor*>& parameters);
+  virtual ~Optimizer() = default;
+
+  Optimizer(const Optimizer&) = delete;
+  Optimizer& operator=(const Optimizer&) = delete;
+
+  /**
+   * @brief Updates every parameter that has a gradient.
+   *
+   * @throws std::invalid_argument if a gradient doesn't have the shape of its
+   * parameter.
+   */
+  void step();
+
+  /**
+   * @brief Resets the gradients of the parameters before the next backward
+   * pass.
+   *
+   * By default dense and CSR gradients are zeroed in place, so that the next
+   * backward pass accumulates into them rather than allocating new ones.
+   * Gradients are deleted (and set to null) if `set_to_none` is true, which
+   * frees their memory and makes the next step skip parameters that don't
+   * receive a gradient. Row-sparse gradients are always deleted, since their
+   * rows change from one step to the next.
+   */
+  void zero_grad(bool set_to_none = false);
+
+  const std::vector<Tensor*>& parameters() const { return parameters_; }
+
+protected:
+  /**
+   * @brief Updates the `n` elements of parameter `index` starting at
+   * `offset`, whose values and gradient are `values` and `grad`. Slices of
+   * the same step may be updated concurrently, but never overlap.
+   */
+  virtual void update(std::size_t index, std::size_t offset, double* values,
+                      const double* grad, std::size_t n) = 0;
+
+  // The number of values of parameter i.
+  std::size_t numel(std::size_t i) const;
+
+  // The number of steps in which parameter i had a gradient, including the
+  // current one.
+  std::size_t steps(std::size_t i) const { return steps_[i]; }
+
+private:
+  std::vector<Tensor*> parameters_;
+  std::vector<std::size_t> steps_;
+  // The dense gradients of the parameters whose gradients aren't stored in
+  // the same layout as their values, reused from step to step.
+  std::vector<std::vector<double>> scratch_;
+};
+
+}  // namespace ember::optim
+
+#endif  // !EMBER_OPTIM_OPTIMIZER_H
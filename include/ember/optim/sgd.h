@@ -0,0 +1,48 @@
+#ifndef EMBER_OPTIM_SGD_H
+#define EMBER_OPTIM_SGD_H
+
+#include <ember/optim/optimizer.h>
+
+#include <vector>
+
+namespace ember::optim {
+
+/**
+ * @brief Stochastic gradient descent, optionally with momentum and weight
+ * decay.
+ *
+ * i.e. $b_t = \mu b_{t-1} + (1 - \tau) g_t$ and $p_t = p_{t-1} - \eta b_t$,
+ * where $g_t = \nabla p_{t-1} + \lambda p_{t-1}$
+ *
+ * On the first step the momentum buffer is set to $g_1$. With Nesterov
+ * momentum the update is $\eta (g_t + \mu b_t)$ instead. This matches
+ * PyTorch's `torch.optim.SGD`.
+ */
+class SGD final : public Optimizer {
+public:
+  /**
+   * @throws std::invalid_argument if a hyperparameter is negative, the
+   * dampening is 1 or more, Nesterov momentum is used without momentum or
+   * with dampening, or a parameter is invalid (see `Optimizer`).
+   */
+  SGD(const std::vector<Tensor*>& parameters, double lr,
+      double momentum = 0.0, double dampening = 0.0,
+      double weight_decay = 0.0, bool nesterov = false);
+
+protected:
+  void update(std::size_t index, std::size_t offset, double* values,
+              const double* grad, std::size_t n) override;
+
+private:
+  double lr_;
+  double momentum_;
+  double dampening_;
+  double weight_decay_;
+  bool nesterov_;
+  // The momentum buffer of each parameter, empty without momentum.
+  std::vector<std::vector<double>> buffers_;
+};
+
+}  // namespace ember::optim
+
+#endif  // !EMBER_OPTIM_SGD_H
@@ -0,0 +1,122 @@
+#ifndef EMBER_PARALLEL_PARALLEL_H
+#define EMBER_PARALLEL_PARALLEL_H
+
+#include <ember/parallel/thread_pool.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace ember {
+
+/**
+ * @brief Sets the number of threads ops may split their work across.
+ *
+ * The default is the number of hardware threads, or the value of the
+ * `EMBER_NUM_THREADS` environment variable if it is set. This should not be
+ * called while ops are running on other threads.
+ *
+ * @throws std::invalid_argument if num_threads is 0
+ */
+void set_num_threads(std::size_t num_threads);
+
+/**
+ * @brief Returns the number of threads ops may split their work across.
+ */
+std::size_t get_num_threads();
+
+}  // namespace ember
+
+namespace ember::parallel {
+
+/**
+ * @brief The number of elements below which ops don't split their work.
+ *
+ * Waking other threads costs a few microseconds, which is more than it takes
+ * to process smaller tensors on one thread.
+ */
+constexpr std::size_t kGrainSize = 32768;
+
+/**
+ * @brief Returns the thread pool shared by all ops.
+ */
+ThreadPool& get_thread_pool();
+
+/**
+ * @brief Returns the number of chunks `parallel_for` splits `[begin, end)`
+ * into.
+ *
+ * This depends only on the size of the range, the grain size and the number of
+ * threads, never on timing. Ranges split from within a parallel region are
+ * always a single chunk.
+ */
+inline std::size_t num_chunks(std::size_t begin, std::size_t end,
+                              std::size_t grain_size) {
+  if (end <= begin || ThreadPool::in_parallel_region()) {
+    return 1;
+  }
+  grain_size = std::max<std::size_t>(grain_size, 1);
+  std::size_t max_chunks = (end - begin + grain_size - 1) / grain_size;
+  return std::clamp<std::size_t>(max_chunks, 1, get_num_threads());
+}
+
+/**
+ * @brief Splits `[begin, end)` into contiguous chunks and calls
+ * `fn(chunk_begin, chunk_end)` for each of them, in parallel when the range is
+ * larger than `grain_size`.
+ */
+inline void parallel_for(
+    std::size_t begin, std::size_t end, std::size_t grain_size,
+    const std::function<void(std::size_t, std::size_t)>& fn) {
+  if (end <= begin) {
+    return;
+  }
+  std::size_t chunks = num_chunks(begin, end, grain_size);
+  if (chunks == 1) {
+    fn(begin, end);
+    return;
+  }
+  std::size_t size = end - begin;
+  get_thread_pool().run(chunks, [&](std::size_t chunk) {
+    fn(begin + size * chunk / chunks, begin + size * (chunk + 1) / chunks);
+  });
+}
+
+/**
+ * @brief Reduces `[begin, end)` by computing `map(chunk_begin, chunk_end)` for
+ * each chunk in parallel and combining the partial results.
+ *
+ * The partial results are combined pairwise in a fixed tree, so for a given
+ * number of threads the result is always the same, even when `combine` is not
+ * associative (as with floating point addition).
+ */
+template <typename T, typename Map, typename Combine>
+T parallel_reduce(std::size_t begin, std::size_t end, std::size_t grain_size,
+                  T identity, const Map& map, const Combine& combine) {
+  if (end <= begin) {
+    return identity;
+  }
+  std::size_t chunks = num_chunks(begin, end, grain_size);
+  if (chunks == 1) {
+    return map(begin, end);
+  }
+  std::size_t size = end - begin;
+  std::vector<T> partials(chunks, identity);
+  get_thread_pool().run(chunks, [&](std::size_t chunk) {
+    partials[chunk] = map(begin + size * chunk / chunks,
+                          begin + size * (chunk + 1) / chunks);
+  });
+  for (std::size_t stride = 1; stride < chunks; stride *= 2) {
+    for (std::size_t i = 0; i + stride < chunks; i += 2 * stride) {
+      partials[i] = combine(std::move(partials[i]),
+                            std::move(partials[i + stride]));
+    }
+  }
+  return std::move(partials[0]);
+}
+
+}  // namespace ember::parallel
+
+#endif  // EMBER_PARALLEL_PARALLEL_H
@@ -0,0 +1,84 @@
+#ifndef EMBER_PARALLEL_THREAD_POOL_H
+#define EMBER_PARALLEL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ember::parallel {
+
+/**
+ * @brief A fixed set of worker threads that run batches of tasks.
+ *
+ * The threads are started once and then wait for work, so running a batch
+ * doesn't pay for creating threads. The thread that submits a batch also works
+ * on it, which means a pool of `n` threads only starts `n - 1` workers.
+ *
+ * Batches submitted from within a task (e.g. an op that is itself called from
+ * a parallel region) run serially on the submitting thread instead of waiting
+ * on the already busy workers.
+ */
+class ThreadPool {
+public:
+  /**
+   * @brief Constructs a pool that runs tasks on `num_threads` threads,
+   * including the thread submitting them.
+   * @throws std::invalid_argument if num_threads is 0
+   */
+  explicit ThreadPool(std::size_t num_threads);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /**
+   * @brief Returns the number of threads tasks are run on.
+   */
+  std::size_t num_threads() const { return workers_.size() + 1; }
+
+  /**
+   * @brief Calls `task(i)` for every `i` in `[0, num_tasks)` and waits for
+   * all of them to finish.
+   *
+   * If any task throws, the remaining tasks still run and the first exception
+   * is rethrown once they are done.
+   */
+  void run(std::size_t num_tasks,
+           const std::function<void(std::size_t)>& task);
+
+  /**
+   * @brief Returns whether the calling thread is currently running a task.
+   */
+  static bool in_parallel_region();
+
+private:
+  void worker_loop();
+  void work_on_batch();
+
+  std::vector<std::thread> workers_;
+
+  // Serializes batches submitted from different threads.
+  std::mutex submit_mutex_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  const std::function<void(std::size_t)>* task_ = nullptr;
+  std::size_t num_tasks_ = 0;
+  std::atomic<std::size_t> next_task_{0};
+  std::size_t busy_workers_ = 0;
+  std::uint64_t batch_ = 0;
+  std::exception_ptr error_;
+  bool stopping_ = false;
+};
+
+}  // namespace ember::parallel
+
+#endif  // EMBER_PARALLEL_THREAD_POOL_H
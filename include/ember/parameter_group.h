@@ -0,0 +1,147 @@
+#ifndef EMBER_PARAMETER_GROUP_H
+#define EMBER_PARAMETER_GROUP_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace ember {
+
+struct Tensor;  // Forward declaration
+
+/**
+ * The parameters of a model and their gradients, laid out in two flat,
+ * contiguous buffers, so that operations on the whole model (zeroing the
+ * gradients, computing their norm, updating the parameters, taking a
+ * snapshot) are a single pass over one buffer rather than a loop over many
+ * small tensors.
+ *
+ * Each tensor owns its own array, so the buffers are copies of the
+ * parameters rather than storage they share: `gather_gradients` copies the
+ * gradients of a backward pass into the gradient buffer, and
+ * `scatter_parameters` copies the parameter buffer back into the tensors
+ * after it has been updated. Each is one copy per parameter. The buffers are
+ * 64-byte aligned and each parameter starts on a 64-byte boundary, so every
+ * parameter's slice can be processed with aligned vector instructions.
+ *
+ * The group refers to the tensors it was given, which must outlive it and
+ * must not move.
+ */
+class ParameterGroup {
+public:
+  // The alignment of the buffers and of each parameter's slice, in bytes.
+  static constexpr std::size_t kAlignment = 64;
+
+  ParameterGroup() = default;
+
+  /**
+   * Creates a group of the given parameters and copies their values into the
+   * parameter buffer.
+   *
+   * @throws std::invalid_argument if a parameter is null, row-sparse or a
+   * CSR matrix, or appears twice.
+   */
+  explicit ParameterGroup(const std::vector<Tensor*>& parameters);
+
+  ParameterGroup(ParameterGroup&&) = default;
+  ParameterGroup& operator=(ParameterGroup&&) = default;
+  ParameterGroup(const ParameterGroup&) = delete;
+  ParameterGroup& operator=(const ParameterGroup&) = delete;
+
+  /**
+   * Adds a parameter to the group, which lays out the buffers again and
+   * copies the values of every parameter into the new parameter buffer. The
+   * gradient buffer is zeroed.
+   *
+   * @throws std::invalid_argument as the constructor does.
+   */
+  void add(Tensor& parameter);
+
+  // The parameters, in the order they were added.
+  const std::vector<Tensor*>& parameters() const { return parameters_; }
+
+  // The number of elements of all the parameters.
+  std::size_t numel() const { return numel_; }
+
+  // The size of each buffer, i.e. numel() plus the padding that aligns each
+  // parameter.
+  std::size_t capacity() const { return capacity_; }
+
+  // The position of parameter i in the buffers.
+  std::size_t offset(std::size_t i) const { return offsets_[i]; }
+
+  // The parameter buffer. Elements in the padding between parameters are 0.
+  double* data() { return data_.get(); }
+  const double* data() const { return data_.get(); }
+
+  // The gradient buffer. Elements in the padding between parameters are 0.
+  double* grad() { return grad_.get(); }
+  const double* grad() const { return grad_.get(); }
+
+  // Copies the values of the parameters into the parameter buffer.
+  void gather_parameters();
+
+  // Copies the parameter buffer into the parameters.
+  void scatter_parameters();
+
+  /**
+   * Copies the gradients of the parameters into the gradient buffer. The
+   * slices of parameters without a gradient are zeroed, and row-sparse
+   * gradients are added to zeros.
+   *
+   * @throws std::invalid_argument if a gradient doesn't have the shape of its
+   * parameter.
+   */
+  void gather_gradients();
+
+  /**
+   * Zeroes the gradient buffer and the gradients of the parameters, ready
+   * for the next backward pass. Dense gradients are zeroed in place, so that
+   * the next backward pass accumulates into them without allocating, and
+   * row-sparse ones are deleted.
+   */
+  void zero_grad();
+
+  // Returns the L2 norm of the gradient buffer.
+  double grad_norm() const;
+
+  /**
+   * Scales the gradient buffer so that its L2 norm is at most `max_norm`, and
+   * returns its norm before scaling.
+   *
+   * @throws std::invalid_argument if `max_norm` is negative.
+   */
+  double clip_grad_norm(double max_norm);
+
+  // Returns a copy of the parameter buffer, which is taken with one copy.
+  std::vector<double> snapshot() const;
+
+  /**
+   * Copies a snapshot into the parameter buffer and the parameters.
+   *
+   * @throws std::invalid_argument if the snapshot was taken of a group with a
+   * different layout.
+   */
+  void restore(const std::vector<double>& snapshot);
+
+private:
+  struct Free {
+    void operator()(double* buffer) const { std::free(buffer); }
+  };
+  using Buffer = std::unique_ptr<double[], Free>;
+
+  // Lays out the buffers for the current parameters.
+  void allocate();
+
+  std::vector<Tensor*> parameters_;
+  std::vector<std::size_t> offsets_;
+  std::size_t numel_ = 0;
+  std::size_t capacity_ = 0;
+  Buffer data_;
+  Buffer grad_;
+};
+
+}  // namespace ember
+
+#endif  // !EMBER_PARAMETER_GROUP_H
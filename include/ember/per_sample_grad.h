@@ -0,0 +1,51 @@
+#ifndef EMBER_PER_SAMPLE_GRAD_H
+#define EMBER_PER_SAMPLE_GRAD_H
+
+#include <ember/tensor_refs.h>
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace ember {
+
+struct Tensor;  // Forward declaration
+
+// Computes the loss of each sample of a batch, as a tensor with one element
+// per sample, or their sum.
+using PerSampleLossFn = std::function<Tensor(const Tensor& batch)>;
+
+/**
+ * Computes the gradient of each sample's loss with respect to each of
+ * `params`, in a single forward and backward pass over the batch.
+ *
+ * The samples are the rows (the first axis) of `batch`. The gradient of a
+ * parameter of shape S is returned with shape (batch size, S...), where row n
+ * is the gradient of the loss of sample n alone. The parameters' own
+ * `gradient`s are left as they are, and their hooks aren't run.
+ *
+ * During the backward pass, the ops that would sum a parameter's gradient
+ * over the samples keep a gradient per sample instead: `linear` and `matmul`
+ * take the outer product of each sample's input and output gradient, and the
+ * broadcasting element-wise ops (add, sub, mul, div, pow) reduce each
+ * sample's gradient separately. The parameters must therefore be operands of
+ * these ops, and `fn` must treat the samples independently (e.g. no batch
+ * norm, and a sum of the losses rather than their mean).
+ *
+ * If `max_norm` is given, the gradients of each sample are then clipped
+ * together, in the same pass, so that their norm over all the parameters is
+ * at most `max_norm`, as in differentially private SGD.
+ *
+ * @throws std::invalid_argument if the batch has no samples, a parameter
+ * doesn't require gradients, the loss doesn't have one element per sample
+ * (or a single one), `max_norm` isn't positive, or an op in `fn` has no
+ * per-sample gradient for one of the parameters.
+ */
+std::vector<Tensor> per_sample_grad(const PerSampleLossFn& fn,
+                                    const TensorRefs& params,
+                                    const Tensor& batch,
+                                    std::optional<double> max_norm = {});
+
+}  // namespace ember
+
+#endif  // !EMBER_PER_SAMPLE_GRAD_H
@@ -0,0 +1,103 @@
+#ifndef EMBER_RANDOM_H
+#define EMBER_RANDOM_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace ember {
+
+/**
+ * @brief Seeds every source of randomness in Ember, so that the random
+ * tensors and the masks of ops like `dropout` that follow are the same on
+ * every run.
+ *
+ * This resets the counter-based stream used by ops to the start of the
+ * stream for `seed`, and seeds xtensor's engine, which `Tensor::randn` uses.
+ * The default seed is 0.
+ */
+void manual_seed(std::uint64_t seed);
+
+/**
+ * @brief Returns the seed of the counter-based stream used by ops.
+ */
+std::uint64_t initial_seed();
+
+}  // namespace ember
+
+namespace ember::random {
+
+/**
+ * The position in a counter-based random stream of a block of values, i.e.
+ * the key the stream was seeded with and the index of its first value.
+ *
+ * Each value of the stream is a function of the seed and its index only, so
+ * any value can be computed without computing the ones before it. Ops can
+ * therefore compute their random values in parallel, and save the position of
+ * their block instead of the values themselves.
+ */
+struct StreamPosition {
+  std::uint64_t seed;
+  // A multiple of 4, since values are generated four at a time.
+  std::uint64_t offset;
+};
+
+/**
+ * @brief Reserves `count` values of the stream, which no other call will
+ * reserve until it is reseeded, and returns their position.
+ *
+ * This is thread safe.
+ */
+StreamPosition reserve(std::size_t count);
+
+/**
+ * @brief The Philox4x32-10 function of Salmon et al. (2011), i.e. ten rounds
+ * of a bijection of the 128-bit counter keyed by the 64-bit key.
+ */
+std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> counter,
+                                    std::array<std::uint32_t, 2> key);
+
+/**
+ * @brief Returns the values of the stream at `position` from `4 * block` to
+ * `4 * block + 3`, as uniformly distributed 32-bit integers.
+ */
+inline std::array<std::uint32_t, 4> block(const StreamPosition& position,
+                                          std::uint64_t block) {
+  std::uint64_t counter = position.offset / 4 + block;
+  return philox({static_cast<std::uint32_t>(counter),
+                 static_cast<std::uint32_t>(counter >> 32), 0, 0},
+                {static_cast<std::uint32_t>(position.seed),
+                 static_cast<std::uint32_t>(position.seed >> 32)});
+}
+
+}  // namespace ember::random
+
+namespace ember {
+
+/**
+ * The state of every source of randomness in Ember: the position of the
+ * counter-based stream used by ops, and xtensor's engine, written out as
+ * text.
+ */
+struct RngState {
+  random::StreamPosition stream;
+  std::string engine;
+};
+
+/**
+ * @brief Returns the current state of the random sources, which
+ * `set_rng_state` can return to in order to draw the same values again.
+ */
+RngState get_rng_state();
+
+/**
+ * @brief Returns the random sources to a state taken by `get_rng_state`.
+ *
+ * This should not be called while other threads draw random values.
+ */
+void set_rng_state(const RngState& state);
+
+}  // namespace ember
+
+#endif  // !EMBER_RANDOM_H
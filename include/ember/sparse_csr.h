@@ -0,0 +1,82 @@
+#ifndef EMBER_SPARSE_CSR_H
+#define EMBER_SPARSE_CSR_H
+
+#include <xtensor/xarray.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+
+/**
+ * A matrix stored in compressed sparse row (CSR) form, i.e. as the values of
+ * its nonzero elements row by row, the column of each, and the offset of each
+ * row's first element in those lists.
+ *
+ * This is the form of matrices too large to store densely of which only a
+ * tiny fraction of the elements are nonzero (e.g. the adjacency matrices of
+ * graphs). Within a row the columns are sorted and unique.
+ */
+struct CsrMatrix {
+  std::size_t rows = 0;
+  std::size_t cols = 0;
+  // The elements of row i are at [row_offsets[i], row_offsets[i + 1]), so
+  // there are rows + 1 offsets.
+  std::vector<std::size_t> row_offsets;
+  std::vector<std::size_t> columns;
+  std::vector<double> values;
+
+  // The number of stored elements.
+  std::size_t nnz() const { return values.size(); }
+
+  /**
+   * Creates a matrix from the coordinates and values of its nonzero elements,
+   * which may be in any order. The values of repeated coordinates are summed.
+   *
+   * @throws std::invalid_argument if the lists have different lengths or a
+   * coordinate is out of range.
+   */
+  static CsrMatrix from_triplets(std::size_t rows, std::size_t cols,
+                                 const std::vector<std::size_t>& row_indices,
+                                 const std::vector<std::size_t>& col_indices,
+                                 const std::vector<double>& values);
+
+  /**
+   * Creates a matrix holding the nonzero elements of a dense one.
+   *
+   * @throws std::invalid_argument if the array isn't 2-dimensional.
+   */
+  static CsrMatrix from_dense(const xt::xarray<double>& dense);
+
+  /**
+   * Checks that the offsets and columns describe a valid matrix.
+   *
+   * @throws std::invalid_argument if they don't.
+   */
+  void validate() const;
+
+  // Returns the transpose, which is computed with a counting sort.
+  CsrMatrix transpose() const;
+
+  /**
+   * Adds `other`, which must have the same shape, merging the two sparsity
+   * patterns.
+   *
+   * @throws std::invalid_argument if the shapes don't match.
+   */
+  void add(const CsrMatrix& other);
+
+  /**
+   * Adds the elements to `dense`, which must have the dense shape.
+   *
+   * @throws std::invalid_argument if the shapes don't match.
+   */
+  void add_to(xt::xarray<double>& dense) const;
+
+  // Returns the dense matrix, i.e. the elements added to zeros.
+  xt::xarray<double> to_dense() const;
+};
+
+}  // namespace ember
+
+#endif  // !EMBER_SPARSE_CSR_H
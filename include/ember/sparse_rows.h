@@ -0,0 +1,58 @@
+#ifndef EMBER_SPARSE_ROWS_H
+#define EMBER_SPARSE_ROWS_H
+
+#include <xtensor/xarray.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace ember {
+
+/**
+ * A tensor of which only some rows (i.e. slices along the first dimension)
+ * are nonzero, stored as the indices of those rows and their values.
+ *
+ * This is the form of the gradients of lookups into large tables (e.g.
+ * `embedding`), whose size is proportional to the number of lookups rather
+ * than to the size of the table. An index may appear more than once, in
+ * which case its rows are summed.
+ */
+struct SparseRows {
+  // The shape of the dense tensor.
+  std::vector<std::size_t> shape;
+  // The row of the dense tensor that each row of `values` belongs to.
+  std::vector<std::size_t> indices;
+  // The rows, with shape (indices.size(), shape[1], ..., shape[n - 1]).
+  xt::xarray<double> values;
+
+  // The number of elements of each row, i.e. the product of shape[1:].
+  std::size_t row_size() const;
+
+  /**
+   * Appends the rows of `other`, which must have the same shape.
+   *
+   * @throws std::invalid_argument if the shapes don't match.
+   */
+  void append(const SparseRows& other);
+
+  /**
+   * Sorts the rows by index and sums the rows with the same index, so that
+   * each index appears once. Rows that already are in that form are left
+   * untouched.
+   */
+  void coalesce();
+
+  /**
+   * Adds the rows to `dense`, which must have the dense shape.
+   *
+   * @throws std::invalid_argument if the shapes don't match.
+   */
+  void add_to(xt::xarray<double>& dense) const;
+
+  // Returns the dense tensor, i.e. the rows added to zeros.
+  xt::xarray<double> to_dense() const;
+};
+
+}  // namespace ember
+
+#endif  // !EMBER_SPARSE_ROWS_H
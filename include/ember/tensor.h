@@ -3,21 +3,64 @@
 
 #include <ember/autograd/accumulator.h>
 #include <ember/autograd/engine.h>
+#include <ember/autograd/grad_mode.h>
 #include <ember/autograd/node.h>
 #include <ember/ops/add.h>
+#include <ember/ops/argmax.h>
+#include <ember/ops/avg_pool2d.h>
+#include <ember/ops/batch_norm.h>
+#include <ember/ops/cat.h>
+#include <ember/ops/conv2d.h>
+#include <ember/ops/cross_entropy.h>
 #include <ember/ops/div.h>
+#include <ember/ops/dropout.h>
+#include <ember/ops/einsum.h>
+#include <ember/ops/embedding.h>
 #include <ember/ops/exp.h>
+#include <ember/ops/gather.h>
+#include <ember/ops/gelu.h>
+#include <ember/ops/gru_cell.h>
+#include <ember/ops/index_select.h>
+#include <ember/ops/layer_norm.h>
+#include <ember/ops/linear.h>
+#include <ember/ops/log.h>
+#include <ember/ops/log_softmax.h>
+#include <ember/ops/logsumexp.h>
+#include <ember/ops/lstm.h>
 #include <ember/ops/matmul.h>
+#include <ember/ops/max.h>
+#include <ember/ops/max_pool2d.h>
+#include <ember/ops/mean.h>
+#include <ember/ops/min.h>
 #include <ember/ops/mul.h>
+#include <ember/ops/pow.h>
+#include <ember/ops/relu.h>
+#include <ember/ops/rsqrt.h>
+#include <ember/ops/scatter_add.h>
+#include <ember/ops/scaled_dot_product_attention.h>
+#include <ember/ops/sigmoid.h>
+#include <ember/ops/softmax.h>
+#include <ember/ops/split.h>
+#include <ember/ops/sqrt.h>
 #include <ember/ops/sub.h>
-
+#include <ember/ops/sum.h>
+#include <ember/ops/tanh.h>
+
+#include <ember/checkpoint.h>
+#include <ember/jvp.h>
+#include <ember/per_sample_grad.h>
+#include <ember/sparse_csr.h>
+#include <ember/sparse_rows.h>
+#include <ember/tensor_refs.h>
 #include <ember/tensor_snapshot.h>
 
 #include <xtensor/xadapt.hpp>
 #include <xtensor/xarray.hpp>
 
+#include <cstddef>
 #include <functional>
 #include <initializer_list>
+#include <memory>
 #include <numeric>
 #include <optional>
 #include <type_traits>
@@ -139,10 +182,32 @@ public:
 
   /**
    * @brief Sets the gradient function for this tensor.
+   *
+   * If recording is disabled on this thread (see `autograd::NoGradGuard`),
+   * the node is deleted instead and the tensor no longer requires gradients.
+   *
    * @param gradient_fn Pointer to the gradient function node
    */
   void set_gradient_fn(autograd::Node* gradient_fn);
 
+  /**
+   * @brief Gets the tangent this tensor carries in forward-mode AD, or
+   * nullptr if it has none.
+   *
+   * Ops give their output a tangent when one of their inputs has one: the
+   * derivative of the output in the direction of the inputs' tangents,
+   * computed in the same pass as the output (see `ember::jvp`).
+   */
+  const Tensor* tangent() const { return tangent_.get(); }
+
+  /**
+   * @brief Sets the tangent of this tensor for forward-mode AD.
+   *
+   * @throws std::invalid_argument if the tangent doesn't have this tensor's
+   * shape, or either of them is row-sparse or CSR.
+   */
+  Tensor& set_tangent(Tensor tangent);
+
   /**
    * @brief Access a tensor element (const version)
    */
@@ -159,6 +224,16 @@ public:
     return data_(args...);
   }
 
+  /**
+   * @brief Registers a function that is called with this tensor each time a
+   * backward pass has accumulated its gradient, e.g. to start reducing the
+   * gradient while the rest of the backward pass runs.
+   *
+   * @throws std::runtime_error if this isn't a leaf tensor that requires
+   * gradients
+   */
+  void register_post_accumulate_hook(std::function<void(Tensor&)> hook);
+
   /**
    * @brief Computes gradients for all input tensors that created this tensor,
    * using the provided gradient as the starting point for backpropagation.
@@ -202,6 +277,93 @@ public:
    */
   Tensor exp();
 
+  /**
+   * @see ember::ops::log
+   */
+  Tensor log();
+
+  /**
+   * @see ember::ops::pow
+   */
+  Tensor pow(const Tensor& exponent);
+
+  /**
+   * @see ember::ops::sqrt
+   */
+  Tensor sqrt();
+
+  /**
+   * @see ember::ops::rsqrt
+   */
+  Tensor rsqrt();
+
+  /**
+   * @see ember::ops::tanh
+   */
+  Tensor tanh();
+
+  /**
+   * @see ember::ops::sigmoid
+   */
+  Tensor sigmoid();
+
+  /**
+   * @see ember::ops::relu
+   */
+  Tensor relu();
+
+  /**
+   * @see ember::ops::gelu
+   */
+  Tensor gelu();
+
+  /**
+   * @see ember::ops::sum
+   */
+  Tensor sum();
+  Tensor sum(const std::vector<std::ptrdiff_t>& axes, bool keepdims = false);
+
+  /**
+   * @see ember::ops::mean
+   */
+  Tensor mean();
+  Tensor mean(const std::vector<std::ptrdiff_t>& axes, bool keepdims = false);
+
+  /**
+   * @see ember::ops::max
+   */
+  Tensor max();
+  Tensor max(std::ptrdiff_t axis, bool keepdims = false);
+
+  /**
+   * @see ember::ops::min
+   */
+  Tensor min();
+  Tensor min(std::ptrdiff_t axis, bool keepdims = false);
+
+  /**
+   * @see ember::ops::logsumexp
+   */
+  Tensor logsumexp();
+  Tensor logsumexp(const std::vector<std::ptrdiff_t>& axes,
+                   bool keepdims = false);
+
+  /**
+   * @see ember::ops::argmax
+   */
+  Tensor argmax();
+  Tensor argmax(std::ptrdiff_t axis, bool keepdims = false);
+
+  /**
+   * @see ember::ops::softmax
+   */
+  Tensor softmax(std::ptrdiff_t axis = -1);
+
+  /**
+   * @see ember::ops::log_softmax
+   */
+  Tensor log_softmax(std::ptrdiff_t axis = -1);
+
   /**
    * @brief Compares two tensors to determine if they are exactly equal.
    *
@@ -230,6 +392,58 @@ public:
    */
   static Tensor from_xarray(xt::xarray<double> data);
 
+  /**
+   * @brief Creates a row-sparse tensor from the given rows.
+   *
+   * Row-sparse tensors are produced by the backward passes of lookups into
+   * large tables (e.g. `embedding`) and are only accumulated into gradients,
+   * never used as the inputs of ops: their data_ is empty, and the nodes of
+   * ops receive them as dense gradients.
+   */
+  static Tensor from_sparse_rows(SparseRows rows);
+
+  /**
+   * @brief Gets whether this tensor is row-sparse.
+   */
+  bool is_sparse() const;
+
+  /**
+   * @brief Gets the rows of a row-sparse tensor.
+   * @throws std::runtime_error if the tensor isn't row-sparse
+   */
+  const SparseRows& sparse_rows() const;
+  SparseRows& sparse_rows();
+
+  /**
+   * @brief Creates a sparse matrix stored in CSR form.
+   *
+   * CSR tensors can only be used as the first operand of `matmul`, and are
+   * otherwise treated like row-sparse tensors: their data_ is empty, their
+   * gradients are CSR matrices with the same sparsity pattern, and the nodes
+   * of ops receive them as dense gradients.
+   *
+   * @throws std::invalid_argument if the matrix isn't valid.
+   */
+  static Tensor from_csr(CsrMatrix matrix);
+
+  /**
+   * @brief Gets whether this tensor is a CSR matrix.
+   */
+  bool is_csr() const;
+
+  /**
+   * @brief Gets the matrix of a CSR tensor.
+   * @throws std::runtime_error if the tensor isn't a CSR matrix
+   */
+  const CsrMatrix& csr() const;
+  CsrMatrix& csr();
+
+  /**
+   * @brief Returns this tensor as a dense tensor, i.e. a copy of it if it
+   * isn't row-sparse or a CSR matrix.
+   */
+  Tensor to_dense() const;
+
   /**
    * @brief Creates a new tensor with the specified shape, initialized to
    * zeros.
@@ -276,6 +490,12 @@ private:
   autograd::Node* gradient_accumulator = nullptr;
   // Whether this tensor requires gradients to be computed and stored.
   bool requires_grad_ = false;
+  // The rows of a row-sparse tensor, in which case data_ is empty.
+  std::optional<SparseRows> sparse_rows_;
+  // The matrix of a CSR tensor, in which case data_ is empty.
+  std::optional<CsrMatrix> csr_;
+  // The tangent of forward-mode AD, shared by copies of this tensor.
+  std::shared_ptr<const Tensor> tangent_;
 
   friend struct TensorSnapshot;
 };  // class Tensor
@@ -0,0 +1,21 @@
+#ifndef EMBER_TENSOR_REFS_H
+#define EMBER_TENSOR_REFS_H
+
+#include <functional>
+#include <vector>
+
+namespace ember {
+
+struct Tensor;  // Forward declaration
+
+/**
+ * The tensors passed to an op that takes any number of inputs (e.g. `cat`).
+ * They are held by reference, so passing them doesn't copy their data, but
+ * temporaries can't be passed (e.g. `cat({a, b})` works but
+ * `cat({a, b * 2.0})` doesn't).
+ */
+using TensorRefs = std::vector<std::reference_wrapper<const Tensor>>;
+
+}  // namespace ember
+
+#endif  // EMBER_TENSOR_REFS_H
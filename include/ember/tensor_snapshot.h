@@ -3,12 +3,21 @@
 
 #include <xtensor/xarray.hpp>
 
+#include <memory>
+
 namespace ember {
 
 struct Tensor;  // Forward declaration
 
+namespace autograd {
+struct OffloadedTensor;  // Forward declaration
+}
+
 struct TensorSnapshot {
   xt::xarray<double> data_;
+  // Set while `data_` is offloaded by an `autograd::SavedTensorOffloader`,
+  // until the engine reads it back before the node that saved it runs.
+  std::shared_ptr<autograd::OffloadedTensor> offloaded;
   TensorSnapshot(const Tensor& tensor);
 };
 }  // namespace ember
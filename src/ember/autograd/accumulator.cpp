@@ -1,4 +1,7 @@
 #include <ember/autograd/accumulator.h>
+#include <ember/autograd/engine.h>
+#include <ember/autograd/per_sample.h>
+#include <ember/ops/utils.h>
 #include <ember/tensor.h>
 
 #include <iostream>
@@ -14,12 +17,43 @@ Accumulator::Accumulator(Tensor* target) : target(target) {
 }
 
 std::vector<Tensor> Accumulator::operator()(Tensor output_grad) {
+  // Per-sample gradients are kept apart from the target's gradient, and
+  // don't run its hooks.
+  if (PerSampleState* per_sample = current_per_sample()) {
+    auto [it, inserted] =
+        per_sample->gradients.try_emplace(target, output_grad);
+    if (!inserted) {
+      accumulate_gradient(it->second, output_grad);
+    }
+    return {};
+  }
   if (target->gradient == nullptr) {
-    target->gradient = new Tensor(Tensor::zeros_like(*target));
+    // A row-sparse or CSR gradient is kept sparse, so that its size is
+    // proportional to the elements it touches rather than to the size of the
+    // target.
+    if (output_grad.is_sparse() || output_grad.is_csr()) {
+      target->gradient = new Tensor(output_grad);
+    } else {
+      target->gradient = new Tensor(Tensor::zeros_like(*target));
+      accumulate_gradient(*target->gradient, output_grad);
+    }
+  } else {
+    accumulate_gradient(*target->gradient, output_grad);
+  }
+  // Sparse rows are only appended as they are added up, so the rows of the
+  // same index are merged here, once per backward pass.
+  if (target->gradient->is_sparse()) {
+    target->gradient->sparse_rows().coalesce();
+  }
+  for (const auto& hook : post_hooks) {
+    hook(*target);
   }
-  *target->gradient = *target->gradient + output_grad;
 
   return {};
 }
 
+void Accumulator::add_post_hook(std::function<void(Tensor&)> hook) {
+  post_hooks.push_back(std::move(hook));
+}
+
 }  // namespace ember::autograd
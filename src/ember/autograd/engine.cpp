@@ -1,5 +1,7 @@
 #include <ember/autograd/engine.h>
 #include <ember/autograd/node.h>
+#include <ember/autograd/offload.h>
+#include <ember/ops/utils.h>
 #include <ember/tensor.h>
 
 #include <iostream>
@@ -37,9 +39,13 @@ void Engine::backward(Node* root, Tensor gradient) {
   grad_buffer[root] = gradient;
 
   std::vector<Node*> nodes = topsort(root);
-  // Evaluate nodes in reverse topological order
-  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
-    evaluate_fn(*it, grad_buffer[*it]);
+  // Evaluate nodes in reverse topological order, reading the saved tensors
+  // that were offloaded back ahead of them.
+  std::vector<Node*> order(nodes.rbegin(), nodes.rend());
+  SavedTensorLoader loader(order);
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    loader.load(i);
+    evaluate_fn(order[i], grad_buffer[order[i]]);
   }
 }
 
@@ -62,12 +68,38 @@ void Engine::evaluate_fn(Node* func, Tensor gradient) {
     // Register a new gradient for the edge node if none exists or add the
     // calculated edge to the previous gradient.
     auto it = grad_buffer.find(edge.fn);
+    const Tensor& input_grad = input_grads[edge.input_nr];
     if (it == grad_buffer.end()) {
-      grad_buffer[edge.fn] = input_grads[edge.input_nr];
+      grad_buffer[edge.fn] = input_grad;
     } else {
-      grad_buffer[edge.fn] = grad_buffer[edge.fn] + input_grads[edge.input_nr];
+      accumulate_gradient(it->second, input_grad);
     }
   }
 }
 
+void accumulate_gradient(Tensor& total, const Tensor& gradient) {
+  if (gradient.is_sparse() && total.is_sparse()) {
+    // The rows of the same index are merged once, by the Accumulator that
+    // receives the sum, rather than on every addition.
+    total.sparse_rows().append(gradient.sparse_rows());
+    return;
+  }
+  if (gradient.is_csr() && total.is_csr()) {
+    total.csr().add(gradient.csr());
+    return;
+  }
+  if (total.is_sparse() || total.is_csr()) {
+    total = total.to_dense();
+  }
+  if (gradient.is_sparse()) {
+    gradient.sparse_rows().add_to(total.data_);
+  } else if (gradient.is_csr()) {
+    gradient.csr().add_to(total.data_);
+  } else if (total.data_.shape() == gradient.data_.shape()) {
+    accumulate(total.data_, gradient.data_);
+  } else {
+    total = total + gradient;
+  }
+}
+
 }  // namespace ember::autograd
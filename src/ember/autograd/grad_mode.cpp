@@ -0,0 +1,70 @@
+#include <ember/autograd/grad_mode.h>
+
+namespace ember::autograd {
+
+namespace {
+thread_local bool grad_enabled = true;
+thread_local std::size_t discarded_nodes = 0;
+thread_local std::size_t recorded_bytes = 0;
+thread_local bool forward_grad_enabled = true;
+thread_local bool recomputing = false;
+}  // namespace
+
+bool is_grad_enabled() {
+  return grad_enabled;
+}
+
+void set_grad_enabled(bool enabled) {
+  grad_enabled = enabled;
+}
+
+std::size_t num_discarded_nodes() {
+  return discarded_nodes;
+}
+
+void count_discarded_node() {
+  ++discarded_nodes;
+}
+
+std::size_t num_saved_bytes() {
+  return recorded_bytes;
+}
+
+void count_saved_bytes(std::size_t bytes) {
+  recorded_bytes += bytes;
+}
+
+GradModeGuard::GradModeGuard(bool enabled) : previous_(grad_enabled) {
+  grad_enabled = enabled;
+}
+
+GradModeGuard::~GradModeGuard() {
+  grad_enabled = previous_;
+}
+
+bool is_forward_grad_enabled() {
+  return forward_grad_enabled;
+}
+
+ForwardGradGuard::ForwardGradGuard(bool enabled)
+    : previous_(forward_grad_enabled) {
+  forward_grad_enabled = enabled;
+}
+
+ForwardGradGuard::~ForwardGradGuard() {
+  forward_grad_enabled = previous_;
+}
+
+bool is_recomputing() {
+  return recomputing;
+}
+
+RecomputeGuard::RecomputeGuard() : previous_(recomputing) {
+  recomputing = true;
+}
+
+RecomputeGuard::~RecomputeGuard() {
+  recomputing = previous_;
+}
+
+}  // namespace ember::autograd
@@ -0,0 +1,40 @@
+#include <ember/autograd/node.h>
+#include <ember/tensor.h>
+
+#include <any>
+#include <cstddef>
+#include <vector>
+
+namespace ember::autograd {
+
+namespace {
+
+std::size_t array_bytes(const std::any& value) {
+  if (const auto* array = std::any_cast<xt::xarray<double>>(&value)) {
+    return array->size() * sizeof(double);
+  }
+  if (const auto* values = std::any_cast<std::vector<double>>(&value)) {
+    return values->size() * sizeof(double);
+  }
+  if (const auto* indices = std::any_cast<std::vector<std::size_t>>(&value)) {
+    return indices->size() * sizeof(std::size_t);
+  }
+  return 0;
+}
+
+}  // namespace
+
+std::size_t saved_bytes(const Node& node) {
+  std::size_t bytes = 0;
+  for (const auto* tensors : {&node.saved_tensors, &node.ctx.saved_tensors}) {
+    for (const TensorSnapshot& snapshot : *tensors) {
+      bytes += snapshot.data_.size() * sizeof(double);
+    }
+  }
+  for (const auto& [name, value] : node.ctx.saved_data) {
+    bytes += array_bytes(value);
+  }
+  return bytes;
+}
+
+}  // namespace ember::autograd
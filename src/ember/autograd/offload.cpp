@@ -0,0 +1,441 @@
+#include <ember/autograd/node.h>
+#include <ember/autograd/offload.h>
+#include <ember/tensor_snapshot.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <any>
+#include <cerrno>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace ember::autograd {
+
+namespace {
+
+constexpr std::size_t kMinPurgeSize = 1024;
+
+using Shape = xt::xarray<double>::shape_type;
+
+// A type of array an offloader spills: the values of a snapshot, or one of
+// the arrays of the saved data that `saved_bytes` counts.
+struct ArrayType {
+  std::size_t (*bytes)(const std::any& value);
+  Shape (*shape)(const std::any& value);
+  char* (*values)(std::any& value);
+  // Returns an array of this type with `shape`, to read values back into.
+  std::any (*allocate)(const Shape& shape);
+};
+
+template <typename Array>
+constexpr ArrayType kArrayType = {
+    [](const std::any& value) {
+      const auto& array = std::any_cast<const Array&>(value);
+      return array.size() * sizeof(typename Array::value_type);
+    },
+    [](const std::any& value) {
+      const auto& array = std::any_cast<const Array&>(value);
+      if constexpr (std::is_same_v<Array, xt::xarray<double>>) {
+        return array.shape();
+      } else {
+        return Shape{array.size()};
+      }
+    },
+    [](std::any& value) {
+      return reinterpret_cast<char*>(std::any_cast<Array&>(value).data());
+    },
+    [](const Shape& shape) -> std::any {
+      if constexpr (std::is_same_v<Array, xt::xarray<double>>) {
+        return Array(xt::empty<double>(shape));
+      } else {
+        return Array(shape[0]);
+      }
+    }};
+
+// Returns the type of the array `value` holds, or null if it isn't one.
+const ArrayType* array_type(const std::any& value) {
+  if (value.type() == typeid(xt::xarray<double>)) {
+    return &kArrayType<xt::xarray<double>>;
+  }
+  if (value.type() == typeid(std::vector<double>)) {
+    return &kArrayType<std::vector<double>>;
+  }
+  if (value.type() == typeid(std::vector<std::size_t>)) {
+    return &kArrayType<std::vector<std::size_t>>;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+// A saved tensor or array handed to an offloader, shared by the copies of its
+// snapshot or saved data. Guarded by the offloader's mutex.
+struct OffloadedTensor {
+  enum class Status { Writing, OnDisk, Reading, Resident, Failed };
+
+  Status status = Status::Writing;
+  // Set when the backward pass wants the tensor before it is written, which
+  // keeps it in memory.
+  bool wanted = false;
+  // The array, while it is being written or once it is read back.
+  std::any data;
+  const ArrayType* type = nullptr;
+  Shape shape;
+  std::size_t offset = 0;
+  std::size_t bytes = 0;
+  std::size_t prefetch_depth = 0;
+  std::error_code error;
+  std::shared_ptr<SavedTensorOffloader::State> owner;
+};
+
+struct SavedTensorOffloader::State {
+  std::mutex mutex;
+  std::condition_variable changed;
+  // The tensors to write (false) or read (true), in order.
+  std::deque<std::pair<std::shared_ptr<OffloadedTensor>, bool>> jobs;
+  bool stopping = false;
+  int fd = -1;
+
+  // The extents of the scratch file that are free, by size, and its end.
+  std::multimap<std::size_t, std::size_t> free_extents;
+  std::size_t end = 0;
+
+  // Every offloaded tensor, purged of those that are gone once it reaches
+  // `purge_size`.
+  std::vector<std::weak_ptr<OffloadedTensor>> tensors;
+  std::size_t purge_size = kMinPurgeSize;
+  std::size_t num_offloaded = 0;
+  std::size_t bytes_offloaded = 0;
+  std::size_t num_stalls = 0;
+
+  std::thread io;
+
+  std::size_t allocate(std::size_t bytes) {
+    auto it = free_extents.lower_bound(bytes);
+    if (it == free_extents.end()) {
+      end += bytes;
+      return end - bytes;
+    }
+    auto [size, offset] = *it;
+    free_extents.erase(it);
+    if (size > bytes) {
+      free_extents.emplace(size - bytes, offset + bytes);
+    }
+    return offset;
+  }
+
+  void release(const OffloadedTensor& tensor) {
+    free_extents.emplace(tensor.bytes, tensor.offset);
+  }
+
+  void run();
+};
+
+namespace {
+
+thread_local SavedTensorOffloader* current = nullptr;
+
+// Reads or writes all of `bytes`, retrying on partial transfers.
+bool transfer(int fd, char* cursor, std::size_t bytes, std::size_t offset,
+              bool read) {
+  while (bytes > 0) {
+    ssize_t n = read ? ::pread(fd, cursor, bytes, offset)
+                     : ::pwrite(fd, cursor, bytes, offset);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      if (n == 0) {
+        errno = EIO;
+      }
+      return false;
+    }
+    cursor += n;
+    bytes -= static_cast<std::size_t>(n);
+    offset += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// An array of no elements, to free the values of an offloaded tensor.
+xt::xarray<double> no_values() {
+  return xt::empty<double>(std::vector<std::size_t>{0});
+}
+
+bool is_loaded(const OffloadedTensor& tensor) {
+  return tensor.status == OffloadedTensor::Status::Resident ||
+         tensor.status == OffloadedTensor::Status::Failed;
+}
+
+// Starts reading `tensor` back, or keeps it in memory if it isn't written
+// yet. Called with the owner's mutex held.
+void request(OffloadedTensor& tensor,
+             const std::shared_ptr<OffloadedTensor>& handle, bool urgent) {
+  SavedTensorOffloader::State& state = *tensor.owner;
+  if (tensor.status == OffloadedTensor::Status::Writing) {
+    tensor.wanted = true;
+  } else if (tensor.status == OffloadedTensor::Status::OnDisk) {
+    tensor.status = OffloadedTensor::Status::Reading;
+    if (urgent) {
+      state.jobs.emplace_front(handle, true);
+    } else {
+      state.jobs.emplace_back(handle, true);
+    }
+    state.changed.notify_all();
+  }
+}
+
+void prefetch(const std::shared_ptr<OffloadedTensor>& tensor) {
+  std::lock_guard<std::mutex> lock(tensor->owner->mutex);
+  request(*tensor, tensor, false);
+}
+
+// Waits until `tensor` is read back and returns its array.
+std::any restore(const std::shared_ptr<OffloadedTensor>& tensor) {
+  SavedTensorOffloader::State& state = *tensor->owner;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  if (!is_loaded(*tensor)) {
+    ++state.num_stalls;
+    request(*tensor, tensor, true);
+    state.changed.wait(lock, [&] { return is_loaded(*tensor); });
+  }
+  if (tensor->status == OffloadedTensor::Status::Failed) {
+    throw std::system_error(tensor->error,
+                            "Failed to read back an offloaded tensor");
+  }
+  return std::move(tensor->data);
+}
+
+}  // namespace
+
+void SavedTensorOffloader::State::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    changed.wait(lock, [this] { return stopping || !jobs.empty(); });
+    if (jobs.empty()) {
+      return;
+    }
+    auto [tensor, read] = std::move(jobs.front());
+    jobs.pop_front();
+
+    if (read) {
+      std::any data = tensor->type->allocate(tensor->shape);
+      lock.unlock();
+      bool ok = transfer(fd, tensor->type->values(data), tensor->bytes,
+                         tensor->offset, true);
+      int error = errno;
+      lock.lock();
+      if (ok) {
+        tensor->data = std::move(data);
+        tensor->status = OffloadedTensor::Status::Resident;
+      } else {
+        tensor->error = std::error_code(error, std::generic_category());
+        tensor->status = OffloadedTensor::Status::Failed;
+      }
+      release(*tensor);
+    } else if (tensor->wanted) {
+      release(*tensor);
+      tensor->status = OffloadedTensor::Status::Resident;
+    } else {
+      // Only this thread frees the values of a tensor being written.
+      char* data = tensor->type->values(tensor->data);
+      lock.unlock();
+      bool ok = transfer(fd, data, tensor->bytes, tensor->offset, false);
+      lock.lock();
+      if (!ok || tensor->wanted) {
+        release(*tensor);
+        tensor->status = OffloadedTensor::Status::Resident;
+      } else {
+        tensor->data.reset();
+        tensor->status = OffloadedTensor::Status::OnDisk;
+        ++num_offloaded;
+        bytes_offloaded += tensor->bytes;
+      }
+    }
+    changed.notify_all();
+  }
+}
+
+SavedTensorOffloader::SavedTensorOffloader(std::size_t min_bytes,
+                                           std::size_t prefetch_depth,
+                                           const std::string& directory)
+    : min_bytes_(std::max<std::size_t>(min_bytes, 1)),
+      prefetch_depth_(std::max<std::size_t>(prefetch_depth, 1)),
+      state_(std::make_shared<State>()) {
+  std::filesystem::path path =
+      directory.empty() ? std::filesystem::temp_directory_path()
+                        : std::filesystem::path(directory);
+  std::string name = (path / "ember-offload-XXXXXX").string();
+  state_->fd = ::mkstemp(name.data());
+  if (state_->fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Failed to create a scratch file in " +
+                                path.string());
+  }
+  ::unlink(name.c_str());
+  state_->io = std::thread([state = state_.get()] { state->run(); });
+}
+
+SavedTensorOffloader::~SavedTensorOffloader() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    for (const auto& weak : state_->tensors) {
+      if (auto tensor = weak.lock()) {
+        request(*tensor, tensor, false);
+      }
+    }
+    // The I/O thread finishes every job before it stops.
+    state_->stopping = true;
+  }
+  state_->changed.notify_all();
+  state_->io.join();
+  ::close(state_->fd);
+}
+
+void SavedTensorOffloader::offload(Node& node) {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  // Queues `data`, an array of `type`, to be written and returns its handle.
+  auto queue = [&](std::any data, const ArrayType& type, std::size_t bytes) {
+    auto tensor = std::make_shared<OffloadedTensor>();
+    tensor->shape = type.shape(data);
+    tensor->type = &type;
+    tensor->data = std::move(data);
+    tensor->bytes = bytes;
+    tensor->offset = state_->allocate(bytes);
+    tensor->prefetch_depth = prefetch_depth_;
+    tensor->owner = state_;
+
+    if (state_->tensors.size() >= state_->purge_size) {
+      std::erase_if(state_->tensors,
+                    [](const auto& weak) { return weak.expired(); });
+      state_->purge_size = std::max(kMinPurgeSize, 2 * state_->tensors.size());
+    }
+    state_->tensors.push_back(tensor);
+    state_->jobs.emplace_back(tensor, false);
+    return tensor;
+  };
+
+  for (auto* snapshots : {&node.saved_tensors, &node.ctx.saved_tensors}) {
+    for (TensorSnapshot& snapshot : *snapshots) {
+      std::size_t bytes = snapshot.data_.size() * sizeof(double);
+      if (bytes < min_bytes_ || snapshot.offloaded != nullptr) {
+        continue;
+      }
+      snapshot.offloaded = queue(std::exchange(snapshot.data_, no_values()),
+                                 kArrayType<xt::xarray<double>>, bytes);
+    }
+  }
+  for (auto& [name, value] : node.ctx.saved_data) {
+    const ArrayType* type = array_type(value);
+    if (type == nullptr || type->bytes(value) < min_bytes_) {
+      continue;
+    }
+    std::size_t bytes = type->bytes(value);
+    value = queue(std::move(value), *type, bytes);
+  }
+  state_->changed.notify_all();
+}
+
+void SavedTensorOffloader::wait_for_writes() {
+  std::unique_lock<std::mutex> lock(state_->mutex);
+  state_->changed.wait(lock, [this] {
+    return std::none_of(
+        state_->tensors.begin(), state_->tensors.end(), [](const auto& weak) {
+          auto tensor = weak.lock();
+          return tensor != nullptr &&
+                 tensor->status == OffloadedTensor::Status::Writing;
+        });
+  });
+}
+
+std::size_t SavedTensorOffloader::num_offloaded() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->num_offloaded;
+}
+
+std::size_t SavedTensorOffloader::bytes_offloaded() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->bytes_offloaded;
+}
+
+std::size_t SavedTensorOffloader::num_stalls() const {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return state_->num_stalls;
+}
+
+OffloadGuard::OffloadGuard(SavedTensorOffloader& offloader)
+    : previous_(current) {
+  current = &offloader;
+}
+
+OffloadGuard::~OffloadGuard() {
+  current = previous_;
+}
+
+SavedTensorOffloader* current_offloader() {
+  return current;
+}
+
+SavedTensorLoader::SavedTensorLoader(const std::vector<Node*>& nodes) {
+  for (std::size_t i = 0; i < nodes.size(); ++i) {
+    for (auto* snapshots :
+         {&nodes[i]->saved_tensors, &nodes[i]->ctx.saved_tensors}) {
+      for (TensorSnapshot& snapshot : *snapshots) {
+        if (snapshot.offloaded != nullptr) {
+          entries_.push_back({i, snapshot.offloaded, &snapshot, nullptr});
+        }
+      }
+    }
+    for (auto& [name, value] : nodes[i]->ctx.saved_data) {
+      if (const auto* tensor =
+              std::any_cast<std::shared_ptr<OffloadedTensor>>(&value)) {
+        entries_.push_back({i, *tensor, nullptr, &value});
+      }
+    }
+  }
+}
+
+void SavedTensorLoader::load(std::size_t index) {
+  while (loaded_ < entries_.size() && entries_[loaded_].node < index) {
+    ++loaded_;
+  }
+  if (loaded_ == entries_.size() || entries_[loaded_].node != index) {
+    return;
+  }
+
+  std::size_t depth = entries_[loaded_].tensor->prefetch_depth;
+  std::size_t end = std::min(entries_.size(), loaded_ + depth);
+  for (prefetched_ = std::max(prefetched_, loaded_); prefetched_ < end;
+       ++prefetched_) {
+    prefetch(entries_[prefetched_].tensor);
+  }
+  for (; loaded_ < entries_.size() && entries_[loaded_].node == index;
+       ++loaded_) {
+    Entry& entry = entries_[loaded_];
+    std::any data = restore(entry.tensor);
+    if (entry.snapshot != nullptr) {
+      entry.snapshot->data_ =
+          std::move(*std::any_cast<xt::xarray<double>>(&data));
+      entry.snapshot->offloaded.reset();
+    } else {
+      *entry.value = std::move(data);
+    }
+    entry.tensor.reset();
+  }
+}
+
+}  // namespace ember::autograd
@@ -0,0 +1,21 @@
+#include <ember/autograd/per_sample.h>
+
+namespace ember::autograd {
+
+namespace {
+thread_local PerSampleState* current = nullptr;
+}  // namespace
+
+PerSampleState* current_per_sample() {
+  return current;
+}
+
+PerSampleGuard::PerSampleGuard(PerSampleState& state) : previous_(current) {
+  current = &state;
+}
+
+PerSampleGuard::~PerSampleGuard() {
+  current = previous_;
+}
+
+}  // namespace ember::autograd
@@ -0,0 +1,378 @@
+#include <ember/autograd/engine.h>
+#include <ember/autograd/grad_mode.h>
+#include <ember/autograd/per_sample.h>
+#include <ember/checkpoint.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ember {
+
+namespace {
+
+// The number of steps the memory a plan may keep is divided into when the
+// planner searches for the cheapest plan. Sizes are rounded up to whole
+// steps, so a plan found always fits, at the cost of missing plans within a
+// step per layer of the budget.
+constexpr std::size_t kPlanResolution = 4096;
+
+// Recomputes a checkpointed segment and runs backward through it.
+struct CheckpointBackward : public autograd::Node {
+  CheckpointBackward(CheckpointFn fn, const TensorRefs& inputs,
+                     RngState rng_state)
+      : fn(std::move(fn)), rng_state(std::move(rng_state)) {
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+      const Tensor& input = inputs[i].get();
+      saved_tensors.push_back(input.save());
+      requires_grad.push_back(input.requires_grad());
+      if (input.requires_grad()) {
+        add_next_edge(autograd::Edge(i, input.get_gradient_fn()));
+      }
+    }
+  }
+
+  std::vector<Tensor> operator()(Tensor output_grad) override {
+    // The leaves are never resized, so their accumulators stay valid.
+    std::vector<Tensor> leaves(saved_tensors.size());
+    TensorRefs refs;
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+      leaves[i].data_ = saved_tensors[i].data_;
+      leaves[i].requires_grad(requires_grad[i]);
+      refs.push_back(leaves[i]);
+    }
+
+    Tensor output;
+    RngState current = get_rng_state();
+    set_rng_state(rng_state);
+    try {
+      autograd::GradModeGuard recording(true);
+      autograd::RecomputeGuard recomputing;
+      output = fn(refs);
+    } catch (...) {
+      set_rng_state(current);
+      throw;
+    }
+    set_rng_state(current);
+
+    // The engine also handles a segment that returns one of its inputs.
+    if (output.requires_grad()) {
+      autograd::Engine engine;
+      engine.backward(output.get_gradient_fn(), output_grad);
+    }
+
+    std::vector<Tensor> grads(leaves.size());
+    autograd::PerSampleState* per_sample = autograd::current_per_sample();
+    for (std::size_t i = 0; i < leaves.size(); ++i) {
+      if (!requires_grad[i]) {
+        continue;
+      }
+      // While per-sample gradients are computed, the leaves' gradients go to
+      // the per-sample state instead.
+      if (per_sample != nullptr && per_sample->gradients.count(&leaves[i])) {
+        grads[i] = std::move(per_sample->gradients[&leaves[i]]);
+        per_sample->gradients.erase(&leaves[i]);
+      } else if (leaves[i].gradient != nullptr) {
+        grads[i] = *leaves[i].gradient;
+      } else {
+        grads[i] = Tensor::zeros_like(leaves[i]);
+      }
+      delete leaves[i].gradient;
+      leaves[i].gradient = nullptr;
+    }
+    return grads;
+  }
+
+  CheckpointFn fn;
+  RngState rng_state;
+  std::vector<bool> requires_grad;
+};
+
+}  // namespace
+
+Tensor checkpoint(const CheckpointFn& fn, const TensorRefs& inputs) {
+  bool any_requires_grad = false;
+  for (const Tensor& input : inputs) {
+    any_requires_grad = any_requires_grad || input.requires_grad();
+  }
+
+  RngState rng_state = get_rng_state();
+  std::size_t discarded = autograd::num_discarded_nodes();
+  Tensor output;
+  {
+    autograd::NoGradGuard guard;
+    output = fn(inputs);
+  }
+  // Ops only discard nodes when one of their inputs required gradients, so
+  // this also catches parameters `fn` uses without them being inputs.
+  bool recorded = any_requires_grad ||
+                  autograd::num_discarded_nodes() != discarded;
+  if (!autograd::is_grad_enabled() || !recorded) {
+    return output;
+  }
+  if (output.is_sparse() || output.is_csr()) {
+    throw std::invalid_argument(
+        "A checkpointed function must return a dense tensor");
+  }
+
+  // A new tensor, in case `fn` returned one of its inputs.
+  Tensor result = Tensor::from_xarray(std::move(output.data_));
+  if (output.tangent() != nullptr) {
+    result.set_tangent(*output.tangent());
+  }
+  result.requires_grad(true);
+  result.set_gradient_fn(new CheckpointBackward(fn, inputs, rng_state));
+  return result;
+}
+
+CheckpointPlanner::CheckpointPlanner(std::vector<Layer> layers,
+                                     std::size_t memory_budget_bytes)
+    : layers_(std::move(layers)), memory_budget_bytes_(memory_budget_bytes) {
+  if (layers_.empty()) {
+    throw std::invalid_argument("A checkpoint planner needs a layer");
+  }
+}
+
+Tensor CheckpointPlanner::forward(const Tensor& input) {
+  if (!autograd::is_grad_enabled()) {
+    Tensor output = input;
+    for (const Layer& layer : layers_) {
+      output = layer(output);
+    }
+    return output;
+  }
+
+  std::size_t start = autograd::num_saved_bytes();
+  recompute_peak_bytes_ = std::make_shared<std::size_t>(0);
+  Tensor output = input;
+  if (!planned()) {
+    profiles_.assign(layers_.size(), LayerProfile());
+    for (std::size_t i = 0; i < layers_.size(); ++i) {
+      LayerProfile& profile = profiles_[i];
+      profile.input_bytes = output.data_.size() * sizeof(double);
+      std::size_t before = autograd::num_saved_bytes();
+      auto begin = std::chrono::steady_clock::now();
+      output = layers_[i](output);
+      profile.seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - begin)
+                            .count();
+      profile.saved_bytes = autograd::num_saved_bytes() - before;
+    }
+    forward_bytes_ = autograd::num_saved_bytes() - start;
+    predicted_bytes_ = predict_peak({});
+    plan();
+    return output;
+  }
+
+  std::size_t i = 0;
+  for (const Segment& segment : segments_) {
+    for (; i < segment.begin; ++i) {
+      output = layers_[i](output);
+    }
+    // Only the recomputation records anything, since the forward pass runs
+    // without recording.
+    output = checkpoint(
+        [this, segment, peak = recompute_peak_bytes_](
+            const TensorRefs& inputs) {
+          std::size_t before = autograd::num_saved_bytes();
+          Tensor result = inputs[0].get();
+          for (std::size_t j = segment.begin; j < segment.end; ++j) {
+            result = layers_[j](result);
+          }
+          *peak = std::max(*peak, autograd::num_saved_bytes() - before);
+          return result;
+        },
+        {output});
+    i = segment.end;
+  }
+  for (; i < layers_.size(); ++i) {
+    output = layers_[i](output);
+  }
+  forward_bytes_ = autograd::num_saved_bytes() - start;
+  predicted_bytes_ = predicted_peak_bytes_;
+  return output;
+}
+
+MemoryReport CheckpointPlanner::report() const {
+  MemoryReport report;
+  report.predicted_peak_bytes = predicted_bytes_;
+  report.actual_peak_bytes = forward_bytes_ + *recompute_peak_bytes_;
+  return report;
+}
+
+std::size_t CheckpointPlanner::predict_peak(
+    const std::vector<Segment>& segments) const {
+  std::size_t bytes = 0;
+  for (const LayerProfile& profile : profiles_) {
+    bytes += profile.saved_bytes;
+  }
+  std::size_t recompute = 0;
+  for (const Segment& segment : segments) {
+    std::size_t saved = 0;
+    for (std::size_t i = segment.begin; i < segment.end; ++i) {
+      saved += profiles_[i].saved_bytes;
+    }
+    bytes = bytes - saved + profiles_[segment.begin].input_bytes;
+    recompute = std::max(recompute, saved);
+  }
+  return bytes + recompute;
+}
+
+void CheckpointPlanner::plan() {
+  const std::size_t n = profiles_.size();
+  std::vector<std::size_t> saved_before(n + 1, 0);
+  std::vector<double> seconds_before(n + 1, 0.0);
+  for (std::size_t i = 0; i < n; ++i) {
+    saved_before[i + 1] = saved_before[i] + profiles_[i].saved_bytes;
+    seconds_before[i + 1] = seconds_before[i] + profiles_[i].seconds;
+  }
+  auto saved = [&](std::size_t begin, std::size_t end) {
+    return saved_before[end] - saved_before[begin];
+  };
+  auto seconds = [&](std::size_t begin, std::size_t end) {
+    return seconds_before[end] - seconds_before[begin];
+  };
+
+  // Everything fits without checkpointing.
+  checkpointed_.assign(n, false);
+  segments_.clear();
+  predicted_peak_bytes_ = saved_before[n];
+  recompute_seconds_ = 0.0;
+  if (predicted_peak_bytes_ <= memory_budget_bytes_) {
+    return;
+  }
+
+  std::vector<Segment> best;
+  std::size_t best_peak = predicted_peak_bytes_;
+  double best_seconds = 0.0;
+  bool fits = false;
+  auto consider = [&](std::vector<Segment> candidate) {
+    std::size_t peak = predict_peak(candidate);
+    double candidate_seconds = 0.0;
+    for (const Segment& segment : candidate) {
+      candidate_seconds += seconds(segment.begin, segment.end);
+    }
+    bool candidate_fits = peak <= memory_budget_bytes_;
+    if ((candidate_fits && (!fits || candidate_seconds < best_seconds)) ||
+        (!candidate_fits && !fits && peak < best_peak)) {
+      best = std::move(candidate);
+      best_peak = peak;
+      best_seconds = candidate_seconds;
+      fits = candidate_fits;
+    }
+  };
+  // `begin[j]` is where the segment ending before layer j begins, or j if
+  // layer j - 1 is kept.
+  auto segments_of = [&](const std::vector<std::size_t>& begin) {
+    std::vector<Segment> segments;
+    for (std::size_t j = n; j > 0;) {
+      if (begin[j] == j) {
+        --j;
+        continue;
+      }
+      segments.push_back({begin[j], j});
+      j = begin[j];
+    }
+    std::reverse(segments.begin(), segments.end());
+    return segments;
+  };
+
+  // The largest segment adds its own size to the peak, so for each size
+  // `limit` it could have, search the segments no larger than it for the plan
+  // that keeps the least in memory besides, and for the fastest one that
+  // keeps at most what the budget leaves. A segment is only worth
+  // checkpointing if it saves more than its input.
+  std::set<std::size_t> limits;
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = i + 1; j <= n; ++j) {
+      if (saved(i, j) > profiles_[i].input_bytes) {
+        limits.insert(saved(i, j));
+      }
+    }
+  }
+  for (std::size_t limit : limits) {
+    std::vector<std::size_t> kept(n + 1, 0);
+    std::vector<std::size_t> begin(n + 1, 0);
+    for (std::size_t j = 1; j <= n; ++j) {
+      kept[j] = kept[j - 1] + profiles_[j - 1].saved_bytes;
+      begin[j] = j;
+      for (std::size_t i = j; i-- > 0 && saved(i, j) <= limit;) {
+        if (kept[i] + profiles_[i].input_bytes < kept[j]) {
+          kept[j] = kept[i] + profiles_[i].input_bytes;
+          begin[j] = i;
+        }
+      }
+    }
+    consider(segments_of(begin));
+    if (kept[n] + limit > memory_budget_bytes_) {
+      continue;
+    }
+
+    // A knapsack over what the layers kept and the segments' inputs use of
+    // `capacity` steps of `step` bytes, of the least time to recompute.
+    std::size_t budget = memory_budget_bytes_ - limit;
+    std::size_t step = std::max<std::size_t>(
+        1, (budget + kPlanResolution - 1) / kPlanResolution);
+    std::size_t capacity = budget / step;
+    auto steps = [&](std::size_t bytes) { return (bytes + step - 1) / step; };
+    constexpr double kNever = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<double>> time(
+        n + 1, std::vector<double>(capacity + 1, kNever));
+    // Like `begin`, for each number of steps used up to layer j.
+    std::vector<std::vector<std::size_t>> from_layer(
+        n + 1, std::vector<std::size_t>(capacity + 1, 0));
+    std::vector<std::vector<std::size_t>> from_used(
+        n + 1, std::vector<std::size_t>(capacity + 1, 0));
+    time[0][0] = 0.0;
+    auto relax = [&](std::size_t i, std::size_t used, std::size_t j,
+                     std::size_t segment_begin, std::size_t bytes,
+                     double cost) {
+      std::size_t next = used + steps(bytes);
+      if (next <= capacity && time[i][used] + cost < time[j][next]) {
+        time[j][next] = time[i][used] + cost;
+        from_layer[j][next] = segment_begin;
+        from_used[j][next] = used;
+      }
+    };
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t used = 0; used <= capacity; ++used) {
+        if (time[i][used] == kNever) {
+          continue;
+        }
+        relax(i, used, i + 1, i + 1, profiles_[i].saved_bytes, 0.0);
+        for (std::size_t j = i + 1; j <= n && saved(i, j) <= limit; ++j) {
+          relax(i, used, j, i, profiles_[i].input_bytes, seconds(i, j));
+        }
+      }
+    }
+    auto last = std::min_element(time[n].begin(), time[n].end());
+    if (*last == kNever) {
+      continue;
+    }
+    std::size_t used = static_cast<std::size_t>(last - time[n].begin());
+    for (std::size_t j = n; j > 0;) {
+      begin[j] = from_layer[j][used];
+      used = from_used[j][used];
+      j = begin[j] == j ? j - 1 : begin[j];
+    }
+    consider(segments_of(begin));
+  }
+
+  for (const Segment& segment : best) {
+    std::fill(checkpointed_.begin() + segment.begin,
+              checkpointed_.begin() + segment.end, true);
+  }
+  segments_ = std::move(best);
+  predicted_peak_bytes_ = best_peak;
+  recompute_seconds_ = best_seconds;
+}
+
+}  // namespace ember
@@ -0,0 +1,179 @@
+#include <ember/distributed/data_parallel.h>
+#include <ember/kernels/dispatch.h>
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ember::distributed {
+
+DataParallel::DataParallel(const std::vector<Tensor*>& parameters,
+                           std::size_t num_replicas, std::size_t bucket_size) {
+  if (num_replicas == 0) {
+    throw std::invalid_argument("DataParallel needs at least one replica");
+  }
+  if (bucket_size == 0) {
+    throw std::invalid_argument("DataParallel's buckets can't be empty");
+  }
+  for (Tensor* parameter : parameters) {
+    if (parameter == nullptr || parameter->is_sparse() ||
+        parameter->is_csr() || !parameter->requires_grad()) {
+      throw std::invalid_argument(
+          "DataParallel's parameters must be dense tensors that require "
+          "gradients");
+    }
+    if (std::find(parameters_.begin(), parameters_.end(), parameter) !=
+        parameters_.end()) {
+      throw std::invalid_argument(
+          "A parameter was given to DataParallel twice");
+    }
+    parameters_.push_back(parameter);
+  }
+
+  // Buckets are filled from the last parameter to the first.
+  bucket_of_.resize(parameters_.size());
+  std::size_t bucket_elements = 0;
+  for (std::size_t p = parameters_.size(); p-- > 0;) {
+    if (buckets_.empty() || bucket_elements >= bucket_size) {
+      buckets_.push_back(std::make_unique<Bucket>());
+      bucket_elements = 0;
+    }
+    buckets_.back()->parameters.push_back(p);
+    bucket_of_[p] = buckets_.size() - 1;
+    bucket_elements += parameters_[p]->data_.size();
+  }
+
+  for (std::size_t r = 0; r < num_replicas; ++r) {
+    auto replica = std::make_unique<Tensor[]>(parameters_.size());
+    std::vector<Tensor*> pointers;
+    for (std::size_t p = 0; p < parameters_.size(); ++p) {
+      replica[p].data_ = parameters_[p]->data_;
+      replica[p].requires_grad(true);
+      replica[p].register_post_accumulate_hook(
+          [this, p](Tensor&) { on_gradient(p); });
+      pointers.push_back(&replica[p]);
+    }
+    replicas_.push_back(std::move(replica));
+    replica_parameters_.push_back(std::move(pointers));
+  }
+}
+
+DataParallel::~DataParallel() {
+  for (const auto& pointers : replica_parameters_) {
+    for (Tensor* parameter : pointers) {
+      delete parameter->gradient;
+    }
+  }
+}
+
+double DataParallel::forward_backward(const LossFn& loss) {
+  for (const auto& pointers : replica_parameters_) {
+    for (std::size_t p = 0; p < parameters_.size(); ++p) {
+      Tensor& parameter = *pointers[p];
+      const auto& values = parameters_[p]->data_;
+      if (parameter.data_.shape() != values.shape()) {
+        parameter.data_ = values;
+      } else {
+        std::copy(values.begin(), values.end(), parameter.data_.begin());
+      }
+      // Dense gradients are zeroed in place so that the backward pass
+      // doesn't reallocate them.
+      if (parameter.gradient != nullptr && !parameter.gradient->is_sparse()) {
+        parameter.gradient->data_.fill(0.0);
+      } else {
+        delete parameter.gradient;
+        parameter.gradient = nullptr;
+      }
+    }
+  }
+  for (const auto& bucket : buckets_) {
+    bucket->pending = bucket->parameters.size() * replicas_.size();
+    bucket->reduced = false;
+  }
+
+  std::vector<double> losses(replicas_.size(), 0.0);
+  parallel::get_thread_pool().run(replicas_.size(), [&](std::size_t r) {
+    Tensor value = loss(replica_parameters_[r], r);
+    value.backward();
+    losses[r] = value.data_.size() == 1 ? value.data_.data()[0] : 0.0;
+  });
+
+  // Buckets of parameters that some replica didn't use never complete.
+  for (const auto& bucket : buckets_) {
+    if (!bucket->reduced.exchange(true)) {
+      reduce(*bucket);
+    }
+  }
+  double total = 0.0;
+  for (double value : losses) {
+    total += value;
+  }
+  return total / static_cast<double>(replicas_.size());
+}
+
+void DataParallel::on_gradient(std::size_t p) {
+  Bucket& bucket = *buckets_[bucket_of_[p]];
+  if (bucket.pending.fetch_sub(1) == 1 && !bucket.reduced.exchange(true)) {
+    reduce(bucket);
+  }
+}
+
+void DataParallel::reduce(Bucket& bucket) {
+  double scale = 1.0 / static_cast<double>(replicas_.size());
+  const kernels::KernelTable& k = kernels::active();
+  for (std::size_t p : bucket.parameters) {
+    Tensor& parameter = *parameters_[p];
+    bool all_sparse = true;
+    bool any = false;
+    for (const auto& pointers : replica_parameters_) {
+      const Tensor* gradient = pointers[p]->gradient;
+      any = any || gradient != nullptr;
+      all_sparse = all_sparse && (gradient == nullptr || gradient->is_sparse());
+    }
+    if (!any) {
+      continue;
+    }
+
+    Tensor mean;
+    if (all_sparse) {
+      SparseRows rows;
+      rows.shape.assign(parameter.data_.shape().begin(),
+                        parameter.data_.shape().end());
+      for (const auto& pointers : replica_parameters_) {
+        if (pointers[p]->gradient != nullptr) {
+          SparseRows scaled = pointers[p]->gradient->sparse_rows();
+          scaled.values *= scale;
+          if (rows.indices.empty()) {
+            rows = std::move(scaled);
+          } else {
+            rows.append(scaled);
+          }
+        }
+      }
+      rows.coalesce();
+      mean = Tensor::from_sparse_rows(std::move(rows));
+    } else {
+      mean = Tensor::zeros_like(parameter);
+      for (const auto& pointers : replica_parameters_) {
+        const Tensor* gradient = pointers[p]->gradient;
+        if (gradient == nullptr) {
+          continue;
+        }
+        Tensor dense = gradient->is_sparse() ? gradient->to_dense()
+                                             : Tensor();
+        const Tensor& source = gradient->is_sparse() ? dense : *gradient;
+        k.axpy(scale, source.data_.data(), mean.data_.data(),
+               mean.data_.size());
+      }
+    }
+
+    if (parameter.gradient == nullptr) {
+      parameter.gradient = new Tensor(mean);
+    } else {
+      autograd::accumulate_gradient(*parameter.gradient, mean);
+    }
+  }
+}
+
+}  // namespace ember::distributed
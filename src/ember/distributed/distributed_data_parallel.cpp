@@ -0,0 +1,234 @@
+#include <ember/distributed/distributed_data_parallel.h>
+#include <ember/distributed/process_group.h>
+#include <ember/tensor.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+
+namespace ember::distributed {
+
+struct DistributedDataParallel::State {
+  explicit State(ProcessGroup& group) : group(group) {}
+
+  // Called by a parameter's hook when its gradient is complete.
+  void on_gradient(std::size_t p);
+  // Runs on the communication thread until the trainer is destroyed.
+  void communicate();
+  // All-reduces bucket b and replaces the gradients with their mean.
+  void reduce(std::size_t b);
+  // Readies the buckets for the next backward pass.
+  void reset();
+
+  ProcessGroup& group;
+  std::vector<Tensor*> parameters;
+  std::vector<std::vector<std::size_t>> buckets;
+  // The bucket of each parameter.
+  std::vector<std::size_t> bucket_of;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  // The number of gradients of each bucket that aren't complete yet.
+  std::vector<std::size_t> pending;
+  std::vector<bool> ready;
+  // The next bucket to all-reduce.
+  std::size_t next = 0;
+  bool stopping = false;
+  std::exception_ptr error;
+  // The buffer a bucket is packed into, only used by the communication
+  // thread.
+  std::vector<double> buffer;
+};
+
+DistributedDataParallel::DistributedDataParallel(
+    ProcessGroup& group, const std::vector<Tensor*>& parameters,
+    std::size_t bucket_size)
+    : state_(std::make_shared<State>(group)) {
+  if (bucket_size == 0) {
+    throw std::invalid_argument(
+        "DistributedDataParallel's buckets can't be empty");
+  }
+  State& state = *state_;
+  for (Tensor* parameter : parameters) {
+    if (parameter == nullptr || parameter->is_sparse() ||
+        parameter->is_csr() || !parameter->requires_grad()) {
+      throw std::invalid_argument(
+          "DistributedDataParallel's parameters must be dense tensors that "
+          "require gradients");
+    }
+    if (std::find(state.parameters.begin(), state.parameters.end(),
+                  parameter) != state.parameters.end()) {
+      throw std::invalid_argument(
+          "A parameter was given to DistributedDataParallel twice");
+    }
+    state.parameters.push_back(parameter);
+  }
+
+  // Buckets are filled from the last parameter to the first.
+  state.bucket_of.resize(state.parameters.size());
+  std::size_t bucket_elements = 0;
+  for (std::size_t p = state.parameters.size(); p-- > 0;) {
+    if (state.buckets.empty() || bucket_elements >= bucket_size) {
+      state.buckets.emplace_back();
+      bucket_elements = 0;
+    }
+    state.buckets.back().push_back(p);
+    state.bucket_of[p] = state.buckets.size() - 1;
+    bucket_elements += state.parameters[p]->data_.size();
+  }
+  state.reset();
+
+  // The hooks stay on the parameters after the trainer is destroyed, so they
+  // only hold a weak reference to its state.
+  std::weak_ptr<State> weak = state_;
+  for (std::size_t p = 0; p < state.parameters.size(); ++p) {
+    state.parameters[p]->register_post_accumulate_hook(
+        [weak, p](Tensor&) {
+          if (auto shared = weak.lock()) {
+            shared->on_gradient(p);
+          }
+        });
+  }
+  communication_ = std::thread([state = state_] { state->communicate(); });
+}
+
+DistributedDataParallel::~DistributedDataParallel() {
+  {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopping = true;
+  }
+  state_->changed.notify_all();
+  communication_.join();
+}
+
+void DistributedDataParallel::broadcast_parameters(std::size_t root) {
+  for (Tensor* parameter : state_->parameters) {
+    state_->group.broadcast(*parameter, root);
+  }
+}
+
+void DistributedDataParallel::synchronize() {
+  State& state = *state_;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  // Buckets holding a parameter the backward pass didn't reach never
+  // complete on their own.
+  std::fill(state.ready.begin(), state.ready.end(), true);
+  state.changed.notify_all();
+  state.changed.wait(lock, [&] { return state.next == state.buckets.size(); });
+
+  std::exception_ptr error = state.error;
+  state.error = nullptr;
+  state.reset();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+const std::vector<Tensor*>& DistributedDataParallel::parameters() const {
+  return state_->parameters;
+}
+
+std::size_t DistributedDataParallel::num_buckets() const {
+  return state_->buckets.size();
+}
+
+void DistributedDataParallel::State::on_gradient(std::size_t p) {
+  std::lock_guard<std::mutex> lock(mutex);
+  std::size_t b = bucket_of[p];
+  if (pending[b] == 0) {
+    // The gradient may be read by the communication thread as it changes,
+    // which `synchronize` reports.
+    if (!error) {
+      error = std::make_exception_ptr(std::runtime_error(
+          "A parameter's gradient was accumulated twice before "
+          "DistributedDataParallel::synchronize was called"));
+    }
+    return;
+  }
+  if (--pending[b] == 0) {
+    ready[b] = true;
+    changed.notify_all();
+  }
+}
+
+void DistributedDataParallel::State::communicate() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    changed.wait(lock, [&] {
+      return stopping || (next < buckets.size() && ready[next]);
+    });
+    if (stopping) {
+      return;
+    }
+    std::size_t b = next;
+    lock.unlock();
+    std::exception_ptr failure;
+    try {
+      reduce(b);
+    } catch (...) {
+      failure = std::current_exception();
+    }
+    lock.lock();
+    if (failure) {
+      // The group is unusable once a collective fails, so the remaining
+      // buckets are skipped.
+      error = failure;
+      next = buckets.size();
+    } else {
+      ++next;
+    }
+    changed.notify_all();
+  }
+}
+
+void DistributedDataParallel::State::reduce(std::size_t b) {
+  std::size_t total = 0;
+  for (std::size_t p : buckets[b]) {
+    total += parameters[p]->data_.size();
+  }
+  buffer.assign(total, 0.0);
+
+  std::size_t offset = 0;
+  for (std::size_t p : buckets[b]) {
+    const Tensor* gradient = parameters[p]->gradient;
+    std::size_t size = parameters[p]->data_.size();
+    if (gradient != nullptr) {
+      Tensor dense = gradient->is_sparse() ? gradient->to_dense() : Tensor();
+      const Tensor& source = gradient->is_sparse() ? dense : *gradient;
+      std::copy(source.data_.data(), source.data_.data() + size,
+                buffer.data() + offset);
+    }
+    offset += size;
+  }
+
+  group.all_reduce(buffer.data(), total);
+
+  double scale = 1.0 / static_cast<double>(group.world_size());
+  offset = 0;
+  for (std::size_t p : buckets[b]) {
+    Tensor& parameter = *parameters[p];
+    std::size_t size = parameter.data_.size();
+    if (parameter.gradient == nullptr || parameter.gradient->is_sparse()) {
+      delete parameter.gradient;
+      parameter.gradient = new Tensor(Tensor::zeros_like(parameter));
+    }
+    double* gradient = parameter.gradient->data_.data();
+    for (std::size_t i = 0; i < size; ++i) {
+      gradient[i] = buffer[offset + i] * scale;
+    }
+    offset += size;
+  }
+}
+
+void DistributedDataParallel::State::reset() {
+  next = 0;
+  pending.assign(buckets.size(), 0);
+  for (std::size_t b = 0; b < buckets.size(); ++b) {
+    pending[b] = buckets[b].size();
+  }
+  ready.assign(buckets.size(), false);
+}
+
+}  // namespace ember::distributed
@@ -0,0 +1,235 @@
+#include <ember/distributed/pipeline.h>
+#include <ember/tensor.h>
+
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xview.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace ember::distributed {
+
+namespace {
+
+// Thrown by a channel that was closed because another stage failed.
+struct Aborted {};
+
+// The values passed from one stage to its neighbour, in the order of the
+// micro-batches they belong to.
+class Channel {
+public:
+  void send(xt::xarray<double> values) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      messages_.push_back(std::move(values));
+    }
+    available_.notify_one();
+  }
+
+  xt::xarray<double> receive() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [this] { return closed_ || !messages_.empty(); });
+    if (closed_) {
+      throw Aborted();
+    }
+    xt::xarray<double> values = std::move(messages_.front());
+    messages_.pop_front();
+    return values;
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    available_.notify_all();
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable available_;
+  std::deque<xt::xarray<double>> messages_;
+  bool closed_ = false;
+};
+
+// Deletes a leaf along with its gradient, which a tensor doesn't own.
+struct DeleteLeaf {
+  void operator()(Tensor* leaf) const {
+    delete leaf->gradient;
+    delete leaf;
+  }
+};
+
+// What a stage keeps of a micro-batch between its forward and backward pass.
+struct Saved {
+  // The stage's output, or the loss for the last stage, whose graph is
+  // released before the leaf it leads to.
+  Tensor output;
+  // The leaf the stage's input was copied into, which must not move.
+  std::unique_ptr<Tensor, DeleteLeaf> input;
+};
+
+// The forward (true) and backward (false) passes of one stage, in order.
+// Micro-batches are always started and finished in ascending order.
+std::vector<bool> passes(Schedule schedule, std::size_t stage,
+                         std::size_t num_stages, std::size_t micro_batches) {
+  std::vector<bool> result;
+  std::size_t warm_up = schedule == Schedule::GPipe
+                            ? micro_batches
+                            : std::min(num_stages - stage - 1, micro_batches);
+  result.insert(result.end(), warm_up, true);
+  for (std::size_t i = warm_up; i < micro_batches; ++i) {
+    result.push_back(true);
+    result.push_back(false);
+  }
+  result.insert(result.end(), warm_up, false);
+  return result;
+}
+
+}  // namespace
+
+Pipeline::Pipeline(std::vector<Stage> stages, std::size_t num_micro_batches,
+                   Schedule schedule)
+    : stages_(std::move(stages)),
+      num_micro_batches_(num_micro_batches),
+      schedule_(schedule) {
+  if (stages_.empty()) {
+    throw std::invalid_argument("A pipeline needs at least one stage");
+  }
+  if (num_micro_batches == 0) {
+    throw std::invalid_argument("A pipeline needs at least one micro-batch");
+  }
+}
+
+double Pipeline::forward_backward(const Tensor& input, const Tensor& target,
+                                  const LossFn& loss) {
+  if (input.data_.dimension() == 0 || target.data_.dimension() == 0 ||
+      input.data_.shape()[0] != target.data_.shape()[0]) {
+    throw std::invalid_argument(
+        "A pipeline's input and target must have the same number of rows");
+  }
+  std::size_t rows = input.data_.shape()[0];
+  std::size_t micro_batches = num_micro_batches_;
+  if (rows < micro_batches) {
+    throw std::invalid_argument(
+        "A pipeline's batch must have at least one row per micro-batch");
+  }
+  std::vector<std::size_t> bounds;
+  for (std::size_t i = 0; i <= micro_batches; ++i) {
+    bounds.push_back(rows * i / micro_batches);
+  }
+
+  std::size_t num_stages = stages_.size();
+  // activations[s] carries outputs from stage s - 1 to stage s, and
+  // gradients[s] carries the gradients of stage s + 1's inputs to stage s.
+  std::vector<Channel> activations(num_stages);
+  std::vector<Channel> gradients(num_stages);
+  std::vector<double> losses(micro_batches, 0.0);
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  auto run_stage = [&](std::size_t s) {
+    bool last = s + 1 == num_stages;
+    std::vector<Saved> saved(micro_batches);
+    std::size_t next_forward = 0;
+    std::size_t next_backward = 0;
+    for (bool forward : passes(schedule_, s, num_stages, micro_batches)) {
+      if (forward) {
+        std::size_t i = next_forward++;
+        Saved& micro_batch = saved[i];
+        auto rows_of = xt::range(bounds[i], bounds[i + 1]);
+        micro_batch.input.reset(new Tensor());
+        if (s == 0) {
+          micro_batch.input->data_ = xt::view(input.data_, rows_of);
+        } else {
+          micro_batch.input->data_ = activations[s].receive();
+          micro_batch.input->requires_grad(true);
+        }
+        Tensor output = stages_[s](*micro_batch.input);
+        if (last) {
+          Tensor micro_target =
+              Tensor::from_xarray(xt::view(target.data_, rows_of));
+          micro_batch.output = loss(output, micro_target);
+          const auto& value = micro_batch.output.data_;
+          losses[i] = value.size() == 1 ? value.data()[0] : 0.0;
+        } else {
+          activations[s + 1].send(output.data_);
+          micro_batch.output = std::move(output);
+        }
+      } else {
+        std::size_t i = next_backward++;
+        Saved& micro_batch = saved[i];
+        Tensor& output = micro_batch.output;
+        if (output.get_gradient_fn() != nullptr) {
+          if (last) {
+            // Weighting the seed weights the micro-batch's loss.
+            double weight = static_cast<double>(bounds[i + 1] - bounds[i]) /
+                            static_cast<double>(rows);
+            output.backward(Tensor::from_xarray(
+                xt::xarray<double>(xt::ones_like(output.data_) * weight)));
+          } else {
+            output.backward(Tensor::from_xarray(gradients[s].receive()));
+          }
+        } else if (!last) {
+          gradients[s].receive();
+        }
+        if (s > 0) {
+          Tensor* gradient = micro_batch.input->gradient;
+          if (gradient == nullptr) {
+            gradients[s - 1].send(xt::zeros_like(micro_batch.input->data_));
+          } else {
+            gradients[s - 1].send(gradient->is_sparse()
+                                      ? gradient->to_dense().data_
+                                      : gradient->data_);
+          }
+        }
+        // Frees the micro-batch's graph.
+        micro_batch = Saved();
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t s = 0; s < num_stages; ++s) {
+    threads.emplace_back([&, s] {
+      try {
+        run_stage(s);
+      } catch (const Aborted&) {
+      } catch (...) {
+        {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error) {
+            error = std::current_exception();
+          }
+        }
+        // Wakes the stages waiting on this one.
+        for (std::size_t c = 0; c < num_stages; ++c) {
+          activations[c].close();
+          gradients[c].close();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  double total = 0.0;
+  for (std::size_t i = 0; i < micro_batches; ++i) {
+    total += losses[i] * static_cast<double>(bounds[i + 1] - bounds[i]) /
+             static_cast<double>(rows);
+  }
+  return total;
+}
+
+}  // namespace ember::distributed
@@ -0,0 +1,413 @@
+#include <ember/distributed/process_group.h>
+#include <ember/tensor.h>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+namespace ember::distributed {
+
+namespace {
+
+// The number of slots in each mailbox, i.e. the number of chunks a process
+// can send before the next one has read any of them.
+constexpr std::size_t kSlots = 4;
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+// A message on a connection between neighbours. Towards the next process it
+// says that `slot` of its mailbox holds `count` values, and back towards the
+// previous one that `slot` is free again.
+struct Message {
+  std::uint64_t slot;
+  std::uint64_t count;
+};
+
+[[noreturn]] void throw_errno(const std::string& what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+void write_message(int socket, const Message& message) {
+  const char* data = reinterpret_cast<const char*>(&message);
+  std::size_t written = 0;
+  while (written < sizeof(message)) {
+    ssize_t result =
+        ::send(socket, data + written, sizeof(message) - written, kSendFlags);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_errno("Failed to send to a process of the group");
+    }
+    written += static_cast<std::size_t>(result);
+  }
+}
+
+Message read_message(int socket) {
+  Message message;
+  char* data = reinterpret_cast<char*>(&message);
+  std::size_t read = 0;
+  while (read < sizeof(message)) {
+    ssize_t result = ::recv(socket, data + read, sizeof(message) - read, 0);
+    if (result == 0) {
+      errno = ECONNRESET;
+      throw_errno("A process left the group");
+    }
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw_errno("Failed to receive from a process of the group");
+    }
+    read += static_cast<std::size_t>(result);
+  }
+  return message;
+}
+
+std::string mailbox_name(const std::string& group, std::size_t rank) {
+  return "/ember-" + group + "-" + std::to_string(rank);
+}
+
+std::string socket_path(const std::string& group, std::size_t rank) {
+  const char* directory = std::getenv("TMPDIR");
+  std::string path = directory != nullptr && *directory != '\0' ? directory
+                                                                : "/tmp";
+  return path + "/ember-" + group + "-" + std::to_string(rank) + ".sock";
+}
+
+sockaddr_un socket_address(const std::string& path) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw std::invalid_argument("The socket path of a group is too long: " +
+                                path);
+  }
+  std::strcpy(address.sun_path, path.c_str());
+  return address;
+}
+
+double* map_mailbox(int fd, std::size_t bytes) {
+  void* memory =
+      ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    throw_errno("Failed to map a mailbox of the group");
+  }
+  return static_cast<double*>(memory);
+}
+
+// Closes a file descriptor when it goes out of scope.
+struct Descriptor {
+  int fd;
+  ~Descriptor() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+
+// The bounds of part `i` of `parts` near-equal parts of [0, n).
+std::size_t part_begin(std::size_t n, std::size_t parts, std::size_t i) {
+  return n * i / parts;
+}
+
+}  // namespace
+
+ProcessGroup::ProcessGroup(const std::string& name, std::size_t rank,
+                           std::size_t world_size, std::size_t chunk_size,
+                           std::chrono::milliseconds timeout)
+    : rank_(rank), world_size_(world_size), chunk_size_(chunk_size) {
+  if (rank >= world_size) {
+    throw std::invalid_argument("A process's rank must be less than the "
+                                "number of processes in its group");
+  }
+  if (chunk_size == 0) {
+    throw std::invalid_argument("A group's chunks can't be empty");
+  }
+  if (name.empty() || name.find('/') != std::string::npos) {
+    throw std::invalid_argument(
+        "A group's name must be nonempty and can't contain '/'");
+  }
+  if (world_size == 1) {
+    return;
+  }
+  try {
+    join(name, timeout);
+  } catch (...) {
+    // Nothing is left behind to confuse a later group of the same name.
+    ::shm_unlink(mailbox_name(name, rank).c_str());
+    ::unlink(socket_path(name, rank).c_str());
+    close();
+    throw;
+  }
+}
+
+ProcessGroup::~ProcessGroup() { close(); }
+
+void ProcessGroup::join(const std::string& name,
+                        std::chrono::milliseconds timeout) {
+  std::size_t next = (rank_ + 1) % world_size_;
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  mailbox_bytes_ = kSlots * chunk_size_ * sizeof(double);
+
+  // This process's mailbox is created before it listens, so the previous
+  // process can open it as soon as it has connected.
+  std::string own_mailbox = mailbox_name(name, rank_);
+  ::shm_unlink(own_mailbox.c_str());
+  Descriptor memory{
+      ::shm_open(own_mailbox.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600)};
+  if (memory.fd < 0) {
+    throw_errno("Failed to create the mailbox " + own_mailbox);
+  }
+  if (::ftruncate(memory.fd, static_cast<off_t>(mailbox_bytes_)) != 0) {
+    throw_errno("Failed to size the mailbox " + own_mailbox);
+  }
+  mailbox_ = map_mailbox(memory.fd, mailbox_bytes_);
+
+  std::string own_path = socket_path(name, rank_);
+  sockaddr_un own_address = socket_address(own_path);
+  Descriptor listener{::socket(AF_UNIX, SOCK_STREAM, 0)};
+  if (listener.fd < 0) {
+    throw_errno("Failed to create a socket");
+  }
+  ::unlink(own_path.c_str());
+  if (::bind(listener.fd, reinterpret_cast<sockaddr*>(&own_address),
+             sizeof(own_address)) != 0 ||
+      ::listen(listener.fd, 1) != 0) {
+    throw_errno("Failed to listen on " + own_path);
+  }
+
+  // Connecting only needs the next process to be listening, not to accept,
+  // so every process connects before it accepts.
+  sockaddr_un next_address = socket_address(socket_path(name, next));
+  while (true) {
+    next_socket_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (next_socket_ < 0) {
+      throw_errno("Failed to create a socket");
+    }
+    if (::connect(next_socket_, reinterpret_cast<sockaddr*>(&next_address),
+                  sizeof(next_address)) == 0) {
+      break;
+    }
+    ::close(next_socket_);
+    next_socket_ = -1;
+    if (std::chrono::steady_clock::now() > deadline) {
+      errno = ETIMEDOUT;
+      throw_errno("Timed out waiting for process " + std::to_string(next) +
+                  " of group " + name);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  std::string next_mailbox = mailbox_name(name, next);
+  Descriptor next_memory{::shm_open(next_mailbox.c_str(), O_RDWR, 0600)};
+  if (next_memory.fd < 0) {
+    throw_errno("Failed to open the mailbox " + next_mailbox);
+  }
+  next_mailbox_ = map_mailbox(next_memory.fd, mailbox_bytes_);
+  // Tells the next process that its mailbox is mapped.
+  write_message(next_socket_, {0, 0});
+
+  pollfd waiting{listener.fd, POLLIN, 0};
+  auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+      deadline - std::chrono::steady_clock::now());
+  int ready = ::poll(&waiting, 1, std::max<int>(0, remaining.count()));
+  if (ready <= 0) {
+    if (ready == 0) {
+      errno = ETIMEDOUT;
+    }
+    throw_errno("Timed out waiting for the previous process of group " +
+                name);
+  }
+  prev_socket_ = ::accept(listener.fd, nullptr, nullptr);
+  if (prev_socket_ < 0) {
+    throw_errno("Failed to accept the previous process of group " + name);
+  }
+  ::unlink(own_path.c_str());
+  // Once the previous process has mapped this mailbox, its name is no longer
+  // needed, and removing it means nothing is left behind if a process dies.
+  read_message(prev_socket_);
+  ::shm_unlink(own_mailbox.c_str());
+
+  for (std::size_t slot = 0; slot < kSlots; ++slot) {
+    free_slots_.push_back(slot);
+  }
+}
+
+void ProcessGroup::close() {
+  if (mailbox_ != nullptr) {
+    ::munmap(mailbox_, mailbox_bytes_);
+    mailbox_ = nullptr;
+  }
+  if (next_mailbox_ != nullptr) {
+    ::munmap(next_mailbox_, mailbox_bytes_);
+    next_mailbox_ = nullptr;
+  }
+  if (prev_socket_ >= 0) {
+    ::close(prev_socket_);
+    prev_socket_ = -1;
+  }
+  if (next_socket_ >= 0) {
+    ::close(next_socket_);
+    next_socket_ = -1;
+  }
+}
+
+void ProcessGroup::send(const double* data, std::size_t count) {
+  if (free_slots_.empty()) {
+    free_slots_.push_back(read_message(next_socket_).slot);
+  }
+  std::size_t slot = free_slots_.back();
+  free_slots_.pop_back();
+  std::copy(data, data + count, next_mailbox_ + slot * chunk_size_);
+  // The system call orders the copy before the message.
+  write_message(next_socket_, {slot, count});
+}
+
+const double* ProcessGroup::receive(std::size_t count, std::size_t& slot) {
+  Message message = read_message(prev_socket_);
+  if (message.slot >= kSlots || message.count != count) {
+    throw std::runtime_error(
+        "The processes of a group called different collectives, or passed "
+        "buffers of different sizes");
+  }
+  slot = message.slot;
+  return mailbox_ + slot * chunk_size_;
+}
+
+void ProcessGroup::release(std::size_t slot) {
+  try {
+    write_message(prev_socket_, {slot, 0});
+  } catch (const std::system_error& error) {
+    // The previous process may have finished its last collective and left
+    // already, in which case it no longer needs the slot. Any other failure
+    // shows up when a chunk is next received.
+    if (error.code() != std::errc::broken_pipe &&
+        error.code() != std::errc::connection_reset) {
+      throw;
+    }
+  }
+}
+
+void ProcessGroup::exchange(const double* send_data, std::size_t send_count,
+                            double* recv_data, std::size_t recv_count,
+                            std::size_t chunks, bool add) {
+  for (std::size_t i = 0; i < chunks; ++i) {
+    std::size_t send_begin = part_begin(send_count, chunks, i);
+    std::size_t send_end = part_begin(send_count, chunks, i + 1);
+    send(send_data + send_begin, send_end - send_begin);
+
+    std::size_t recv_begin = part_begin(recv_count, chunks, i);
+    std::size_t recv_end = part_begin(recv_count, chunks, i + 1);
+    std::size_t slot;
+    const double* chunk = receive(recv_end - recv_begin, slot);
+    double* out = recv_data + recv_begin;
+    if (add) {
+      for (std::size_t j = 0; j < recv_end - recv_begin; ++j) {
+        out[j] += chunk[j];
+      }
+    } else {
+      std::copy(chunk, chunk + (recv_end - recv_begin), out);
+    }
+    release(slot);
+  }
+}
+
+void ProcessGroup::all_reduce(double* data, std::size_t n) {
+  std::size_t p = world_size_;
+  if (p == 1) {
+    return;
+  }
+  auto segment = [&](std::size_t s) { return data + part_begin(n, p, s); };
+  auto length = [&](std::size_t s) {
+    return part_begin(n, p, s + 1) - part_begin(n, p, s);
+  };
+  // Every segment is split into the same number of chunks, enough for the
+  // longest one, so that every process has sent and received the same number
+  // of chunks at each point, which keeps the ring from deadlocking on full
+  // mailboxes.
+  std::size_t longest = (n + p - 1) / p;
+  std::size_t chunks =
+      std::max<std::size_t>(1, (longest + chunk_size_ - 1) / chunk_size_);
+  // Reduce-scatter: after step k, segment r - k - 1 holds the sum of k + 2
+  // processes, so each process ends with the full sum of segment r + 1.
+  for (std::size_t k = 0; k + 1 < p; ++k) {
+    std::size_t send_segment = (rank_ + p - k) % p;
+    std::size_t recv_segment = (rank_ + 2 * p - k - 1) % p;
+    exchange(segment(send_segment), length(send_segment),
+             segment(recv_segment), length(recv_segment), chunks, true);
+  }
+  // All-gather: the full sums are passed around the ring.
+  for (std::size_t k = 0; k + 1 < p; ++k) {
+    std::size_t send_segment = (rank_ + 1 + p - k) % p;
+    std::size_t recv_segment = (rank_ + p - k) % p;
+    exchange(segment(send_segment), length(send_segment),
+             segment(recv_segment), length(recv_segment), chunks, false);
+  }
+}
+
+void ProcessGroup::all_reduce(Tensor& tensor) {
+  if (tensor.is_sparse() || tensor.is_csr()) {
+    throw std::invalid_argument("Only dense tensors can be all-reduced");
+  }
+  all_reduce(tensor.data_.data(), tensor.data_.size());
+}
+
+void ProcessGroup::broadcast(double* data, std::size_t n, std::size_t root) {
+  if (root >= world_size_) {
+    throw std::invalid_argument("The root of a broadcast must be a rank of "
+                                "the group");
+  }
+  if (world_size_ == 1) {
+    return;
+  }
+  // The chunks are passed along the ring from the root, each process
+  // forwarding a chunk as soon as it has it, except the one before the root.
+  bool last = (rank_ + 1) % world_size_ == root;
+  std::size_t chunks =
+      std::max<std::size_t>(1, (n + chunk_size_ - 1) / chunk_size_);
+  for (std::size_t i = 0; i < chunks; ++i) {
+    std::size_t begin = part_begin(n, chunks, i);
+    std::size_t end = part_begin(n, chunks, i + 1);
+    if (rank_ != root) {
+      std::size_t slot;
+      const double* chunk = receive(end - begin, slot);
+      std::copy(chunk, chunk + (end - begin), data + begin);
+      release(slot);
+    }
+    if (!last) {
+      send(data + begin, end - begin);
+    }
+  }
+}
+
+void ProcessGroup::broadcast(Tensor& tensor, std::size_t root) {
+  if (tensor.is_sparse() || tensor.is_csr()) {
+    throw std::invalid_argument("Only dense tensors can be broadcast");
+  }
+  broadcast(tensor.data_.data(), tensor.data_.size(), root);
+}
+
+void ProcessGroup::barrier() {
+  // An all-reduce only completes once data from every process has gone
+  // around the ring.
+  double token = 0.0;
+  all_reduce(&token, 1);
+}
+
+}  // namespace ember::distributed
@@ -0,0 +1,47 @@
+#include <ember/autograd/grad_mode.h>
+#include <ember/jvp.h>
+#include <ember/tensor.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ember {
+
+std::pair<Tensor, Tensor> jvp(const JvpFn& fn, const TensorRefs& primals,
+                              const TensorRefs& tangents) {
+  if (primals.size() != tangents.size()) {
+    throw std::invalid_argument("jvp expects one tangent per primal, got " +
+                                std::to_string(tangents.size()) + " for " +
+                                std::to_string(primals.size()));
+  }
+  // New tensors, so the primals passed in don't keep the tangents.
+  std::vector<Tensor> inputs(primals.size());
+  TensorRefs refs;
+  for (std::size_t i = 0; i < primals.size(); ++i) {
+    const Tensor& primal = primals[i].get();
+    if (primal.is_sparse() || primal.is_csr()) {
+      throw std::invalid_argument("jvp expects dense primals");
+    }
+    inputs[i].data_ = primal.data_;
+    inputs[i].set_tangent(tangents[i].get());
+    refs.push_back(inputs[i]);
+  }
+
+  Tensor output;
+  {
+    autograd::NoGradGuard no_grad;
+    autograd::ForwardGradGuard forward_grad(true);
+    output = fn(refs);
+  }
+  if (output.is_sparse() || output.is_csr()) {
+    throw std::invalid_argument("jvp expects fn to return a dense tensor");
+  }
+  Tensor tangent = output.tangent() != nullptr ? *output.tangent()
+                                               : Tensor::zeros_like(output);
+  return {Tensor::from_xarray(std::move(output.data_)), std::move(tangent)};
+}
+
+}  // namespace ember
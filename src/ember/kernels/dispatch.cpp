@@ -0,0 +1,126 @@
+#include <ember/kernels/dispatch.h>
+
+#include <atomic>
+#include <stdexcept>
+
+namespace ember::kernels {
+
+// Each of these is defined by a copy of kernels.cpp compiled with the flags for
+// that instruction set.
+namespace baseline {
+KernelTable make_table();
+}
+#ifdef EMBER_KERNELS_X86_DISPATCH
+namespace sse42 {
+KernelTable make_table();
+}
+namespace avx2 {
+KernelTable make_table();
+}
+namespace avx512 {
+KernelTable make_table();
+}
+#endif
+
+namespace {
+
+struct Tables {
+  KernelTable baseline = kernels::baseline::make_table();
+#ifdef EMBER_KERNELS_X86_DISPATCH
+  KernelTable sse42 = kernels::sse42::make_table();
+  KernelTable avx2 = kernels::avx2::make_table();
+  KernelTable avx512 = kernels::avx512::make_table();
+#endif
+};
+
+const Tables& tables() {
+  static const Tables instance;
+  return instance;
+}
+
+std::atomic<const KernelTable*>& active_table() {
+  static std::atomic<const KernelTable*> instance{&table(detect_isa())};
+  return instance;
+}
+
+std::atomic<Isa>& active_isa_ref() {
+  static std::atomic<Isa> instance{detect_isa()};
+  return instance;
+}
+
+std::atomic<bool> fast_math{false};
+
+}  // namespace
+
+Isa detect_isa() {
+  for (Isa isa : {Isa::AVX512, Isa::AVX2, Isa::SSE42}) {
+    if (is_supported(isa)) {
+      return isa;
+    }
+  }
+  return Isa::Baseline;
+}
+
+bool is_supported(Isa isa) {
+#ifdef EMBER_KERNELS_X86_DISPATCH
+  // __builtin_cpu_supports also checks that the OS saves the wider registers.
+  switch (isa) {
+    case Isa::Baseline:
+      return true;
+    case Isa::SSE42:
+      return __builtin_cpu_supports("sse4.2");
+    case Isa::AVX2:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case Isa::AVX512:
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+  return false;
+#else
+  return isa == Isa::Baseline;
+#endif
+}
+
+Isa active_isa() {
+  return active_isa_ref().load();
+}
+
+void set_isa(Isa isa) {
+  const KernelTable& kernels = table(isa);
+  active_isa_ref().store(isa);
+  active_table().store(&kernels);
+}
+
+const KernelTable& active() {
+  return *active_table().load(std::memory_order_relaxed);
+}
+
+void set_fast_math(bool enabled) {
+  fast_math.store(enabled);
+}
+
+bool fast_math_enabled() {
+  return fast_math.load(std::memory_order_relaxed);
+}
+
+const KernelTable& table(Isa isa) {
+  if (!is_supported(isa)) {
+    throw std::invalid_argument(
+        "Kernels for the requested instruction set are not supported on this "
+        "machine");
+  }
+  switch (isa) {
+#ifdef EMBER_KERNELS_X86_DISPATCH
+    case Isa::SSE42:
+      return tables().sse42;
+    case Isa::AVX2:
+      return tables().avx2;
+    case Isa::AVX512:
+      return tables().avx512;
+#endif
+    default:
+      return tables().baseline;
+  }
+}
+
+}  // namespace ember::kernels
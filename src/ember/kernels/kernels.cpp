@@ -0,0 +1,441 @@
+// This file is compiled once per instruction set, with EMBER_KERNEL_ISA naming
+// the namespace its kernels are placed in (see CMakeLists.txt). The loops are
+// written so that the compiler can vectorize them for whichever instruction set
+// is enabled, so it must not include anything that could be instantiated
+// outside of that namespace.
+#include <ember/kernels/dispatch.h>
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__)
+#define EMBER_SQRT __builtin_sqrt
+#else
+// Only the baseline kernels are built by other compilers, so <cmath> can't mix
+// instruction sets here.
+#include <cmath>
+#define EMBER_SQRT std::sqrt
+#endif
+
+#ifndef EMBER_KERNEL_ISA
+#error "EMBER_KERNEL_ISA must name the instruction set being compiled"
+#endif
+
+#define EMBER_STRINGIFY_IMPL(x) #x
+#define EMBER_STRINGIFY(x) EMBER_STRINGIFY_IMPL(x)
+
+namespace ember::kernels::EMBER_KERNEL_ISA {
+
+static void add(const double* a, const double* b, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] + b[i];
+  }
+}
+
+static void sub(const double* a, const double* b, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] - b[i];
+  }
+}
+
+static void mul(const double* a, const double* b, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] * b[i];
+  }
+}
+
+static void div(const double* a, const double* b, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = a[i] / b[i];
+  }
+}
+
+static void axpy(double alpha, const double* x, double* y, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    y[i] += alpha * x[i];
+  }
+}
+
+/**
+ * Sums with eight independent accumulators so that the additions can be
+ * spread across vector lanes without reassociating them, which keeps the result
+ * the same regardless of vector width.
+ */
+static double sum(const double* x, std::size_t n) {
+  constexpr std::size_t kLanes = 8;
+  double acc[kLanes] = {};
+  std::size_t i = 0;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+      acc[lane] += x[i + lane];
+    }
+  }
+  for (std::size_t lane = 0; i < n; ++i, ++lane) {
+    acc[lane] += x[i];
+  }
+  return ((acc[0] + acc[1]) + (acc[2] + acc[3])) +
+         ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+/**
+ * Runs Welford's algorithm on eight interleaved lanes, which all hold the same
+ * number of elements, so each step shares one reciprocal and the updates can
+ * be spread across vector lanes. The lanes are then merged pairwise and the
+ * remaining elements folded in one at a time, which keeps the result the same
+ * regardless of vector width.
+ */
+static void moments(const double* x, std::size_t n, double* mean, double* m2) {
+  constexpr std::size_t kLanes = 8;
+  double lane_mean[kLanes] = {};
+  double lane_m2[kLanes] = {};
+  std::size_t steps = n / kLanes;
+  for (std::size_t step = 0; step < steps; ++step) {
+    double inverse_count = 1.0 / static_cast<double>(step + 1);
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+      double value = x[step * kLanes + lane];
+      double delta = value - lane_mean[lane];
+      lane_mean[lane] += delta * inverse_count;
+      lane_m2[lane] += delta * (value - lane_mean[lane]);
+    }
+  }
+
+  // Merging two lanes of c elements each adds delta^2 * c / 2 to M2.
+  double count = static_cast<double>(steps);
+  for (std::size_t stride = 1; stride < kLanes; stride *= 2) {
+    for (std::size_t lane = 0; lane < kLanes; lane += 2 * stride) {
+      double delta = lane_mean[lane + stride] - lane_mean[lane];
+      lane_mean[lane] += delta * 0.5;
+      lane_m2[lane] += lane_m2[lane + stride] + delta * delta * count * 0.5;
+    }
+    count *= 2;
+  }
+
+  double result_mean = lane_mean[0];
+  double result_m2 = lane_m2[0];
+  for (std::size_t i = steps * kLanes; i < n; ++i) {
+    count += 1;
+    double delta = x[i] - result_mean;
+    result_mean += delta / count;
+    result_m2 += delta * (x[i] - result_mean);
+  }
+  *mean = result_mean;
+  *m2 = result_m2;
+}
+
+/**
+ * Returns whether x should replace best as the running maximum (or minimum).
+ * NaNs replace anything but another NaN, so the first NaN wins.
+ */
+template <bool kLargest>
+static inline bool replaces(double x, double best) {
+  bool x_is_nan = x != x;
+  bool best_is_nan = best != best;
+  return (kLargest ? x > best : x < best) | (x_is_nan & !best_is_nan);
+}
+
+template <bool kLargest>
+static void arg_update(const double* x, double* best, std::size_t* index,
+                       std::size_t position, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    bool replace = replaces<kLargest>(x[i], best[i]);
+    best[i] = replace ? x[i] : best[i];
+    index[i] = replace ? position : index[i];
+  }
+}
+
+/**
+ * Scans with eight independent running extremes, each of which keeps the first
+ * of its equal elements, and then picks the lane with the extreme that comes
+ * first. The result is therefore the same as a sequential scan.
+ */
+template <bool kLargest>
+static std::size_t arg_reduce(const double* x, std::size_t n) {
+  constexpr std::size_t kLanes = 8;
+  if (n < kLanes) {
+    std::size_t result = 0;
+    for (std::size_t i = 1; i < n; ++i) {
+      result = replaces<kLargest>(x[i], x[result]) ? i : result;
+    }
+    return result;
+  }
+
+  double best[kLanes];
+  std::size_t index[kLanes];
+  for (std::size_t lane = 0; lane < kLanes; ++lane) {
+    best[lane] = x[lane];
+    index[lane] = lane;
+  }
+  std::size_t i = kLanes;
+  for (; i + kLanes <= n; i += kLanes) {
+    for (std::size_t lane = 0; lane < kLanes; ++lane) {
+      bool replace = replaces<kLargest>(x[i + lane], best[lane]);
+      best[lane] = replace ? x[i + lane] : best[lane];
+      index[lane] = replace ? i + lane : index[lane];
+    }
+  }
+  for (std::size_t lane = 0; i < n; ++i, ++lane) {
+    if (replaces<kLargest>(x[i], best[lane])) {
+      best[lane] = x[i];
+      index[lane] = i;
+    }
+  }
+
+  std::size_t result = 0;
+  for (std::size_t lane = 1; lane < kLanes; ++lane) {
+    bool ties = !replaces<kLargest>(best[result], best[lane]) &&
+                index[lane] < index[result];
+    if (replaces<kLargest>(best[lane], best[result]) || ties) {
+      result = lane;
+    }
+  }
+  return index[result];
+}
+
+static void sqrt(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = EMBER_SQRT(x[i]);
+  }
+}
+
+static void rsqrt(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = 1.0 / EMBER_SQRT(x[i]);
+  }
+}
+
+static void relu(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    // Written so that NaNs are propagated.
+    out[i] = x[i] < 0.0 ? 0.0 : x[i];
+  }
+}
+
+/**
+ * Each branch on the hyperparameters is taken once per call, outside the
+ * loops, so that each loop is a single vectorizable pass.
+ */
+static void sgd(double* param, const double* grad, double* buffer,
+                std::size_t n, const SgdStep& step) {
+  double lr = step.lr;
+  double decay = step.weight_decay;
+  if (step.momentum == 0.0) {
+    for (std::size_t i = 0; i < n; ++i) {
+      param[i] -= lr * (grad[i] + decay * param[i]);
+    }
+    return;
+  }
+  double momentum = step.momentum;
+  // On the first step the buffer is set to the gradient.
+  double keep = step.first ? 0.0 : momentum;
+  double scale = step.first ? 1.0 : 1.0 - step.dampening;
+  if (step.nesterov) {
+    for (std::size_t i = 0; i < n; ++i) {
+      double g = grad[i] + decay * param[i];
+      double b = keep * buffer[i] + scale * g;
+      buffer[i] = b;
+      param[i] -= lr * (g + momentum * b);
+    }
+  } else {
+    for (std::size_t i = 0; i < n; ++i) {
+      double b = keep * buffer[i] + scale * (grad[i] + decay * param[i]);
+      buffer[i] = b;
+      param[i] -= lr * b;
+    }
+  }
+}
+
+static void adam(double* param, const double* grad, double* m, double* v,
+                 std::size_t n, const AdamStep& step) {
+  double beta1 = step.beta1;
+  double beta2 = step.beta2;
+  double step_size = step.lr / step.bias_correction1;
+  double inverse_sqrt_correction2 = 1.0 / EMBER_SQRT(step.bias_correction2);
+  double eps = step.eps;
+  // Coupled weight decay is added to the gradient, decoupled weight decay
+  // shrinks the parameter.
+  double coupled = step.decoupled ? 0.0 : step.weight_decay;
+  double shrink = step.decoupled ? 1.0 - step.lr * step.weight_decay : 1.0;
+  for (std::size_t i = 0; i < n; ++i) {
+    double g = grad[i] + coupled * param[i];
+    double m_i = beta1 * m[i] + (1.0 - beta1) * g;
+    double v_i = beta2 * v[i] + (1.0 - beta2) * (g * g);
+    m[i] = m_i;
+    v[i] = v_i;
+    double denominator = EMBER_SQRT(v_i) * inverse_sqrt_correction2 + eps;
+    param[i] = shrink * param[i] - step_size * (m_i / denominator);
+  }
+}
+
+// The fast-math kernels below are written without branches or library calls so
+// that they vectorize. Their accuracy is documented in dispatch.h.
+
+static inline double from_bits(std::uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static inline std::uint64_t to_bits(double value) {
+  std::uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+constexpr std::uint64_t kInfinityBits = 0x7ff0000000000000;
+constexpr std::uint64_t kNaNBits = 0x7ff8000000000000;
+constexpr double kLog2e = 0x1.71547652b82fep0;
+// ln(2) split in two, where kLn2Hi has enough trailing zero bits that
+// multiplying it by an exponent is exact.
+constexpr double kLn2Hi = 0x1.62e42fee00000p-1;
+constexpr double kLn2Lo = 0x1.a39ef35793c76p-33;
+// Adding this to a double of magnitude below 2^51 rounds it to an integer,
+// which is left in the low bits of the sum.
+constexpr double kRoundShift = 0x1.8p52;
+
+/**
+ * Returns e^r - 1 for |r| <= ln(2) / 2 from its Taylor series, which is
+ * truncated after r^13 where the remaining terms are below 0.01 ULP.
+ */
+static inline double expm1_poly(double r) {
+  double p = 1.0 / 6227020800.0;
+  p = p * r + 1.0 / 479001600.0;
+  p = p * r + 1.0 / 39916800.0;
+  p = p * r + 1.0 / 3628800.0;
+  p = p * r + 1.0 / 362880.0;
+  p = p * r + 1.0 / 40320.0;
+  p = p * r + 1.0 / 5040.0;
+  p = p * r + 1.0 / 720.0;
+  p = p * r + 1.0 / 120.0;
+  p = p * r + 1.0 / 24.0;
+  p = p * r + 1.0 / 6.0;
+  p = p * r + 0.5;
+  return (p * r) * r + r;
+}
+
+/**
+ * Computes e^x as 2^n * e^r, where n is x / ln(2) rounded to an integer and
+ * r = x - n * ln(2).
+ */
+static inline double exp_one(double x) {
+  // Below -708 the result is subnormal and is flushed to zero. Clamping keeps
+  // n within [-1021, 1024], so that 2^(n - 1) is always a normal number.
+  double clamped = x < -708.0 ? -708.0 : (x > 709.79 ? 709.79 : x);
+  double shifted = clamped * kLog2e + kRoundShift;
+  double n = shifted - kRoundShift;
+  double r = (clamped - n * kLn2Hi) - n * kLn2Lo;
+  double half_scale = from_bits((to_bits(shifted) + 1022) << 52);
+  double result = ((1.0 + expm1_poly(r)) * half_scale) * 2.0;
+  result = x > 709.79 ? from_bits(kInfinityBits) : result;
+  result = x < -708.0 ? 0.0 : result;
+  return x != x ? x : result;
+}
+
+static void fast_exp(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = exp_one(x[i]);
+  }
+}
+
+/**
+ * Computes log(x) as e * ln(2) + log(m), where x = m * 2^e with m in
+ * [sqrt(1/2), sqrt(2)), and log(m) = 2 * atanh(s) with s = (m - 1) / (m + 1)
+ * is summed from the Taylor series of atanh up to s^23.
+ */
+static inline double log_one(double x) {
+  // Subnormals are scaled up by 2^54 so that their exponent field is usable.
+  bool subnormal = x < 0x1p-1022;
+  std::uint64_t bits = to_bits(subnormal ? x * 0x1p54 : x);
+  // The exponent field, converted to a double with the same trick as above.
+  double biased_exponent =
+      from_bits((bits >> 52) | 0x4330000000000000) - 0x1p52;
+  double m = from_bits((bits & 0x000fffffffffffff) | 0x3ff0000000000000);
+  bool above_sqrt2 = m > 0x1.6a09e667f3bcdp0;
+  m = above_sqrt2 ? m * 0.5 : m;
+  double e = biased_exponent - (subnormal ? 1077.0 : 1023.0) +
+             (above_sqrt2 ? 1.0 : 0.0);
+
+  double s = (m - 1.0) / (m + 1.0);
+  double s2 = s * s;
+  double p = 2.0 / 23.0;
+  p = p * s2 + 2.0 / 21.0;
+  p = p * s2 + 2.0 / 19.0;
+  p = p * s2 + 2.0 / 17.0;
+  p = p * s2 + 2.0 / 15.0;
+  p = p * s2 + 2.0 / 13.0;
+  p = p * s2 + 2.0 / 11.0;
+  p = p * s2 + 2.0 / 9.0;
+  p = p * s2 + 2.0 / 7.0;
+  p = p * s2 + 2.0 / 5.0;
+  p = p * s2 + 2.0 / 3.0;
+  double log_m = 2.0 * s + (p * s2) * s;
+  double result = e * kLn2Hi + (log_m + e * kLn2Lo);
+
+  result = x == 0.0 ? -from_bits(kInfinityBits) : result;
+  result = x == from_bits(kInfinityBits) ? x : result;
+  result = x < 0.0 ? from_bits(kNaNBits) : result;
+  return x != x ? x : result;
+}
+
+static void fast_log(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = log_one(x[i]);
+  }
+}
+
+/**
+ * Computes tanh(x) as e / (e + 2) with e = e^(2|x|) - 1, which stays accurate
+ * for small x where 1 - 2 / (e^(2x) + 1) would cancel.
+ */
+static inline double tanh_one(double x) {
+  // tanh(x) rounds to 1 well before |x| = 20.
+  double a = x < 0.0 ? -x : x;
+  a = a < 20.0 ? 2.0 * a : 40.0;
+  double shifted = a * kLog2e + kRoundShift;
+  double n = shifted - kRoundShift;
+  double r = (a - n * kLn2Hi) - n * kLn2Lo;
+  double scale = from_bits((to_bits(shifted) + 1023) << 52);
+  double e = scale * expm1_poly(r) + (scale - 1.0);
+  double result = e / (e + 2.0);
+  result = x < 0.0 ? -result : result;
+  return x != x ? x : result;
+}
+
+static void fast_tanh(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = tanh_one(x[i]);
+  }
+}
+
+static void fast_sigmoid(const double* x, double* out, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = 1.0 / (1.0 + exp_one(-x[i]));
+  }
+}
+
+KernelTable make_table() {
+  KernelTable table;
+  table.name = EMBER_STRINGIFY(EMBER_KERNEL_ISA);
+  table.add = add;
+  table.sub = sub;
+  table.mul = mul;
+  table.div = div;
+  table.axpy = axpy;
+  table.sum = sum;
+  table.moments = moments;
+  table.max_update = arg_update<true>;
+  table.min_update = arg_update<false>;
+  table.argmax = arg_reduce<true>;
+  table.argmin = arg_reduce<false>;
+  table.sqrt = sqrt;
+  table.rsqrt = rsqrt;
+  table.relu = relu;
+  table.sgd = sgd;
+  table.adam = adam;
+  table.fast_exp = fast_exp;
+  table.fast_log = fast_log;
+  table.fast_tanh = fast_tanh;
+  table.fast_sigmoid = fast_sigmoid;
+  return table;
+}
+
+}  // namespace ember::kernels::EMBER_KERNEL_ISA
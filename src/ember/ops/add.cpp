@@ -18,7 +18,8 @@ std::size_t ADDEND_INDEX = 1;
 static Tensor add_forward(autograd::Context& context, const Tensor& augend,
                           const Tensor& addend) {
   context.save_for_backward(augend, addend);
-  return Tensor::from_xarray(xt::eval(augend.data_ + addend.data_));
+  return Tensor::from_xarray(
+      apply_binary_kernel(kernels::active().add, augend.data_, addend.data_));
 }
 
 /**
@@ -49,6 +50,12 @@ std::vector<Tensor> add_backward(autograd::Context& context,
           Tensor::from_xarray(addend_gradient)};
 }
 
-REGISTER_BINARY_OP(add, add_forward, add_backward);
+// The tangent of a + b is ta + tb.
+static Tensor add_tangent(const Tensor& augend, const Tensor& addend,
+                          const Tensor& /*output*/) {
+  return tangent_of(augend) + tangent_of(addend);
+}
+
+REGISTER_BINARY_OP(add, add_forward, add_backward, add_tangent);
 
 }  // namespace ember
@@ -0,0 +1,34 @@
+#include <ember/ops/argmax.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace ember {
+
+static Tensor argmax_over_axes(const Tensor& input,
+                               const std::vector<std::size_t>& axes,
+                               bool keepdims) {
+  // argmax has no gradient or tangent, so rather than go through apply_op it
+  // only checks its input.
+  check_dense({input}, "argmax");
+  std::vector<std::size_t> indices;
+  extreme_over_axes(input.data_, axes, true, indices);
+  auto output = xt::xarray<double>::from_shape(
+      reduced_shape(input.data_.shape(), axes, keepdims));
+  std::copy(indices.begin(), indices.end(), output.begin());
+  return Tensor::from_xarray(std::move(output));
+}
+
+Tensor argmax(const Tensor& input, std::ptrdiff_t axis, bool keepdims) {
+  return argmax_over_axes(
+      input, normalize_axes({axis}, input.data_.dimension()), keepdims);
+}
+
+Tensor argmax(const Tensor& input) {
+  auto axes = all_axes(input.data_.dimension());
+  return argmax_over_axes(input, normalize_axes(axes, input.data_.dimension()),
+                          false);
+}
+
+}  // namespace ember
@@ -0,0 +1,94 @@
+#include <ember/ops/avg_pool2d.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <any>
+#include <vector>
+
+namespace ember {
+
+// Splits the planes (i.e. channels of each image) across threads.
+static std::size_t plane_grain_size(const Window2d& window) {
+  return std::max<std::size_t>(
+      1, parallel::kGrainSize /
+             std::max<std::size_t>(window.input_plane(), 1));
+}
+
+Tensor avg_pool2d_forward(
+    autograd::Context& ctx, const Tensor& input,
+    const std::array<std::size_t, 2>& kernel_size,
+    const std::optional<std::array<std::size_t, 2>>& stride,
+    const std::array<std::size_t, 2>& padding) {
+  const auto& x = input.data_;
+  Window2d window = make_pool_window(x, kernel_size, stride, padding);
+  std::size_t in_plane = window.input_plane();
+  std::size_t out_plane = window.output_plane();
+  std::size_t planes = x.shape()[0] * x.shape()[1];
+  double scale = 1.0 / static_cast<double>(kernel_size[0] * kernel_size[1]);
+
+  auto output = xt::xarray<double>::from_shape(
+      {x.shape()[0], x.shape()[1], window.output[0], window.output[1]});
+  parallel::parallel_for(
+      0, planes, plane_grain_size(window),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t plane = begin; plane < end; ++plane) {
+          const double* in = x.data() + plane * in_plane;
+          double* out = output.data() + plane * out_plane;
+          std::fill(out, out + out_plane, 0.0);
+          for_each_unfolded(window, 1, [&](std::size_t c, std::size_t i) {
+            out[c % out_plane] += in[i];
+          });
+          std::for_each(out, out + out_plane,
+                        [scale](double& v) { v *= scale; });
+        }
+      });
+
+  ctx.saved_data["window"] = window;
+  ctx.saved_data["input_shape"] = x.shape();
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> avg_pool2d_backward(autograd::Context& ctx,
+                                        const Tensor& output_grad) {
+  using shape_type = xt::xarray<double>::shape_type;
+  const auto& window = std::any_cast<const Window2d&>(ctx.saved_data["window"]);
+  auto input_shape = std::any_cast<shape_type>(ctx.saved_data["input_shape"]);
+  std::size_t in_plane = window.input_plane();
+  std::size_t out_plane = window.output_plane();
+  std::size_t planes = input_shape[0] * input_shape[1];
+  double scale = 1.0 / static_cast<double>(window.kernel[0] * window.kernel[1]);
+  const double* g = output_grad.data_.data();
+
+  xt::xarray<double> input_grad = xt::zeros<double>(input_shape);
+  parallel::parallel_for(
+      0, planes, plane_grain_size(window),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t plane = begin; plane < end; ++plane) {
+          const double* g_plane = g + plane * out_plane;
+          double* dx = input_grad.data() + plane * in_plane;
+          for_each_unfolded(window, 1, [&](std::size_t c, std::size_t i) {
+            dx[i] += g_plane[c % out_plane] * scale;
+          });
+        }
+      });
+  return {Tensor::from_xarray(std::move(input_grad))};
+}
+
+REGISTER_OP_BACKWARD(avg_pool2d, avg_pool2d_backward)
+
+Tensor avg_pool2d(const Tensor& input,
+                  const std::array<std::size_t, 2>& kernel_size,
+                  const std::optional<std::array<std::size_t, 2>>& stride,
+                  const std::array<std::size_t, 2>& padding) {
+  return apply_op<avg_pool2dBackward>(
+      "avg_pool2d", {input},
+      [&](autograd::Context& ctx) {
+        return avg_pool2d_forward(ctx, input, kernel_size, stride, padding);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return avg_pool2d(*input.tangent(), kernel_size, stride, padding);
+      });
+}
+
+}  // namespace ember
@@ -0,0 +1,249 @@
+#include <ember/ops/batch_norm.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <any>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+namespace {
+
+/**
+ * The input of a batch norm viewed as an array of shape (batch, channels,
+ * spatial), where each channel of each example is a contiguous run of
+ * `spatial` elements.
+ */
+struct ChannelLayout {
+  std::size_t batch;
+  std::size_t channels;
+  std::size_t spatial;
+
+  const double* run(const double* data, std::size_t n, std::size_t c) const {
+    return data + (n * channels + c) * spatial;
+  }
+  double* run(double* data, std::size_t n, std::size_t c) const {
+    return data + (n * channels + c) * spatial;
+  }
+};
+
+}  // namespace
+
+static ChannelLayout channel_layout(const xt::xarray<double>& x) {
+  ChannelLayout layout{x.shape()[0], x.shape()[1], 1};
+  for (std::size_t axis = 2; axis < x.dimension(); ++axis) {
+    layout.spatial *= x.shape()[axis];
+  }
+  return layout;
+}
+
+// Channels are processed independently, each by a single thread.
+static void for_each_channel(const ChannelLayout& layout,
+                             const std::function<void(std::size_t)>& fn) {
+  std::size_t per_channel = layout.batch * layout.spatial;
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(per_channel, 1));
+  parallel::parallel_for(0, layout.channels, grain_size,
+                         [&](std::size_t begin, std::size_t end) {
+                           for (std::size_t c = begin; c < end; ++c) {
+                             fn(c);
+                           }
+                         });
+}
+
+Tensor batch_norm_forward(autograd::Context& ctx, const Tensor& input,
+                          const Tensor& weight, const Tensor& bias,
+                          Tensor& running_mean, Tensor& running_var,
+                          bool training, double momentum, double eps) {
+  const auto& x = input.data_;
+  if (x.dimension() < 2) {
+    throw std::invalid_argument(
+        "batch_norm expects an input of shape (batch, channels, ...)");
+  }
+  ChannelLayout layout = channel_layout(x);
+  std::vector<const Tensor*> params = {&weight, &bias, &running_mean,
+                                       &running_var};
+  for (const Tensor* param : params) {
+    if (param->data_.dimension() != 1 ||
+        param->data_.size() != layout.channels) {
+      throw std::invalid_argument(
+          "The weight, bias and running statistics must have shape (" +
+          std::to_string(layout.channels) + ")");
+    }
+  }
+  std::size_t per_channel = layout.batch * layout.spatial;
+  if (training && per_channel < 2) {
+    throw std::invalid_argument(
+        "batch_norm needs more than one value per channel when training");
+  }
+
+  std::vector<double> mean(layout.channels);
+  std::vector<double> rstd(layout.channels);
+  auto output = xt::xarray<double>::from_shape(x.shape());
+  for_each_channel(layout, [&](std::size_t c) {
+    if (training) {
+      Moments moments;
+      for (std::size_t n = 0; n < layout.batch; ++n) {
+        moments = merge_moments(
+            moments, compute_moments(layout.run(x.data(), n, c),
+                                     layout.spatial));
+      }
+      mean[c] = moments.mean;
+      rstd[c] = 1.0 / std::sqrt(moments.m2 / moments.count + eps);
+      double unbiased_var = moments.m2 / (moments.count - 1.0);
+      // A checkpointed segment already updated them in the forward pass.
+      if (!autograd::is_recomputing()) {
+        double& running_mean_c = running_mean.data_(c);
+        double& running_var_c = running_var.data_(c);
+        running_mean_c += momentum * (mean[c] - running_mean_c);
+        running_var_c += momentum * (unbiased_var - running_var_c);
+      }
+    } else {
+      mean[c] = running_mean.data_(c);
+      rstd[c] = 1.0 / std::sqrt(running_var.data_(c) + eps);
+    }
+
+    // y = (x - mean) * rstd * w + b = x * scale + shift
+    double scale = rstd[c] * weight.data_(c);
+    double shift = bias.data_(c) - mean[c] * scale;
+    for (std::size_t n = 0; n < layout.batch; ++n) {
+      const double* in = layout.run(x.data(), n, c);
+      double* out = layout.run(output.data(), n, c);
+      for (std::size_t i = 0; i < layout.spatial; ++i) {
+        out[i] = in[i] * scale + shift;
+      }
+    }
+  });
+
+  ctx.save_for_backward(input, weight);
+  ctx.saved_data["mean"] = std::move(mean);
+  ctx.saved_data["rstd"] = std::move(rstd);
+  ctx.saved_data["training"] = training;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> batch_norm_backward(autograd::Context& ctx,
+                                        const Tensor& output_grad) {
+  const auto& x = ctx.saved_tensors[0].data_;
+  const auto& w = ctx.saved_tensors[1].data_;
+  const auto& mean =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["mean"]);
+  const auto& rstd =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["rstd"]);
+  bool training = std::any_cast<bool>(ctx.saved_data["training"]);
+  const auto& g = output_grad.data_;
+  ChannelLayout layout = channel_layout(x);
+  double count = static_cast<double>(layout.batch * layout.spatial);
+
+  auto input_grad = xt::xarray<double>::from_shape(x.shape());
+  auto weight_grad = xt::xarray<double>::from_shape({layout.channels});
+  auto bias_grad = xt::xarray<double>::from_shape({layout.channels});
+  for_each_channel(layout, [&](std::size_t c) {
+    // The first pass sums the bias and weight gradients, which the second
+    // needs for the input gradient when the batch statistics were used:
+    //   dx = w * rstd * (g - mean(g) - x_hat * mean(g x_hat))
+    double sum_g = 0.0;
+    double sum_g_x_hat = 0.0;
+    for (std::size_t n = 0; n < layout.batch; ++n) {
+      const double* in = layout.run(x.data(), n, c);
+      const double* g_run = layout.run(g.data(), n, c);
+      for (std::size_t i = 0; i < layout.spatial; ++i) {
+        sum_g += g_run[i];
+        sum_g_x_hat += g_run[i] * (in[i] - mean[c]) * rstd[c];
+      }
+    }
+    bias_grad(c) = sum_g;
+    weight_grad(c) = sum_g_x_hat;
+
+    double scale = w(c) * rstd[c];
+    double mean_g = training ? sum_g / count : 0.0;
+    double mean_g_x_hat = training ? sum_g_x_hat / count : 0.0;
+    for (std::size_t n = 0; n < layout.batch; ++n) {
+      const double* in = layout.run(x.data(), n, c);
+      const double* g_run = layout.run(g.data(), n, c);
+      double* dx = layout.run(input_grad.data(), n, c);
+      for (std::size_t i = 0; i < layout.spatial; ++i) {
+        double x_hat = (in[i] - mean[c]) * rstd[c];
+        dx[i] = scale * (g_run[i] - mean_g - x_hat * mean_g_x_hat);
+      }
+    }
+  });
+  return {Tensor::from_xarray(std::move(input_grad)),
+          Tensor::from_xarray(std::move(weight_grad)),
+          Tensor::from_xarray(std::move(bias_grad))};
+}
+
+REGISTER_OP_BACKWARD(batch_norm, batch_norm_backward)
+
+/**
+ * Computes the tangent of the output of `batch_norm` from the tangents of its
+ * inputs (zeros for those without one). The statistics only depend on the
+ * input when the batch statistics were used:
+ *   tx_hat = rstd * (tx - mean(tx) - x_hat * mean(x_hat tx))
+ *   ty = tx_hat w + x_hat tw + tb
+ */
+static Tensor batch_norm_tangent(autograd::Context& ctx, const Tensor& input,
+                                 const Tensor& weight, const Tensor& bias) {
+  const auto& x = input.data_;
+  const auto& w = weight.data_;
+  const auto& mean =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["mean"]);
+  const auto& rstd =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["rstd"]);
+  bool training = std::any_cast<bool>(ctx.saved_data["training"]);
+  xt::xarray<double> tx = tangent_of(input).data_;
+  xt::xarray<double> tw = tangent_of(weight).data_;
+  xt::xarray<double> tb = tangent_of(bias).data_;
+  ChannelLayout layout = channel_layout(x);
+  double count = static_cast<double>(layout.batch * layout.spatial);
+
+  auto tangent = xt::xarray<double>::from_shape(x.shape());
+  for_each_channel(layout, [&](std::size_t c) {
+    double sum_t = 0.0;
+    double sum_t_x_hat = 0.0;
+    if (training) {
+      for (std::size_t n = 0; n < layout.batch; ++n) {
+        const double* in = layout.run(x.data(), n, c);
+        const double* t_run = layout.run(tx.data(), n, c);
+        for (std::size_t i = 0; i < layout.spatial; ++i) {
+          sum_t += t_run[i];
+          sum_t_x_hat += t_run[i] * (in[i] - mean[c]) * rstd[c];
+        }
+      }
+    }
+    double mean_t = sum_t / count;
+    double mean_t_x_hat = sum_t_x_hat / count;
+    for (std::size_t n = 0; n < layout.batch; ++n) {
+      const double* in = layout.run(x.data(), n, c);
+      const double* t_run = layout.run(tx.data(), n, c);
+      double* out = layout.run(tangent.data(), n, c);
+      for (std::size_t i = 0; i < layout.spatial; ++i) {
+        double x_hat = (in[i] - mean[c]) * rstd[c];
+        double t_x_hat = rstd[c] * (t_run[i] - mean_t - x_hat * mean_t_x_hat);
+        out[i] = t_x_hat * w(c) + x_hat * tw(c) + tb(c);
+      }
+    }
+  });
+  return Tensor::from_xarray(std::move(tangent));
+}
+
+Tensor batch_norm(const Tensor& input, const Tensor& weight, const Tensor& bias,
+                  Tensor& running_mean, Tensor& running_var, bool training,
+                  double momentum, double eps) {
+  return apply_op<batch_normBackward>(
+      "batch_norm", {input, weight, bias},
+      [&](autograd::Context& ctx) {
+        return batch_norm_forward(ctx, input, weight, bias, running_mean,
+                                  running_var, training, momentum, eps);
+      },
+      [&](autograd::Context& ctx, const Tensor& /*output*/) {
+        return batch_norm_tangent(ctx, input, weight, bias);
+      },
+      {running_mean, running_var});
+}
+
+}  // namespace ember
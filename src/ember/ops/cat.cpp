@@ -0,0 +1,218 @@
+#include <ember/ops/cat.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <any>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+using Shape = std::vector<std::size_t>;
+
+// Returns the product of the dimensions of `shape` in [first, last).
+static std::size_t extent(const Shape& shape, std::size_t first,
+                          std::size_t last) {
+  std::size_t size = 1;
+  for (std::size_t d = first; d < last; ++d) {
+    size *= shape[d];
+  }
+  return size;
+}
+
+// Calls `fn(o, j)` for each input `j` and each index `o` of the axes before
+// the concatenated one, i.e. for each contiguous run of elements an input
+// occupies in the output. Large tensors are split across threads.
+template <typename Fn>
+static void for_each_run(std::size_t outer, std::size_t count,
+                         std::size_t run_size, Fn fn) {
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(run_size, 1));
+  parallel::parallel_for(
+      0, outer * count, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          fn(i / count, i % count);
+        }
+      });
+}
+
+/**
+ * Concatenates the inputs along `axis`, or stacks them along a new axis if
+ * `stacked` is true, which is the same as concatenating them along an axis of
+ * size 1 inserted at `axis`.
+ *
+ * The result is written into `destination` if it isn't null, which must
+ * already have the result's shape, and into a new array otherwise.
+ */
+static xt::xarray<double> cat_forward(autograd::Context& ctx,
+                                      const TensorRefs& inputs,
+                                      std::ptrdiff_t axis, bool stacked,
+                                      xt::xarray<double>* destination) {
+  if (inputs.empty()) {
+    throw std::invalid_argument(std::string(stacked ? "stack" : "cat") +
+                                " expects at least one tensor");
+  }
+  const auto& first = inputs[0].get().data_;
+  Shape shape(first.shape().begin(), first.shape().end());
+  std::size_t resolved =
+      normalize_axes({axis}, shape.size() + (stacked ? 1 : 0))[0];
+
+  std::size_t count = inputs.size();
+  std::vector<Shape> shapes;
+  std::vector<std::size_t> sizes;
+  std::vector<std::size_t> offsets;
+  std::vector<bool> needs_grad;
+  std::size_t total = 0;
+  for (const Tensor& input : inputs) {
+    Shape s(input.data_.shape().begin(), input.data_.shape().end());
+    bool matches = s.size() == shape.size();
+    for (std::size_t d = 0; matches && d < s.size(); ++d) {
+      matches = s[d] == shape[d] || (!stacked && d == resolved);
+    }
+    if (!matches) {
+      throw std::invalid_argument(
+          stacked ? "stack expects tensors of the same shape"
+                  : "cat expects tensors of the same shape except along the "
+                    "concatenated axis");
+    }
+    std::size_t size = stacked ? 1 : s[resolved];
+    offsets.push_back(total);
+    sizes.push_back(size);
+    total += size;
+    shapes.push_back(std::move(s));
+    needs_grad.push_back(input.requires_grad());
+  }
+
+  std::size_t outer = extent(shape, 0, resolved);
+  std::size_t inner =
+      extent(shape, resolved + (stacked ? 0 : 1), shape.size());
+  if (stacked) {
+    shape.insert(shape.begin() + resolved, total);
+  } else {
+    shape[resolved] = total;
+  }
+  xt::xarray<double> allocated;
+  if (destination == nullptr) {
+    allocated = xt::xarray<double>::from_shape(shape);
+    destination = &allocated;
+  } else if (!std::equal(shape.begin(), shape.end(),
+                         destination->shape().begin(),
+                         destination->shape().end())) {
+    throw std::invalid_argument(
+        "cat_into expects a destination of the concatenated shape");
+  }
+  xt::xarray<double>& output = *destination;
+  for_each_run(outer, count, total * inner / count,
+               [&](std::size_t o, std::size_t j) {
+                 std::size_t run = sizes[j] * inner;
+                 const double* in = inputs[j].get().data_.data() + o * run;
+                 std::copy(in, in + run,
+                           output.data() + (o * total + offsets[j]) * inner);
+               });
+
+  ctx.saved_data["shapes"] = std::move(shapes);
+  ctx.saved_data["sizes"] = std::move(sizes);
+  ctx.saved_data["offsets"] = std::move(offsets);
+  ctx.saved_data["needs_grad"] = std::move(needs_grad);
+  ctx.saved_data["outer"] = outer;
+  ctx.saved_data["inner"] = inner;
+  ctx.saved_data["total"] = total;
+  return allocated;
+}
+
+std::vector<Tensor> cat_backward(autograd::Context& ctx,
+                                 const Tensor& output_grad) {
+  const auto& shapes =
+      std::any_cast<const std::vector<Shape>&>(ctx.saved_data["shapes"]);
+  const auto& sizes =
+      std::any_cast<const std::vector<std::size_t>&>(ctx.saved_data["sizes"]);
+  const auto& offsets = std::any_cast<const std::vector<std::size_t>&>(
+      ctx.saved_data["offsets"]);
+  const auto& needs_grad =
+      std::any_cast<const std::vector<bool>&>(ctx.saved_data["needs_grad"]);
+  auto outer = std::any_cast<std::size_t>(ctx.saved_data["outer"]);
+  auto inner = std::any_cast<std::size_t>(ctx.saved_data["inner"]);
+  auto total = std::any_cast<std::size_t>(ctx.saved_data["total"]);
+
+  // Each input's gradient is its slice of the output's gradient, so only the
+  // inputs that require gradients get one.
+  std::size_t count = shapes.size();
+  std::vector<Tensor> grads(count);
+  for (std::size_t j = 0; j < count; ++j) {
+    if (needs_grad[j]) {
+      grads[j].data_ = xt::xarray<double>::from_shape(shapes[j]);
+    }
+  }
+  const double* g = output_grad.data_.data();
+  for_each_run(outer, count, total * inner / count,
+               [&](std::size_t o, std::size_t j) {
+                 if (!needs_grad[j]) {
+                   return;
+                 }
+                 std::size_t run = sizes[j] * inner;
+                 const double* slice = g + (o * total + offsets[j]) * inner;
+                 std::copy(slice, slice + run,
+                           grads[j].data_.data() + o * run);
+               });
+  return grads;
+}
+
+REGISTER_OP_BACKWARD(cat, cat_backward)
+
+// Returns the tangent of the concatenation of `inputs`, i.e. the
+// concatenation of their tangents.
+static Tensor cat_tangent(const TensorRefs& inputs, std::ptrdiff_t axis,
+                          bool stacked) {
+  std::vector<Tensor> tangents;
+  for (const Tensor& input : inputs) {
+    tangents.push_back(tangent_of(input));
+  }
+  autograd::Context unused;
+  return Tensor::from_xarray(
+      cat_forward(unused, TensorRefs(tangents.begin(), tangents.end()), axis,
+                  stacked, nullptr));
+}
+
+static Tensor concatenate(const TensorRefs& inputs, std::ptrdiff_t axis,
+                          bool stacked) {
+  return apply_op<catBackward>(
+      stacked ? "stack" : "cat", inputs,
+      [&](autograd::Context& ctx) {
+        return Tensor::from_xarray(
+            cat_forward(ctx, inputs, axis, stacked, nullptr));
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return cat_tangent(inputs, axis, stacked);
+      });
+}
+
+Tensor cat(const TensorRefs& inputs, std::ptrdiff_t axis) {
+  return concatenate(inputs, axis, false);
+}
+
+Tensor& cat_into(Tensor& out, const TensorRefs& inputs, std::ptrdiff_t axis) {
+  if (std::any_of(inputs.begin(), inputs.end(),
+                  [&](const Tensor& input) { return &input == &out; })) {
+    throw std::invalid_argument(
+        "cat_into expects a destination that isn't one of its inputs");
+  }
+  // The concatenation is written to the destination's own buffer, and
+  // replaces the tangent and node of its old values.
+  apply_op_into<catBackward>(
+      out, "cat_into", inputs,
+      [&](autograd::Context& ctx) {
+        cat_forward(ctx, inputs, axis, false, &out.data_);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return cat_tangent(inputs, axis, false);
+      },
+      {out});
+  return out;
+}
+
+Tensor stack(const TensorRefs& inputs, std::ptrdiff_t axis) {
+  return concatenate(inputs, axis, true);
+}
+
+}  // namespace ember
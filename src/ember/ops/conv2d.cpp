@@ -0,0 +1,365 @@
+#include <ember/ops/conv2d.h>
+#include <ember/ops/utils.h>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmanipulation.hpp>
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+namespace {
+
+// The ways of computing a convolution, from the most to the least specialized.
+enum class ConvPath { Pointwise, Depthwise, Im2col };
+
+/**
+ * The shapes of a convolution, which is computed as `groups` independent
+ * convolutions of `group_in()` input channels to `group_out()` output channels.
+ */
+struct ConvGeometry {
+  std::size_t batch;
+  std::size_t in_channels;
+  std::size_t out_channels;
+  std::size_t groups;
+  Window2d window;
+
+  std::size_t group_in() const { return in_channels / groups; }
+  std::size_t group_out() const { return out_channels / groups; }
+
+  // The number of weights of each output channel, which is also the number of
+  // rows of the unfolded input of a group.
+  std::size_t patch() const {
+    return group_in() * window.kernel[0] * window.kernel[1];
+  }
+
+  ConvPath path() const {
+    if (window.kernel == std::array<std::size_t, 2>{1, 1} &&
+        window.stride == std::array<std::size_t, 2>{1, 1} &&
+        window.padding == std::array<std::size_t, 2>{0, 0}) {
+      return ConvPath::Pointwise;
+    }
+    return group_in() == 1 ? ConvPath::Depthwise : ConvPath::Im2col;
+  }
+};
+
+}  // namespace
+
+static ConvGeometry conv_geometry(const Tensor& input, const Tensor& weight,
+                                  const Tensor* bias,
+                                  const Conv2dOptions& options) {
+  const auto& x = input.data_;
+  const auto& w = weight.data_;
+  if (x.dimension() != 4 || w.dimension() != 4) {
+    throw std::invalid_argument(
+        "conv2d expects an input of shape (batch, channels, height, width) "
+        "and a 4-dimensional weight");
+  }
+  std::size_t groups = options.groups;
+  std::size_t in_channels = x.shape()[1];
+  std::size_t out_channels = w.shape()[0];
+  if (groups == 0 || in_channels % groups != 0 || out_channels % groups != 0) {
+    throw std::invalid_argument(
+        "The number of input and output channels must be divisible by the "
+        "number of groups");
+  }
+  if (w.shape()[1] * groups != in_channels) {
+    throw std::invalid_argument(
+        "The input has " + std::to_string(in_channels) +
+        " channels but the weight expects " +
+        std::to_string(w.shape()[1] * groups));
+  }
+  if (bias != nullptr && (bias->data_.dimension() != 1 ||
+                          bias->data_.shape()[0] != out_channels)) {
+    throw std::invalid_argument("The bias must have shape (" +
+                                std::to_string(out_channels) + ")");
+  }
+  Window2d window =
+      make_window_2d(x.shape()[2], x.shape()[3], {w.shape()[2], w.shape()[3]},
+                     options.stride, options.padding, options.dilation);
+  return {x.shape()[0], in_channels, out_channels, groups, window};
+}
+
+// Unfolds `channels` planes of the input at `in` into the matrix `col`.
+static void im2col(const double* in, double* col, const Window2d& w,
+                   std::size_t channels) {
+  std::size_t rows = channels * w.kernel[0] * w.kernel[1];
+  std::fill(col, col + rows * w.output_plane(), 0.0);
+  for_each_unfolded(w, channels,
+                    [&](std::size_t c, std::size_t i) { col[c] = in[i]; });
+}
+
+// Adds the unfolded matrix `col` back onto the input planes at `out`.
+static void col2im(const double* col, double* out, const Window2d& w,
+                   std::size_t channels) {
+  for_each_unfolded(w, channels,
+                    [&](std::size_t c, std::size_t i) { out[i] += col[c]; });
+}
+
+/**
+ * Convolves one input plane with each of the `multiplier` kernels at `w`,
+ * writing one output plane per kernel to `out`.
+ */
+static void depthwise_forward(const double* in, const double* w, double* out,
+                              const Window2d& window, std::size_t multiplier) {
+  std::size_t taps = window.kernel[0] * window.kernel[1];
+  std::size_t plane = window.output_plane();
+  std::fill(out, out + multiplier * plane, 0.0);
+  for (std::size_t m = 0; m < multiplier; ++m) {
+    for_each_unfolded(window, 1, [&](std::size_t c, std::size_t i) {
+      out[m * plane + c % plane] += w[m * taps + c / plane] * in[i];
+    });
+  }
+}
+
+/**
+ * Adds the gradients of a depthwise convolution of one input plane to
+ * `input_grad` (unless it is null) and `weight_grad`.
+ */
+static void depthwise_backward(const double* in, const double* w,
+                               const double* grad, double* input_grad,
+                               double* weight_grad, const Window2d& window,
+                               std::size_t multiplier) {
+  std::size_t taps = window.kernel[0] * window.kernel[1];
+  std::size_t plane = window.output_plane();
+  for (std::size_t m = 0; m < multiplier; ++m) {
+    for_each_unfolded(window, 1, [&](std::size_t c, std::size_t i) {
+      double g = grad[m * plane + c % plane];
+      weight_grad[m * taps + c / plane] += g * in[i];
+      if (input_grad != nullptr) {
+        input_grad[i] += g * w[m * taps + c / plane];
+      }
+    });
+  }
+}
+
+// Splits the images of the batch across threads.
+static std::size_t batch_grain_size(const ConvGeometry& geometry) {
+  std::size_t work = geometry.out_channels * geometry.window.output_plane() *
+                     geometry.patch();
+  return std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(work, 1));
+}
+
+Tensor conv2d_forward(autograd::Context& ctx, const Tensor& input,
+                      const Tensor& weight, const Tensor* bias,
+                      const Conv2dOptions& options) {
+  ConvGeometry geometry = conv_geometry(input, weight, bias, options);
+  const Window2d& window = geometry.window;
+  std::size_t in_plane = window.input_plane();
+  std::size_t out_plane = window.output_plane();
+  std::size_t group_in = geometry.group_in();
+  std::size_t group_out = geometry.group_out();
+  std::size_t patch = geometry.patch();
+  ConvPath path = geometry.path();
+  const double* x = input.data_.data();
+  const double* w = weight.data_.data();
+
+  auto output = xt::xarray<double>::from_shape(
+      {geometry.batch, geometry.out_channels, window.output[0],
+       window.output[1]});
+  parallel::parallel_for(
+      0, geometry.batch, batch_grain_size(geometry),
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<double> col(path == ConvPath::Im2col ? patch * out_plane
+                                                         : 0);
+        for (std::size_t n = begin; n < end; ++n) {
+          for (std::size_t group = 0; group < geometry.groups; ++group) {
+            const double* x_group =
+                x + (n * geometry.in_channels + group * group_in) * in_plane;
+            const double* w_group = w + group * group_out * patch;
+            double* out = output.data() +
+                          (n * geometry.out_channels + group * group_out) *
+                              out_plane;
+            if (path == ConvPath::Depthwise) {
+              depthwise_forward(x_group, w_group, out, window, group_out);
+              continue;
+            }
+            // A pointwise convolution's input is already its unfolded input.
+            const double* unfolded = x_group;
+            if (path == ConvPath::Im2col) {
+              im2col(x_group, col.data(), window, group_in);
+              unfolded = col.data();
+            }
+            xt::xarray<double> product =
+                xt::linalg::dot(matrix(w_group, group_out, patch),
+                                matrix(unfolded, patch, out_plane));
+            std::copy(product.begin(), product.end(), out);
+          }
+          if (bias != nullptr) {
+            for (std::size_t o = 0; o < geometry.out_channels; ++o) {
+              double* out = output.data() +
+                            (n * geometry.out_channels + o) * out_plane;
+              double b = bias->data_(o);
+              std::for_each(out, out + out_plane, [b](double& v) { v += b; });
+            }
+          }
+        }
+      });
+
+  ctx.save_for_backward(input, weight);
+  ctx.saved_data["geometry"] = geometry;
+  ctx.saved_data["has_bias"] = bias != nullptr;
+  ctx.saved_data["input_requires_grad"] = input.requires_grad();
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> conv2d_backward(autograd::Context& ctx,
+                                    const Tensor& output_grad) {
+  const auto& input = ctx.saved_tensors[0].data_;
+  const auto& weight = ctx.saved_tensors[1].data_;
+  const auto& geometry =
+      std::any_cast<const ConvGeometry&>(ctx.saved_data["geometry"]);
+  bool input_requires_grad =
+      std::any_cast<bool>(ctx.saved_data["input_requires_grad"]);
+  const Window2d& window = geometry.window;
+  std::size_t in_plane = window.input_plane();
+  std::size_t out_plane = window.output_plane();
+  std::size_t group_in = geometry.group_in();
+  std::size_t group_out = geometry.group_out();
+  std::size_t patch = geometry.patch();
+  ConvPath path = geometry.path();
+  const double* x = input.data();
+  const double* w = weight.data();
+  const double* g = output_grad.data_.data();
+  const kernels::KernelTable& k = kernels::active();
+
+  // Each image's input gradient is written in the same pass that adds its
+  // contribution to the weight gradient, which is kept as one buffer of
+  // partial sums per chunk of images. The unfolded input is recomputed rather
+  // than saved, as it is `patch` times larger than the input.
+  xt::xarray<double> input_grad;
+  if (input_requires_grad) {
+    input_grad = xt::zeros<double>(input.shape());
+  }
+  auto grad_images = [&](std::size_t begin, std::size_t end) {
+    std::vector<double> partial(weight.size(), 0.0);
+    std::vector<double> col(path == ConvPath::Im2col ? patch * out_plane : 0);
+    for (std::size_t n = begin; n < end; ++n) {
+      for (std::size_t group = 0; group < geometry.groups; ++group) {
+        std::size_t in_offset =
+            (n * geometry.in_channels + group * group_in) * in_plane;
+        const double* x_group = x + in_offset;
+        const double* w_group = w + group * group_out * patch;
+        const double* g_group =
+            g + (n * geometry.out_channels + group * group_out) * out_plane;
+        double* dx_group =
+            input_requires_grad ? input_grad.data() + in_offset : nullptr;
+        double* dw_group = partial.data() + group * group_out * patch;
+        if (path == ConvPath::Depthwise) {
+          depthwise_backward(x_group, w_group, g_group, dx_group, dw_group,
+                             window, group_out);
+          continue;
+        }
+        const double* unfolded = x_group;
+        if (path == ConvPath::Im2col) {
+          im2col(x_group, col.data(), window, group_in);
+          unfolded = col.data();
+        }
+        auto grad = matrix(g_group, group_out, out_plane);
+        xt::xarray<double> weight_grad = xt::linalg::dot(
+            grad, xt::transpose(matrix(unfolded, patch, out_plane)));
+        k.axpy(1.0, weight_grad.data(), dw_group, weight_grad.size());
+        if (dx_group == nullptr) {
+          continue;
+        }
+        xt::xarray<double> unfolded_grad = xt::linalg::dot(
+            xt::transpose(matrix(w_group, group_out, patch)), grad);
+        if (path == ConvPath::Pointwise) {
+          std::copy(unfolded_grad.begin(), unfolded_grad.end(), dx_group);
+        } else {
+          col2im(unfolded_grad.data(), dx_group, window, group_in);
+        }
+      }
+    }
+    return partial;
+  };
+  auto add_partials = [&](std::vector<double> a, std::vector<double> b) {
+    k.axpy(1.0, b.data(), a.data(), a.size());
+    return a;
+  };
+  std::vector<double> weight_grad = parallel::parallel_reduce(
+      0, geometry.batch, batch_grain_size(geometry),
+      std::vector<double>(weight.size(), 0.0), grad_images, add_partials);
+
+  std::vector<Tensor> grads;
+  if (input_requires_grad) {
+    grads.push_back(Tensor::from_xarray(std::move(input_grad)));
+  } else {
+    grads.emplace_back();
+  }
+  auto dw = xt::xarray<double>::from_shape(weight.shape());
+  std::copy(weight_grad.begin(), weight_grad.end(), dw.begin());
+  grads.push_back(Tensor::from_xarray(std::move(dw)));
+  if (std::any_cast<bool>(ctx.saved_data["has_bias"])) {
+    // The gradient is summed over the batch, then over each output plane.
+    std::size_t out_size = geometry.out_channels * out_plane;
+    std::vector<double> per_image_sum(out_size);
+    auto bias_grad = xt::xarray<double>::from_shape({geometry.out_channels});
+    sum_block(g, per_image_sum.data(), {1, geometry.batch, out_size});
+    sum_block(per_image_sum.data(), bias_grad.data(),
+              {geometry.out_channels, out_plane, 1});
+    grads.push_back(Tensor::from_xarray(std::move(bias_grad)));
+  }
+  return grads;
+}
+
+REGISTER_OP_BACKWARD(conv2d, conv2d_backward)
+
+/**
+ * Computes the tangent of the output of `conv2d`, which is linear in each of
+ * its inputs: conv(tx, w) + conv(x, tw) + tb over every position.
+ */
+static Tensor conv2d_tangent(const Tensor& input, const Tensor& weight,
+                             const Tensor* bias, const Conv2dOptions& options,
+                             const Tensor& output) {
+  TensorRefs inputs = {input, weight};
+  if (bias != nullptr) {
+    inputs.push_back(*bias);
+  }
+  return sum_tangent_terms(inputs, [&](std::size_t i, const Tensor& tangent) {
+    switch (i) {
+      case 0:
+        return conv2d(tangent, weight, options);
+      case 1:
+        return conv2d(input, tangent, options);
+      default: {
+        xt::xarray<double> channels = tangent.data_;
+        channels.reshape(std::vector<std::size_t>{channels.size(), 1, 1});
+        return Tensor::zeros_like(output) +
+               Tensor::from_xarray(std::move(channels));
+      }
+    }
+  });
+}
+
+Tensor conv2d(const Tensor& input, const Tensor& weight, const Tensor& bias,
+              const Conv2dOptions& options) {
+  return apply_op<conv2dBackward>(
+      "conv2d", {input, weight, bias},
+      [&](autograd::Context& ctx) {
+        return conv2d_forward(ctx, input, weight, &bias, options);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& output) {
+        return conv2d_tangent(input, weight, &bias, options, output);
+      });
+}
+
+Tensor conv2d(const Tensor& input, const Tensor& weight,
+              const Conv2dOptions& options) {
+  return apply_op<conv2dBackward>(
+      "conv2d", {input, weight},
+      [&](autograd::Context& ctx) {
+        return conv2d_forward(ctx, input, weight, nullptr, options);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& output) {
+        return conv2d_tangent(input, weight, nullptr, options, output);
+      });
+}
+
+}  // namespace ember
@@ -0,0 +1,100 @@
+#include <ember/ops/cross_entropy.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <any>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+Tensor cross_entropy_forward(autograd::Context& ctx, const Tensor& logits,
+                             const Tensor& targets) {
+  const auto& x = logits.data_;
+  const auto& t = targets.data_;
+  if (x.dimension() != 2 || t.dimension() != 1 || t.size() != x.shape()[0]) {
+    throw std::invalid_argument(
+        "cross_entropy expects logits of shape (batch, classes) and targets "
+        "of shape (batch)");
+  }
+  std::size_t batch = x.shape()[0];
+  std::size_t classes = x.shape()[1];
+  std::vector<std::size_t> classes_of(batch);
+  for (std::size_t n = 0; n < batch; ++n) {
+    double target = t(n);
+    if (!(target >= 0 && target < classes) || target != std::floor(target)) {
+      throw std::invalid_argument("Target " + std::to_string(target) +
+                                  " is not the index of one of the " +
+                                  std::to_string(classes) + " classes");
+    }
+    classes_of[n] = static_cast<std::size_t>(target);
+  }
+
+  auto log_probs = xt::xarray<double>::from_shape(x.shape());
+  softmax_block(x.data(), log_probs.data(), {batch, classes, 1}, true);
+  double loss = 0.0;
+  for (std::size_t n = 0; n < batch; ++n) {
+    loss -= log_probs(n, classes_of[n]);
+  }
+  loss /= static_cast<double>(batch);
+
+  // The log-probabilities are moved rather than snapshotted, since nothing
+  // else refers to them.
+  ctx.saved_data["log_probs"] = std::move(log_probs);
+  ctx.saved_data["classes"] = std::move(classes_of);
+  return Tensor::from_xarray(
+      xt::xarray<double>(xt::xarray<double>::shape_type{}, loss));
+}
+
+std::vector<Tensor> cross_entropy_backward(autograd::Context& ctx,
+                                           const Tensor& output_grad) {
+  const auto& log_probs =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["log_probs"]);
+  const auto& classes_of = std::any_cast<const std::vector<std::size_t>&>(
+      ctx.saved_data["classes"]);
+  std::size_t batch = log_probs.shape()[0];
+  std::size_t classes = log_probs.shape()[1];
+  double scale = output_grad.data_.data()[0] / static_cast<double>(batch);
+
+  // d/dx_{n} = (softmax(x_{n}) - onehot(t_{n})) / N, with the softmax
+  // recovered from the saved log-probabilities.
+  auto grad = xt::xarray<double>::from_shape(log_probs.shape());
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(classes, 1));
+  parallel::parallel_for(
+      0, batch, grain_size, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+          double* row = grad.data() + n * classes;
+          std::copy(log_probs.data() + n * classes,
+                    log_probs.data() + (n + 1) * classes, row);
+          exp_in_place(row, classes);
+          row[classes_of[n]] -= 1.0;
+          for (std::size_t c = 0; c < classes; ++c) {
+            row[c] *= scale;
+          }
+        }
+      });
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(cross_entropy, cross_entropy_backward)
+
+Tensor cross_entropy(const Tensor& logits, const Tensor& targets) {
+  return apply_op<cross_entropyBackward>(
+      "cross_entropy", {logits},
+      [&](autograd::Context& ctx) {
+        return cross_entropy_forward(ctx, logits, targets);
+      },
+      // The loss is a scalar, so its tangent is the dot product of its
+      // gradient with the tangent of the logits.
+      [&](autograd::Context& ctx, const Tensor& output) {
+        Tensor grad =
+            cross_entropy_backward(ctx, Tensor::ones_like(output))[0];
+        return sum(grad * *logits.tangent());
+      },
+      {targets});
+}
+
+}  // namespace ember
@@ -15,7 +15,8 @@ static Tensor div_forward(autograd::Context& context, const Tensor& dividend,
   }
   context.save_for_backward(dividend);
   context.save_for_backward(divisor);
-  return Tensor::from_xarray(xt::eval(dividend.data_ / divisor.data_));
+  return Tensor::from_xarray(apply_binary_kernel(
+      kernels::active().div, dividend.data_, divisor.data_));
 }
 
 /**
@@ -37,7 +38,8 @@ std::vector<Tensor> div_backward(autograd::Context& context,
   auto dividend = context.saved_tensors[DIVIDEND_INDEX];
   auto divisor = context.saved_tensors[DIVISOR_INDEX];
 
-  auto dividend_grad_raw = xt::eval(output_grad.data_ / divisor.data_);
+  auto dividend_grad_raw = apply_binary_kernel(
+      kernels::active().div, output_grad.data_, divisor.data_);
   auto divisor_grad_raw = xt::eval(
       output_grad.data_ * (-dividend.data_ / (divisor.data_ * divisor.data_)));
 
@@ -49,6 +51,18 @@ std::vector<Tensor> div_backward(autograd::Context& context,
           Tensor::from_xarray(divisor_grad)};
 }
 
-REGISTER_BINARY_OP(div, div_forward, div_backward);
+// The tangent of c = a / b is (ta - c * tb) / b.
+static Tensor div_tangent(const Tensor& dividend, const Tensor& divisor,
+                          const Tensor& output) {
+  return sum_tangent_terms(
+      {dividend, divisor}, [&](std::size_t i, const Tensor& tangent) {
+        if (i == DIVIDEND_INDEX) {
+          return tangent / divisor;
+        }
+        return Tensor(0.0) - output * tangent / divisor;
+      });
+}
+
+REGISTER_BINARY_OP(div, div_forward, div_backward, div_tangent);
 
 }  // namespace ember
@@ -0,0 +1,83 @@
+#include <ember/ops/dropout.h>
+#include <ember/ops/utils.h>
+#include <ember/random.h>
+
+#include <any>
+#include <cmath>
+#include <stdexcept>
+
+namespace ember {
+
+// Sets `out` to `in` scaled by `scale` where the values of the stream at
+// `position` are at least `threshold`, and to 0 elsewhere. Each thread
+// handles whole blocks of four values, so the mask doesn't depend on how the
+// elements are split across threads.
+static void apply_mask(const random::StreamPosition& position,
+                       std::uint64_t threshold, double scale,
+                       const double* in, double* out, std::size_t count) {
+  std::size_t blocks = (count + 3) / 4;
+  std::size_t grain = std::max<std::size_t>(1, parallel::kGrainSize / 4);
+  parallel::parallel_for(
+      0, blocks, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+          auto values = random::block(position, b);
+          std::size_t first = 4 * b;
+          std::size_t last = std::min(first + 4, count);
+          for (std::size_t i = first; i < last; ++i) {
+            out[i] = values[i - first] >= threshold ? in[i] * scale : 0.0;
+          }
+        }
+      });
+}
+
+// The smallest 32-bit value that is kept, so that a uniform value is below
+// it, and dropped, with probability p.
+static std::uint64_t keep_threshold(double p) {
+  return static_cast<std::uint64_t>(std::ceil(p * 4294967296.0));
+}
+
+Tensor dropout_forward(autograd::Context& ctx, const Tensor& input,
+                       double p) {
+  const auto& x = input.data_;
+  auto output = xt::xarray<double>::from_shape(x.shape());
+  auto position = random::reserve(x.size());
+  double scale = p < 1.0 ? 1.0 / (1.0 - p) : 0.0;
+  apply_mask(position, keep_threshold(p), scale, x.data(), output.data(),
+             x.size());
+  ctx.saved_data["position"] = position;
+  ctx.saved_data["p"] = p;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> dropout_backward(autograd::Context& ctx,
+                                     const Tensor& output_grad) {
+  auto position =
+      std::any_cast<random::StreamPosition>(ctx.saved_data["position"]);
+  double p = std::any_cast<double>(ctx.saved_data["p"]);
+  const auto& g = output_grad.data_;
+  auto grad = xt::xarray<double>::from_shape(g.shape());
+  double scale = p < 1.0 ? 1.0 / (1.0 - p) : 0.0;
+  apply_mask(position, keep_threshold(p), scale, g.data(), grad.data(),
+             g.size());
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(dropout, dropout_backward)
+
+Tensor dropout(const Tensor& input, double p, bool training) {
+  if (!(p >= 0.0 && p <= 1.0)) {
+    throw std::invalid_argument("The dropout probability must be in [0, 1]");
+  }
+  if (!training || p == 0.0) {
+    return input;
+  }
+  return apply_op<dropoutBackward>(
+      "dropout", {input},
+      [&](autograd::Context& ctx) { return dropout_forward(ctx, input, p); },
+      // The mask is diagonal, so the backward function also gives the tangent.
+      [&](autograd::Context& ctx, const Tensor& /*output*/) {
+        return dropout_backward(ctx, *input.tangent())[0];
+      });
+}
+
+}  // namespace ember
@@ -0,0 +1,682 @@
+#include <ember/ops/einsum.h>
+#include <ember/ops/utils.h>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ember {
+
+using Shape = std::vector<std::size_t>;
+// A set of labels, with a bit for each letter.
+using LabelSet = std::uint64_t;
+
+// The most operands whose contraction order is found by searching every
+// order. Beyond this the search takes too long, and the cheapest contraction
+// is picked greedily at each step instead.
+static constexpr std::size_t kMaxOptimalOperands = 10;
+
+// The most plans kept in the cache, which is cleared when it's full.
+static constexpr std::size_t kMaxCachedPlans = 1024;
+
+namespace {
+
+// The labels of the operands and of the output of an equation.
+struct Equation {
+  std::vector<std::string> inputs;
+  std::string output;
+};
+
+// A contraction of two intermediate results, lowered to a batched matrix
+// multiplication of a (batch, m, k) and a (batch, k, n) array.
+struct Step {
+  // The intermediate results contracted, which are the operands followed by
+  // the results of the steps.
+  std::size_t lhs;
+  std::size_t rhs;
+  // The permutations of the axes of each into (batch, m, k) and (batch, k, n)
+  // order, or empty if they're already in that order.
+  Shape lhs_perm;
+  Shape rhs_perm;
+  std::size_t batch;
+  std::size_t m;
+  std::size_t k;
+  std::size_t n;
+  // The shape of the result, i.e. its batch, lhs-only and rhs-only axes.
+  Shape shape;
+};
+
+// How to evaluate an equation for operands of particular shapes.
+struct Plan {
+  // The axes of each operand summed before any contraction, and the shape
+  // left after summing them.
+  std::vector<Shape> reduced_axes;
+  std::vector<Shape> reduced_shapes;
+  std::vector<Step> steps;
+  // The permutation of the axes of the last result into the output's order,
+  // or empty if they're already in it.
+  Shape output_perm;
+};
+
+}  // namespace
+
+// Returns the position of a label among the letters, or throws if it isn't
+// one.
+static std::size_t label_index(char label) {
+  if (label >= 'a' && label <= 'z') {
+    return static_cast<std::size_t>(label - 'a');
+  }
+  if (label >= 'A' && label <= 'Z') {
+    return static_cast<std::size_t>(26 + label - 'A');
+  }
+  throw std::invalid_argument(std::string("einsum labels must be letters, "
+                                          "but the equation has '") +
+                              label + "'");
+}
+
+static LabelSet label_bit(char label) {
+  return LabelSet{1} << label_index(label);
+}
+
+static LabelSet label_set(const std::string& labels) {
+  LabelSet set = 0;
+  for (char label : labels) {
+    set |= label_bit(label);
+  }
+  return set;
+}
+
+// Throws if a label appears more than once in `labels`.
+static void check_unique(const std::string& labels) {
+  LabelSet seen = 0;
+  for (char label : labels) {
+    if (seen & label_bit(label)) {
+      throw std::invalid_argument(
+          std::string("einsum doesn't support repeating a label within an "
+                      "operand or the output, but '") +
+          labels + "' repeats '" + label + "'");
+    }
+    seen |= label_bit(label);
+  }
+}
+
+static Equation parse_equation(const std::string& text,
+                               std::size_t num_operands) {
+  std::string equation;
+  std::copy_if(text.begin(), text.end(), std::back_inserter(equation),
+               [](char c) { return c != ' '; });
+  std::size_t arrow = equation.find("->");
+  std::string lhs = equation.substr(0, arrow);
+
+  Equation result;
+  std::size_t begin = 0;
+  while (true) {
+    std::size_t comma = lhs.find(',', begin);
+    result.inputs.push_back(lhs.substr(begin, comma - begin));
+    if (comma == std::string::npos) {
+      break;
+    }
+    begin = comma + 1;
+  }
+  if (result.inputs.size() != num_operands) {
+    throw std::invalid_argument(
+        "The einsum equation '" + text + "' has " +
+        std::to_string(result.inputs.size()) + " operands, but " +
+        std::to_string(num_operands) + " tensors were given");
+  }
+  std::array<std::size_t, 52> counts{};
+  for (const std::string& labels : result.inputs) {
+    check_unique(labels);
+    for (char label : labels) {
+      counts[label_index(label)] += 1;
+    }
+  }
+
+  if (arrow != std::string::npos) {
+    result.output = equation.substr(arrow + 2);
+    check_unique(result.output);
+    LabelSet inputs = 0;
+    for (const std::string& labels : result.inputs) {
+      inputs |= label_set(labels);
+    }
+    if ((label_set(result.output) & ~inputs) != 0) {
+      throw std::invalid_argument("The output of the einsum equation '" +
+                                  text + "' has a label no operand has");
+    }
+  } else {
+    for (std::size_t index = 0; index < 52; ++index) {
+      if (counts[index] == 1) {
+        result.output += static_cast<char>(
+            index < 26 ? 'a' + index : 'A' + (index - 26));
+      }
+    }
+    // Upper case letters come before lower case ones, as in NumPy.
+    std::sort(result.output.begin(), result.output.end());
+  }
+  return result;
+}
+
+// Returns the number of elements spanned by the labels in `set`.
+static double extent(LabelSet set, const std::array<std::size_t, 64>& sizes) {
+  double size = 1.0;
+  for (std::size_t index = 0; index < 64; ++index) {
+    if (set & (LabelSet{1} << index)) {
+      size *= static_cast<double>(sizes[index]);
+    }
+  }
+  return size;
+}
+
+// Returns the positions in `labels` of each label in `order`.
+static Shape positions(const std::string& labels, const std::string& order) {
+  Shape result;
+  for (char label : order) {
+    result.push_back(labels.find(label));
+  }
+  return result;
+}
+
+// Returns `perm`, or an empty permutation if it's the identity.
+static Shape unless_identity(Shape perm) {
+  for (std::size_t d = 0; d < perm.size(); ++d) {
+    if (perm[d] != d) {
+      return perm;
+    }
+  }
+  return {};
+}
+
+namespace {
+
+/**
+ * Plans the contraction of operands of the given shapes. `labels[i]` is the
+ * set of labels of operand i left after its reduction, and `kept(subset)`
+ * gives the labels that the result of contracting a subset of the operands
+ * keeps, i.e. those of its labels in the output or in other operands.
+ */
+class Planner {
+public:
+  Planner(const Equation& equation, const std::vector<Shape>& shapes)
+      : equation_(equation), sizes_{} {
+    std::size_t count = equation.inputs.size();
+    output_ = label_set(equation.output);
+    for (std::size_t i = 0; i < count; ++i) {
+      const std::string& labels = equation.inputs[i];
+      if (labels.size() != shapes[i].size()) {
+        throw std::invalid_argument(
+            "Operand " + std::to_string(i) + " of the einsum has " +
+            std::to_string(shapes[i].size()) + " dimensions, but the "
+            "equation labels " + std::to_string(labels.size()));
+      }
+      for (std::size_t d = 0; d < labels.size(); ++d) {
+        LabelSet bit = label_bit(labels[d]);
+        std::size_t index = label_index(labels[d]);
+        if ((seen_ & bit) && sizes_[index] != shapes[i][d]) {
+          throw std::invalid_argument(
+              std::string("The einsum operands have different sizes for "
+                          "the axes labelled '") +
+              labels[d] + "'");
+        }
+        seen_ |= bit;
+        sizes_[index] = shapes[i][d];
+      }
+    }
+  }
+
+  Plan plan() {
+    std::size_t count = equation_.inputs.size();
+    Plan plan;
+    // Labels that only one operand has and the output doesn't are summed
+    // out of that operand first.
+    for (std::size_t i = 0; i < count; ++i) {
+      LabelSet elsewhere = output_;
+      for (std::size_t j = 0; j < count; ++j) {
+        if (j != i) {
+          elsewhere |= label_set(equation_.inputs[j]);
+        }
+      }
+      const std::string& labels = equation_.inputs[i];
+      std::string reduced;
+      Shape axes;
+      Shape shape;
+      for (std::size_t d = 0; d < labels.size(); ++d) {
+        if (elsewhere & label_bit(labels[d])) {
+          reduced += labels[d];
+          shape.push_back(size_of(labels[d]));
+        } else {
+          axes.push_back(d);
+        }
+      }
+      plan.reduced_axes.push_back(std::move(axes));
+      plan.reduced_shapes.push_back(std::move(shape));
+      labels_.push_back(std::move(reduced));
+      subsets_.push_back(LabelSet{1} << i);
+    }
+
+    if (count >= 2 && count <= kMaxOptimalOperands) {
+      contract_optimally(plan);
+    } else if (count > kMaxOptimalOperands) {
+      contract_greedily(plan);
+    }
+    plan.output_perm =
+        unless_identity(positions(labels_.back(), equation_.output));
+    return plan;
+  }
+
+private:
+  std::size_t size_of(char label) const { return sizes_[label_index(label)]; }
+
+  // Returns the labels of the operands in `subset`, a set of operands.
+  LabelSet labels_of(std::uint64_t subset) const {
+    LabelSet set = 0;
+    for (std::size_t i = 0; i < equation_.inputs.size(); ++i) {
+      if (subset & (std::uint64_t{1} << i)) {
+        set |= label_set(labels_[i]);
+      }
+    }
+    return set;
+  }
+
+  LabelSet kept(std::uint64_t subset) const {
+    std::uint64_t all = (std::uint64_t{1} << equation_.inputs.size()) - 1;
+    return labels_of(subset) & (output_ | labels_of(all & ~subset));
+  }
+
+  // The number of multiplications of contracting two results.
+  double cost(std::uint64_t lhs, std::uint64_t rhs) const {
+    return extent(kept(lhs) | kept(rhs), sizes_);
+  }
+
+  // Searches every order of contractions, i.e. finds the cheapest way to
+  // contract each subset of the operands from the cheapest ways to contract
+  // each split of it into two.
+  void contract_optimally(Plan& plan) {
+    std::size_t count = equation_.inputs.size();
+    std::uint64_t all = (std::uint64_t{1} << count) - 1;
+    std::vector<double> best(all + 1, std::numeric_limits<double>::infinity());
+    std::vector<std::uint64_t> split(all + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+      best[std::uint64_t{1} << i] = 0.0;
+    }
+    for (std::uint64_t subset = 1; subset <= all; ++subset) {
+      if ((subset & (subset - 1)) == 0) {
+        continue;
+      }
+      // Each split is visited once by requiring the lowest operand to be on
+      // the left.
+      std::uint64_t lowest = subset & (~subset + 1);
+      for (std::uint64_t lhs = (subset - 1) & subset; lhs != 0;
+           lhs = (lhs - 1) & subset) {
+        if ((lhs & lowest) == 0) {
+          continue;
+        }
+        std::uint64_t rhs = subset & ~lhs;
+        double total = best[lhs] + best[rhs] + cost(lhs, rhs);
+        if (total < best[subset]) {
+          best[subset] = total;
+          split[subset] = lhs;
+        }
+      }
+    }
+    emit(plan, split, all);
+  }
+
+  // Adds the steps that contract `subset` as found by `contract_optimally`
+  // to the plan, and returns the result they leave it in.
+  std::size_t emit(Plan& plan, const std::vector<std::uint64_t>& split,
+                   std::uint64_t subset) {
+    if ((subset & (subset - 1)) == 0) {
+      std::size_t i = 0;
+      while ((std::uint64_t{1} << i) != subset) {
+        ++i;
+      }
+      return i;
+    }
+    std::size_t lhs = emit(plan, split, split[subset]);
+    std::size_t rhs = emit(plan, split, subset & ~split[subset]);
+    return add_step(plan, lhs, rhs);
+  }
+
+  // Contracts the pair of results that costs the fewest multiplications
+  // until one is left.
+  void contract_greedily(Plan& plan) {
+    std::vector<std::size_t> active(labels_.size());
+    std::iota(active.begin(), active.end(), 0);
+    while (active.size() > 1) {
+      std::size_t best_a = 0;
+      std::size_t best_b = 1;
+      double best = std::numeric_limits<double>::infinity();
+      for (std::size_t a = 0; a < active.size(); ++a) {
+        for (std::size_t b = a + 1; b < active.size(); ++b) {
+          double c = cost(subsets_[active[a]], subsets_[active[b]]);
+          if (c < best) {
+            best = c;
+            best_a = a;
+            best_b = b;
+          }
+        }
+      }
+      std::size_t result = add_step(plan, active[best_a], active[best_b]);
+      active.erase(active.begin() + best_b);
+      active.erase(active.begin() + best_a);
+      active.push_back(result);
+    }
+  }
+
+  // Adds the contraction of two results to the plan and returns its result.
+  std::size_t add_step(Plan& plan, std::size_t lhs, std::size_t rhs) {
+    const std::string& a = labels_[lhs];
+    const std::string& b = labels_[rhs];
+    std::uint64_t subset = subsets_[lhs] | subsets_[rhs];
+    LabelSet keep = kept(subset);
+    LabelSet in_b = label_set(b);
+
+    std::string batch, lhs_only, rhs_only, contracted;
+    for (char label : a) {
+      if (!(in_b & label_bit(label))) {
+        lhs_only += label;
+      } else if (keep & label_bit(label)) {
+        batch += label;
+      } else {
+        contracted += label;
+      }
+    }
+    LabelSet in_a = label_set(a);
+    for (char label : b) {
+      if (!(in_a & label_bit(label))) {
+        rhs_only += label;
+      }
+    }
+
+    Step step;
+    step.lhs = lhs;
+    step.rhs = rhs;
+    step.lhs_perm =
+        unless_identity(positions(a, batch + lhs_only + contracted));
+    step.rhs_perm =
+        unless_identity(positions(b, batch + contracted + rhs_only));
+    auto product = [this](const std::string& labels) {
+      std::size_t size = 1;
+      for (char label : labels) {
+        size *= size_of(label);
+      }
+      return size;
+    };
+    step.batch = product(batch);
+    step.m = product(lhs_only);
+    step.k = product(contracted);
+    step.n = product(rhs_only);
+    std::string result = batch + lhs_only + rhs_only;
+    for (char label : result) {
+      step.shape.push_back(size_of(label));
+    }
+    plan.steps.push_back(std::move(step));
+
+    labels_.push_back(std::move(result));
+    subsets_.push_back(subset);
+    return labels_.size() - 1;
+  }
+
+  const Equation& equation_;
+  std::array<std::size_t, 64> sizes_;
+  LabelSet seen_ = 0;
+  LabelSet output_ = 0;
+  // The labels, in order, and the operands of each result.
+  std::vector<std::string> labels_;
+  std::vector<std::uint64_t> subsets_;
+};
+
+}  // namespace
+
+// Returns the plan for the equation and shapes, from the cache if it's been
+// made before.
+static std::shared_ptr<const Plan> find_plan(const std::string& equation,
+                                             const std::vector<Shape>& shapes) {
+  static std::mutex mutex;
+  static std::unordered_map<std::string, std::shared_ptr<const Plan>> cache;
+
+  std::string key = equation;
+  for (const Shape& shape : shapes) {
+    key += '|';
+    for (std::size_t size : shape) {
+      key += std::to_string(size) + ',';
+    }
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+      return it->second;
+    }
+  }
+  Equation parsed = parse_equation(equation, shapes.size());
+  auto plan = std::make_shared<const Plan>(Planner(parsed, shapes).plan());
+  std::lock_guard<std::mutex> lock(mutex);
+  if (cache.size() >= kMaxCachedPlans) {
+    cache.clear();
+  }
+  cache.emplace(std::move(key), plan);
+  return plan;
+}
+
+// Returns `input` with its axes permuted, i.e. whose axis d is axis perm[d]
+// of the input.
+static xt::xarray<double> permute(const xt::xarray<double>& input,
+                                  const Shape& perm) {
+  std::size_t ndim = perm.size();
+  Shape strides(ndim, 1);
+  for (std::size_t d = ndim; d-- > 1;) {
+    strides[d - 1] = strides[d] * input.shape()[d];
+  }
+  Shape shape(ndim);
+  Shape steps(ndim);
+  for (std::size_t d = 0; d < ndim; ++d) {
+    shape[d] = input.shape()[perm[d]];
+    steps[d] = strides[perm[d]];
+  }
+  auto output = xt::xarray<double>::from_shape(shape);
+  std::size_t last = shape[ndim - 1];
+  if (output.size() == 0) {
+    return output;
+  }
+  // Each row of the output (along its last axis) reads a strided run of the
+  // input.
+  std::size_t rows = output.size() / last;
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(last, 1));
+  parallel::parallel_for(
+      0, rows, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+          std::size_t offset = 0;
+          std::size_t rest = r;
+          for (std::size_t d = ndim - 1; d-- > 0;) {
+            offset += (rest % shape[d]) * steps[d];
+            rest /= shape[d];
+          }
+          const double* in = input.data() + offset;
+          double* out = output.data() + r * last;
+          for (std::size_t j = 0; j < last; ++j) {
+            out[j] = in[j * steps[ndim - 1]];
+          }
+        }
+      });
+  return output;
+}
+
+// Returns the product of each (m, k) matrix at `a` and (k, n) matrix at `b`.
+static xt::xarray<double> batched_matmul(const double* a, const double* b,
+                                         const Step& step) {
+  auto output = xt::xarray<double>::from_shape(step.shape);
+  std::size_t m = step.m, k = step.k, n = step.n;
+  if (output.size() == 0) {
+    return output;
+  }
+  if (k == 0) {
+    std::fill(output.begin(), output.end(), 0.0);
+    return output;
+  }
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(m * k * n, 1));
+  parallel::parallel_for(
+      0, step.batch, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          xt::xarray<double> product = xt::linalg::dot(
+              matrix(a + i * m * k, m, k), matrix(b + i * k * n, k, n));
+          std::copy(product.begin(), product.end(),
+                    output.data() + i * m * n);
+        }
+      });
+  return output;
+}
+
+/**
+ * Evaluates an equation on arrays, without recording it in the graph. This is
+ * both the forward pass of `einsum` and, on the gradient of its output and
+ * the other operands, the gradient of each operand.
+ */
+static xt::xarray<double> contract(
+    const std::string& equation,
+    const std::vector<const xt::xarray<double>*>& operands) {
+  std::vector<Shape> shapes;
+  for (const auto* operand : operands) {
+    shapes.emplace_back(operand->shape().begin(), operand->shape().end());
+  }
+  std::shared_ptr<const Plan> plan = find_plan(equation, shapes);
+
+  // The operands followed by the result of each step. Results are freed once
+  // they've been contracted.
+  std::size_t count = operands.size();
+  std::vector<xt::xarray<double>> owned(count + plan->steps.size());
+  std::vector<const xt::xarray<double>*> results(owned.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    results[i] = operands[i];
+    if (!plan->reduced_axes[i].empty()) {
+      owned[i] = sum_over_axes(*operands[i], plan->reduced_axes[i]);
+      owned[i].reshape(plan->reduced_shapes[i]);
+      results[i] = &owned[i];
+    }
+  }
+  for (std::size_t s = 0; s < plan->steps.size(); ++s) {
+    const Step& step = plan->steps[s];
+    xt::xarray<double> lhs, rhs;
+    if (!step.lhs_perm.empty()) {
+      lhs = permute(*results[step.lhs], step.lhs_perm);
+    }
+    if (!step.rhs_perm.empty()) {
+      rhs = permute(*results[step.rhs], step.rhs_perm);
+    }
+    owned[count + s] = batched_matmul(
+        step.lhs_perm.empty() ? results[step.lhs]->data() : lhs.data(),
+        step.rhs_perm.empty() ? results[step.rhs]->data() : rhs.data(), step);
+    results[count + s] = &owned[count + s];
+    owned[step.lhs] = xt::xarray<double>();
+    owned[step.rhs] = xt::xarray<double>();
+  }
+
+  std::size_t last = owned.size() - 1;
+  if (!plan->output_perm.empty()) {
+    return permute(*results[last], plan->output_perm);
+  }
+  if (results[last] == &owned[last]) {
+    return std::move(owned[last]);
+  }
+  return *results[last];
+}
+
+Tensor einsum_forward(autograd::Context& ctx, const std::string& equation,
+                      const TensorRefs& operands) {
+  std::vector<const xt::xarray<double>*> arrays;
+  std::vector<bool> needs_grad;
+  for (const Tensor& operand : operands) {
+    arrays.push_back(&operand.data_);
+    needs_grad.push_back(operand.requires_grad());
+  }
+  xt::xarray<double> output = contract(equation, arrays);
+
+  for (const Tensor& operand : operands) {
+    ctx.saved_tensors.emplace_back(operand.save());
+  }
+  ctx.saved_data["equation"] =
+      parse_equation(equation, operands.size());
+  ctx.saved_data["needs_grad"] = std::move(needs_grad);
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> einsum_backward(autograd::Context& ctx,
+                                    const Tensor& output_grad) {
+  const auto& equation =
+      std::any_cast<const Equation&>(ctx.saved_data["equation"]);
+  const auto& needs_grad =
+      std::any_cast<const std::vector<bool>&>(ctx.saved_data["needs_grad"]);
+
+  // The gradient of each operand contracts the output's gradient with the
+  // other operands, over the labels the operand doesn't have. Its labels that
+  // nothing else has were summed, so the gradient is broadcast along them.
+  std::size_t count = equation.inputs.size();
+  std::vector<Tensor> grads(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!needs_grad[i]) {
+      continue;
+    }
+    std::string inputs = equation.output;
+    std::vector<const xt::xarray<double>*> arrays = {&output_grad.data_};
+    LabelSet elsewhere = label_set(equation.output);
+    for (std::size_t j = 0; j < count; ++j) {
+      if (j != i) {
+        inputs += "," + equation.inputs[j];
+        arrays.push_back(&ctx.saved_tensors[j].data_);
+        elsewhere |= label_set(equation.inputs[j]);
+      }
+    }
+    const auto& input = ctx.saved_tensors[i].data_;
+    std::string target;
+    auto kept_shape = input.shape();
+    for (std::size_t d = 0; d < equation.inputs[i].size(); ++d) {
+      if (elsewhere & label_bit(equation.inputs[i][d])) {
+        target += equation.inputs[i][d];
+      } else {
+        kept_shape[d] = 1;
+      }
+    }
+    xt::xarray<double> grad = contract(inputs + "->" + target, arrays);
+    if (target.size() != equation.inputs[i].size()) {
+      grad = broadcast_reduced(grad, kept_shape, input.shape());
+    }
+    grads[i].data_ = std::move(grad);
+  }
+  return grads;
+}
+
+REGISTER_OP_BACKWARD(einsum, einsum_backward)
+
+Tensor einsum(const std::string& equation, const TensorRefs& operands) {
+  return apply_op<einsumBackward>(
+      "einsum", operands,
+      [&](autograd::Context& ctx) {
+        return einsum_forward(ctx, equation, operands);
+      },
+      // The output is linear in each operand, so its tangent has a term for
+      // each operand with a tangent, with the operand replaced by its tangent.
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return sum_tangent_terms(
+            operands, [&](std::size_t i, const Tensor& tangent) {
+              TensorRefs replaced = operands;
+              replaced[i] = tangent;
+              return einsum(equation, replaced);
+            });
+      });
+}
+
+}  // namespace ember
@@ -0,0 +1,64 @@
+#include <ember/ops/embedding.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <any>
+#include <stdexcept>
+#include <vector>
+
+namespace ember {
+
+Tensor embedding_forward(autograd::Context& ctx, const Tensor& weight,
+                         const Tensor& indices) {
+  const auto& w = weight.data_;
+  if (w.dimension() == 0) {
+    throw std::invalid_argument(
+        "embedding expects a weight of shape (num_embeddings, ...)");
+  }
+  std::vector<std::size_t> rows = index_values(indices.data_, w.shape()[0]);
+  std::size_t row_size = w.size() / w.shape()[0];
+
+  std::vector<std::size_t> shape(indices.data_.shape().begin(),
+                                 indices.data_.shape().end());
+  shape.insert(shape.end(), w.shape().begin() + 1, w.shape().end());
+  auto output = xt::xarray<double>::from_shape(shape);
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(row_size, 1));
+  parallel::parallel_for(
+      0, rows.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          const double* row = w.data() + rows[i] * row_size;
+          std::copy(row, row + row_size, output.data() + i * row_size);
+        }
+      });
+
+  ctx.saved_data["rows"] = std::move(rows);
+  ctx.saved_data["weight_shape"] = w.shape();
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> embedding_backward(autograd::Context& ctx,
+                                       const Tensor& output_grad) {
+  const auto& shape = std::any_cast<const xt::xarray<double>::shape_type&>(
+      ctx.saved_data["weight_shape"]);
+  const auto& rows =
+      std::any_cast<const std::vector<std::size_t>&>(ctx.saved_data["rows"]);
+  return {Tensor::from_sparse_rows(
+      selected_rows_grad(shape, rows, output_grad.data_))};
+}
+
+REGISTER_OP_BACKWARD(embedding, embedding_backward)
+
+Tensor embedding(const Tensor& weight, const Tensor& indices) {
+  return apply_op<embeddingBackward>(
+      "embedding", {weight},
+      [&](autograd::Context& ctx) {
+        return embedding_forward(ctx, weight, indices);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return embedding(*weight.tangent(), indices);
+      },
+      {indices});
+}
+
+}  // namespace ember
@@ -5,14 +5,19 @@
 namespace ember {
 
 Tensor exp_forward(autograd::Context& ctx, const Tensor& exponent) {
-  auto output = Tensor::from_xarray(xt::exp(exponent.data_));
+  auto output = Tensor::from_xarray(
+      kernels::fast_math_enabled()
+          ? map_elementwise(exponent.data_, kernels::active().fast_exp)
+          : map_expression(exponent.data_,
+                           [](const auto& x) { return xt::exp(x); }));
   ctx.save_for_backward(output);
   return output;
 }
 
 std::vector<Tensor> exp_backward(autograd::Context& ctx,
                                  const Tensor& output_grad) {
-  return {Tensor::from_xarray(ctx.saved_tensors[0].data_ * output_grad.data_)};
+  return {Tensor::from_xarray(apply_binary_kernel(
+      kernels::active().mul, ctx.saved_tensors[0].data_, output_grad.data_))};
 }
 
 REGISTER_UNARY_OP(exp, exp_forward, exp_backward)
@@ -0,0 +1,85 @@
+#include <ember/ops/gather.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <any>
+#include <vector>
+
+namespace ember {
+
+Tensor gather_forward(autograd::Context& ctx, const Tensor& input,
+                      std::ptrdiff_t axis, const Tensor& index) {
+  const auto& x = input.data_;
+  std::size_t resolved = normalize_axes({axis}, x.dimension())[0];
+  std::vector<std::size_t> offsets =
+      gather_offsets(x.shape(), resolved, index.data_);
+
+  auto output = xt::xarray<double>::from_shape(index.data_.shape());
+  parallel::parallel_for(0, offsets.size(), parallel::kGrainSize,
+                         [&](std::size_t begin, std::size_t end) {
+                           for (std::size_t i = begin; i < end; ++i) {
+                             output.data()[i] = x.data()[offsets[i]];
+                           }
+                         });
+
+  ctx.saved_data["offsets"] = std::move(offsets);
+  ctx.saved_data["input_shape"] = x.shape();
+  ctx.saved_data["axis"] = resolved;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> gather_backward(autograd::Context& ctx,
+                                    const Tensor& output_grad) {
+  const auto& offsets =
+      std::any_cast<const std::vector<std::size_t>&>(ctx.saved_data["offsets"]);
+  const auto& shape = std::any_cast<const xt::xarray<double>::shape_type&>(
+      ctx.saved_data["input_shape"]);
+  const double* g = output_grad.data_.data();
+  if (std::any_cast<std::size_t>(ctx.saved_data["axis"]) != 0) {
+    xt::xarray<double> grad = xt::zeros<double>(shape);
+    for (std::size_t i = 0; i < offsets.size(); ++i) {
+      grad.data()[offsets[i]] += g[i];
+    }
+    return {Tensor::from_xarray(std::move(grad))};
+  }
+
+  // Gathering along the first axis reads from the rows named by the index,
+  // so only those rows of the gradient are stored.
+  SparseRows grad;
+  grad.shape.assign(shape.begin(), shape.end());
+  std::size_t row_size = grad.row_size();
+  for (std::size_t offset : offsets) {
+    grad.indices.push_back(offset / row_size);
+  }
+  std::sort(grad.indices.begin(), grad.indices.end());
+  grad.indices.erase(std::unique(grad.indices.begin(), grad.indices.end()),
+                     grad.indices.end());
+  std::vector<std::size_t> values_shape(grad.shape);
+  values_shape[0] = grad.indices.size();
+  grad.values = xt::zeros<double>(values_shape);
+  for (std::size_t i = 0; i < offsets.size(); ++i) {
+    std::size_t row = offsets[i] / row_size;
+    std::size_t slot =
+        std::lower_bound(grad.indices.begin(), grad.indices.end(), row) -
+        grad.indices.begin();
+    grad.values.data()[slot * row_size + offsets[i] % row_size] += g[i];
+  }
+  return {Tensor::from_sparse_rows(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(gather, gather_backward)
+
+Tensor gather(const Tensor& input, std::ptrdiff_t axis, const Tensor& index) {
+  return apply_op<gatherBackward>(
+      "gather", {input},
+      [&](autograd::Context& ctx) {
+        return gather_forward(ctx, input, axis, index);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return gather(*input.tangent(), axis, index);
+      },
+      {index});
+}
+
+}  // namespace ember
@@ -0,0 +1,35 @@
+#include <ember/ops/gelu.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xmath.hpp>
+
+#include <cmath>
+
+namespace ember {
+
+static constexpr double kSqrtHalf = 0.70710678118654752440;
+static constexpr double kInvSqrt2Pi = 0.39894228040143267794;
+
+Tensor gelu_forward(autograd::Context& ctx, const Tensor& input) {
+  ctx.save_for_backward(input);
+  return Tensor::from_xarray(
+      map_expression(input.data_, [](const auto& x) {
+        return 0.5 * x * (1.0 + xt::erf(x * kSqrtHalf));
+      }));
+}
+
+std::vector<Tensor> gelu_backward(autograd::Context& ctx,
+                                  const Tensor& output_grad) {
+  // d/dx x * Phi(x) = Phi(x) + x * phi(x), where phi is the standard normal
+  // density.
+  xt::xarray<double> derivative =
+      map_expression(ctx.saved_tensors[0].data_, [](const auto& x) {
+        return 0.5 * (1.0 + xt::erf(x * kSqrtHalf)) +
+               x * kInvSqrt2Pi * xt::exp(-0.5 * x * x);
+      });
+  return {Tensor::from_xarray(apply_binary_kernel(
+      kernels::active().mul, output_grad.data_, derivative))};
+}
+
+REGISTER_UNARY_OP(gelu, gelu_forward, gelu_backward)
+
+}  // namespace ember
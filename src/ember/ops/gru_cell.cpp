@@ -0,0 +1,251 @@
+#include <ember/ops/gru_cell.h>
+#include <ember/ops/utils.h>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xmanipulation.hpp>
+
+#include <algorithm>
+#include <any>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+static void check_gru_shapes(const Tensor& input, const Tensor& hidden,
+                             const Tensor& weight_ih, const Tensor& weight_hh,
+                             const Tensor& bias_ih, const Tensor& bias_hh) {
+  const auto& x = input.data_;
+  const auto& h = hidden.data_;
+  if (x.dimension() != 2 || h.dimension() != 2 ||
+      x.shape()[0] != h.shape()[0]) {
+    throw std::invalid_argument(
+        "gru_cell expects an input of shape (batch, input_size) and a hidden "
+        "state of shape (batch, hidden_size)");
+  }
+  std::size_t hidden_size = h.shape()[1];
+  std::size_t width = 3 * hidden_size;
+  if (weight_ih.data_.dimension() != 2 ||
+      weight_ih.data_.shape()[0] != x.shape()[1] ||
+      weight_ih.data_.shape()[1] != width) {
+    throw std::invalid_argument("The input weight must have shape (" +
+                                std::to_string(x.shape()[1]) + ", " +
+                                std::to_string(width) + ")");
+  }
+  if (weight_hh.data_.dimension() != 2 ||
+      weight_hh.data_.shape()[0] != hidden_size ||
+      weight_hh.data_.shape()[1] != width) {
+    throw std::invalid_argument("The hidden weight must have shape (" +
+                                std::to_string(hidden_size) + ", " +
+                                std::to_string(width) + ")");
+  }
+  for (const Tensor* bias : {&bias_ih, &bias_hh}) {
+    if (bias->data_.dimension() != 1 || bias->data_.size() != width) {
+      throw std::invalid_argument("The biases must have shape (" +
+                                  std::to_string(width) + ")");
+    }
+  }
+}
+
+Tensor gru_cell_forward(autograd::Context& ctx, const Tensor& input,
+                        const Tensor& hidden, const Tensor& weight_ih,
+                        const Tensor& weight_hh, const Tensor& bias_ih,
+                        const Tensor& bias_hh) {
+  check_gru_shapes(input, hidden, weight_ih, weight_hh, bias_ih, bias_hh);
+  std::size_t batch = hidden.data_.shape()[0];
+  std::size_t hidden_size = hidden.data_.shape()[1];
+  std::size_t width = 3 * hidden_size;
+  const kernels::KernelTable& k = kernels::active();
+
+  // The gates' pre-activations from the input are replaced by the gate
+  // activations, and only the new gate's part of the hidden state's
+  // pre-activations (which the reset gate scales) is kept.
+  xt::xarray<double> gates = xt::linalg::dot(input.data_, weight_ih.data_);
+  xt::xarray<double> recurrent = xt::linalg::dot(hidden.data_, weight_hh.data_);
+  auto candidate = xt::xarray<double>::from_shape({batch, hidden_size});
+  auto output = xt::xarray<double>::from_shape({batch, hidden_size});
+  std::size_t grain =
+      std::max<std::size_t>(1, parallel::kGrainSize / std::max<std::size_t>(
+                                                          width, 1));
+  parallel::parallel_for(0, batch, grain, [&](std::size_t begin,
+                                              std::size_t end) {
+    for (std::size_t n = begin; n < end; ++n) {
+      double* gate = gates.data() + n * width;
+      double* rec = recurrent.data() + n * width;
+      double* h_n = candidate.data() + n * hidden_size;
+      k.add(gate, bias_ih.data_.data(), gate, width);
+      k.add(rec, bias_hh.data_.data(), rec, width);
+      std::copy(rec + 2 * hidden_size, rec + width, h_n);
+      // The reset and update gates are adjacent, so they're activated as one
+      // contiguous run of the row.
+      k.add(gate, rec, gate, 2 * hidden_size);
+      sigmoid_in_place(gate, 2 * hidden_size);
+      const double* r = gate;
+      const double* z = gate + hidden_size;
+      double* new_gate = gate + 2 * hidden_size;
+      for (std::size_t j = 0; j < hidden_size; ++j) {
+        new_gate[j] += r[j] * h_n[j];
+      }
+      tanh_in_place(new_gate, hidden_size);
+      const double* h = hidden.data_.data() + n * hidden_size;
+      double* out = output.data() + n * hidden_size;
+      for (std::size_t j = 0; j < hidden_size; ++j) {
+        out[j] = new_gate[j] + z[j] * (h[j] - new_gate[j]);
+      }
+    }
+  });
+
+  ctx.save_for_backward(input, hidden, weight_ih, weight_hh);
+  ctx.saved_data["gates"] = std::move(gates);
+  ctx.saved_data["candidate"] = std::move(candidate);
+  ctx.saved_data["input_requires_grad"] = input.requires_grad();
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> gru_cell_backward(autograd::Context& ctx,
+                                      const Tensor& output_grad) {
+  const auto& input = ctx.saved_tensors[0].data_;
+  const auto& hidden = ctx.saved_tensors[1].data_;
+  const auto& weight_ih = ctx.saved_tensors[2].data_;
+  const auto& weight_hh = ctx.saved_tensors[3].data_;
+  const auto& gates =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["gates"]);
+  const auto& candidate =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["candidate"]);
+  std::size_t batch = hidden.shape()[0];
+  std::size_t hidden_size = hidden.shape()[1];
+  std::size_t width = 3 * hidden_size;
+  const double* g_out = output_grad.data_.data();
+
+  // The gradients of the pre-activations from the input and from the hidden
+  // state differ only in the new gate, which the reset gate scales for the
+  // latter. The hidden state's direct contribution to its own gradient is
+  // written first, and the matrix multiplication's is added below.
+  auto input_gate_grad = xt::xarray<double>::from_shape({batch, width});
+  auto hidden_gate_grad = xt::xarray<double>::from_shape({batch, width});
+  auto hidden_grad = xt::xarray<double>::from_shape({batch, hidden_size});
+  std::size_t grain =
+      std::max<std::size_t>(1, parallel::kGrainSize / std::max<std::size_t>(
+                                                          width, 1));
+  parallel::parallel_for(0, batch, grain, [&](std::size_t begin,
+                                              std::size_t end) {
+    for (std::size_t n = begin; n < end; ++n) {
+      const double* r = gates.data() + n * width;
+      const double* z = r + hidden_size;
+      const double* new_gate = r + 2 * hidden_size;
+      const double* h_n = candidate.data() + n * hidden_size;
+      const double* h = hidden.data() + n * hidden_size;
+      const double* dy = g_out + n * hidden_size;
+      double* dx_gate = input_gate_grad.data() + n * width;
+      double* dh_gate = hidden_gate_grad.data() + n * width;
+      double* dh = hidden_grad.data() + n * hidden_size;
+      for (std::size_t j = 0; j < hidden_size; ++j) {
+        double d_new = dy[j] * (1.0 - z[j]) * (1.0 - new_gate[j] * new_gate[j]);
+        double d_reset = d_new * h_n[j] * r[j] * (1.0 - r[j]);
+        double d_update = dy[j] * (h[j] - new_gate[j]) * z[j] * (1.0 - z[j]);
+        dx_gate[j] = dh_gate[j] = d_reset;
+        dx_gate[hidden_size + j] = dh_gate[hidden_size + j] = d_update;
+        dx_gate[2 * hidden_size + j] = d_new;
+        dh_gate[2 * hidden_size + j] = d_new * r[j];
+        dh[j] = dy[j] * z[j];
+      }
+    }
+  });
+
+  std::vector<Tensor> grads;
+  if (std::any_cast<bool>(ctx.saved_data["input_requires_grad"])) {
+    grads.push_back(Tensor::from_xarray(
+        xt::linalg::dot(input_gate_grad, xt::transpose(weight_ih))));
+  } else {
+    grads.emplace_back();
+  }
+  xt::xarray<double> hidden_product =
+      xt::linalg::dot(hidden_gate_grad, xt::transpose(weight_hh));
+  kernels::active().add(hidden_grad.data(), hidden_product.data(),
+                        hidden_grad.data(), hidden_grad.size());
+  grads.push_back(Tensor::from_xarray(std::move(hidden_grad)));
+  grads.push_back(Tensor::from_xarray(
+      xt::linalg::dot(xt::transpose(input), input_gate_grad)));
+  grads.push_back(Tensor::from_xarray(
+      xt::linalg::dot(xt::transpose(hidden), hidden_gate_grad)));
+  auto bias_ih_grad = xt::xarray<double>::from_shape({width});
+  auto bias_hh_grad = xt::xarray<double>::from_shape({width});
+  sum_block(input_gate_grad.data(), bias_ih_grad.data(), {1, batch, width});
+  sum_block(hidden_gate_grad.data(), bias_hh_grad.data(), {1, batch, width});
+  grads.push_back(Tensor::from_xarray(std::move(bias_ih_grad)));
+  grads.push_back(Tensor::from_xarray(std::move(bias_hh_grad)));
+  return grads;
+}
+
+REGISTER_OP_BACKWARD(gru_cell, gru_cell_backward)
+
+/**
+ * Computes the tangent of the new hidden state from the saved gate
+ * activations and the tangents of the inputs (zeros for those without one):
+ *   tr = r (1 - r) (tx_r + th_r), tz = z (1 - z) (tx_z + th_z),
+ *   tn = (1 - n^2) (tx_n + tr h_n + r th_n) and
+ *   th' = (1 - z) tn + tz (h - n) + z th
+ * where tx and th are the tangents of the gates' pre-activations from the
+ * input and the hidden state.
+ */
+static Tensor gru_cell_tangent(autograd::Context& ctx, const Tensor& input,
+                               const Tensor& hidden, const Tensor& weight_ih,
+                               const Tensor& weight_hh, const Tensor& bias_ih,
+                               const Tensor& bias_hh) {
+  std::size_t batch = hidden.data_.shape()[0];
+  std::size_t hidden_size = hidden.data_.shape()[1];
+  std::size_t width = 3 * hidden_size;
+  const auto& gates =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["gates"]);
+  const auto& candidate =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["candidate"]);
+  xt::xarray<double> tx = product_tangent(input, weight_ih);
+  xt::xarray<double> th = product_tangent(hidden, weight_hh);
+  xt::xarray<double> tb_ih = tangent_of(bias_ih).data_;
+  xt::xarray<double> tb_hh = tangent_of(bias_hh).data_;
+  xt::xarray<double> t_hidden = tangent_of(hidden).data_;
+
+  auto tangent = xt::xarray<double>::from_shape({batch, hidden_size});
+  for (std::size_t n = 0; n < batch; ++n) {
+    const double* gate = gates.data() + n * width;
+    const double* tx_n = tx.data() + n * width;
+    const double* th_n = th.data() + n * width;
+    const double* h = hidden.data_.data() + n * hidden_size;
+    const double* t_h = t_hidden.data() + n * hidden_size;
+    const double* h_n = candidate.data() + n * hidden_size;
+    double* out = tangent.data() + n * hidden_size;
+    for (std::size_t j = 0; j < hidden_size; ++j) {
+      std::size_t rj = j;
+      std::size_t zj = hidden_size + j;
+      std::size_t nj = 2 * hidden_size + j;
+      double r = gate[rj];
+      double z = gate[zj];
+      double new_gate = gate[nj];
+      double tr = r * (1.0 - r) *
+                  (tx_n[rj] + tb_ih(rj) + th_n[rj] + tb_hh(rj));
+      double tz = z * (1.0 - z) *
+                  (tx_n[zj] + tb_ih(zj) + th_n[zj] + tb_hh(zj));
+      double tn = (1.0 - new_gate * new_gate) *
+                  (tx_n[nj] + tb_ih(nj) + tr * h_n[j] +
+                   r * (th_n[nj] + tb_hh(nj)));
+      out[j] = (1.0 - z) * tn + tz * (h[j] - new_gate) + z * t_h[j];
+    }
+  }
+  return Tensor::from_xarray(std::move(tangent));
+}
+
+Tensor gru_cell(const Tensor& input, const Tensor& hidden,
+                const Tensor& weight_ih, const Tensor& weight_hh,
+                const Tensor& bias_ih, const Tensor& bias_hh) {
+  return apply_op<gru_cellBackward>(
+      "gru_cell", {input, hidden, weight_ih, weight_hh, bias_ih, bias_hh},
+      [&](autograd::Context& ctx) {
+        return gru_cell_forward(ctx, input, hidden, weight_ih, weight_hh,
+                                bias_ih, bias_hh);
+      },
+      [&](autograd::Context& ctx, const Tensor& /*output*/) {
+        return gru_cell_tangent(ctx, input, hidden, weight_ih, weight_hh,
+                                bias_ih, bias_hh);
+      });
+}
+
+}  // namespace ember
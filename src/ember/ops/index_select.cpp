@@ -0,0 +1,96 @@
+#include <ember/ops/index_select.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <any>
+#include <stdexcept>
+#include <vector>
+
+namespace ember {
+
+Tensor index_select_forward(autograd::Context& ctx, const Tensor& input,
+                            std::ptrdiff_t axis, const Tensor& index) {
+  const auto& x = input.data_;
+  std::size_t resolved = normalize_axes({axis}, x.dimension())[0];
+  if (index.data_.dimension() != 1) {
+    throw std::invalid_argument("index_select expects a 1-dimensional index");
+  }
+  std::vector<std::size_t> values =
+      index_values(index.data_, x.shape()[resolved]);
+  ReductionBlock block = make_reduction_block(x.shape(), resolved, resolved);
+  std::size_t count = values.size();
+
+  auto shape = x.shape();
+  shape[resolved] = count;
+  auto output = xt::xarray<double>::from_shape(shape);
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(block.inner, 1));
+  parallel::parallel_for(
+      0, block.outer * count, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          std::size_t o = i / count;
+          const double* slice =
+              x.data() + (o * block.size + values[i % count]) * block.inner;
+          std::copy(slice, slice + block.inner,
+                    output.data() + i * block.inner);
+        }
+      });
+
+  ctx.saved_data["values"] = std::move(values);
+  ctx.saved_data["input_shape"] = x.shape();
+  ctx.saved_data["block"] = block;
+  ctx.saved_data["axis"] = resolved;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> index_select_backward(autograd::Context& ctx,
+                                          const Tensor& output_grad) {
+  const auto& values =
+      std::any_cast<const std::vector<std::size_t>&>(ctx.saved_data["values"]);
+  const auto& shape = std::any_cast<const xt::xarray<double>::shape_type&>(
+      ctx.saved_data["input_shape"]);
+  auto block = std::any_cast<ReductionBlock>(ctx.saved_data["block"]);
+  // Selecting along the first axis selects whole rows.
+  if (std::any_cast<std::size_t>(ctx.saved_data["axis"]) == 0) {
+    return {Tensor::from_sparse_rows(
+        selected_rows_grad(shape, values, output_grad.data_))};
+  }
+
+  // Slices selected more than once are summed, so the outer blocks are split
+  // across threads but the slices within one are added sequentially.
+  std::size_t count = values.size();
+  const kernels::KernelTable& k = kernels::active();
+  xt::xarray<double> grad = xt::zeros<double>(shape);
+  const double* g = output_grad.data_.data();
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(count * block.inner, 1));
+  parallel::parallel_for(
+      0, block.outer, grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t o = begin; o < end; ++o) {
+          for (std::size_t i = 0; i < count; ++i) {
+            k.axpy(1.0, g + (o * count + i) * block.inner,
+                   grad.data() + (o * block.size + values[i]) * block.inner,
+                   block.inner);
+          }
+        }
+      });
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(index_select, index_select_backward)
+
+Tensor index_select(const Tensor& input, std::ptrdiff_t axis,
+                    const Tensor& index) {
+  return apply_op<index_selectBackward>(
+      "index_select", {input},
+      [&](autograd::Context& ctx) {
+        return index_select_forward(ctx, input, axis, index);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return index_select(*input.tangent(), axis, index);
+      },
+      {index});
+}
+
+}  // namespace ember
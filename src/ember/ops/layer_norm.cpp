@@ -0,0 +1,183 @@
+#include <ember/ops/layer_norm.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <any>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+Tensor layer_norm_forward(autograd::Context& ctx, const Tensor& input,
+                          const Tensor& weight, const Tensor& bias,
+                          double eps) {
+  const auto& x = input.data_;
+  if (x.dimension() == 0) {
+    throw std::invalid_argument("layer_norm expects at least one dimension");
+  }
+  std::size_t features = x.shape()[x.dimension() - 1];
+  for (const Tensor* param : {&weight, &bias}) {
+    if (param->data_.dimension() != 1 || param->data_.size() != features) {
+      throw std::invalid_argument("The weight and bias must have shape (" +
+                                  std::to_string(features) + ")");
+    }
+  }
+  std::size_t rows = features == 0 ? 0 : x.size() / features;
+  const double* w = weight.data_.data();
+  const double* b = bias.data_.data();
+
+  std::vector<double> mean(rows);
+  std::vector<double> rstd(rows);
+  auto output = xt::xarray<double>::from_shape(x.shape());
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(features, 1));
+  parallel::parallel_for(
+      0, rows, grain_size, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t row = begin; row < end; ++row) {
+          const double* in = x.data() + row * features;
+          double* out = output.data() + row * features;
+          Moments moments = compute_moments(in, features);
+          mean[row] = moments.mean;
+          rstd[row] = 1.0 / std::sqrt(moments.m2 / moments.count + eps);
+          for (std::size_t i = 0; i < features; ++i) {
+            out[i] = (in[i] - mean[row]) * rstd[row] * w[i] + b[i];
+          }
+        }
+      });
+
+  ctx.save_for_backward(input, weight);
+  ctx.saved_data["mean"] = std::move(mean);
+  ctx.saved_data["rstd"] = std::move(rstd);
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> layer_norm_backward(autograd::Context& ctx,
+                                        const Tensor& output_grad) {
+  const auto& x = ctx.saved_tensors[0].data_;
+  const double* w = ctx.saved_tensors[1].data_.data();
+  const auto& mean =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["mean"]);
+  const auto& rstd =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["rstd"]);
+  const double* g = output_grad.data_.data();
+  std::size_t features = x.shape()[x.dimension() - 1];
+  std::size_t rows = mean.size();
+  const kernels::KernelTable& k = kernels::active();
+
+  // Each row's input gradient is written in the same pass that accumulates
+  // its contribution to the weight and bias gradients, which are kept side by
+  // side in one buffer of partial sums per chunk of rows.
+  //   dx = rstd * (g w - mean(g w) - x_hat * mean(g w x_hat))
+  auto input_grad = xt::xarray<double>::from_shape(x.shape());
+  auto grad_rows = [&](std::size_t begin, std::size_t end) {
+    std::vector<double> partial(2 * features, 0.0);
+    std::vector<double> x_hat(features);
+    for (std::size_t row = begin; row < end; ++row) {
+      const double* in = x.data() + row * features;
+      const double* g_row = g + row * features;
+      double* dx = input_grad.data() + row * features;
+      double sum_dx_hat = 0.0;
+      double sum_dx_hat_x_hat = 0.0;
+      for (std::size_t i = 0; i < features; ++i) {
+        x_hat[i] = (in[i] - mean[row]) * rstd[row];
+        double dx_hat = g_row[i] * w[i];
+        sum_dx_hat += dx_hat;
+        sum_dx_hat_x_hat += dx_hat * x_hat[i];
+        partial[i] += g_row[i] * x_hat[i];
+      }
+      k.axpy(1.0, g_row, partial.data() + features, features);
+      double mean_dx_hat = sum_dx_hat / features;
+      double mean_dx_hat_x_hat = sum_dx_hat_x_hat / features;
+      for (std::size_t i = 0; i < features; ++i) {
+        dx[i] = rstd[row] * (g_row[i] * w[i] - mean_dx_hat -
+                             x_hat[i] * mean_dx_hat_x_hat);
+      }
+    }
+    return partial;
+  };
+  auto add_partials = [&](std::vector<double> a, std::vector<double> b) {
+    k.axpy(1.0, b.data(), a.data(), a.size());
+    return a;
+  };
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(features, 1));
+  std::vector<double> param_grads = parallel::parallel_reduce(
+      0, rows, grain_size, std::vector<double>(2 * features, 0.0), grad_rows,
+      add_partials);
+
+  auto weight_grad = xt::xarray<double>::from_shape({features});
+  auto bias_grad = xt::xarray<double>::from_shape({features});
+  std::copy(param_grads.begin(), param_grads.begin() + features,
+            weight_grad.begin());
+  std::copy(param_grads.begin() + features, param_grads.end(),
+            bias_grad.begin());
+  return {Tensor::from_xarray(std::move(input_grad)),
+          Tensor::from_xarray(std::move(weight_grad)),
+          Tensor::from_xarray(std::move(bias_grad))};
+}
+
+REGISTER_OP_BACKWARD(layer_norm, layer_norm_backward)
+
+/**
+ * Computes the tangent of the output of `layer_norm` from the tangents of its
+ * inputs (zeros for those without one):
+ *   tx_hat = rstd * (tx - mean(tx) - x_hat * mean(x_hat tx))
+ *   ty = tx_hat w + x_hat tw + tb
+ */
+static Tensor layer_norm_tangent(autograd::Context& ctx, const Tensor& input,
+                                 const Tensor& weight, const Tensor& bias) {
+  const auto& x = input.data_;
+  const double* w = weight.data_.data();
+  const auto& mean =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["mean"]);
+  const auto& rstd =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["rstd"]);
+  xt::xarray<double> tx = tangent_of(input).data_;
+  xt::xarray<double> tw = tangent_of(weight).data_;
+  xt::xarray<double> tb = tangent_of(bias).data_;
+  std::size_t features = x.shape()[x.dimension() - 1];
+
+  auto tangent = xt::xarray<double>::from_shape(x.shape());
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(features, 1));
+  parallel::parallel_for(
+      0, mean.size(), grain_size, [&](std::size_t begin, std::size_t end) {
+        std::vector<double> x_hat(features);
+        for (std::size_t row = begin; row < end; ++row) {
+          const double* in = x.data() + row * features;
+          const double* t_row = tx.data() + row * features;
+          double* out = tangent.data() + row * features;
+          double sum_t = 0.0;
+          double sum_t_x_hat = 0.0;
+          for (std::size_t i = 0; i < features; ++i) {
+            x_hat[i] = (in[i] - mean[row]) * rstd[row];
+            sum_t += t_row[i];
+            sum_t_x_hat += t_row[i] * x_hat[i];
+          }
+          double mean_t = sum_t / features;
+          double mean_t_x_hat = sum_t_x_hat / features;
+          for (std::size_t i = 0; i < features; ++i) {
+            double t_x_hat =
+                rstd[row] * (t_row[i] - mean_t - x_hat[i] * mean_t_x_hat);
+            out[i] = t_x_hat * w[i] + x_hat[i] * tw(i) + tb(i);
+          }
+        }
+      });
+  return Tensor::from_xarray(std::move(tangent));
+}
+
+Tensor layer_norm(const Tensor& input, const Tensor& weight, const Tensor& bias,
+                  double eps) {
+  return apply_op<layer_normBackward>(
+      "layer_norm", {input, weight, bias},
+      [&](autograd::Context& ctx) {
+        return layer_norm_forward(ctx, input, weight, bias, eps);
+      },
+      [&](autograd::Context& ctx, const Tensor& /*output*/) {
+        return layer_norm_tangent(ctx, input, weight, bias);
+      });
+}
+
+}  // namespace ember
@@ -0,0 +1,288 @@
+#include <ember/ops/linear.h>
+#include <ember/autograd/per_sample.h>
+#include <ember/ops/utils.h>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xmath.hpp>
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+static constexpr double kSqrtHalf = 0.70710678118654752440;
+static constexpr double kInvSqrt2Pi = 0.39894228040143267794;
+
+// Returns a view of the n doubles at `data` as a 1-dimensional expression.
+static auto view(double* data, std::size_t n) {
+  return xt::adapt(data, n, xt::no_ownership(), std::array<std::size_t, 1>{n});
+}
+
+static auto view(const double* data, std::size_t n) {
+  return view(const_cast<double*>(data), n);
+}
+
+/**
+ * Writes the activation of the n elements at `z` to `out`, which may be the
+ * same buffer.
+ */
+static void activate(Activation activation, const double* z, double* out,
+                     std::size_t n) {
+  const kernels::KernelTable& k = kernels::active();
+  bool fast = kernels::fast_math_enabled();
+  auto out_chunk = view(out, n);
+  auto z_chunk = view(z, n);
+  switch (activation) {
+    case Activation::None:
+      break;
+    case Activation::ReLU:
+      k.relu(z, out, n);
+      break;
+    case Activation::Sigmoid:
+      if (fast) {
+        k.fast_sigmoid(z, out, n);
+      } else {
+        out_chunk = 1.0 / (1.0 + xt::exp(-z_chunk));
+      }
+      break;
+    case Activation::Tanh:
+      if (fast) {
+        k.fast_tanh(z, out, n);
+      } else {
+        out_chunk = xt::tanh(z_chunk);
+      }
+      break;
+    case Activation::GELU:
+      out_chunk = 0.5 * z_chunk * (1.0 + xt::erf(z_chunk * kSqrtHalf));
+      break;
+  }
+}
+
+/**
+ * Writes the gradient of the n pre-activation values to `dz`, given the
+ * gradient `g` of the activation's output and `saved`, which holds the output
+ * for every activation except GELU, which needs its input.
+ */
+static void activation_grad(Activation activation, const double* g,
+                            const double* saved, double* dz, std::size_t n) {
+  auto g_chunk = view(g, n);
+  auto s = view(saved, n);
+  auto dz_chunk = view(dz, n);
+  switch (activation) {
+    case Activation::None:
+      std::copy(g, g + n, dz);
+      break;
+    case Activation::ReLU:
+      dz_chunk = xt::where(xt::greater(s, 0.0), g_chunk, 0.0);
+      break;
+    case Activation::Sigmoid:
+      dz_chunk = g_chunk * s * (1.0 - s);
+      break;
+    case Activation::Tanh:
+      dz_chunk = g_chunk * (1.0 - s * s);
+      break;
+    case Activation::GELU:
+      dz_chunk = g_chunk * (0.5 * (1.0 + xt::erf(s * kSqrtHalf)) +
+                            s * kInvSqrt2Pi * xt::exp(-0.5 * s * s));
+      break;
+  }
+}
+
+static void check_shapes(const Tensor& input, const Tensor& weight,
+                         const Tensor* bias) {
+  const auto& x = input.data_;
+  const auto& w = weight.data_;
+  if (x.dimension() != 2 || w.dimension() != 2) {
+    throw std::invalid_argument(
+        "linear expects a 2-dimensional input and weight");
+  }
+  if (x.shape()[1] != w.shape()[0]) {
+    throw std::invalid_argument(
+        "The input has " + std::to_string(x.shape()[1]) +
+        " features but the weight expects " + std::to_string(w.shape()[0]));
+  }
+  if (bias != nullptr && (bias->data_.dimension() != 1 ||
+                          bias->data_.shape()[0] != w.shape()[1])) {
+    throw std::invalid_argument("The bias must have shape (" +
+                                std::to_string(w.shape()[1]) + ")");
+  }
+}
+
+Tensor linear_forward(autograd::Context& ctx, const Tensor& input,
+                      const Tensor& weight, const Tensor* bias,
+                      Activation activation) {
+  check_shapes(input, weight, bias);
+  xt::xarray<double> z = xt::linalg::dot(input.data_, weight.data_);
+  std::size_t rows = z.shape()[0];
+  std::size_t cols = z.shape()[1];
+
+  // GELU's backward pass needs its input, so its output goes to a separate
+  // buffer. Every other activation is applied to `z` in place.
+  bool keep_z = activation == Activation::GELU;
+  xt::xarray<double> output =
+      keep_z ? xt::xarray<double>::from_shape(z.shape()) : xt::xarray<double>();
+  double* out = keep_z ? output.data() : z.data();
+
+  // The bias and activation are applied to each block of rows while it is
+  // still in cache.
+  const kernels::KernelTable& k = kernels::active();
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(cols, 1));
+  parallel::parallel_for(
+      0, rows, grain_size, [&](std::size_t begin, std::size_t end) {
+        double* z_rows = z.data() + begin * cols;
+        if (bias != nullptr) {
+          for (std::size_t row = 0; row < end - begin; ++row) {
+            k.add(z_rows + row * cols, bias->data_.data(),
+                  z_rows + row * cols, cols);
+          }
+        }
+        activate(activation, z_rows, out + begin * cols,
+                 (end - begin) * cols);
+      });
+
+  ctx.save_for_backward(input, weight);
+  ctx.saved_data["activation"] = activation;
+  ctx.saved_data["has_bias"] = bias != nullptr;
+  ctx.saved_data["input_requires_grad"] = input.requires_grad();
+  if (keep_z) {
+    ctx.saved_data["activation_input"] = std::move(z);
+    return Tensor::from_xarray(std::move(output));
+  }
+  Tensor result = Tensor::from_xarray(std::move(z));
+  if (activation != Activation::None) {
+    ctx.save_for_backward(result);
+  }
+  return result;
+}
+
+std::vector<Tensor> linear_backward(autograd::Context& ctx,
+                                    const Tensor& output_grad) {
+  const auto& x = ctx.saved_tensors[0].data_;
+  const auto& w = ctx.saved_tensors[1].data_;
+  auto activation = std::any_cast<Activation>(ctx.saved_data["activation"]);
+  const auto& g = output_grad.data_;
+  std::size_t rows = g.shape()[0];
+  std::size_t cols = g.shape()[1];
+
+  // The gradient of the pre-activation values is computed in a single pass,
+  // and shared by all three input gradients.
+  xt::xarray<double> dz;
+  if (activation == Activation::None) {
+    dz = g;
+  } else {
+    const double* saved =
+        activation == Activation::GELU
+            ? std::any_cast<const xt::xarray<double>&>(
+                  ctx.saved_data["activation_input"])
+                  .data()
+            : ctx.saved_tensors[2].data_.data();
+    dz = xt::xarray<double>::from_shape(g.shape());
+    parallel::parallel_for(
+        0, dz.size(), parallel::kGrainSize,
+        [&](std::size_t begin, std::size_t end) {
+          activation_grad(activation, g.data() + begin, saved + begin,
+                          dz.data() + begin, end - begin);
+        });
+  }
+
+  std::vector<Tensor> grads;
+  // The first layer of a network usually has an input that doesn't need a
+  // gradient, so its (often largest) product is skipped.
+  if (std::any_cast<bool>(ctx.saved_data["input_requires_grad"])) {
+    grads.push_back(
+        Tensor::from_xarray(xt::linalg::dot(dz, xt::transpose(w))));
+  } else {
+    grads.emplace_back();
+  }
+  // Per-sample gradients keep the outer product of each row apart, and the
+  // rows of the bias gradient are the gradients of each sample.
+  const autograd::PerSampleState* per_sample = autograd::current_per_sample();
+  if (per_sample != nullptr && per_sample->batch_size == rows) {
+    grads.push_back(Tensor::from_xarray(per_sample_outer(x, dz)));
+    if (std::any_cast<bool>(ctx.saved_data["has_bias"])) {
+      grads.push_back(Tensor::from_xarray(std::move(dz)));
+    }
+    return grads;
+  }
+  grads.push_back(Tensor::from_xarray(xt::linalg::dot(xt::transpose(x), dz)));
+  if (std::any_cast<bool>(ctx.saved_data["has_bias"])) {
+    auto bias_grad = xt::xarray<double>::from_shape({cols});
+    sum_block(dz.data(), bias_grad.data(), {1, rows, cols});
+    grads.push_back(Tensor::from_xarray(std::move(bias_grad)));
+  }
+  return grads;
+}
+
+REGISTER_OP_BACKWARD(linear, linear_backward)
+
+/**
+ * Computes the tangent of the output of `linear`: the tangent of the
+ * pre-activation values, tx w + x tw + tb, scaled by the derivative of the
+ * activation, which is diagonal.
+ */
+static Tensor linear_tangent(autograd::Context& ctx, const Tensor& input,
+                             const Tensor& weight, const Tensor* bias,
+                             const Tensor& output) {
+  TensorRefs inputs = {input, weight};
+  if (bias != nullptr) {
+    inputs.push_back(*bias);
+  }
+  Tensor dz =
+      sum_tangent_terms(inputs, [&](std::size_t i, const Tensor& tangent) {
+        switch (i) {
+          case 0:
+            return matmul(tangent, weight);
+          case 1:
+            return matmul(input, tangent);
+          default:
+            return tangent;
+        }
+      });
+  // Only the bias has a tangent, which is broadcast over the rows.
+  if (dz.data_.shape() != output.data_.shape()) {
+    dz = Tensor::zeros_like(output) + dz;
+  }
+  auto activation = std::any_cast<Activation>(ctx.saved_data["activation"]);
+  if (activation == Activation::None) {
+    return dz;
+  }
+  const double* saved = activation == Activation::GELU
+                            ? std::any_cast<const xt::xarray<double>&>(
+                                  ctx.saved_data["activation_input"])
+                                  .data()
+                            : output.data_.data();
+  auto tangent = xt::xarray<double>::from_shape(output.data_.shape());
+  activation_grad(activation, dz.data_.data(), saved, tangent.data(),
+                  tangent.size());
+  return Tensor::from_xarray(std::move(tangent));
+}
+
+Tensor linear(const Tensor& input, const Tensor& weight, const Tensor& bias,
+              Activation activation) {
+  return apply_op<linearBackward>(
+      "linear", {input, weight, bias},
+      [&](autograd::Context& ctx) {
+        return linear_forward(ctx, input, weight, &bias, activation);
+      },
+      [&](autograd::Context& ctx, const Tensor& output) {
+        return linear_tangent(ctx, input, weight, &bias, output);
+      });
+}
+
+Tensor linear(const Tensor& input, const Tensor& weight,
+              Activation activation) {
+  return apply_op<linearBackward>(
+      "linear", {input, weight},
+      [&](autograd::Context& ctx) {
+        return linear_forward(ctx, input, weight, nullptr, activation);
+      },
+      [&](autograd::Context& ctx, const Tensor& output) {
+        return linear_tangent(ctx, input, weight, nullptr, output);
+      });
+}
+
+}  // namespace ember
@@ -0,0 +1,25 @@
+#include <ember/ops/log.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xmath.hpp>
+
+namespace ember {
+
+Tensor log_forward(autograd::Context& ctx, const Tensor& input) {
+  ctx.save_for_backward(input);
+  return Tensor::from_xarray(
+      kernels::fast_math_enabled()
+          ? map_elementwise(input.data_, kernels::active().fast_log)
+          : map_expression(input.data_,
+                           [](const auto& x) { return xt::log(x); }));
+}
+
+std::vector<Tensor> log_backward(autograd::Context& ctx,
+                                 const Tensor& output_grad) {
+  // d/dx ln(x) = 1 / x
+  return {Tensor::from_xarray(apply_binary_kernel(
+      kernels::active().div, output_grad.data_, ctx.saved_tensors[0].data_))};
+}
+
+REGISTER_UNARY_OP(log, log_forward, log_backward)
+
+}  // namespace ember
@@ -0,0 +1,50 @@
+#include <ember/ops/log_softmax.h>
+#include <ember/ops/utils.h>
+
+#include <any>
+
+namespace ember {
+
+Tensor log_softmax_forward(autograd::Context& ctx, const Tensor& input,
+                           std::ptrdiff_t axis) {
+  const auto& x = input.data_;
+  std::size_t resolved = normalize_axes({axis}, x.dimension())[0];
+  ReductionBlock block = make_reduction_block(x.shape(), resolved, resolved);
+
+  auto output = xt::xarray<double>::from_shape(x.shape());
+  softmax_block(x.data(), output.data(), block, true);
+
+  // The backward pass recomputes the probabilities from the output, so the
+  // exponents aren't kept.
+  Tensor result = Tensor::from_xarray(std::move(output));
+  ctx.save_for_backward(result);
+  ctx.saved_data["block"] = block;
+  return result;
+}
+
+std::vector<Tensor> log_softmax_backward(autograd::Context& ctx,
+                                         const Tensor& output_grad) {
+  const auto& output = ctx.saved_tensors[0].data_;
+  auto grad = xt::xarray<double>::from_shape(output.shape());
+  softmax_grad_block(output.data(), output_grad.data_.data(), grad.data(),
+                     std::any_cast<ReductionBlock>(ctx.saved_data["block"]),
+                     true);
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(log_softmax, log_softmax_backward)
+
+Tensor log_softmax(const Tensor& input, std::ptrdiff_t axis) {
+  return apply_op<log_softmaxBackward>(
+      "log_softmax", {input},
+      [&](autograd::Context& ctx) {
+        return log_softmax_forward(ctx, input, axis);
+      },
+      // The tangent of log(s) is t - sum(s * t) over the axis.
+      [&](autograd::Context& /*ctx*/, const Tensor& output) {
+        const Tensor& tangent = *input.tangent();
+        return tangent - sum(exp(output) * tangent, {axis}, true);
+      });
+}
+
+}  // namespace ember
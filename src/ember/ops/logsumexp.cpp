@@ -0,0 +1,84 @@
+#include <ember/ops/logsumexp.h>
+#include <ember/ops/utils.h>
+
+#include <xtensor/xmath.hpp>
+
+#include <any>
+#include <cmath>
+
+namespace ember {
+
+static void exp_in_place(xt::xarray<double>& values) {
+  parallel::parallel_for(0, values.size(), parallel::kGrainSize,
+                         [&](std::size_t begin, std::size_t end) {
+                           exp_in_place(values.data() + begin, end - begin);
+                         });
+}
+
+Tensor logsumexp_forward(autograd::Context& ctx, const Tensor& input,
+                         const std::vector<std::ptrdiff_t>& axes,
+                         bool keepdims) {
+  auto reduced_axes = normalize_axes(axes, input.data_.dimension());
+  const kernels::KernelTable& k = kernels::active();
+
+  // Shift each block by its largest element so that the largest exponent is
+  // e^0. Blocks whose largest element is infinite or NaN aren't shifted, which
+  // lets the infinity or NaN through to the result.
+  xt::xarray<double> shift = reduce_over_axes(
+      input.data_, reduced_axes,
+      [](const double* in, double* out, const ReductionBlock& block) {
+        std::vector<std::size_t> unused(block.outer * block.inner);
+        extreme_block(in, out, unused.data(), block, true);
+      });
+  for (double& value : shift) {
+    value = std::isfinite(value) ? value : 0.0;
+  }
+  xt::xarray<double> exponents =
+      apply_binary_kernel(k.sub, input.data_, shift);
+  exp_in_place(exponents);
+
+  xt::xarray<double> output = sum_over_axes(exponents, reduced_axes);
+  output = xt::log(output) + shift;
+
+  Tensor kept_output = Tensor::from_xarray(output);
+  ctx.save_for_backward(input, kept_output);
+  output.reshape(reduced_shape(input.data_.shape(), reduced_axes, keepdims));
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> logsumexp_backward(autograd::Context& ctx,
+                                       const Tensor& output_grad) {
+  const kernels::KernelTable& k = kernels::active();
+  const xt::xarray<double>& input = ctx.saved_tensors[0].data_;
+  const xt::xarray<double>& kept_output = ctx.saved_tensors[1].data_;
+
+  // d/dx_i log(sum_j e^{x_j}) = e^{x_i - y}
+  xt::xarray<double> grad = apply_binary_kernel(k.sub, input, kept_output);
+  exp_in_place(grad);
+  xt::xarray<double> kept_grad = output_grad.data_;
+  kept_grad.reshape(kept_output.shape());
+  return {Tensor::from_xarray(apply_binary_kernel(k.mul, grad, kept_grad))};
+}
+
+REGISTER_OP_BACKWARD(logsumexp, logsumexp_backward)
+
+Tensor logsumexp(const Tensor& input, const std::vector<std::ptrdiff_t>& axes,
+                 bool keepdims) {
+  return apply_op<logsumexpBackward>(
+      "logsumexp", {input},
+      [&](autograd::Context& ctx) {
+        return logsumexp_forward(ctx, input, axes, keepdims);
+      },
+      // The gradient of each output is the softmax of its block, so the
+      // tangent is the sum of the input's tangent weighted by it.
+      [&](autograd::Context& ctx, const Tensor& output) {
+        Tensor weights = logsumexp_backward(ctx, Tensor::ones_like(output))[0];
+        return sum(weights * *input.tangent(), axes, keepdims);
+      });
+}
+
+Tensor logsumexp(const Tensor& input) {
+  return logsumexp(input, all_axes(input.data_.dimension()));
+}
+
+}  // namespace ember
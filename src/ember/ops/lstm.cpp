@@ -0,0 +1,426 @@
+#include <ember/ops/lstm.h>
+#include <ember/ops/utils.h>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmanipulation.hpp>
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+namespace {
+
+// The sizes of an LSTM run over a sequence. A single cell is one timestep.
+struct LstmShape {
+  std::size_t steps;
+  std::size_t batch;
+  std::size_t input_size;
+  std::size_t hidden_size;
+
+  // The number of pre-activations of each row, i.e. of all four gates.
+  std::size_t gates() const { return 4 * hidden_size; }
+  // The number of elements of a (batch, hidden_size) state.
+  std::size_t state() const { return batch * hidden_size; }
+};
+
+}  // namespace
+
+static LstmShape lstm_shape(const Tensor& input, const Tensor& hidden,
+                            const Tensor& cell, const Tensor& weight_ih,
+                            const Tensor& weight_hh, const Tensor& bias,
+                            bool sequence) {
+  const auto& x = input.data_;
+  if (sequence && (x.dimension() != 3 || x.shape()[0] == 0)) {
+    throw std::invalid_argument(
+        "lstm expects an input of shape (steps, batch, input_size) with at "
+        "least one step");
+  }
+  if (!sequence && x.dimension() != 2) {
+    throw std::invalid_argument(
+        "lstm_cell expects an input of shape (batch, input_size)");
+  }
+  LstmShape shape;
+  shape.steps = sequence ? x.shape()[0] : 1;
+  shape.batch = x.shape()[x.dimension() - 2];
+  shape.input_size = x.shape()[x.dimension() - 1];
+  if (weight_hh.data_.dimension() != 2 ||
+      weight_hh.data_.shape()[1] != 4 * weight_hh.data_.shape()[0]) {
+    throw std::invalid_argument(
+        "The hidden weight must have shape (hidden_size, 4 * hidden_size)");
+  }
+  shape.hidden_size = weight_hh.data_.shape()[0];
+  if (weight_ih.data_.dimension() != 2 ||
+      weight_ih.data_.shape()[0] != shape.input_size ||
+      weight_ih.data_.shape()[1] != shape.gates()) {
+    throw std::invalid_argument(
+        "The input weight must have shape (" +
+        std::to_string(shape.input_size) + ", " +
+        std::to_string(shape.gates()) + ")");
+  }
+  if (bias.data_.dimension() != 1 || bias.data_.size() != shape.gates()) {
+    throw std::invalid_argument("The bias must have shape (" +
+                                std::to_string(shape.gates()) + ")");
+  }
+  for (const Tensor* state : {&hidden, &cell}) {
+    const auto& s = state->data_;
+    if (s.dimension() != 2 || s.shape()[0] != shape.batch ||
+        s.shape()[1] != shape.hidden_size) {
+      throw std::invalid_argument(
+          "The hidden and cell states must have shape (" +
+          std::to_string(shape.batch) + ", " +
+          std::to_string(shape.hidden_size) + ")");
+    }
+  }
+  return shape;
+}
+
+/**
+ * Runs the LSTM and returns the hidden state of every timestep followed by
+ * the final cell state, as a single (steps + 1, batch, hidden_size) tensor
+ * which `lstm_unpack` splits into the tensors returned to the caller.
+ */
+Tensor lstm_forward(autograd::Context& ctx, const Tensor& input,
+                    const Tensor& hidden, const Tensor& cell,
+                    const Tensor& weight_ih, const Tensor& weight_hh,
+                    const Tensor& bias, bool sequence) {
+  LstmShape shape =
+      lstm_shape(input, hidden, cell, weight_ih, weight_hh, bias, sequence);
+  std::size_t steps = shape.steps;
+  std::size_t batch = shape.batch;
+  std::size_t hidden_size = shape.hidden_size;
+  std::size_t width = shape.gates();
+  std::size_t state = shape.state();
+  const double* b = bias.data_.data();
+  const kernels::KernelTable& k = kernels::active();
+
+  // The input's contribution to the gates doesn't depend on the recurrence,
+  // so it's computed for every timestep with one matrix multiplication.
+  xt::xarray<double> gates = xt::linalg::dot(
+      matrix(input.data_.data(), steps * batch, shape.input_size),
+      weight_ih.data_);
+  // The state entering each timestep, followed by the final state.
+  auto hiddens =
+      xt::xarray<double>::from_shape({steps + 1, batch, hidden_size});
+  auto cells = xt::xarray<double>::from_shape({steps + 1, batch, hidden_size});
+  std::copy(hidden.data_.begin(), hidden.data_.end(), hiddens.begin());
+  std::copy(cell.data_.begin(), cell.data_.end(), cells.begin());
+
+  std::size_t grain =
+      std::max<std::size_t>(1, parallel::kGrainSize / std::max<std::size_t>(
+                                                          width, 1));
+  for (std::size_t t = 0; t < steps; ++t) {
+    xt::xarray<double> recurrent = xt::linalg::dot(
+        matrix(hiddens.data() + t * state, batch, hidden_size),
+        weight_hh.data_);
+    parallel::parallel_for(0, batch, grain, [&](std::size_t begin,
+                                                std::size_t end) {
+      for (std::size_t n = begin; n < end; ++n) {
+        double* gate = gates.data() + (t * batch + n) * width;
+        k.add(gate, recurrent.data() + n * width, gate, width);
+        k.add(gate, b, gate, width);
+        // The input and forget gates are adjacent, so each nonlinearity is
+        // applied to one contiguous run of the row.
+        sigmoid_in_place(gate, 2 * hidden_size);
+        tanh_in_place(gate + 2 * hidden_size, hidden_size);
+        sigmoid_in_place(gate + 3 * hidden_size, hidden_size);
+        const double* i = gate;
+        const double* f = gate + hidden_size;
+        const double* g = gate + 2 * hidden_size;
+        const double* o = gate + 3 * hidden_size;
+        const double* c_prev = cells.data() + t * state + n * hidden_size;
+        double* c = cells.data() + (t + 1) * state + n * hidden_size;
+        double* h = hiddens.data() + (t + 1) * state + n * hidden_size;
+        for (std::size_t j = 0; j < hidden_size; ++j) {
+          c[j] = f[j] * c_prev[j] + i[j] * g[j];
+          h[j] = c[j];
+        }
+        tanh_in_place(h, hidden_size);
+        k.mul(h, o, h, hidden_size);
+      }
+    });
+  }
+
+  auto output =
+      xt::xarray<double>::from_shape({steps + 1, batch, hidden_size});
+  std::copy(hiddens.data() + state, hiddens.data() + (steps + 1) * state,
+            output.data());
+  std::copy(cells.data() + steps * state, cells.data() + (steps + 1) * state,
+            output.data() + steps * state);
+
+  ctx.save_for_backward(input, weight_ih, weight_hh);
+  ctx.saved_data["shape"] = shape;
+  ctx.saved_data["gates"] = std::move(gates);
+  ctx.saved_data["hiddens"] = std::move(hiddens);
+  ctx.saved_data["cells"] = std::move(cells);
+  ctx.saved_data["input_requires_grad"] = input.requires_grad();
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> lstm_backward(autograd::Context& ctx,
+                                  const Tensor& output_grad) {
+  const auto& input = ctx.saved_tensors[0].data_;
+  const auto& weight_ih = ctx.saved_tensors[1].data_;
+  const auto& weight_hh = ctx.saved_tensors[2].data_;
+  const auto& shape = std::any_cast<const LstmShape&>(ctx.saved_data["shape"]);
+  const auto& gates =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["gates"]);
+  const auto& hiddens =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["hiddens"]);
+  const auto& cells =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["cells"]);
+  std::size_t steps = shape.steps;
+  std::size_t batch = shape.batch;
+  std::size_t hidden_size = shape.hidden_size;
+  std::size_t width = shape.gates();
+  std::size_t state = shape.state();
+  std::size_t rows = steps * batch;
+  const double* g_out = output_grad.data_.data();
+  const kernels::KernelTable& k = kernels::active();
+
+  // The gradients of the gates' pre-activations at every timestep, and of the
+  // state leaving the current timestep, which are updated in place as the
+  // timesteps are walked in reverse.
+  auto gate_grad = xt::xarray<double>::from_shape({rows, width});
+  xt::xarray<double> hidden_grad = xt::zeros<double>({batch, hidden_size});
+  auto cell_grad = xt::xarray<double>::from_shape({batch, hidden_size});
+  std::copy(g_out + steps * state, g_out + (steps + 1) * state,
+            cell_grad.data());
+
+  std::size_t grain =
+      std::max<std::size_t>(1, parallel::kGrainSize / std::max<std::size_t>(
+                                                          width, 1));
+  for (std::size_t t = steps; t-- > 0;) {
+    k.add(hidden_grad.data(), g_out + t * state, hidden_grad.data(), state);
+    parallel::parallel_for(0, batch, grain, [&](std::size_t begin,
+                                                std::size_t end) {
+      for (std::size_t n = begin; n < end; ++n) {
+        const double* gate = gates.data() + (t * batch + n) * width;
+        const double* i = gate;
+        const double* f = gate + hidden_size;
+        const double* g = gate + 2 * hidden_size;
+        const double* o = gate + 3 * hidden_size;
+        const double* c_prev = cells.data() + t * state + n * hidden_size;
+        const double* c = cells.data() + (t + 1) * state + n * hidden_size;
+        const double* dh = hidden_grad.data() + n * hidden_size;
+        double* dc = cell_grad.data() + n * hidden_size;
+        double* d_gate = gate_grad.data() + (t * batch + n) * width;
+        // tanh(c) is recomputed in the output gate's slot, which each element
+        // reads before overwriting it with that gate's gradient.
+        double* d_o = d_gate + 3 * hidden_size;
+        std::copy(c, c + hidden_size, d_o);
+        tanh_in_place(d_o, hidden_size);
+        for (std::size_t j = 0; j < hidden_size; ++j) {
+          double tanh_c = d_o[j];
+          double dc_total = dc[j] + dh[j] * o[j] * (1.0 - tanh_c * tanh_c);
+          d_gate[j] = dc_total * g[j] * i[j] * (1.0 - i[j]);
+          d_gate[hidden_size + j] = dc_total * c_prev[j] * f[j] * (1.0 - f[j]);
+          d_gate[2 * hidden_size + j] = dc_total * i[j] * (1.0 - g[j] * g[j]);
+          d_o[j] = dh[j] * tanh_c * o[j] * (1.0 - o[j]);
+          dc[j] = dc_total * f[j];
+        }
+      }
+    });
+    hidden_grad = xt::linalg::dot(
+        matrix(gate_grad.data() + t * batch * width, batch, width),
+        xt::transpose(weight_hh));
+  }
+
+  // Every timestep shares the weights, so their gradients are each one
+  // matrix multiplication over the gradients of all the timesteps' gates.
+  auto d_gates = matrix(gate_grad.data(), rows, width);
+  std::vector<Tensor> grads;
+  if (std::any_cast<bool>(ctx.saved_data["input_requires_grad"])) {
+    xt::xarray<double> product =
+        xt::linalg::dot(d_gates, xt::transpose(weight_ih));
+    auto input_grad = xt::xarray<double>::from_shape(input.shape());
+    std::copy(product.begin(), product.end(), input_grad.begin());
+    grads.push_back(Tensor::from_xarray(std::move(input_grad)));
+  } else {
+    grads.emplace_back();
+  }
+  grads.push_back(Tensor::from_xarray(std::move(hidden_grad)));
+  grads.push_back(Tensor::from_xarray(std::move(cell_grad)));
+  grads.push_back(Tensor::from_xarray(xt::linalg::dot(
+      xt::transpose(matrix(input.data(), rows, shape.input_size)), d_gates)));
+  grads.push_back(Tensor::from_xarray(xt::linalg::dot(
+      xt::transpose(matrix(hiddens.data(), rows, hidden_size)), d_gates)));
+  auto bias_grad = xt::xarray<double>::from_shape({width});
+  sum_block(gate_grad.data(), bias_grad.data(), {1, rows, width});
+  grads.push_back(Tensor::from_xarray(std::move(bias_grad)));
+  return grads;
+}
+
+REGISTER_OP_BACKWARD(lstm, lstm_backward)
+
+/**
+ * Computes the tangent of the packed output of `lstm_forward` by running the
+ * recurrence forward on the tangents of the inputs (zeros for those without
+ * one), from the saved gate activations and states:
+ *   ti = i (1 - i) tpre_i, tf = f (1 - f) tpre_f, tg = (1 - g^2) tpre_g,
+ *   to = o (1 - o) tpre_o, tc = tf c_prev + f tc_prev + ti g + i tg and
+ *   th = to tanh(c) + o (1 - tanh(c)^2) tc
+ * where tpre is the tangent of the gates' pre-activations.
+ */
+static Tensor lstm_tangent(autograd::Context& ctx, const Tensor& input,
+                           const Tensor& hidden, const Tensor& cell,
+                           const Tensor& weight_ih, const Tensor& weight_hh,
+                           const Tensor& bias) {
+  auto shape = std::any_cast<LstmShape>(ctx.saved_data["shape"]);
+  const auto& gates =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["gates"]);
+  const auto& hiddens =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["hiddens"]);
+  const auto& cells =
+      std::any_cast<const xt::xarray<double>&>(ctx.saved_data["cells"]);
+  std::size_t steps = shape.steps;
+  std::size_t batch = shape.batch;
+  std::size_t hidden_size = shape.hidden_size;
+  std::size_t width = shape.gates();
+  std::size_t state = shape.state();
+
+  // The tangents of the input's contribution to the gates, of every timestep.
+  xt::xarray<double> t_gates = product_tangent(input, weight_ih);
+  xt::xarray<double> tb = tangent_of(bias).data_;
+  auto t_hiddens =
+      xt::xarray<double>::from_shape({steps + 1, batch, hidden_size});
+  auto t_cells =
+      xt::xarray<double>::from_shape({steps + 1, batch, hidden_size});
+  xt::xarray<double> t_hidden = tangent_of(hidden).data_;
+  xt::xarray<double> t_cell = tangent_of(cell).data_;
+  std::copy(t_hidden.begin(), t_hidden.end(), t_hiddens.begin());
+  std::copy(t_cell.begin(), t_cell.end(), t_cells.begin());
+
+  for (std::size_t t = 0; t < steps; ++t) {
+    xt::xarray<double> t_recurrent = xt::linalg::dot(
+        matrix(t_hiddens.data() + t * state, batch, hidden_size),
+        weight_hh.data_);
+    if (const Tensor* tw = weight_hh.tangent()) {
+      t_recurrent += xt::linalg::dot(
+          matrix(hiddens.data() + t * state, batch, hidden_size), tw->data_);
+    }
+    for (std::size_t n = 0; n < batch; ++n) {
+      const double* gate = gates.data() + (t * batch + n) * width;
+      const double* t_in = t_gates.data() + (t * batch + n) * width;
+      const double* t_rec = t_recurrent.data() + n * width;
+      std::size_t row = n * hidden_size;
+      const double* c_prev = cells.data() + t * state + row;
+      const double* c = cells.data() + (t + 1) * state + row;
+      const double* tc_prev = t_cells.data() + t * state + row;
+      double* tc = t_cells.data() + (t + 1) * state + row;
+      double* th = t_hiddens.data() + (t + 1) * state + row;
+      for (std::size_t j = 0; j < hidden_size; ++j) {
+        auto pre = [&](std::size_t k) { return t_in[k] + t_rec[k] + tb(k); };
+        double i = gate[j];
+        double f = gate[hidden_size + j];
+        double g = gate[2 * hidden_size + j];
+        double o = gate[3 * hidden_size + j];
+        double ti = i * (1.0 - i) * pre(j);
+        double tf = f * (1.0 - f) * pre(hidden_size + j);
+        double tg = (1.0 - g * g) * pre(2 * hidden_size + j);
+        double to = o * (1.0 - o) * pre(3 * hidden_size + j);
+        tc[j] = tf * c_prev[j] + f * tc_prev[j] + ti * g + i * tg;
+        double tanh_c = std::tanh(c[j]);
+        th[j] = to * tanh_c + o * (1.0 - tanh_c * tanh_c) * tc[j];
+      }
+    }
+  }
+
+  auto tangent =
+      xt::xarray<double>::from_shape({steps + 1, batch, hidden_size});
+  std::copy(t_hiddens.data() + state, t_hiddens.data() + (steps + 1) * state,
+            tangent.data());
+  std::copy(t_cells.data() + steps * state,
+            t_cells.data() + (steps + 1) * state,
+            tangent.data() + steps * state);
+  return Tensor::from_xarray(std::move(tangent));
+}
+
+/**
+ * Returns slots [begin, end) of the first dimension of the packed output of
+ * `lstm_forward`, without that dimension if `squeeze` is set.
+ */
+Tensor lstm_unpack_forward(autograd::Context& ctx, const Tensor& packed,
+                           std::size_t begin, std::size_t end, bool squeeze) {
+  const auto& p = packed.data_;
+  std::size_t slot = p.size() / p.shape()[0];
+  std::vector<std::size_t> shape(p.shape().begin(), p.shape().end());
+  shape[0] = end - begin;
+  if (squeeze) {
+    shape.erase(shape.begin());
+  }
+  auto output = xt::xarray<double>::from_shape(shape);
+  std::copy(p.data() + begin * slot, p.data() + end * slot, output.begin());
+  ctx.saved_data["packed_shape"] =
+      std::vector<std::size_t>(p.shape().begin(), p.shape().end());
+  ctx.saved_data["begin"] = begin * slot;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> lstm_unpack_backward(autograd::Context& ctx,
+                                         const Tensor& output_grad) {
+  const auto& packed_shape = std::any_cast<const std::vector<std::size_t>&>(
+      ctx.saved_data["packed_shape"]);
+  auto begin = std::any_cast<std::size_t>(ctx.saved_data["begin"]);
+  xt::xarray<double> grad = xt::zeros<double>(packed_shape);
+  std::copy(output_grad.data_.begin(), output_grad.data_.end(),
+            grad.data() + begin);
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(lstm_unpack, lstm_unpack_backward)
+
+static Tensor run_lstm(const Tensor& input, const LstmState& state,
+                       const Tensor& weight_ih, const Tensor& weight_hh,
+                       const Tensor& bias, bool sequence) {
+  return apply_op<lstmBackward>(
+      sequence ? "lstm" : "lstm_cell",
+      {input, state.first, state.second, weight_ih, weight_hh, bias},
+      [&](autograd::Context& ctx) {
+        return lstm_forward(ctx, input, state.first, state.second, weight_ih,
+                            weight_hh, bias, sequence);
+      },
+      [&](autograd::Context& ctx, const Tensor& /*output*/) {
+        return lstm_tangent(ctx, input, state.first, state.second, weight_ih,
+                            weight_hh, bias);
+      });
+}
+
+static Tensor unpack(const Tensor& packed, std::size_t begin, std::size_t end,
+                     bool squeeze) {
+  return apply_op<lstm_unpackBackward>(
+      "lstm", {packed},
+      [&](autograd::Context& ctx) {
+        return lstm_unpack_forward(ctx, packed, begin, end, squeeze);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        autograd::Context unused;
+        return lstm_unpack_forward(unused, *packed.tangent(), begin, end,
+                                   squeeze);
+      });
+}
+
+LstmState lstm_cell(const Tensor& input, const LstmState& state,
+                    const Tensor& weight_ih, const Tensor& weight_hh,
+                    const Tensor& bias) {
+  Tensor packed = run_lstm(input, state, weight_ih, weight_hh, bias, false);
+  return {unpack(packed, 0, 1, true), unpack(packed, 1, 2, true)};
+}
+
+std::pair<Tensor, LstmState> lstm(const Tensor& input,
+                                  const LstmState& initial,
+                                  const Tensor& weight_ih,
+                                  const Tensor& weight_hh, const Tensor& bias) {
+  Tensor packed = run_lstm(input, initial, weight_ih, weight_hh, bias, true);
+  std::size_t steps = input.data_.shape()[0];
+  return {unpack(packed, 0, steps, false),
+          {unpack(packed, steps - 1, steps, true),
+           unpack(packed, steps, steps + 1, true)}};
+}
+
+}  // namespace ember
@@ -1,14 +1,112 @@
 #include <ember/ops/matmul.h>
+#include <ember/autograd/per_sample.h>
 #include <ember/ops/utils.h>
 #include <xtensor-blas/xlinalg.hpp>
 #include <xtensor/xio.hpp>
 
+#include <algorithm>
+#include <any>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
 namespace ember {
 
 struct MatmulBackward;
 
+// Returns the grain for splitting the rows of `a` across threads, where each
+// of its elements costs `n` operations.
+static std::size_t row_grain(const CsrMatrix& a, std::size_t n) {
+  std::size_t per_row = std::max<std::size_t>(
+      a.nnz() / std::max<std::size_t>(a.rows, 1), 1);
+  return std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(per_row * n, 1));
+}
+
+// Writes the product of the CSR matrix `a` and the (a.cols, n) matrix at `b`
+// to the (a.rows, n) matrix at `out`. Each row of the output is a sum of rows
+// of `b`, so the rows are split across threads.
+static void spmm(const CsrMatrix& a, const double* b, std::size_t n,
+                 double* out) {
+  const kernels::KernelTable& k = kernels::active();
+  parallel::parallel_for(
+      0, a.rows, row_grain(a, n), [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+          double* row = out + r * n;
+          std::fill(row, row + n, 0.0);
+          for (std::size_t i = a.row_offsets[r]; i < a.row_offsets[r + 1];
+               ++i) {
+            k.axpy(a.values[i], b + a.columns[i] * n, row, n);
+          }
+        }
+      });
+}
+
+// Returns the product of the CSR matrix `a` and the dense matrix (or vector)
+// `b`, saving what its backward pass needs.
+static Tensor spmm_forward(autograd::Context& ctx, const Tensor& a,
+                           const Tensor& b) {
+  const CsrMatrix& m = a.csr();
+  const auto& x = b.data_;
+  if ((x.dimension() != 1 && x.dimension() != 2) || x.shape()[0] != m.cols) {
+    throw std::invalid_argument(
+        "A CSR matrix of shape (m, k) can only be multiplied by a dense "
+        "matrix of shape (k, n) or a vector of size k");
+  }
+  std::size_t n = x.dimension() == 1 ? 1 : x.shape()[1];
+  auto output = x.dimension() == 1
+                    ? xt::xarray<double>::from_shape({m.rows})
+                    : xt::xarray<double>::from_shape({m.rows, n});
+  spmm(m, x.data(), n, output.data());
+
+  ctx.save_for_backward(b);
+  ctx.saved_data["csr"] = m;
+  ctx.saved_data["needs_grad"] =
+      std::vector<bool>{a.requires_grad(), b.requires_grad()};
+  return Tensor::from_xarray(std::move(output));
+}
+
+// The gradient of the dense operand is the product of the CSR matrix's
+// transpose and the output's gradient. The gradient of the CSR matrix is
+// only computed on its sparsity pattern, i.e. as the dot products of the rows
+// of the output's gradient and of the dense operand that it multiplies.
+static std::vector<Tensor> spmm_backward(autograd::Context& ctx,
+                                         const Tensor& output_grad) {
+  const auto& m = std::any_cast<const CsrMatrix&>(ctx.saved_data["csr"]);
+  const auto& needs_grad =
+      std::any_cast<const std::vector<bool>&>(ctx.saved_data["needs_grad"]);
+  const auto& x = ctx.saved_tensors[0].data_;
+  std::size_t n = x.dimension() == 1 ? 1 : x.shape()[1];
+  const double* g = output_grad.data_.data();
+
+  std::vector<Tensor> grads(2);
+  if (needs_grad[0]) {
+    CsrMatrix grad = m;
+    parallel::parallel_for(
+        0, m.rows, row_grain(m, n), [&](std::size_t begin, std::size_t end) {
+          for (std::size_t r = begin; r < end; ++r) {
+            for (std::size_t i = m.row_offsets[r]; i < m.row_offsets[r + 1];
+                 ++i) {
+              const double* row = x.data() + m.columns[i] * n;
+              grad.values[i] =
+                  std::inner_product(row, row + n, g + r * n, 0.0);
+            }
+          }
+        });
+    grads[0] = Tensor::from_csr(std::move(grad));
+  }
+  if (needs_grad[1]) {
+    grads[1].data_ = xt::xarray<double>::from_shape(x.shape());
+    spmm(m.transpose(), g, n, grads[1].data_.data());
+  }
+  return grads;
+}
+
 Tensor matmul_forward(autograd::Context& ctx, const Tensor& a,
                       const Tensor& b) {
+  if (a.is_csr()) {
+    return spmm_forward(ctx, a, b);
+  }
   ctx.save_for_backward(a);
   ctx.save_for_backward(b);
   return Tensor::from_xarray(xt::linalg::dot(a.data_, b.data_));
@@ -16,12 +114,48 @@ Tensor matmul_forward(autograd::Context& ctx, const Tensor& a,
 
 std::vector<Tensor> matmul_backward(autograd::Context& ctx,
                                     const Tensor& output_grad) {
+  if (ctx.saved_data.count("csr") != 0) {
+    return spmm_backward(ctx, output_grad);
+  }
+  const auto& a = ctx.saved_tensors[0].data_;
+  const autograd::PerSampleState* per_sample = autograd::current_per_sample();
+  if (per_sample != nullptr && a.dimension() == 2 &&
+      ctx.saved_tensors[1].data_.dimension() == 2 &&
+      a.shape()[0] == per_sample->batch_size) {
+    return {Tensor::from_xarray(xt::linalg::dot(
+                output_grad.data_, xt::transpose(ctx.saved_tensors[1].data_))),
+            Tensor::from_xarray(per_sample_outer(a, output_grad.data_))};
+  }
   return {Tensor::from_xarray(xt::linalg::dot(
               output_grad.data_, xt::transpose(ctx.saved_tensors[1].data_))),
           Tensor::from_xarray(xt::linalg::dot(
               xt::transpose(ctx.saved_tensors[0].data_), output_grad.data_))};
 }
 
-REGISTER_BINARY_OP(matmul, matmul_forward, matmul_backward)
+// The tangent of a b is ta b + a tb. CSR tensors have no tangents.
+static Tensor matmul_tangent(const Tensor& a, const Tensor& b,
+                             const Tensor& /*output*/) {
+  return sum_tangent_terms({a, b}, [&](std::size_t i, const Tensor& tangent) {
+    return i == 0 ? matmul(tangent, b) : matmul(a, tangent);
+  });
+}
+
+REGISTER_OP_BACKWARD(matmul, matmul_backward)
+
+Tensor matmul(const Tensor& a, const Tensor& b) {
+  if (b.is_csr()) {
+    throw std::invalid_argument(
+        "Only the first operand of matmul can be a CSR matrix");
+  }
+  // Unlike the other binary ops, matmul takes a CSR first operand, so it
+  // isn't registered with REGISTER_BINARY_OP.
+  return apply_op<matmulBackward>(
+      "matmul", {a, b},
+      [&](autograd::Context& ctx) { return matmul_forward(ctx, a, b); },
+      [&](autograd::Context& /*ctx*/, const Tensor& output) {
+        return matmul_tangent(a, b, output);
+      },
+      {}, SparseInputs::CsrFirst);
+}
 
 }  // namespace ember
@@ -0,0 +1,107 @@
+#include <ember/ops/max_pool2d.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <any>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace ember {
+
+static constexpr std::size_t kNoIndex = std::numeric_limits<std::size_t>::max();
+
+Tensor max_pool2d_forward(
+    autograd::Context& ctx, const Tensor& input,
+    const std::array<std::size_t, 2>& kernel_size,
+    const std::optional<std::array<std::size_t, 2>>& stride,
+    const std::array<std::size_t, 2>& padding) {
+  const auto& x = input.data_;
+  Window2d window = make_pool_window(x, kernel_size, stride, padding);
+  std::size_t in_plane = window.input_plane();
+  std::size_t out_plane = window.output_plane();
+  std::size_t planes = x.shape()[0] * x.shape()[1];
+
+  // Only the position in the input of each selected element is needed for the
+  // backward pass, so the input itself isn't saved.
+  auto output = xt::xarray<double>::from_shape(
+      {x.shape()[0], x.shape()[1], window.output[0], window.output[1]});
+  std::vector<std::size_t> indices(output.size(), kNoIndex);
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(in_plane, 1));
+  parallel::parallel_for(
+      0, planes, grain_size, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t plane = begin; plane < end; ++plane) {
+          const double* in = x.data() + plane * in_plane;
+          double* out = output.data() + plane * out_plane;
+          std::size_t* index = indices.data() + plane * out_plane;
+          // The kernel's elements are visited in order, so ties go to the
+          // first and the first NaN is kept.
+          for_each_unfolded(window, 1, [&](std::size_t c, std::size_t i) {
+            std::size_t o = c % out_plane;
+            double v = in[i];
+            if (index[o] == kNoIndex || v > out[o] ||
+                (std::isnan(v) && !std::isnan(out[o]))) {
+              out[o] = v;
+              index[o] = plane * in_plane + i;
+            }
+          });
+        }
+      });
+
+  ctx.saved_data["indices"] = std::move(indices);
+  ctx.saved_data["input_shape"] = x.shape();
+  ctx.saved_data["in_plane"] = in_plane;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> max_pool2d_backward(autograd::Context& ctx,
+                                        const Tensor& output_grad) {
+  using shape_type = xt::xarray<double>::shape_type;
+  const auto& indices = std::any_cast<const std::vector<std::size_t>&>(
+      ctx.saved_data["indices"]);
+  auto input_shape = std::any_cast<shape_type>(ctx.saved_data["input_shape"]);
+  std::size_t in_plane = std::any_cast<std::size_t>(ctx.saved_data["in_plane"]);
+  std::size_t planes = input_shape[0] * input_shape[1];
+  std::size_t out_plane = planes == 0 ? 0 : indices.size() / planes;
+  const double* g = output_grad.data_.data();
+
+  // Overlapping windows can select the same element, so the gradients are
+  // added. Each plane's outputs only select elements of the same plane.
+  xt::xarray<double> input_grad = xt::zeros<double>(input_shape);
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(in_plane, 1));
+  parallel::parallel_for(
+      0, planes, grain_size, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t o = begin * out_plane; o < end * out_plane; ++o) {
+          input_grad.data()[indices[o]] += g[o];
+        }
+      });
+  return {Tensor::from_xarray(std::move(input_grad))};
+}
+
+REGISTER_OP_BACKWARD(max_pool2d, max_pool2d_backward)
+
+Tensor max_pool2d(const Tensor& input,
+                  const std::array<std::size_t, 2>& kernel_size,
+                  const std::optional<std::array<std::size_t, 2>>& stride,
+                  const std::array<std::size_t, 2>& padding) {
+  return apply_op<max_pool2dBackward>(
+      "max_pool2d", {input},
+      [&](autograd::Context& ctx) {
+        return max_pool2d_forward(ctx, input, kernel_size, stride, padding);
+      },
+      [&](autograd::Context& ctx, const Tensor& output) {
+        const auto& indices = std::any_cast<const std::vector<std::size_t>&>(
+            ctx.saved_data["indices"]);
+        const double* t = input.tangent()->data_.data();
+        auto tangent = xt::xarray<double>::from_shape(output.data_.shape());
+        for (std::size_t o = 0; o < indices.size(); ++o) {
+          tangent.data()[o] = t[indices[o]];
+        }
+        return Tensor::from_xarray(std::move(tangent));
+      });
+}
+
+}  // namespace ember
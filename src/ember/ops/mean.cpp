@@ -0,0 +1,56 @@
+#include <ember/ops/mean.h>
+#include <ember/ops/utils.h>
+
+#include <any>
+
+namespace ember {
+
+Tensor mean_forward(autograd::Context& ctx, const Tensor& input,
+                    const std::vector<std::ptrdiff_t>& axes, bool keepdims) {
+  auto reduced_axes = normalize_axes(axes, input.data_.dimension());
+  std::size_t count = 1;
+  for (std::size_t axis : reduced_axes) {
+    count *= input.data_.shape()[axis];
+  }
+  double scale = 1.0 / static_cast<double>(count);
+  ctx.saved_data["input_shape"] = input.data_.shape();
+  ctx.saved_data["kept_shape"] =
+      reduced_shape(input.data_.shape(), reduced_axes, true);
+  ctx.saved_data["scale"] = scale;
+
+  xt::xarray<double> output = sum_over_axes(input.data_, reduced_axes);
+  output *= scale;
+  output.reshape(reduced_shape(input.data_.shape(), reduced_axes, keepdims));
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> mean_backward(autograd::Context& ctx,
+                                  const Tensor& output_grad) {
+  using shape_type = xt::xarray<double>::shape_type;
+  xt::xarray<double> grad = broadcast_reduced(
+      output_grad.data_,
+      std::any_cast<shape_type>(ctx.saved_data["kept_shape"]),
+      std::any_cast<shape_type>(ctx.saved_data["input_shape"]));
+  grad *= std::any_cast<double>(ctx.saved_data["scale"]);
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(mean, mean_backward)
+
+Tensor mean(const Tensor& input, const std::vector<std::ptrdiff_t>& axes,
+            bool keepdims) {
+  return apply_op<meanBackward>(
+      "mean", {input},
+      [&](autograd::Context& ctx) {
+        return mean_forward(ctx, input, axes, keepdims);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return mean(*input.tangent(), axes, keepdims);
+      });
+}
+
+Tensor mean(const Tensor& input) {
+  return mean(input, all_axes(input.data_.dimension()));
+}
+
+}  // namespace ember
@@ -0,0 +1,67 @@
+#include <ember/ops/min.h>
+#include <ember/ops/utils.h>
+
+#include <any>
+#include <vector>
+
+namespace ember {
+
+Tensor min_forward(autograd::Context& ctx, const Tensor& input,
+                   const std::vector<std::size_t>& axes, bool keepdims) {
+  // Only the positions of the selected elements are needed for the backward
+  // pass, so the input itself isn't saved.
+  std::vector<std::size_t> indices;
+  xt::xarray<double> output =
+      extreme_over_axes(input.data_, axes, false, indices);
+  ctx.saved_data["indices"] = std::move(indices);
+  ctx.saved_data["axes"] = axes;
+  ctx.saved_data["input_shape"] = input.data_.shape();
+
+  output.reshape(reduced_shape(input.data_.shape(), axes, keepdims));
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> min_backward(autograd::Context& ctx,
+                                 const Tensor& output_grad) {
+  using shape_type = xt::xarray<double>::shape_type;
+  return {Tensor::from_xarray(scatter_extremes(
+      output_grad.data_,
+      std::any_cast<const std::vector<std::size_t>&>(
+          ctx.saved_data["indices"]),
+      std::any_cast<const std::vector<std::size_t>&>(ctx.saved_data["axes"]),
+      std::any_cast<shape_type>(ctx.saved_data["input_shape"])))};
+}
+
+REGISTER_OP_BACKWARD(min, min_backward)
+
+static Tensor min_over_axes(const Tensor& input,
+                            const std::vector<std::size_t>& axes,
+                            bool keepdims) {
+  return apply_op<minBackward>(
+      "min", {input},
+      [&](autograd::Context& ctx) {
+        return min_forward(ctx, input, axes, keepdims);
+      },
+      [&](autograd::Context& ctx, const Tensor& output) {
+        xt::xarray<double> tangent = gather_extremes(
+            input.tangent()->data_,
+            std::any_cast<const std::vector<std::size_t>&>(
+                ctx.saved_data["indices"]),
+            axes);
+        tangent.reshape(output.data_.shape());
+        return Tensor::from_xarray(std::move(tangent));
+      });
+}
+
+Tensor min(const Tensor& input, std::ptrdiff_t axis, bool keepdims) {
+  return min_over_axes(
+      input, normalize_axes({axis}, input.data_.dimension()), keepdims);
+}
+
+Tensor min(const Tensor& input) {
+  auto axes = all_axes(input.data_.dimension());
+  return min_over_axes(input,
+                       normalize_axes(axes, input.data_.dimension()), false);
+}
+
+}  // namespace ember
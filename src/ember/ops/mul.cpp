@@ -13,7 +13,8 @@ static Tensor mul_forward(autograd::Context& context,
                           const Tensor& multiplier) {
   context.save_for_backward(multiplicand);
   context.save_for_backward(multiplier);
-  return Tensor::from_xarray(xt::eval(multiplicand.data_ * multiplier.data_));
+  return Tensor::from_xarray(apply_binary_kernel(
+      kernels::active().mul, multiplicand.data_, multiplier.data_));
 }
 
 /**
@@ -37,10 +38,11 @@ std::vector<Tensor> mul_backward(autograd::Context& context,
   auto multiplicand = context.saved_tensors[MULTIPLICAND_INDEX];
   auto multiplier = context.saved_tensors[MULTIPLIER_INDEX];
 
+  const kernels::KernelTable& k = kernels::active();
   xt::xarray<double> multiplicand_grad_raw =
-      multiplier.data_ * output_grad.data_;
+      apply_binary_kernel(k.mul, multiplier.data_, output_grad.data_);
   xt::xarray<double> multiplier_grad_raw =
-      multiplicand.data_ * output_grad.data_;
+      apply_binary_kernel(k.mul, multiplicand.data_, output_grad.data_);
 
   auto multiplicand_grad =
       reduce_broadcast(multiplicand_grad_raw, multiplicand.data_.shape());
@@ -51,6 +53,16 @@ std::vector<Tensor> mul_backward(autograd::Context& context,
           Tensor::from_xarray(multiplier_grad)};
 }
 
-REGISTER_BINARY_OP(mul, mul_forward, mul_backward);
+// The tangent of a * b is ta * b + a * tb.
+static Tensor mul_tangent(const Tensor& multiplicand, const Tensor& multiplier,
+                          const Tensor& /*output*/) {
+  return sum_tangent_terms(
+      {multiplicand, multiplier}, [&](std::size_t i, const Tensor& tangent) {
+        return i == MULTIPLICAND_INDEX ? tangent * multiplier
+                                       : multiplicand * tangent;
+      });
+}
+
+REGISTER_BINARY_OP(mul, mul_forward, mul_backward, mul_tangent);
 
 }  // namespace ember
@@ -0,0 +1,60 @@
+#include <ember/ops/pow.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xoperation.hpp>
+
+namespace ember {
+
+Tensor pow_forward(autograd::Context& ctx, const Tensor& base,
+                   const Tensor& exponent) {
+  auto output =
+      Tensor::from_xarray(xt::eval(xt::pow(base.data_, exponent.data_)));
+  ctx.save_for_backward(base, exponent, output);
+  return output;
+}
+
+/**
+ * Given that y = a ^ b, the partial derivatives of a and b are:
+ *
+ * - ∂y/∂a = b * a ^ (b - 1)
+ * - ∂y/∂b = y * ln(a)
+ */
+std::vector<Tensor> pow_backward(autograd::Context& ctx,
+                                 const Tensor& output_grad) {
+  const auto& base = ctx.saved_tensors[0].data_;
+  const auto& exponent = ctx.saved_tensors[1].data_;
+  const auto& output = ctx.saved_tensors[2].data_;
+
+  xt::xarray<double> base_grad = xt::eval(
+      output_grad.data_ * exponent * xt::pow(base, exponent - 1.0));
+  // ln(0) is -inf, but 0 ^ b doesn't change with b (for b > 0), so the
+  // gradient is taken to be 0 there instead of NaN.
+  xt::xarray<double> exponent_grad = xt::eval(
+      output_grad.data_ *
+      xt::where(xt::equal(base, 0.0), 0.0, output * xt::log(base)));
+
+  return {Tensor::from_xarray(reduce_broadcast(base_grad, base.shape())),
+          Tensor::from_xarray(
+              reduce_broadcast(exponent_grad, exponent.shape()))};
+}
+
+// The tangent of y = a ^ b is ta * b * a ^ (b - 1) + tb * y * ln(a), with the
+// same convention at a = 0 as the backward pass.
+static Tensor pow_tangent(const Tensor& base, const Tensor& exponent,
+                          const Tensor& output) {
+  return sum_tangent_terms(
+      {base, exponent}, [&](std::size_t i, const Tensor& tangent) {
+        if (i == 0) {
+          return Tensor::from_xarray(xt::eval(
+              tangent.data_ * exponent.data_ *
+              xt::pow(base.data_, exponent.data_ - 1.0)));
+        }
+        return Tensor::from_xarray(xt::eval(
+            tangent.data_ * xt::where(xt::equal(base.data_, 0.0), 0.0,
+                                      output.data_ * xt::log(base.data_))));
+      });
+}
+
+REGISTER_BINARY_OP(pow, pow_forward, pow_backward, pow_tangent)
+
+}  // namespace ember
@@ -0,0 +1,24 @@
+#include <ember/ops/relu.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xoperation.hpp>
+
+namespace ember {
+
+Tensor relu_forward(autograd::Context& ctx, const Tensor& input) {
+  auto output = Tensor::from_xarray(
+      map_elementwise(input.data_, kernels::active().relu));
+  ctx.save_for_backward(output);
+  return output;
+}
+
+std::vector<Tensor> relu_backward(autograd::Context& ctx,
+                                  const Tensor& output_grad) {
+  // The output is positive exactly where the input is.
+  const auto& output = ctx.saved_tensors[0].data_;
+  return {Tensor::from_xarray(
+      xt::eval(xt::where(xt::greater(output, 0.0), output_grad.data_, 0.0)))};
+}
+
+REGISTER_UNARY_OP(relu, relu_forward, relu_backward)
+
+}  // namespace ember
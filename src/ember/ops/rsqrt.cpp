@@ -0,0 +1,23 @@
+#include <ember/ops/rsqrt.h>
+#include <ember/ops/utils.h>
+
+namespace ember {
+
+Tensor rsqrt_forward(autograd::Context& ctx, const Tensor& input) {
+  auto output = Tensor::from_xarray(
+      map_elementwise(input.data_, kernels::active().rsqrt));
+  ctx.save_for_backward(output);
+  return output;
+}
+
+std::vector<Tensor> rsqrt_backward(autograd::Context& ctx,
+                                   const Tensor& output_grad) {
+  // d/dx x^(-1/2) = -x^(-3/2) / 2 = -rsqrt(x)^3 / 2
+  const auto& output = ctx.saved_tensors[0].data_;
+  return {Tensor::from_xarray(
+      xt::eval(output_grad.data_ * (-0.5 * output * output * output)))};
+}
+
+REGISTER_UNARY_OP(rsqrt, rsqrt_forward, rsqrt_backward)
+
+}  // namespace ember
@@ -0,0 +1,547 @@
+#include <ember/ops/scaled_dot_product_attention.h>
+#include <ember/ops/utils.h>
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmanipulation.hpp>
+
+#include <algorithm>
+#include <any>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ember {
+
+// The number of queries and keys in a tile. A tile of scores is 32KB, which
+// fits in L1 cache alongside the rows of the inputs it is computed from.
+static constexpr std::size_t kTileSize = 64;
+
+static constexpr double kInf = std::numeric_limits<double>::infinity();
+
+namespace {
+
+/**
+ * The shape of an attention problem, where the leading dimensions of the
+ * inputs are flattened into `batch` sequences.
+ */
+struct AttentionShape {
+  std::size_t batch;
+  std::size_t queries;
+  std::size_t keys;
+  std::size_t dim;
+  std::size_t value_dim;
+  bool causal;
+  bool has_mask;
+  // Whether every sequence uses the same (queries, keys) mask.
+  bool shared_mask;
+
+  double scale() const { return 1.0 / std::sqrt(static_cast<double>(dim)); }
+
+  std::size_t query_tiles() const {
+    return (queries + kTileSize - 1) / kTileSize;
+  }
+  std::size_t key_tiles() const { return (keys + kTileSize - 1) / kTileSize; }
+};
+
+// The queries [q_begin, q_end) and keys [k_begin, k_end) of one sequence.
+struct Tile {
+  std::size_t q_begin;
+  std::size_t q_end;
+  std::size_t k_begin;
+  std::size_t k_end;
+
+  std::size_t rows() const { return q_end - q_begin; }
+  std::size_t cols() const { return k_end - k_begin; }
+};
+
+// The inputs of one sequence.
+struct Sequence {
+  const double* query;
+  const double* key;
+  const double* value;
+  // Null if there is no mask.
+  const double* mask;
+};
+
+}  // namespace
+
+// Adds `alpha * a b` to the m x n matrix `c`, where a is m x k.
+static void add_product(const double* a, const double* b, double* c,
+                        std::size_t m, std::size_t k, std::size_t n,
+                        double alpha) {
+  xt::xarray<double> product =
+      xt::linalg::dot(matrix(a, m, k), matrix(b, k, n));
+  kernels::active().axpy(alpha, product.data(), c, m * n);
+}
+
+// Adds `alpha * a^T b` to the m x n matrix `c`, where a is k x m.
+static void add_product_transposed_a(const double* a, const double* b,
+                                     double* c, std::size_t m, std::size_t k,
+                                     std::size_t n, double alpha) {
+  xt::xarray<double> product =
+      xt::linalg::dot(xt::transpose(matrix(a, k, m)), matrix(b, k, n));
+  kernels::active().axpy(alpha, product.data(), c, m * n);
+}
+
+// Adds `alpha * a b^T` to the m x n matrix `c`, where b is n x k.
+static void add_product_transposed_b(const double* a, const double* b,
+                                     double* c, std::size_t m, std::size_t k,
+                                     std::size_t n, double alpha) {
+  xt::xarray<double> product =
+      xt::linalg::dot(matrix(a, m, k), xt::transpose(matrix(b, n, k)));
+  kernels::active().axpy(alpha, product.data(), c, m * n);
+}
+
+static AttentionShape attention_shape(const Tensor& query, const Tensor& key,
+                                      const Tensor& value, const Tensor* mask,
+                                      bool causal) {
+  const auto& q = query.data_;
+  const auto& k = key.data_;
+  const auto& v = value.data_;
+  std::size_t ndim = q.dimension();
+  if (ndim < 2 || k.dimension() != ndim || v.dimension() != ndim) {
+    throw std::invalid_argument(
+        "The query, key and value must have the same number of dimensions, "
+        "and at least 2");
+  }
+  std::size_t batch = 1;
+  for (std::size_t axis = 0; axis + 2 < ndim; ++axis) {
+    if (k.shape()[axis] != q.shape()[axis] ||
+        v.shape()[axis] != q.shape()[axis]) {
+      throw std::invalid_argument(
+          "The query, key and value must have the same leading dimensions");
+    }
+    batch *= q.shape()[axis];
+  }
+  AttentionShape shape;
+  shape.batch = batch;
+  shape.queries = q.shape()[ndim - 2];
+  shape.keys = k.shape()[ndim - 2];
+  shape.dim = q.shape()[ndim - 1];
+  shape.value_dim = v.shape()[ndim - 1];
+  shape.causal = causal;
+  shape.has_mask = mask != nullptr;
+  shape.shared_mask = false;
+  if (k.shape()[ndim - 1] != shape.dim) {
+    throw std::invalid_argument(
+        "The queries have " + std::to_string(shape.dim) +
+        " features but the keys have " + std::to_string(k.shape()[ndim - 1]));
+  }
+  if (v.shape()[ndim - 2] != shape.keys) {
+    throw std::invalid_argument("There are " + std::to_string(shape.keys) +
+                                " keys but " +
+                                std::to_string(v.shape()[ndim - 2]) +
+                                " values");
+  }
+  if (mask != nullptr) {
+    const auto& m = mask->data_;
+    shape.shared_mask = m.dimension() == 2;
+    bool matches = shape.shared_mask || m.dimension() == ndim;
+    for (std::size_t axis = 0; matches && axis + 2 < m.dimension(); ++axis) {
+      matches = m.shape()[axis] == q.shape()[axis];
+    }
+    if (!matches || m.shape()[m.dimension() - 2] != shape.queries ||
+        m.shape()[m.dimension() - 1] != shape.keys) {
+      throw std::invalid_argument(
+          "The mask must have shape (" + std::to_string(shape.queries) + ", " +
+          std::to_string(shape.keys) + ") or the leading dimensions of the "
+          "query followed by that");
+    }
+  }
+  return shape;
+}
+
+static Sequence sequence(const AttentionShape& shape, std::size_t b,
+                         const double* query, const double* key,
+                         const double* value, const double* mask) {
+  std::size_t mask_offset =
+      shape.shared_mask ? 0 : b * shape.queries * shape.keys;
+  return {query + b * shape.queries * shape.dim,
+          key + b * shape.keys * shape.dim,
+          value + b * shape.keys * shape.value_dim,
+          mask == nullptr ? nullptr : mask + mask_offset};
+}
+
+// Returns true if every query of the tile is masked from every key by the
+// causal mask, so the tile can be skipped.
+static bool causally_masked(const AttentionShape& shape, const Tile& tile) {
+  return shape.causal && tile.k_begin >= tile.q_end;
+}
+
+/**
+ * Writes the scaled scores of the tile to the rows x cols matrix `scores`,
+ * with masked scores set to -infinity.
+ */
+static void tile_scores(const AttentionShape& shape, const Sequence& seq,
+                        const Tile& tile, double* scores) {
+  std::fill(scores, scores + tile.rows() * tile.cols(), 0.0);
+  add_product_transposed_b(seq.query + tile.q_begin * shape.dim,
+                           seq.key + tile.k_begin * shape.dim, scores,
+                           tile.rows(), shape.dim, tile.cols(), shape.scale());
+  if (!shape.causal && seq.mask == nullptr) {
+    return;
+  }
+  for (std::size_t r = 0; r < tile.rows(); ++r) {
+    std::size_t i = tile.q_begin + r;
+    double* row = scores + r * tile.cols();
+    for (std::size_t c = 0; c < tile.cols(); ++c) {
+      std::size_t j = tile.k_begin + c;
+      bool masked = (shape.causal && j > i) ||
+                    (seq.mask != nullptr && seq.mask[i * shape.keys + j] == 0);
+      if (masked) {
+        row[c] = -kInf;
+      }
+    }
+  }
+}
+
+Tensor scaled_dot_product_attention_forward(autograd::Context& ctx,
+                                            const Tensor& query,
+                                            const Tensor& key,
+                                            const Tensor& value,
+                                            const Tensor* mask, bool causal) {
+  AttentionShape shape = attention_shape(query, key, value, mask, causal);
+  auto output_shape = query.data_.shape();
+  output_shape.back() = shape.value_dim;
+  auto output = xt::xarray<double>::from_shape(output_shape);
+  std::vector<double> logsumexp(shape.batch * shape.queries);
+  const kernels::KernelTable& k = kernels::active();
+
+  // Each tile of queries is processed by a single thread, which keeps a
+  // running maximum, sum and weighted sum of values for each query as it
+  // sweeps over the tiles of keys. Whenever the maximum grows, the sum and
+  // the weighted sum are rescaled by e^(old max - new max).
+  std::size_t dv = shape.value_dim;
+  parallel::parallel_for(
+      0, shape.batch * shape.query_tiles(), 1,
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<double> scores(kTileSize * kTileSize);
+        std::vector<double> weighted(kTileSize * dv);
+        std::vector<double> row_max(kTileSize);
+        std::vector<double> row_sum(kTileSize);
+        for (std::size_t unit = begin; unit < end; ++unit) {
+          std::size_t b = unit / shape.query_tiles();
+          std::size_t q_begin = unit % shape.query_tiles() * kTileSize;
+          std::size_t q_end = std::min(q_begin + kTileSize, shape.queries);
+          std::size_t rows = q_end - q_begin;
+          Sequence seq = sequence(shape, b, query.data_.data(),
+                                  key.data_.data(), value.data_.data(),
+                                  mask == nullptr ? nullptr
+                                                  : mask->data_.data());
+          std::fill(weighted.begin(), weighted.end(), 0.0);
+          std::fill(row_max.begin(), row_max.end(), -kInf);
+          std::fill(row_sum.begin(), row_sum.end(), 0.0);
+
+          for (std::size_t k_begin = 0; k_begin < shape.keys;
+               k_begin += kTileSize) {
+            Tile tile{q_begin, q_end, k_begin,
+                      std::min(k_begin + kTileSize, shape.keys)};
+            if (causally_masked(shape, tile)) {
+              break;
+            }
+            std::size_t cols = tile.cols();
+            tile_scores(shape, seq, tile, scores.data());
+            for (std::size_t r = 0; r < rows; ++r) {
+              double* p = scores.data() + r * cols;
+              double new_max =
+                  std::max(row_max[r], *std::max_element(p, p + cols));
+              if (new_max == -kInf) {
+                // Every key so far is masked.
+                std::fill(p, p + cols, 0.0);
+                continue;
+              }
+              std::for_each(p, p + cols, [new_max](double& s) {
+                s -= new_max;
+              });
+              exp_in_place(p, cols);
+              double correction = std::exp(row_max[r] - new_max);
+              row_sum[r] = row_sum[r] * correction + k.sum(p, cols);
+              double* w = weighted.data() + r * dv;
+              std::for_each(w, w + dv,
+                            [correction](double& v) { v *= correction; });
+              row_max[r] = new_max;
+            }
+            add_product(scores.data(), seq.value + tile.k_begin * dv,
+                        weighted.data(), rows, cols, dv, 1.0);
+          }
+
+          for (std::size_t r = 0; r < rows; ++r) {
+            std::size_t i = b * shape.queries + q_begin + r;
+            double* out = output.data() + i * dv;
+            const double* w = weighted.data() + r * dv;
+            double inverse = row_sum[r] > 0.0 ? 1.0 / row_sum[r] : 0.0;
+            std::transform(w, w + dv, out,
+                           [inverse](double v) { return v * inverse; });
+            logsumexp[i] =
+                row_sum[r] > 0.0 ? row_max[r] + std::log(row_sum[r]) : -kInf;
+          }
+        }
+      });
+
+  Tensor result = Tensor::from_xarray(std::move(output));
+  ctx.save_for_backward(query, key, value, result);
+  if (mask != nullptr) {
+    ctx.save_for_backward(*mask);
+  }
+  ctx.saved_data["shape"] = shape;
+  ctx.saved_data["logsumexp"] = std::move(logsumexp);
+  return result;
+}
+
+namespace {
+
+// The saved tensors and values of the backward pass of one sequence.
+struct GradSequence {
+  Sequence inputs;
+  const double* output_grad;
+  // The logsumexp of each query's scores.
+  const double* logsumexp;
+  // The dot product of each query's output and its gradient.
+  const double* delta;
+};
+
+}  // namespace
+
+/**
+ * Recomputes the probabilities of the tile into the rows x cols matrix `p`,
+ * and writes the gradient of the scores (before scaling) to `score_grad`.
+ *   dS = P * (dO V^T - delta)
+ */
+static void tile_grads(const AttentionShape& shape, const GradSequence& seq,
+                       const Tile& tile, double* p, double* score_grad) {
+  std::size_t rows = tile.rows();
+  std::size_t cols = tile.cols();
+  tile_scores(shape, seq.inputs, tile, p);
+  std::fill(score_grad, score_grad + rows * cols, 0.0);
+  add_product_transposed_b(seq.output_grad + tile.q_begin * shape.value_dim,
+                           seq.inputs.value + tile.k_begin * shape.value_dim,
+                           score_grad, rows, shape.value_dim, cols, 1.0);
+  for (std::size_t r = 0; r < rows; ++r) {
+    std::size_t i = tile.q_begin + r;
+    double* p_row = p + r * cols;
+    double* ds_row = score_grad + r * cols;
+    if (seq.logsumexp[i] == -kInf) {
+      std::fill(p_row, p_row + cols, 0.0);
+      std::fill(ds_row, ds_row + cols, 0.0);
+      continue;
+    }
+    double lse = seq.logsumexp[i];
+    std::for_each(p_row, p_row + cols, [lse](double& s) { s -= lse; });
+    exp_in_place(p_row, cols);
+    for (std::size_t c = 0; c < cols; ++c) {
+      ds_row[c] = p_row[c] * (ds_row[c] - seq.delta[i]);
+    }
+  }
+}
+
+std::vector<Tensor> scaled_dot_product_attention_backward(
+    autograd::Context& ctx, const Tensor& output_grad) {
+  const auto& query = ctx.saved_tensors[0].data_;
+  const auto& key = ctx.saved_tensors[1].data_;
+  const auto& value = ctx.saved_tensors[2].data_;
+  const auto& output = ctx.saved_tensors[3].data_;
+  const auto& shape =
+      std::any_cast<const AttentionShape&>(ctx.saved_data["shape"]);
+  const auto& logsumexp =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["logsumexp"]);
+  const double* mask =
+      shape.has_mask ? ctx.saved_tensors[4].data_.data() : nullptr;
+  const double* g = output_grad.data_.data();
+  std::size_t d = shape.dim;
+  std::size_t dv = shape.value_dim;
+  const kernels::KernelTable& k = kernels::active();
+
+  std::vector<double> delta(shape.batch * shape.queries);
+  parallel::parallel_for(
+      0, delta.size(), std::max<std::size_t>(1, parallel::kGrainSize / dv),
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<double> product(dv);
+        for (std::size_t i = begin; i < end; ++i) {
+          k.mul(g + i * dv, output.data() + i * dv, product.data(), dv);
+          delta[i] = k.sum(product.data(), dv);
+        }
+      });
+  auto grad_sequence = [&](std::size_t b) {
+    return GradSequence{sequence(shape, b, query.data(), key.data(),
+                                 value.data(), mask),
+                        g + b * shape.queries * dv,
+                        logsumexp.data() + b * shape.queries,
+                        delta.data() + b * shape.queries};
+  };
+
+  // The gradients of the keys and values are computed one tile of keys at a
+  // time, and those of the queries one tile of queries at a time, so each
+  // thread writes to its own rows. This recomputes each tile twice, but needs
+  // no synchronization and keeps the result deterministic.
+  xt::xarray<double> query_grad = xt::zeros<double>(query.shape());
+  xt::xarray<double> key_grad = xt::zeros<double>(key.shape());
+  xt::xarray<double> value_grad = xt::zeros<double>(value.shape());
+  parallel::parallel_for(
+      0, shape.batch * shape.key_tiles(), 1,
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<double> p(kTileSize * kTileSize);
+        std::vector<double> score_grad(kTileSize * kTileSize);
+        for (std::size_t unit = begin; unit < end; ++unit) {
+          std::size_t b = unit / shape.key_tiles();
+          std::size_t k_begin = unit % shape.key_tiles() * kTileSize;
+          std::size_t k_end = std::min(k_begin + kTileSize, shape.keys);
+          GradSequence seq = grad_sequence(b);
+          double* dk = key_grad.data() + (b * shape.keys + k_begin) * d;
+          double* dval = value_grad.data() + (b * shape.keys + k_begin) * dv;
+          for (std::size_t q_begin = 0; q_begin < shape.queries;
+               q_begin += kTileSize) {
+            Tile tile{q_begin, std::min(q_begin + kTileSize, shape.queries),
+                      k_begin, k_end};
+            if (causally_masked(shape, tile)) {
+              continue;
+            }
+            tile_grads(shape, seq, tile, p.data(), score_grad.data());
+            // dV += P^T dO and dK += scale * dS^T Q
+            add_product_transposed_a(p.data(), seq.output_grad + q_begin * dv,
+                                     dval, tile.cols(), tile.rows(), dv, 1.0);
+            add_product_transposed_a(score_grad.data(),
+                                     seq.inputs.query + q_begin * d, dk,
+                                     tile.cols(), tile.rows(), d,
+                                     shape.scale());
+          }
+        }
+      });
+  parallel::parallel_for(
+      0, shape.batch * shape.query_tiles(), 1,
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<double> p(kTileSize * kTileSize);
+        std::vector<double> score_grad(kTileSize * kTileSize);
+        for (std::size_t unit = begin; unit < end; ++unit) {
+          std::size_t b = unit / shape.query_tiles();
+          std::size_t q_begin = unit % shape.query_tiles() * kTileSize;
+          std::size_t q_end = std::min(q_begin + kTileSize, shape.queries);
+          GradSequence seq = grad_sequence(b);
+          double* dq = query_grad.data() + (b * shape.queries + q_begin) * d;
+          for (std::size_t k_begin = 0; k_begin < shape.keys;
+               k_begin += kTileSize) {
+            Tile tile{q_begin, q_end, k_begin,
+                      std::min(k_begin + kTileSize, shape.keys)};
+            if (causally_masked(shape, tile)) {
+              break;
+            }
+            tile_grads(shape, seq, tile, p.data(), score_grad.data());
+            // dQ += scale * dS K
+            add_product(score_grad.data(), seq.inputs.key + k_begin * d, dq,
+                        tile.rows(), tile.cols(), d, shape.scale());
+          }
+        }
+      });
+  return {Tensor::from_xarray(std::move(query_grad)),
+          Tensor::from_xarray(std::move(key_grad)),
+          Tensor::from_xarray(std::move(value_grad))};
+}
+
+REGISTER_OP_BACKWARD(scaled_dot_product_attention,
+                     scaled_dot_product_attention_backward)
+
+/**
+ * Computes the tangent of the output from the tangents of the query, key and
+ * value (zeros for those without one), recomputing the probabilities of each
+ * tile of queries against every key from the saved logsumexp:
+ *   tS = scale (tQ K^T + Q tK^T), tP = P * (tS - rowsum(P * tS)) and
+ *   tO = tP V + P tV
+ */
+static Tensor attention_tangent(autograd::Context& ctx, const Tensor& query,
+                                const Tensor& key, const Tensor& value,
+                                const Tensor* mask, const Tensor& output) {
+  const auto& shape =
+      std::any_cast<const AttentionShape&>(ctx.saved_data["shape"]);
+  const auto& logsumexp =
+      std::any_cast<const std::vector<double>&>(ctx.saved_data["logsumexp"]);
+  xt::xarray<double> tq = tangent_of(query).data_;
+  xt::xarray<double> tk = tangent_of(key).data_;
+  xt::xarray<double> tv = tangent_of(value).data_;
+  std::size_t d = shape.dim;
+  std::size_t dv = shape.value_dim;
+  std::size_t keys = shape.keys;
+
+  auto tangent = xt::xarray<double>::from_shape(output.data_.shape());
+  parallel::parallel_for(
+      0, shape.batch * shape.query_tiles(), 1,
+      [&](std::size_t begin, std::size_t end) {
+        std::vector<double> p(kTileSize * keys);
+        std::vector<double> score_tangent(kTileSize * keys);
+        for (std::size_t unit = begin; unit < end; ++unit) {
+          std::size_t b = unit / shape.query_tiles();
+          std::size_t q_begin = unit % shape.query_tiles() * kTileSize;
+          Tile tile{q_begin, std::min(q_begin + kTileSize, shape.queries), 0,
+                    keys};
+          std::size_t rows = tile.rows();
+          Sequence seq = sequence(shape, b, query.data_.data(),
+                                  key.data_.data(), value.data_.data(),
+                                  mask == nullptr ? nullptr
+                                                  : mask->data_.data());
+          Sequence t_seq =
+              sequence(shape, b, tq.data(), tk.data(), tv.data(), nullptr);
+          tile_scores(shape, seq, tile, p.data());
+          std::fill(score_tangent.begin(), score_tangent.begin() + rows * keys,
+                    0.0);
+          add_product_transposed_b(t_seq.query + q_begin * d, seq.key,
+                                   score_tangent.data(), rows, d, keys,
+                                   shape.scale());
+          add_product_transposed_b(seq.query + q_begin * d, t_seq.key,
+                                   score_tangent.data(), rows, d, keys,
+                                   shape.scale());
+          for (std::size_t r = 0; r < rows; ++r) {
+            double lse = logsumexp[b * shape.queries + q_begin + r];
+            double* p_row = p.data() + r * keys;
+            double* ts_row = score_tangent.data() + r * keys;
+            if (lse == -kInf) {
+              std::fill(p_row, p_row + keys, 0.0);
+              std::fill(ts_row, ts_row + keys, 0.0);
+              continue;
+            }
+            std::for_each(p_row, p_row + keys, [lse](double& s) { s -= lse; });
+            exp_in_place(p_row, keys);
+            double mean = 0.0;
+            for (std::size_t c = 0; c < keys; ++c) {
+              mean += p_row[c] * ts_row[c];
+            }
+            for (std::size_t c = 0; c < keys; ++c) {
+              ts_row[c] = p_row[c] * (ts_row[c] - mean);
+            }
+          }
+          double* out = tangent.data() + (b * shape.queries + q_begin) * dv;
+          std::fill(out, out + rows * dv, 0.0);
+          add_product(score_tangent.data(), seq.value, out, rows, keys, dv,
+                      1.0);
+          add_product(p.data(), t_seq.value, out, rows, keys, dv, 1.0);
+        }
+      });
+  return Tensor::from_xarray(std::move(tangent));
+}
+
+static Tensor attention(const Tensor& query, const Tensor& key,
+                        const Tensor& value, const Tensor* mask, bool causal) {
+  // The mask never needs a gradient, so it isn't an input of the node.
+  return apply_op<scaled_dot_product_attentionBackward>(
+      "scaled_dot_product_attention", {query, key, value},
+      [&](autograd::Context& ctx) {
+        return scaled_dot_product_attention_forward(ctx, query, key, value,
+                                                    mask, causal);
+      },
+      [&](autograd::Context& ctx, const Tensor& output) {
+        return attention_tangent(ctx, query, key, value, mask, output);
+      },
+      mask != nullptr ? TensorRefs{*mask} : TensorRefs{});
+}
+
+Tensor scaled_dot_product_attention(const Tensor& query, const Tensor& key,
+                                    const Tensor& value, const Tensor& mask) {
+  return attention(query, key, value, &mask, false);
+}
+
+Tensor scaled_dot_product_attention(const Tensor& query, const Tensor& key,
+                                    const Tensor& value, bool causal) {
+  return attention(query, key, value, nullptr, causal);
+}
+
+}  // namespace ember
@@ -0,0 +1,68 @@
+#include <ember/ops/scatter_add.h>
+#include <ember/ops/utils.h>
+
+#include <algorithm>
+#include <any>
+#include <stdexcept>
+#include <vector>
+
+namespace ember {
+
+Tensor scatter_add_forward(autograd::Context& ctx, const Tensor& input,
+                           std::ptrdiff_t axis, const Tensor& index,
+                           const Tensor& source) {
+  const auto& x = input.data_;
+  std::size_t resolved = normalize_axes({axis}, x.dimension())[0];
+  if (index.data_.shape() != source.data_.shape()) {
+    throw std::invalid_argument(
+        "scatter_add expects an index and a source of the same shape");
+  }
+  std::vector<std::size_t> offsets =
+      gather_offsets(x.shape(), resolved, index.data_);
+
+  // Positions named more than once are summed, so the source is added
+  // sequentially.
+  xt::xarray<double> output(x);
+  const double* src = source.data_.data();
+  for (std::size_t i = 0; i < offsets.size(); ++i) {
+    output.data()[offsets[i]] += src[i];
+  }
+
+  ctx.saved_data["offsets"] = std::move(offsets);
+  ctx.saved_data["source_shape"] = source.data_.shape();
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> scatter_add_backward(autograd::Context& ctx,
+                                         const Tensor& output_grad) {
+  const auto& offsets =
+      std::any_cast<const std::vector<std::size_t>&>(ctx.saved_data["offsets"]);
+  const auto& shape = std::any_cast<const xt::xarray<double>::shape_type&>(
+      ctx.saved_data["source_shape"]);
+  const double* g = output_grad.data_.data();
+  auto source_grad = xt::xarray<double>::from_shape(shape);
+  parallel::parallel_for(0, offsets.size(), parallel::kGrainSize,
+                         [&](std::size_t begin, std::size_t end) {
+                           for (std::size_t i = begin; i < end; ++i) {
+                             source_grad.data()[i] = g[offsets[i]];
+                           }
+                         });
+  return {output_grad, Tensor::from_xarray(std::move(source_grad))};
+}
+
+REGISTER_OP_BACKWARD(scatter_add, scatter_add_backward)
+
+Tensor scatter_add(const Tensor& input, std::ptrdiff_t axis,
+                   const Tensor& index, const Tensor& source) {
+  return apply_op<scatter_addBackward>(
+      "scatter_add", {input, source},
+      [&](autograd::Context& ctx) {
+        return scatter_add_forward(ctx, input, axis, index, source);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return scatter_add(tangent_of(input), axis, index, tangent_of(source));
+      },
+      {index});
+}
+
+}  // namespace ember
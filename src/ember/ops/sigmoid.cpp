@@ -0,0 +1,28 @@
+#include <ember/ops/sigmoid.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xmath.hpp>
+
+namespace ember {
+
+Tensor sigmoid_forward(autograd::Context& ctx, const Tensor& input) {
+  auto output = Tensor::from_xarray(
+      kernels::fast_math_enabled()
+          ? map_elementwise(input.data_, kernels::active().fast_sigmoid)
+          : map_expression(input.data_, [](const auto& x) {
+              return 1.0 / (1.0 + xt::exp(-x));
+            }));
+  ctx.save_for_backward(output);
+  return output;
+}
+
+std::vector<Tensor> sigmoid_backward(autograd::Context& ctx,
+                                     const Tensor& output_grad) {
+  // d/dx sigmoid(x) = sigmoid(x) * (1 - sigmoid(x))
+  const auto& output = ctx.saved_tensors[0].data_;
+  return {Tensor::from_xarray(
+      xt::eval(output_grad.data_ * output * (1.0 - output)))};
+}
+
+REGISTER_UNARY_OP(sigmoid, sigmoid_forward, sigmoid_backward)
+
+}  // namespace ember
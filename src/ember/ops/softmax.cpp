@@ -0,0 +1,49 @@
+#include <ember/ops/softmax.h>
+#include <ember/ops/utils.h>
+
+#include <any>
+
+namespace ember {
+
+Tensor softmax_forward(autograd::Context& ctx, const Tensor& input,
+                       std::ptrdiff_t axis) {
+  const auto& x = input.data_;
+  std::size_t resolved = normalize_axes({axis}, x.dimension())[0];
+  ReductionBlock block = make_reduction_block(x.shape(), resolved, resolved);
+
+  auto output = xt::xarray<double>::from_shape(x.shape());
+  softmax_block(x.data(), output.data(), block, false);
+
+  // The backward pass only needs the output, so the exponents aren't kept.
+  Tensor result = Tensor::from_xarray(std::move(output));
+  ctx.save_for_backward(result);
+  ctx.saved_data["block"] = block;
+  return result;
+}
+
+std::vector<Tensor> softmax_backward(autograd::Context& ctx,
+                                     const Tensor& output_grad) {
+  const auto& output = ctx.saved_tensors[0].data_;
+  auto grad = xt::xarray<double>::from_shape(output.shape());
+  softmax_grad_block(output.data(), output_grad.data_.data(), grad.data(),
+                     std::any_cast<ReductionBlock>(ctx.saved_data["block"]),
+                     false);
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(softmax, softmax_backward)
+
+Tensor softmax(const Tensor& input, std::ptrdiff_t axis) {
+  return apply_op<softmaxBackward>(
+      "softmax", {input},
+      [&](autograd::Context& ctx) {
+        return softmax_forward(ctx, input, axis);
+      },
+      // The Jacobian diag(s) - s s^T is symmetric, so the backward function
+      // also gives the tangent.
+      [&](autograd::Context& ctx, const Tensor& /*output*/) {
+        return softmax_backward(ctx, *input.tangent())[0];
+      });
+}
+
+}  // namespace ember
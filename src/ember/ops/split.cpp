@@ -0,0 +1,119 @@
+#include <ember/ops/split.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <any>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace ember {
+
+/**
+ * Returns the `size` slices of the input from `begin` along the axis, laid
+ * out as described by `block`.
+ */
+Tensor split_forward(autograd::Context& ctx, const Tensor& input,
+                     std::size_t axis, const ReductionBlock& block,
+                     std::size_t begin, std::size_t size) {
+  const auto& x = input.data_;
+  auto shape = x.shape();
+  shape[axis] = size;
+  auto output = xt::xarray<double>::from_shape(shape);
+  std::size_t run = size * block.inner;
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(run, 1));
+  parallel::parallel_for(
+      0, block.outer, grain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t o = first; o < last; ++o) {
+          const double* in =
+              x.data() + (o * block.size + begin) * block.inner;
+          std::copy(in, in + run, output.data() + o * run);
+        }
+      });
+
+  ctx.saved_data["input_shape"] = x.shape();
+  ctx.saved_data["block"] = block;
+  ctx.saved_data["begin"] = begin;
+  ctx.saved_data["size"] = size;
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> split_backward(autograd::Context& ctx,
+                                   const Tensor& output_grad) {
+  const auto& shape = std::any_cast<const xt::xarray<double>::shape_type&>(
+      ctx.saved_data["input_shape"]);
+  auto block = std::any_cast<ReductionBlock>(ctx.saved_data["block"]);
+  auto begin = std::any_cast<std::size_t>(ctx.saved_data["begin"]);
+  auto size = std::any_cast<std::size_t>(ctx.saved_data["size"]);
+
+  xt::xarray<double> grad = xt::zeros<double>(shape);
+  std::size_t run = size * block.inner;
+  const double* g = output_grad.data_.data();
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(run, 1));
+  parallel::parallel_for(
+      0, block.outer, grain, [&](std::size_t first, std::size_t last) {
+        for (std::size_t o = first; o < last; ++o) {
+          std::copy(g + o * run, g + (o + 1) * run,
+                    grad.data() + (o * block.size + begin) * block.inner);
+        }
+      });
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_OP_BACKWARD(split, split_backward)
+
+std::vector<Tensor> split(const Tensor& input,
+                          const std::vector<std::size_t>& sizes,
+                          std::ptrdiff_t axis) {
+  const auto& x = input.data_;
+  std::size_t resolved = normalize_axes({axis}, x.dimension())[0];
+  if (std::accumulate(sizes.begin(), sizes.end(), std::size_t{0}) !=
+      x.shape()[resolved]) {
+    throw std::invalid_argument(
+        "split expects sizes that add up to the size of the split axis");
+  }
+  ReductionBlock block = make_reduction_block(x.shape(), resolved, resolved);
+
+  std::vector<Tensor> pieces;
+  pieces.reserve(sizes.size());
+  std::size_t begin = 0;
+  for (std::size_t size : sizes) {
+    // Tensors are copied rather than moved, so each piece is computed into a
+    // tensor already in place.
+    apply_op_into<splitBackward>(
+        pieces.emplace_back(), "split", {input},
+        [&](autograd::Context& ctx) {
+          return split_forward(ctx, input, resolved, block, begin, size);
+        },
+        [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+          autograd::Context unused;
+          return split_forward(unused, *input.tangent(), resolved, block,
+                               begin, size);
+        });
+    begin += size;
+  }
+  return pieces;
+}
+
+std::vector<Tensor> chunk(const Tensor& input, std::size_t chunks,
+                          std::ptrdiff_t axis) {
+  if (chunks == 0) {
+    throw std::invalid_argument("chunk expects at least one chunk");
+  }
+  const auto& x = input.data_;
+  std::size_t length = x.shape()[normalize_axes({axis}, x.dimension())[0]];
+  std::size_t piece = (length + chunks - 1) / chunks;
+  std::vector<std::size_t> sizes;
+  for (std::size_t begin = 0; begin < length; begin += piece) {
+    sizes.push_back(std::min(piece, length - begin));
+  }
+  if (sizes.empty()) {
+    sizes.push_back(0);
+  }
+  return split(input, sizes, axis);
+}
+
+}  // namespace ember
@@ -0,0 +1,24 @@
+#include <ember/ops/sqrt.h>
+#include <ember/ops/utils.h>
+
+namespace ember {
+
+Tensor sqrt_forward(autograd::Context& ctx, const Tensor& input) {
+  auto output = Tensor::from_xarray(
+      map_elementwise(input.data_, kernels::active().sqrt));
+  ctx.save_for_backward(output);
+  return output;
+}
+
+std::vector<Tensor> sqrt_backward(autograd::Context& ctx,
+                                  const Tensor& output_grad) {
+  // d/dx sqrt(x) = 1 / (2 * sqrt(x))
+  xt::xarray<double> grad = apply_binary_kernel(
+      kernels::active().div, output_grad.data_, ctx.saved_tensors[0].data_);
+  grad *= 0.5;
+  return {Tensor::from_xarray(std::move(grad))};
+}
+
+REGISTER_UNARY_OP(sqrt, sqrt_forward, sqrt_backward)
+
+}  // namespace ember
@@ -12,7 +12,8 @@ static Tensor sub_forward(autograd::Context& context, const Tensor& minuend,
                           const Tensor& subtrahend) {
   context.save_for_backward(minuend);
   context.save_for_backward(subtrahend);
-  return Tensor::from_xarray(xt::eval(minuend.data_ - subtrahend.data_));
+  return Tensor::from_xarray(apply_binary_kernel(
+      kernels::active().sub, minuend.data_, subtrahend.data_));
 }
 
 /**
@@ -46,6 +47,12 @@ std::vector<Tensor> sub_backward(autograd::Context& context,
           Tensor::from_xarray(subtrahend_grad)};
 }
 
-REGISTER_BINARY_OP(sub, sub_forward, sub_backward);
+// The tangent of a - b is ta - tb.
+static Tensor sub_tangent(const Tensor& minuend, const Tensor& subtrahend,
+                          const Tensor& /*output*/) {
+  return tangent_of(minuend) - tangent_of(subtrahend);
+}
+
+REGISTER_BINARY_OP(sub, sub_forward, sub_backward, sub_tangent);
 
 }  // namespace ember
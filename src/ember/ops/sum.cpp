@@ -0,0 +1,47 @@
+#include <ember/ops/sum.h>
+#include <ember/ops/utils.h>
+
+#include <any>
+
+namespace ember {
+
+Tensor sum_forward(autograd::Context& ctx, const Tensor& input,
+                   const std::vector<std::ptrdiff_t>& axes, bool keepdims) {
+  auto reduced_axes = normalize_axes(axes, input.data_.dimension());
+  ctx.saved_data["input_shape"] = input.data_.shape();
+  ctx.saved_data["kept_shape"] =
+      reduced_shape(input.data_.shape(), reduced_axes, true);
+
+  xt::xarray<double> output = sum_over_axes(input.data_, reduced_axes);
+  output.reshape(reduced_shape(input.data_.shape(), reduced_axes, keepdims));
+  return Tensor::from_xarray(std::move(output));
+}
+
+std::vector<Tensor> sum_backward(autograd::Context& ctx,
+                                 const Tensor& output_grad) {
+  using shape_type = xt::xarray<double>::shape_type;
+  return {Tensor::from_xarray(broadcast_reduced(
+      output_grad.data_,
+      std::any_cast<shape_type>(ctx.saved_data["kept_shape"]),
+      std::any_cast<shape_type>(ctx.saved_data["input_shape"])))};
+}
+
+REGISTER_OP_BACKWARD(sum, sum_backward)
+
+Tensor sum(const Tensor& input, const std::vector<std::ptrdiff_t>& axes,
+           bool keepdims) {
+  return apply_op<sumBackward>(
+      "sum", {input},
+      [&](autograd::Context& ctx) {
+        return sum_forward(ctx, input, axes, keepdims);
+      },
+      [&](autograd::Context& /*ctx*/, const Tensor& /*output*/) {
+        return sum(*input.tangent(), axes, keepdims);
+      });
+}
+
+Tensor sum(const Tensor& input) {
+  return sum(input, all_axes(input.data_.dimension()));
+}
+
+}  // namespace ember
@@ -0,0 +1,27 @@
+#include <ember/ops/tanh.h>
+#include <ember/ops/utils.h>
+#include <xtensor/xmath.hpp>
+
+namespace ember {
+
+Tensor tanh_forward(autograd::Context& ctx, const Tensor& input) {
+  auto output = Tensor::from_xarray(
+      kernels::fast_math_enabled()
+          ? map_elementwise(input.data_, kernels::active().fast_tanh)
+          : map_expression(input.data_,
+                           [](const auto& x) { return xt::tanh(x); }));
+  ctx.save_for_backward(output);
+  return output;
+}
+
+std::vector<Tensor> tanh_backward(autograd::Context& ctx,
+                                  const Tensor& output_grad) {
+  // d/dx tanh(x) = 1 - tanh(x)^2
+  const auto& output = ctx.saved_tensors[0].data_;
+  return {Tensor::from_xarray(
+      xt::eval(output_grad.data_ * (1.0 - output * output)))};
+}
+
+REGISTER_UNARY_OP(tanh, tanh_forward, tanh_backward)
+
+}  // namespace ember
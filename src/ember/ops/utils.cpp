@@ -1,21 +1,30 @@
 #include "ember/ops/utils.h"
 
+#include <ember/autograd/per_sample.h>
+
+#include <ember/parallel/parallel.h>
+
+#include <xtensor-blas/xlinalg.hpp>
+#include <xtensor/xbroadcast.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xreducer.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace ember {
 
-/**
- * Reduces an xarray to a specified target shape by summing over dimensions
- * that were added during broadcasting.
- *
- * This function is used to revert an xarray from its broadcasted shape
- * back to its original shape by summing over the extra dimensions.
- *
- * @param broadcasted_array The xarray that has been broadcasted.
- * @param desired_shape The desired shape to reduce the xarray to.
- * @return A new xarray reduced to the target shape.
- * @throws std::invalid_argument if the target shape has more dimensions
- *         than the source shape.
- */
-xt::xarray<double> reduce_broadcast(
+namespace {
+
+// Sums the broadcast dimensions of `broadcasted_array` away, which gives an
+// array of `desired_shape`.
+xt::xarray<double> sum_to_shape(
     const xt::xarray<double>& broadcasted_array,
     const xt::xarray<double>::shape_type& desired_shape) {
   auto source_shape = broadcasted_array.shape();
@@ -36,15 +45,62 @@ xt::xarray<double> reduce_broadcast(
     aligned_shape[target_offset + i] = desired_shape[i];
   }
 
-  // Make a deep copy of the broadcasted array to perform the reduction.
-  xt::xarray<double> result = xt::eval(broadcasted_array);
+  // Leading dimensions that the desired shape doesn't have (or has as 1) are
+  // reduced by accumulating each contiguous row of the source into the result,
+  // which walks the source once in memory order.
+  std::size_t leading = 0;
+  while (leading < source_shape.size() && aligned_shape[leading] == 1) {
+    ++leading;
+  }
+  std::vector<std::size_t> row_shape(source_shape.begin() + leading,
+                                     source_shape.end());
+  xt::xarray<double> zeros = xt::zeros<double>(row_shape);
+  std::size_t row_size = zeros.size();
+  std::size_t num_rows =
+      row_size == 0 ? 0 : broadcasted_array.size() / row_size;
+  const double* source = broadcasted_array.data();
+  const kernels::KernelTable& k = kernels::active();
+
+  xt::xarray<double> result;
+  if (row_size >= parallel::kGrainSize || num_rows < 2) {
+    // Wide rows are split by column, with each thread summing every row of
+    // its columns in order.
+    result = zeros;
+    std::size_t grain_size = std::max<std::size_t>(
+        1, parallel::kGrainSize / std::max<std::size_t>(num_rows, 1));
+    parallel::parallel_for(
+        0, row_size, grain_size, [&](std::size_t begin, std::size_t end) {
+          for (std::size_t row = 0; row < num_rows; ++row) {
+            k.axpy(1.0, source + row * row_size + begin,
+                   result.data() + begin, end - begin);
+          }
+        });
+  } else {
+    // Otherwise the rows are split into chunks that are summed separately and
+    // then combined in a fixed order.
+    auto sum_rows = [&](std::size_t begin, std::size_t end) {
+      xt::xarray<double> partial = zeros;
+      for (std::size_t row = begin; row < end; ++row) {
+        k.axpy(1.0, source + row * row_size, partial.data(), row_size);
+      }
+      return partial;
+    };
+    auto add_partials = [&](xt::xarray<double> a, xt::xarray<double> b) {
+      k.axpy(1.0, b.data(), a.data(), a.size());
+      return a;
+    };
+    std::size_t grain_size =
+        std::max<std::size_t>(1, parallel::kGrainSize / row_size);
+    result = parallel::parallel_reduce(0, num_rows, grain_size, zeros,
+                                       sum_rows, add_partials);
+  }
 
-  // Determine which axes need to be summed over. These are the axes where
-  // the source shape differs from the aligned shape.
+  // Determine which of the remaining axes need to be summed over. These are
+  // the axes where the source shape differs from the aligned shape.
   std::vector<std::size_t> reduction_axes;
-  for (std::size_t i = 0; i < source_shape.size(); ++i) {
+  for (std::size_t i = leading; i < source_shape.size(); ++i) {
     if (source_shape[i] != aligned_shape[i]) {
-      reduction_axes.push_back(i);
+      reduction_axes.push_back(i - leading);
     }
   }
 
@@ -52,8 +108,893 @@ xt::xarray<double> reduce_broadcast(
   if (!reduction_axes.empty()) {
     result = xt::sum(result, reduction_axes);
   }
+  result.reshape(desired_shape);
+
+  return result;
+}
+
+}  // namespace
+
+/**
+ * Reduces an xarray to a specified target shape by summing over dimensions
+ * that were added during broadcasting.
+ *
+ * This function is used to revert an xarray from its broadcasted shape
+ * back to its original shape by summing over the extra dimensions.
+ *
+ * While per-sample gradients are computed (see `autograd::PerSampleState`),
+ * an array whose first axis is the batch is reduced to the desired shape for
+ * each sample instead, giving an array of shape (batch, desired shape...),
+ * unless the desired shape already has that first axis, or the array already
+ * has the desired shape (a batch of one sample, where nothing is reduced).
+ *
+ * @param broadcasted_array The xarray that has been broadcasted.
+ * @param desired_shape The desired shape to reduce the xarray to.
+ * @return A new xarray reduced to the target shape.
+ * @throws std::invalid_argument if the target shape has more dimensions
+ *         than the source shape.
+ */
+xt::xarray<double> reduce_broadcast(
+    const xt::xarray<double>& broadcasted_array,
+    const xt::xarray<double>::shape_type& desired_shape) {
+  const autograd::PerSampleState* per_sample = autograd::current_per_sample();
+  const auto& source_shape = broadcasted_array.shape();
+  if (per_sample == nullptr || source_shape.empty() ||
+      source_shape[0] != per_sample->batch_size ||
+      desired_shape.size() > source_shape.size() ||
+      (desired_shape.size() == source_shape.size() &&
+       (desired_shape[0] != 1 || std::equal(desired_shape.begin(),
+                                            desired_shape.end(),
+                                            source_shape.begin())))) {
+    return sum_to_shape(broadcasted_array, desired_shape);
+  }
+
+  // The first axis is kept, and each sample is reduced to the desired shape
+  // (without its leading 1 if it has one, e.g. for a (1, n) bias).
+  std::size_t skipped = desired_shape.size() == source_shape.size() ? 1 : 0;
+  xt::xarray<double>::shape_type aligned_shape(source_shape.size(), 1);
+  aligned_shape[0] = per_sample->batch_size;
+  std::copy(desired_shape.begin() + skipped, desired_shape.end(),
+            aligned_shape.end() - (desired_shape.size() - skipped));
+  xt::xarray<double> result = sum_to_shape(broadcasted_array, aligned_shape);
+
+  xt::xarray<double>::shape_type per_sample_shape(desired_shape.size() + 1);
+  per_sample_shape[0] = per_sample->batch_size;
+  std::copy(desired_shape.begin(), desired_shape.end(),
+            per_sample_shape.begin() + 1);
+  result.reshape(per_sample_shape);
+  return result;
+}
 
+xt::xarray<double> per_sample_outer(const xt::xarray<double>& x,
+                                    const xt::xarray<double>& g) {
+  std::size_t batch = x.shape()[0];
+  std::size_t m = x.shape()[1];
+  std::size_t n = g.shape()[1];
+  xt::xarray<double> result = xt::zeros<double>({batch, m, n});
+  const kernels::KernelTable& k = kernels::active();
+  parallel::parallel_for(
+      0, batch, std::max<std::size_t>(1, parallel::kGrainSize / (m * n + 1)),
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b = begin; b < end; ++b) {
+          for (std::size_t i = 0; i < m; ++i) {
+            k.axpy(x(b, i), g.data() + b * n, result.data() + (b * m + i) * n,
+                   n);
+          }
+        }
+      });
   return result;
 }
 
+/**
+ * Applies an element-wise kernel to two broadcast-compatible arrays.
+ *
+ * The output is treated as a sequence of rows, where a row is the largest
+ * block of trailing dimensions over which neither input is broadcast. Each
+ * row is contiguous in the output and in both inputs, so the kernel can be
+ * called once per row. When the last dimension itself is broadcast (e.g. a
+ * column vector against a matrix) the row is the last dimension, and the
+ * broadcast input's single value is repeated into a scratch row first.
+ *
+ * @throws std::runtime_error if the shapes cannot be broadcast together.
+ */
+xt::xarray<double> apply_binary_kernel(kernels::BinaryKernel kernel,
+                                       const xt::xarray<double>& a,
+                                       const xt::xarray<double>& b) {
+  if (a.shape() == b.shape()) {
+    auto out = xt::xarray<double>::from_shape(a.shape());
+    parallel::parallel_for(0, out.size(), parallel::kGrainSize,
+                           [&](std::size_t begin, std::size_t end) {
+                             kernel(a.data() + begin, b.data() + begin,
+                                    out.data() + begin, end - begin);
+                           });
+    return out;
+  }
+
+  // Align both shapes with the trailing dimensions of the output, giving each
+  // input a stride of 0 along the dimensions it is broadcast over.
+  std::size_t rank = std::max(a.dimension(), b.dimension());
+  std::vector<std::size_t> out_shape(rank, 1);
+  std::vector<std::size_t> a_strides(rank, 0);
+  std::vector<std::size_t> b_strides(rank, 0);
+  std::size_t a_stride = 1;
+  std::size_t b_stride = 1;
+  for (std::size_t i = rank; i-- > 0;) {
+    std::size_t a_dim = i + a.dimension() >= rank
+                            ? a.shape()[i + a.dimension() - rank]
+                            : 1;
+    std::size_t b_dim = i + b.dimension() >= rank
+                            ? b.shape()[i + b.dimension() - rank]
+                            : 1;
+    if (a_dim != b_dim && a_dim != 1 && b_dim != 1) {
+      throw std::runtime_error("Shapes cannot be broadcast together");
+    }
+    out_shape[i] = a_dim == 1 ? b_dim : a_dim;
+    a_strides[i] = a_dim == 1 ? 0 : a_stride;
+    b_strides[i] = b_dim == 1 ? 0 : b_stride;
+    a_stride *= a_dim;
+    b_stride *= b_dim;
+  }
+
+  auto out = xt::xarray<double>::from_shape(out_shape);
+  if (out.size() == 0) {
+    return out;
+  }
+
+  // Dimensions [split, rank) form a row.
+  std::size_t split = rank;
+  std::size_t row_size = 1;
+  auto broadcast_in = [&](std::size_t dim) {
+    return (a_strides[dim] == 0 || b_strides[dim] == 0) && out_shape[dim] != 1;
+  };
+  while (split > 0 && !broadcast_in(split - 1)) {
+    row_size *= out_shape[--split];
+  }
+  bool a_repeats = false;
+  bool b_repeats = false;
+  if (split == rank) {
+    split = rank - 1;
+    row_size = out_shape.back();
+    a_repeats = a_strides.back() == 0;
+    b_repeats = b_strides.back() == 0;
+  }
+
+  auto process_rows = [&](std::size_t begin, std::size_t end) {
+    // Find where the first row of this chunk starts in each input.
+    std::vector<std::size_t> index(split, 0);
+    std::size_t a_offset = 0;
+    std::size_t b_offset = 0;
+    for (std::size_t dim = split, rest = begin; dim-- > 0;) {
+      index[dim] = rest % out_shape[dim];
+      rest /= out_shape[dim];
+      a_offset += index[dim] * a_strides[dim];
+      b_offset += index[dim] * b_strides[dim];
+    }
+
+    std::vector<double> scratch(a_repeats || b_repeats ? row_size : 0);
+    for (std::size_t row = begin; row < end; ++row) {
+      const double* a_row = a.data() + a_offset;
+      const double* b_row = b.data() + b_offset;
+      if (a_repeats) {
+        std::fill(scratch.begin(), scratch.end(), *a_row);
+        a_row = scratch.data();
+      } else if (b_repeats) {
+        std::fill(scratch.begin(), scratch.end(), *b_row);
+        b_row = scratch.data();
+      }
+      kernel(a_row, b_row, out.data() + row * row_size, row_size);
+
+      // Advance to the next row, odometer style.
+      for (std::size_t dim = split; dim-- > 0;) {
+        a_offset += a_strides[dim];
+        b_offset += b_strides[dim];
+        if (++index[dim] < out_shape[dim]) {
+          break;
+        }
+        a_offset -= a_strides[dim] * out_shape[dim];
+        b_offset -= b_strides[dim] * out_shape[dim];
+        index[dim] = 0;
+      }
+    }
+  };
+  std::size_t grain_size =
+      std::max<std::size_t>(1, parallel::kGrainSize / row_size);
+  parallel::parallel_for(0, out.size() / row_size, grain_size, process_rows);
+
+  return out;
+}
+
+void accumulate(xt::xarray<double>& target, const xt::xarray<double>& source) {
+  if (target.shape() != source.shape()) {
+    throw std::invalid_argument(
+        "Cannot accumulate arrays with different shapes.");
+  }
+  const kernels::KernelTable& k = kernels::active();
+  parallel::parallel_for(0, target.size(), parallel::kGrainSize,
+                         [&](std::size_t begin, std::size_t end) {
+                           k.axpy(1.0, source.data() + begin,
+                                  target.data() + begin, end - begin);
+                         });
+}
+
+ReductionBlock make_reduction_block(const xt::xarray<double>::shape_type& shape,
+                                    std::size_t first_axis,
+                                    std::size_t last_axis) {
+  ReductionBlock block{1, 1, 1};
+  for (std::size_t axis = 0; axis < shape.size(); ++axis) {
+    if (axis < first_axis) {
+      block.outer *= shape[axis];
+    } else if (axis <= last_axis) {
+      block.size *= shape[axis];
+    } else {
+      block.inner *= shape[axis];
+    }
+  }
+  return block;
+}
+
+std::vector<std::size_t> normalize_axes(const std::vector<std::ptrdiff_t>& axes,
+                                        std::size_t ndim) {
+  std::vector<std::size_t> normalized;
+  normalized.reserve(axes.size());
+  for (std::ptrdiff_t axis : axes) {
+    std::ptrdiff_t resolved =
+        axis < 0 ? axis + static_cast<std::ptrdiff_t>(ndim) : axis;
+    if (resolved < 0 || resolved >= static_cast<std::ptrdiff_t>(ndim)) {
+      throw std::invalid_argument("Axis " + std::to_string(axis) +
+                                  " is out of range for a tensor with " +
+                                  std::to_string(ndim) + " dimensions.");
+    }
+    normalized.push_back(static_cast<std::size_t>(resolved));
+  }
+  std::sort(normalized.begin(), normalized.end());
+  if (std::adjacent_find(normalized.begin(), normalized.end()) !=
+      normalized.end()) {
+    throw std::invalid_argument("Cannot reduce over the same axis twice.");
+  }
+  return normalized;
+}
+
+std::vector<std::ptrdiff_t> all_axes(std::size_t ndim) {
+  std::vector<std::ptrdiff_t> axes(ndim);
+  std::iota(axes.begin(), axes.end(), 0);
+  return axes;
+}
+
+xt::xarray<double>::shape_type reduced_shape(
+    const xt::xarray<double>::shape_type& shape,
+    const std::vector<std::size_t>& axes, bool keepdims) {
+  std::vector<std::size_t> result;
+  auto next_axis = axes.begin();
+  for (std::size_t axis = 0; axis < shape.size(); ++axis) {
+    if (next_axis != axes.end() && *next_axis == axis) {
+      ++next_axis;
+      if (keepdims) {
+        result.push_back(1);
+      }
+    } else {
+      result.push_back(shape[axis]);
+    }
+  }
+  return xt::xarray<double>::shape_type(result.begin(), result.end());
+}
+
+/**
+ * Both reductions below produce `outer * inner` results. When there are at
+ * least as many results as threads, each thread computes a contiguous range of
+ * them. Otherwise (e.g. when reducing a whole tensor to a single value) the
+ * reduced dimension is split between the threads instead, and their partial
+ * results are combined in a fixed order.
+ *
+ * Within a range, the reduced dimension is walked in memory order: each row of
+ * `inner` elements is folded into the running results with one kernel call, and
+ * when `inner` is 1 the kernel reduces the whole contiguous row at once.
+ */
+void sum_block(const double* in, double* out, const ReductionBlock& block) {
+  const kernels::KernelTable& k = kernels::active();
+  auto [outer, size, inner] = block;
+  std::size_t outputs = outer * inner;
+  if (outputs == 0) {
+    return;
+  }
+
+  // Sums positions [r_begin, r_end) of the reduced dimension into results
+  // [begin, end).
+  auto sum_range = [&](double* result, std::size_t begin, std::size_t end,
+                       std::size_t r_begin, std::size_t r_end) {
+    if (inner == 1) {
+      for (std::size_t o = begin; o < end; ++o) {
+        result[o] = k.sum(in + o * size + r_begin, r_end - r_begin);
+      }
+      return;
+    }
+    std::fill(result + begin, result + end, 0.0);
+    for (std::size_t o = begin / inner; o * inner < end; ++o) {
+      std::size_t col_begin = std::max(begin, o * inner) - o * inner;
+      std::size_t col_end = std::min(end, (o + 1) * inner) - o * inner;
+      for (std::size_t r = r_begin; r < r_end; ++r) {
+        k.axpy(1.0, in + (o * size + r) * inner + col_begin,
+               result + o * inner + col_begin, col_end - col_begin);
+      }
+    }
+  };
+
+  if (outputs >= get_num_threads() || size < 2) {
+    std::size_t grain_size = std::max<std::size_t>(
+        1, parallel::kGrainSize / std::max<std::size_t>(size, 1));
+    parallel::parallel_for(0, outputs, grain_size,
+                           [&](std::size_t begin, std::size_t end) {
+                             sum_range(out, begin, end, 0, size);
+                           });
+    return;
+  }
+
+  auto partial_sums = [&](std::size_t r_begin, std::size_t r_end) {
+    std::vector<double> partial(outputs);
+    sum_range(partial.data(), 0, outputs, r_begin, r_end);
+    return partial;
+  };
+  auto add_partials = [&](std::vector<double> a, std::vector<double> b) {
+    k.axpy(1.0, b.data(), a.data(), outputs);
+    return a;
+  };
+  std::size_t grain_size =
+      std::max<std::size_t>(1, parallel::kGrainSize / outputs);
+  std::vector<double> total = parallel::parallel_reduce(
+      0, size, grain_size, std::vector<double>(outputs, 0.0), partial_sums,
+      add_partials);
+  std::copy(total.begin(), total.end(), out);
+}
+
+void extreme_block(const double* in, double* best, std::size_t* index,
+                   const ReductionBlock& block, bool largest) {
+  const kernels::KernelTable& k = kernels::active();
+  auto [outer, size, inner] = block;
+  if (size == 0) {
+    throw std::invalid_argument(
+        "Cannot find the largest or smallest element of an empty dimension.");
+  }
+  std::size_t outputs = outer * inner;
+  if (outputs == 0) {
+    return;
+  }
+  kernels::ArgReduceKernel arg_reduce = largest ? k.argmax : k.argmin;
+  kernels::ArgUpdateKernel arg_update = largest ? k.max_update : k.min_update;
+
+  // Finds the extremes of positions [r_begin, r_end) of the reduced dimension
+  // for results [begin, end).
+  auto extreme_range = [&](double* best_out, std::size_t* index_out,
+                           std::size_t begin, std::size_t end,
+                           std::size_t r_begin, std::size_t r_end) {
+    if (inner == 1) {
+      for (std::size_t o = begin; o < end; ++o) {
+        const double* row = in + o * size;
+        index_out[o] = r_begin + arg_reduce(row + r_begin, r_end - r_begin);
+        best_out[o] = row[index_out[o]];
+      }
+      return;
+    }
+    for (std::size_t o = begin / inner; o * inner < end; ++o) {
+      std::size_t col_begin = std::max(begin, o * inner) - o * inner;
+      std::size_t col_end = std::min(end, (o + 1) * inner) - o * inner;
+      std::size_t n = col_end - col_begin;
+      double* best_row = best_out + o * inner + col_begin;
+      std::size_t* index_row = index_out + o * inner + col_begin;
+      std::copy_n(in + (o * size + r_begin) * inner + col_begin, n, best_row);
+      std::fill_n(index_row, n, r_begin);
+      for (std::size_t r = r_begin + 1; r < r_end; ++r) {
+        arg_update(in + (o * size + r) * inner + col_begin, best_row,
+                   index_row, r, n);
+      }
+    }
+  };
+
+  if (outputs >= get_num_threads() || size < 2) {
+    std::size_t grain_size =
+        std::max<std::size_t>(1, parallel::kGrainSize / size);
+    parallel::parallel_for(0, outputs, grain_size,
+                           [&](std::size_t begin, std::size_t end) {
+                             extreme_range(best, index, begin, end, 0, size);
+                           });
+    return;
+  }
+
+  struct Partial {
+    std::vector<double> best;
+    std::vector<std::size_t> index;
+  };
+  auto partial_extremes = [&](std::size_t r_begin, std::size_t r_end) {
+    Partial partial{std::vector<double>(outputs),
+                    std::vector<std::size_t>(outputs)};
+    extreme_range(partial.best.data(), partial.index.data(), 0, outputs,
+                  r_begin, r_end);
+    return partial;
+  };
+  // `b` always covers later positions than `a`, so it only wins strictly.
+  auto combine_partials = [&](Partial a, Partial b) {
+    for (std::size_t i = 0; i < outputs; ++i) {
+      bool b_is_nan = std::isnan(b.best[i]);
+      bool a_is_nan = std::isnan(a.best[i]);
+      bool b_wins = largest ? b.best[i] > a.best[i] : b.best[i] < a.best[i];
+      if (b_wins || (b_is_nan && !a_is_nan)) {
+        a.best[i] = b.best[i];
+        a.index[i] = b.index[i];
+      }
+    }
+    return a;
+  };
+  std::size_t grain_size =
+      std::max<std::size_t>(1, parallel::kGrainSize / outputs);
+  Partial total = parallel::parallel_reduce(
+      0, size, grain_size, Partial{}, partial_extremes, combine_partials);
+  std::copy(total.best.begin(), total.best.end(), best);
+  std::copy(total.index.begin(), total.index.end(), index);
+}
+
+xt::xarray<double> reduce_over_axes(
+    const xt::xarray<double>& input, const std::vector<std::size_t>& axes,
+    const std::function<void(const double*, double*, const ReductionBlock&)>&
+        reduce_block) {
+  if (axes.empty()) {
+    return input;
+  }
+  xt::xarray<double> result;
+  const xt::xarray<double>* source = &input;
+  for (std::size_t end = axes.size(); end > 0;) {
+    std::size_t begin = end - 1;
+    while (begin > 0 && axes[begin - 1] + 1 == axes[begin]) {
+      --begin;
+    }
+    ReductionBlock block =
+        make_reduction_block(source->shape(), axes[begin], axes[end - 1]);
+    xt::xarray<double>::shape_type shape = source->shape();
+    for (std::size_t i = begin; i < end; ++i) {
+      shape[axes[i]] = 1;
+    }
+    auto reduced = xt::xarray<double>::from_shape(shape);
+    reduce_block(source->data(), reduced.data(), block);
+    result = std::move(reduced);
+    source = &result;
+    end = begin;
+  }
+  return result;
+}
+
+xt::xarray<double> sum_over_axes(const xt::xarray<double>& input,
+                                 const std::vector<std::size_t>& axes) {
+  return reduce_over_axes(input, axes, sum_block);
+}
+
+/**
+ * Returns the block for reducing an array of the given shape over `axes`, which
+ * must be contiguous.
+ */
+static ReductionBlock contiguous_block(
+    const xt::xarray<double>::shape_type& shape,
+    const std::vector<std::size_t>& axes) {
+  if (axes.empty()) {
+    std::size_t size = std::accumulate(shape.begin(), shape.end(),
+                                       std::size_t{1}, std::multiplies<>());
+    return ReductionBlock{size, 1, 1};
+  }
+  if (axes.back() - axes.front() + 1 != axes.size()) {
+    throw std::invalid_argument("The reduced axes must be contiguous.");
+  }
+  return make_reduction_block(shape, axes.front(), axes.back());
+}
+
+xt::xarray<double> extreme_over_axes(const xt::xarray<double>& input,
+                                     const std::vector<std::size_t>& axes,
+                                     bool largest,
+                                     std::vector<std::size_t>& indices) {
+  ReductionBlock block = contiguous_block(input.shape(), axes);
+  auto result =
+      xt::xarray<double>::from_shape(reduced_shape(input.shape(), axes, true));
+  indices.resize(result.size());
+  extreme_block(input.data(), result.data(), indices.data(), block, largest);
+  return result;
+}
+
+xt::xarray<double> scatter_extremes(
+    const xt::xarray<double>& grad, const std::vector<std::size_t>& indices,
+    const std::vector<std::size_t>& axes,
+    const xt::xarray<double>::shape_type& input_shape) {
+  auto [outer, size, inner] = contiguous_block(input_shape, axes);
+  xt::xarray<double> result = xt::zeros<double>(input_shape);
+  parallel::parallel_for(
+      0, indices.size(), parallel::kGrainSize,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          std::size_t o = i / inner;
+          result.data()[(o * size + indices[i]) * inner + i % inner] =
+              grad.data()[i];
+        }
+      });
+  return result;
+}
+
+xt::xarray<double> gather_extremes(const xt::xarray<double>& input,
+                                   const std::vector<std::size_t>& indices,
+                                   const std::vector<std::size_t>& axes) {
+  auto [outer, size, inner] = contiguous_block(input.shape(), axes);
+  auto result =
+      xt::xarray<double>::from_shape(reduced_shape(input.shape(), axes, true));
+  parallel::parallel_for(
+      0, indices.size(), parallel::kGrainSize,
+      [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          std::size_t o = i / inner;
+          result.data()[i] =
+              input.data()[(o * size + indices[i]) * inner + i % inner];
+        }
+      });
+  return result;
+}
+
+xt::xarray<double> broadcast_reduced(
+    const xt::xarray<double>& grad,
+    const xt::xarray<double>::shape_type& kept_shape,
+    const xt::xarray<double>::shape_type& input_shape) {
+  xt::xarray<double> kept = grad;
+  kept.reshape(kept_shape);
+  return xt::broadcast(kept, input_shape);
+}
+
+Moments compute_moments(const double* x, std::size_t n) {
+  Moments result;
+  result.count = static_cast<double>(n);
+  kernels::active().moments(x, n, &result.mean, &result.m2);
+  return result;
+}
+
+Moments merge_moments(const Moments& a, const Moments& b) {
+  if (a.count == 0.0) {
+    return b;
+  }
+  if (b.count == 0.0) {
+    return a;
+  }
+  Moments result;
+  result.count = a.count + b.count;
+  double delta = b.mean - a.mean;
+  result.mean = a.mean + delta * (b.count / result.count);
+  result.m2 = a.m2 + b.m2 + delta * delta * (a.count * b.count / result.count);
+  return result;
+}
+
+void exp_in_place(double* values, std::size_t n) {
+  if (kernels::fast_math_enabled()) {
+    kernels::active().fast_exp(values, values, n);
+    return;
+  }
+  std::array<std::size_t, 1> shape = {n};
+  auto chunk = xt::adapt(values, n, xt::no_ownership(), shape);
+  chunk = xt::exp(chunk);
+}
+
+void sigmoid_in_place(double* values, std::size_t n) {
+  if (kernels::fast_math_enabled()) {
+    kernels::active().fast_sigmoid(values, values, n);
+    return;
+  }
+  std::array<std::size_t, 1> shape = {n};
+  auto chunk = xt::adapt(values, n, xt::no_ownership(), shape);
+  chunk = 1.0 / (1.0 + xt::exp(-chunk));
+}
+
+void tanh_in_place(double* values, std::size_t n) {
+  if (kernels::fast_math_enabled()) {
+    kernels::active().fast_tanh(values, values, n);
+    return;
+  }
+  std::array<std::size_t, 1> shape = {n};
+  auto chunk = xt::adapt(values, n, xt::no_ownership(), shape);
+  chunk = xt::tanh(chunk);
+}
+
+/**
+ * Calls `fn(o, col_begin, col_end)` for ranges of the `outer * inner` lanes of
+ * a block, where each range is columns [col_begin, col_end) of outer index o.
+ * The lanes are split across threads, each lane doing `size` elements of work.
+ */
+static void for_each_lane_range(
+    const ReductionBlock& block,
+    const std::function<void(std::size_t, std::size_t, std::size_t)>& fn) {
+  auto [outer, size, inner] = block;
+  std::size_t grain_size = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(size, 1));
+  parallel::parallel_for(
+      0, outer * inner, grain_size, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t o = begin / inner; o * inner < end; ++o) {
+          fn(o, std::max(begin, o * inner) - o * inner,
+             std::min(end, (o + 1) * inner) - o * inner);
+        }
+      });
+}
+
+/**
+ * Each lane is processed on its own, which for the common case of a softmax
+ * over the last axis is a single contiguous row: its largest element is found,
+ * then the shifted exponents are written, summed and normalized in place. A
+ * row of a classifier's logits fits in cache, so every pass after the first
+ * reads from cache rather than memory.
+ */
+void softmax_block(const double* in, double* out, const ReductionBlock& block,
+                   bool log) {
+  const kernels::KernelTable& k = kernels::active();
+  auto [outer, size, inner] = block;
+  if (size == 0) {
+    return;
+  }
+  for_each_lane_range(block, [&](std::size_t o, std::size_t col_begin,
+                                 std::size_t col_end) {
+    std::size_t width = col_end - col_begin;
+    const double* x = in + o * size * inner + col_begin;
+    double* y = out + o * size * inner + col_begin;
+
+    // Shift each lane by its largest element so that the largest exponent is
+    // e^0. As in `logsumexp`, lanes whose largest element is infinite or NaN
+    // aren't shifted, which lets the infinity or NaN through.
+    std::vector<double> shift(x, x + width);
+    for (std::size_t r = 1; r < size; ++r) {
+      for (std::size_t c = 0; c < width; ++c) {
+        double value = x[r * inner + c];
+        if (value > shift[c] || std::isnan(value)) {
+          shift[c] = value;
+        }
+      }
+    }
+    for (double& value : shift) {
+      value = std::isfinite(value) ? value : 0.0;
+    }
+
+    std::vector<double> total(width, 0.0);
+    if (inner == 1) {
+      for (std::size_t r = 0; r < size; ++r) {
+        y[r] = x[r] - shift[0];
+      }
+      exp_in_place(y, size);
+      total[0] = k.sum(y, size);
+    } else {
+      for (std::size_t r = 0; r < size; ++r) {
+        for (std::size_t c = 0; c < width; ++c) {
+          y[r * inner + c] = x[r * inner + c] - shift[c];
+        }
+        exp_in_place(y + r * inner, width);
+        k.axpy(1.0, y + r * inner, total.data(), width);
+      }
+    }
+
+    if (log) {
+      // log(e^{x - shift} / total) = x - (shift + log(total))
+      for (std::size_t c = 0; c < width; ++c) {
+        shift[c] += std::log(total[c]);
+      }
+      for (std::size_t r = 0; r < size; ++r) {
+        for (std::size_t c = 0; c < width; ++c) {
+          y[r * inner + c] = x[r * inner + c] - shift[c];
+        }
+      }
+    } else {
+      for (std::size_t r = 0; r < size; ++r) {
+        for (std::size_t c = 0; c < width; ++c) {
+          y[r * inner + c] /= total[c];
+        }
+      }
+    }
+  });
+}
+
+void softmax_grad_block(const double* output, const double* grad,
+                        double* out, const ReductionBlock& block, bool log) {
+  const kernels::KernelTable& k = kernels::active();
+  auto [outer, size, inner] = block;
+  if (size == 0) {
+    return;
+  }
+  for_each_lane_range(block, [&](std::size_t o, std::size_t col_begin,
+                                 std::size_t col_end) {
+    std::size_t width = col_end - col_begin;
+    std::size_t offset = o * size * inner + col_begin;
+    const double* y = output + offset;
+    const double* g = grad + offset;
+    double* dx = out + offset;
+
+    // softmax:     dx = y * (g - sum(g * y))
+    // log-softmax: dx = g - e^y * sum(g)
+    std::vector<double> total(width, 0.0);
+    for (std::size_t r = 0; r < size; ++r) {
+      if (log) {
+        std::copy(y + r * inner, y + r * inner + width, dx + r * inner);
+        exp_in_place(dx + r * inner, width);
+      } else {
+        k.mul(g + r * inner, y + r * inner, dx + r * inner, width);
+      }
+    }
+    const double* summed = log ? g : dx;
+    if (inner == 1) {
+      total[0] = k.sum(summed, size);
+    } else {
+      for (std::size_t r = 0; r < size; ++r) {
+        k.axpy(1.0, summed + r * inner, total.data(), width);
+      }
+    }
+    for (std::size_t r = 0; r < size; ++r) {
+      for (std::size_t c = 0; c < width; ++c) {
+        std::size_t i = r * inner + c;
+        dx[i] = log ? g[i] - dx[i] * total[c] : dx[i] - y[i] * total[c];
+      }
+    }
+  });
+}
+
+Window2d make_window_2d(std::size_t height, std::size_t width,
+                        const std::array<std::size_t, 2>& kernel,
+                        const std::array<std::size_t, 2>& stride,
+                        const std::array<std::size_t, 2>& padding,
+                        const std::array<std::size_t, 2>& dilation) {
+  Window2d window{{height, width}, kernel, stride, padding, dilation, {0, 0}};
+  for (std::size_t axis = 0; axis < 2; ++axis) {
+    if (kernel[axis] == 0 || stride[axis] == 0 || dilation[axis] == 0) {
+      throw std::invalid_argument(
+          "The kernel size, stride and dilation must be positive");
+    }
+    std::size_t span = dilation[axis] * (kernel[axis] - 1) + 1;
+    std::size_t padded = window.input[axis] + 2 * padding[axis];
+    if (span > padded) {
+      throw std::invalid_argument(
+          "The kernel spans " + std::to_string(span) +
+          " elements but the padded input only has " + std::to_string(padded));
+    }
+    window.output[axis] = (padded - span) / stride[axis] + 1;
+  }
+  return window;
+}
+
+std::array<std::size_t, 2> window_range(const Window2d& window,
+                                        std::size_t axis, std::size_t k) {
+  auto stride = static_cast<std::ptrdiff_t>(window.stride[axis]);
+  auto input = static_cast<std::ptrdiff_t>(window.input[axis]);
+  auto output = static_cast<std::ptrdiff_t>(window.output[axis]);
+  std::ptrdiff_t offset =
+      static_cast<std::ptrdiff_t>(k * window.dilation[axis]) -
+      static_cast<std::ptrdiff_t>(window.padding[axis]);
+  // o * stride + offset >= 0 and o * stride + offset < input
+  std::ptrdiff_t first = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+  std::ptrdiff_t last =
+      input - offset <= 0 ? 0 : (input - offset - 1) / stride + 1;
+  last = std::min(last, output);
+  first = std::min(first, last);
+  return {static_cast<std::size_t>(first), static_cast<std::size_t>(last)};
+}
+
+Window2d make_pool_window(
+    const xt::xarray<double>& input, const std::array<std::size_t, 2>& kernel,
+    const std::optional<std::array<std::size_t, 2>>& stride,
+    const std::array<std::size_t, 2>& padding) {
+  if (input.dimension() != 4) {
+    throw std::invalid_argument(
+        "Pooling expects an input of shape (batch, channels, height, width)");
+  }
+  if (2 * padding[0] > kernel[0] || 2 * padding[1] > kernel[1]) {
+    throw std::invalid_argument(
+        "The padding can be at most half of the kernel size");
+  }
+  return make_window_2d(input.shape()[2], input.shape()[3], kernel,
+                        stride.value_or(kernel), padding, {1, 1});
+}
+
+std::vector<std::size_t> index_values(const xt::xarray<double>& index,
+                                      std::size_t size) {
+  std::vector<std::size_t> values(index.size());
+  for (std::size_t i = 0; i < index.size(); ++i) {
+    double value = index.data()[i];
+    if (!(value >= 0.0 && value < static_cast<double>(size)) ||
+        value != std::floor(value)) {
+      throw std::invalid_argument("Index " + std::to_string(value) +
+                                  " is out of range for a dimension of size " +
+                                  std::to_string(size));
+    }
+    values[i] = static_cast<std::size_t>(value);
+  }
+  return values;
+}
+
+std::vector<std::size_t> gather_offsets(
+    const xt::xarray<double>::shape_type& shape, std::size_t axis,
+    const xt::xarray<double>& index) {
+  std::size_t ndim = shape.size();
+  if (index.dimension() != ndim) {
+    throw std::invalid_argument(
+        "The index must have as many dimensions as the tensor it indexes");
+  }
+  for (std::size_t d = 0; d < ndim; ++d) {
+    if (d != axis && index.shape()[d] > shape[d]) {
+      throw std::invalid_argument(
+          "The index is larger than the tensor it indexes along axis " +
+          std::to_string(d));
+    }
+  }
+  std::vector<std::size_t> values = index_values(index, shape[axis]);
+  std::vector<std::size_t> strides(ndim, 1);
+  for (std::size_t d = ndim; d-- > 1;) {
+    strides[d - 1] = strides[d] * shape[d];
+  }
+
+  // The position of the current element of the index, and the offset of the
+  // element at that position in the array, ignoring `axis`.
+  std::vector<std::size_t> position(ndim, 0);
+  std::size_t base = 0;
+  std::vector<std::size_t> offsets(index.size());
+  for (std::size_t i = 0; i < index.size(); ++i) {
+    offsets[i] = base + values[i] * strides[axis];
+    for (std::size_t d = ndim; d-- > 0;) {
+      std::size_t step = d == axis ? 0 : strides[d];
+      if (++position[d] < index.shape()[d]) {
+        base += step;
+        break;
+      }
+      base -= step * (position[d] - 1);
+      position[d] = 0;
+    }
+  }
+  return offsets;
+}
+
+SparseRows selected_rows_grad(const xt::xarray<double>::shape_type& shape,
+                              std::vector<std::size_t> rows,
+                              const xt::xarray<double>& grad) {
+  SparseRows result;
+  result.shape.assign(shape.begin(), shape.end());
+  std::vector<std::size_t> values_shape(result.shape);
+  values_shape[0] = rows.size();
+  result.values = xt::xarray<double>::from_shape(values_shape);
+  std::copy(grad.begin(), grad.end(), result.values.begin());
+  result.indices = std::move(rows);
+  result.coalesce();
+  return result;
+}
+
+void check_dense(const TensorRefs& inputs, const std::string& op,
+                 SparseInputs sparse) {
+  for (std::size_t i = 0; i < inputs.size(); ++i) {
+    const Tensor& input = inputs[i];
+    bool allowed = sparse == SparseInputs::CsrFirst && i == 0;
+    if (input.is_sparse() || (input.is_csr() && !allowed)) {
+      throw std::invalid_argument(
+          op + " expects dense tensors; use to_dense() to convert sparse ones");
+    }
+  }
+}
+
+bool needs_tangent(const TensorRefs& inputs) {
+  if (!autograd::is_forward_grad_enabled()) {
+    return false;
+  }
+  return std::any_of(inputs.begin(), inputs.end(), [](const Tensor& input) {
+    return input.tangent() != nullptr;
+  });
+}
+
+xt::xarray<double> product_tangent(const Tensor& x, const Tensor& w) {
+  std::size_t inner = w.data_.shape()[0];
+  std::size_t rows = inner == 0 ? 0 : x.data_.size() / inner;
+  xt::xarray<double> tangent = xt::zeros<double>(
+      std::vector<std::size_t>{rows, w.data_.shape()[1]});
+  if (const Tensor* tx = x.tangent()) {
+    tangent += xt::linalg::dot(matrix(tx->data_.data(), rows, inner), w.data_);
+  }
+  if (const Tensor* tw = w.tangent()) {
+    tangent += xt::linalg::dot(matrix(x.data_.data(), rows, inner), tw->data_);
+  }
+  return tangent;
+}
+
+Tensor tangent_of(const Tensor& input) {
+  if (const Tensor* tangent = input.tangent()) {
+    return *tangent;
+  }
+  return Tensor::zeros_like(input);
+}
+
 }  // namespace ember
@@ -0,0 +1,45 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/optim/adam.h>
+
+#include <cmath>
+#include <stdexcept>
+
+namespace ember::optim {
+
+Adam::Adam(const std::vector<Tensor*>& parameters, double lr, double beta1,
+           double beta2, double eps, double weight_decay)
+    : Adam(parameters, lr, beta1, beta2, eps, weight_decay, false) {}
+
+Adam::Adam(const std::vector<Tensor*>& parameters, double lr, double beta1,
+           double beta2, double eps, double weight_decay, bool decoupled)
+    : Optimizer(parameters), lr_(lr), beta1_(beta1), beta2_(beta2),
+      eps_(eps), weight_decay_(weight_decay), decoupled_(decoupled),
+      m_(this->parameters().size()), v_(this->parameters().size()) {
+  if (lr < 0.0 || eps < 0.0 || weight_decay < 0.0) {
+    throw std::invalid_argument(
+        "Adam's learning rate, epsilon and weight decay can't be negative");
+  }
+  if (!(beta1 >= 0.0 && beta1 < 1.0 && beta2 >= 0.0 && beta2 < 1.0)) {
+    throw std::invalid_argument("Adam's betas must be in [0, 1)");
+  }
+  for (std::size_t i = 0; i < m_.size(); ++i) {
+    m_[i].assign(numel(i), 0.0);
+    v_[i].assign(numel(i), 0.0);
+  }
+}
+
+void Adam::update(std::size_t index, std::size_t offset, double* values,
+                  const double* grad, std::size_t n) {
+  double t = static_cast<double>(steps(index));
+  kernels::active().adam(values, grad, m_[index].data() + offset,
+                         v_[index].data() + offset, n,
+                         {lr_, beta1_, beta2_, eps_, weight_decay_,
+                          decoupled_, 1.0 - std::pow(beta1_, t),
+                          1.0 - std::pow(beta2_, t)});
+}
+
+AdamW::AdamW(const std::vector<Tensor*>& parameters, double lr, double beta1,
+             double beta2, double eps, double weight_decay)
+    : Adam(parameters, lr, beta1, beta2, eps, weight_decay, true) {}
+
+}  // namespace ember::optim
@@ -0,0 +1,166 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/optim/optimizer.h>
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace ember::optim {
+
+namespace {
+
+// A contiguous range of the values of one parameter, and its gradient.
+struct Slice {
+  std::size_t index;
+  std::size_t offset;
+  double* values;
+  const double* grad;
+  std::size_t n;
+};
+
+double* values_of(Tensor& parameter) {
+  return parameter.is_csr() ? parameter.csr().values.data()
+                            : parameter.data_.data();
+}
+
+// Returns the shape of `tensor` as a dense tensor.
+std::vector<std::size_t> dense_shape(const Tensor& tensor) {
+  if (tensor.is_sparse()) {
+    return tensor.sparse_rows().shape;
+  }
+  if (tensor.is_csr()) {
+    return {tensor.csr().rows, tensor.csr().cols};
+  }
+  return {tensor.data_.shape().begin(), tensor.data_.shape().end()};
+}
+
+// Sets `out` to the gradient of a parameter in the layout of its values.
+void densify(const Tensor& parameter, const Tensor& gradient,
+             std::vector<double>& out) {
+  if (dense_shape(gradient) != dense_shape(parameter)) {
+    throw std::invalid_argument(
+        "A gradient must have the shape of its parameter");
+  }
+  if (!parameter.is_csr()) {
+    out.assign(parameter.data_.size(), 0.0);
+    if (gradient.is_sparse()) {
+      const SparseRows& rows = gradient.sparse_rows();
+      std::size_t row_size = rows.row_size();
+      for (std::size_t r = 0; r < rows.indices.size(); ++r) {
+        kernels::active().axpy(1.0, rows.values.data() + r * row_size,
+                               out.data() + rows.indices[r] * row_size,
+                               row_size);
+      }
+    } else {
+      xt::xarray<double> dense = gradient.to_dense().data_;
+      std::copy(dense.begin(), dense.end(), out.begin());
+    }
+    return;
+  }
+  // Only the gradients of the stored elements of a CSR parameter are used.
+  const CsrMatrix& pattern = parameter.csr();
+  xt::xarray<double> dense = gradient.to_dense().data_;
+  out.resize(pattern.nnz());
+  for (std::size_t r = 0; r < pattern.rows; ++r) {
+    for (std::size_t k = pattern.row_offsets[r];
+         k < pattern.row_offsets[r + 1]; ++k) {
+      out[k] = dense.data()[r * pattern.cols + pattern.columns[k]];
+    }
+  }
+}
+
+}  // namespace
+
+Optimizer::Optimizer(const std::vector<Tensor*>& parameters)
+    : steps_(parameters.size(), 0), scratch_(parameters.size()) {
+  for (Tensor* parameter : parameters) {
+    if (parameter == nullptr) {
+      throw std::invalid_argument("An optimizer can't update a null tensor");
+    }
+    if (parameter->is_sparse()) {
+      throw std::invalid_argument(
+          "An optimizer can't update a row-sparse tensor");
+    }
+    if (std::find(parameters_.begin(), parameters_.end(), parameter) !=
+        parameters_.end()) {
+      throw std::invalid_argument(
+          "A parameter was given to an optimizer twice");
+    }
+    parameters_.push_back(parameter);
+  }
+}
+
+std::size_t Optimizer::numel(std::size_t i) const {
+  const Tensor* parameter = parameters_[i];
+  return parameter->is_csr() ? parameter->csr().nnz()
+                             : parameter->data_.size();
+}
+
+void Optimizer::step() {
+  std::vector<Slice> slices;
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < parameters_.size(); ++i) {
+    Tensor& parameter = *parameters_[i];
+    if (parameter.gradient == nullptr) {
+      continue;
+    }
+    const Tensor& gradient = *parameter.gradient;
+    std::size_t size = numel(i);
+    const double* grad = nullptr;
+    if (parameter.is_csr() && gradient.is_csr() &&
+        gradient.csr().row_offsets == parameter.csr().row_offsets &&
+        gradient.csr().columns == parameter.csr().columns) {
+      grad = gradient.csr().values.data();
+    } else if (!parameter.is_csr() && !gradient.is_sparse() &&
+               !gradient.is_csr() &&
+               gradient.data_.shape() == parameter.data_.shape()) {
+      grad = gradient.data_.data();
+    } else {
+      densify(parameter, gradient, scratch_[i]);
+      grad = scratch_[i].data();
+    }
+    steps_[i] += 1;
+    double* values = values_of(parameter);
+    for (std::size_t offset = 0; offset < size;
+         offset += parallel::kGrainSize) {
+      std::size_t n = std::min(parallel::kGrainSize, size - offset);
+      slices.push_back({i, offset, values + offset, grad + offset, n});
+    }
+    total += size;
+  }
+
+  // Small parameters share a thread, so that a step over a small model isn't
+  // split at all.
+  std::size_t grain = std::max<std::size_t>(
+      1, slices.size() * parallel::kGrainSize /
+             std::max<std::size_t>(total, 1));
+  parallel::parallel_for(
+      0, slices.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t s = begin; s < end; ++s) {
+          const Slice& slice = slices[s];
+          update(slice.index, slice.offset, slice.values, slice.grad,
+                 slice.n);
+        }
+      });
+}
+
+void Optimizer::zero_grad(bool set_to_none) {
+  for (Tensor* parameter : parameters_) {
+    Tensor*& gradient = parameter->gradient;
+    if (gradient == nullptr) {
+      continue;
+    }
+    if (set_to_none || gradient->is_sparse()) {
+      delete gradient;
+      gradient = nullptr;
+    } else if (gradient->is_csr()) {
+      std::fill(gradient->csr().values.begin(), gradient->csr().values.end(),
+                0.0);
+    } else {
+      gradient->data_.fill(0.0);
+    }
+  }
+}
+
+}  // namespace ember::optim
@@ -0,0 +1,39 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/optim/sgd.h>
+
+#include <stdexcept>
+
+namespace ember::optim {
+
+SGD::SGD(const std::vector<Tensor*>& parameters, double lr, double momentum,
+         double dampening, double weight_decay, bool nesterov)
+    : Optimizer(parameters), lr_(lr), momentum_(momentum),
+      dampening_(dampening), weight_decay_(weight_decay),
+      nesterov_(nesterov) {
+  if (lr < 0.0 || momentum < 0.0 || dampening < 0.0 || weight_decay < 0.0) {
+    throw std::invalid_argument("SGD's hyperparameters can't be negative");
+  }
+  if (dampening >= 1.0) {
+    throw std::invalid_argument("SGD's dampening must be less than 1");
+  }
+  if (nesterov && (momentum == 0.0 || dampening != 0.0)) {
+    throw std::invalid_argument(
+        "Nesterov momentum needs momentum and no dampening");
+  }
+  if (momentum != 0.0) {
+    buffers_.resize(this->parameters().size());
+    for (std::size_t i = 0; i < buffers_.size(); ++i) {
+      buffers_[i].assign(numel(i), 0.0);
+    }
+  }
+}
+
+void SGD::update(std::size_t index, std::size_t offset, double* values,
+                 const double* grad, std::size_t n) {
+  double* buffer = buffers_.empty() ? nullptr : buffers_[index].data() + offset;
+  kernels::active().sgd(values, grad, buffer, n,
+                        {lr_, momentum_, dampening_, weight_decay_, nesterov_,
+                         steps(index) == 1});
+}
+
+}  // namespace ember::optim
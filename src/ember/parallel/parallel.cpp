@@ -0,0 +1,70 @@
+#include <ember/parallel/parallel.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace ember {
+
+namespace {
+
+std::size_t default_num_threads() {
+  if (const char* env = std::getenv("EMBER_NUM_THREADS")) {
+    try {
+      std::size_t num_threads = std::stoul(env);
+      if (num_threads > 0) {
+        return num_threads;
+      }
+    } catch (const std::exception&) {
+      // Fall back to the hardware default below.
+    }
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::mutex pool_mutex;
+std::unique_ptr<parallel::ThreadPool> pool;
+// Lets ops reach the pool without taking the mutex once it exists.
+std::atomic<parallel::ThreadPool*> current_pool{nullptr};
+
+}  // namespace
+
+void set_num_threads(std::size_t num_threads) {
+  if (num_threads == 0) {
+    throw std::invalid_argument("The number of threads must be at least 1");
+  }
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (pool == nullptr || pool->num_threads() != num_threads) {
+    // Join the old workers before starting the new ones.
+    current_pool.store(nullptr);
+    pool.reset();
+    pool = std::make_unique<parallel::ThreadPool>(num_threads);
+    current_pool.store(pool.get());
+  }
+}
+
+std::size_t get_num_threads() {
+  return parallel::get_thread_pool().num_threads();
+}
+
+namespace parallel {
+
+ThreadPool& get_thread_pool() {
+  if (ThreadPool* existing = current_pool.load()) {
+    return *existing;
+  }
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (pool == nullptr) {
+    pool = std::make_unique<ThreadPool>(default_num_threads());
+    current_pool.store(pool.get());
+  }
+  return *pool;
+}
+
+}  // namespace parallel
+
+}  // namespace ember
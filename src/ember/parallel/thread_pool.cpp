@@ -0,0 +1,110 @@
+#include <ember/parallel/thread_pool.h>
+
+#include <stdexcept>
+
+namespace ember::parallel {
+
+namespace {
+thread_local bool in_task = false;
+}
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+  if (num_threads == 0) {
+    throw std::invalid_argument("A thread pool needs at least one thread");
+  }
+  workers_.reserve(num_threads - 1);
+  for (std::size_t i = 0; i + 1 < num_threads; ++i) {
+    workers_.emplace_back([this] { worker_loop(); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::run(std::size_t num_tasks,
+                     const std::function<void(std::size_t)>& task) {
+  if (num_tasks == 0) {
+    return;
+  }
+  if (num_tasks == 1 || workers_.empty() || in_task) {
+    for (std::size_t i = 0; i < num_tasks; ++i) {
+      task(i);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> submit_lock(submit_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_.store(0);
+    busy_workers_ = workers_.size();
+    error_ = nullptr;
+    ++batch_;
+  }
+  work_available_.notify_all();
+
+  work_on_batch();
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return busy_workers_ == 0; });
+  task_ = nullptr;
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+bool ThreadPool::in_parallel_region() {
+  return in_task;
+}
+
+void ThreadPool::worker_loop() {
+  std::uint64_t last_batch = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(
+          lock, [&] { return stopping_ || batch_ != last_batch; });
+      if (stopping_) {
+        return;
+      }
+      last_batch = batch_;
+    }
+
+    work_on_batch();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busy_workers_ == 0) {
+      work_done_.notify_one();
+    }
+  }
+}
+
+/**
+ * Claims and runs tasks from the current batch until none are left.
+ */
+void ThreadPool::work_on_batch() {
+  in_task = true;
+  for (std::size_t i = next_task_++; i < num_tasks_; i = next_task_++) {
+    try {
+      (*task_)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+  in_task = false;
+}
+
+}  // namespace ember::parallel
@@ -0,0 +1,192 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/parallel/parallel.h>
+#include <ember/parameter_group.h>
+#include <ember/tensor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <stdexcept>
+
+namespace ember {
+
+// The number of doubles in each aligned block of the buffers.
+static constexpr std::size_t kBlock =
+    ParameterGroup::kAlignment / sizeof(double);
+
+static std::size_t round_up(std::size_t n) {
+  return (n + kBlock - 1) / kBlock * kBlock;
+}
+
+static void check_parameter(const Tensor* parameter) {
+  if (parameter == nullptr) {
+    throw std::invalid_argument("A parameter group can't hold a null tensor");
+  }
+  if (parameter->is_sparse() || parameter->is_csr()) {
+    throw std::invalid_argument(
+        "Only dense tensors can be laid out in a parameter group");
+  }
+}
+
+// Checks that `gradient` has the shape of `parameter`, whose slice of the
+// gradient buffer it fills.
+static void check_gradient(const Tensor& parameter, const Tensor& gradient) {
+  const auto& shape = parameter.data_.shape();
+  bool matches =
+      gradient.is_sparse()
+          ? std::equal(shape.begin(), shape.end(),
+                       gradient.sparse_rows().shape.begin(),
+                       gradient.sparse_rows().shape.end())
+          : !gradient.is_csr() && gradient.data_.shape() == shape;
+  if (!matches) {
+    throw std::invalid_argument(
+        "A gradient must have the shape of its parameter");
+  }
+}
+
+ParameterGroup::ParameterGroup(const std::vector<Tensor*>& parameters) {
+  for (Tensor* parameter : parameters) {
+    check_parameter(parameter);
+    if (std::find(parameters_.begin(), parameters_.end(), parameter) !=
+        parameters_.end()) {
+      throw std::invalid_argument("A parameter was added to a group twice");
+    }
+    parameters_.push_back(parameter);
+  }
+  allocate();
+}
+
+void ParameterGroup::add(Tensor& parameter) {
+  check_parameter(&parameter);
+  if (std::find(parameters_.begin(), parameters_.end(), &parameter) !=
+      parameters_.end()) {
+    throw std::invalid_argument("A parameter was added to a group twice");
+  }
+  parameters_.push_back(&parameter);
+  allocate();
+}
+
+void ParameterGroup::allocate() {
+  offsets_.clear();
+  numel_ = 0;
+  capacity_ = 0;
+  for (const Tensor* parameter : parameters_) {
+    offsets_.push_back(capacity_);
+    numel_ += parameter->data_.size();
+    capacity_ += round_up(parameter->data_.size());
+  }
+  // aligned_alloc needs a nonzero size that is a multiple of the alignment.
+  std::size_t bytes = std::max<std::size_t>(capacity_, kBlock) * sizeof(double);
+  data_.reset(static_cast<double*>(std::aligned_alloc(kAlignment, bytes)));
+  grad_.reset(static_cast<double*>(std::aligned_alloc(kAlignment, bytes)));
+  if (!data_ || !grad_) {
+    throw std::bad_alloc();
+  }
+  std::fill(data_.get(), data_.get() + capacity_, 0.0);
+  std::fill(grad_.get(), grad_.get() + capacity_, 0.0);
+  gather_parameters();
+}
+
+void ParameterGroup::gather_parameters() {
+  for (std::size_t i = 0; i < parameters_.size(); ++i) {
+    const auto& values = parameters_[i]->data_;
+    std::copy(values.data(), values.data() + values.size(),
+              data_.get() + offsets_[i]);
+  }
+}
+
+void ParameterGroup::scatter_parameters() {
+  for (std::size_t i = 0; i < parameters_.size(); ++i) {
+    auto& values = parameters_[i]->data_;
+    const double* slice = data_.get() + offsets_[i];
+    std::copy(slice, slice + values.size(), values.data());
+  }
+}
+
+void ParameterGroup::gather_gradients() {
+  for (std::size_t i = 0; i < parameters_.size(); ++i) {
+    const Tensor* parameter = parameters_[i];
+    double* slice = grad_.get() + offsets_[i];
+    std::size_t size = parameter->data_.size();
+    const Tensor* gradient = parameter->gradient;
+    if (gradient != nullptr) {
+      check_gradient(*parameter, *gradient);
+    }
+    if (gradient != nullptr && !gradient->is_sparse()) {
+      std::copy(gradient->data_.data(), gradient->data_.data() + size, slice);
+      continue;
+    }
+    std::fill(slice, slice + size, 0.0);
+    if (gradient != nullptr && gradient->is_sparse()) {
+      const SparseRows& rows = gradient->sparse_rows();
+      std::size_t row_size = rows.row_size();
+      for (std::size_t r = 0; r < rows.indices.size(); ++r) {
+        kernels::active().axpy(1.0, rows.values.data() + r * row_size,
+                               slice + rows.indices[r] * row_size, row_size);
+      }
+    }
+  }
+}
+
+void ParameterGroup::zero_grad() {
+  std::fill(grad_.get(), grad_.get() + capacity_, 0.0);
+  for (Tensor* parameter : parameters_) {
+    if (parameter->gradient == nullptr) {
+      continue;
+    }
+    if (parameter->gradient->is_sparse() || parameter->gradient->is_csr()) {
+      delete parameter->gradient;
+      parameter->gradient = nullptr;
+    } else {
+      parameter->gradient->data_.fill(0.0);
+    }
+  }
+}
+
+double ParameterGroup::grad_norm() const {
+  const double* g = grad_.get();
+  double sum_of_squares = parallel::parallel_reduce(
+      0, capacity_, parallel::kGrainSize, 0.0,
+      [&](std::size_t begin, std::size_t end) {
+        double sum = 0.0;
+        for (std::size_t i = begin; i < end; ++i) {
+          sum += g[i] * g[i];
+        }
+        return sum;
+      },
+      [](double a, double b) { return a + b; });
+  return std::sqrt(sum_of_squares);
+}
+
+double ParameterGroup::clip_grad_norm(double max_norm) {
+  if (max_norm < 0.0) {
+    throw std::invalid_argument("The maximum gradient norm can't be negative");
+  }
+  double norm = grad_norm();
+  if (norm > max_norm) {
+    double scale = max_norm / norm;
+    double* g = grad_.get();
+    parallel::parallel_for(0, capacity_, parallel::kGrainSize,
+                           [&](std::size_t begin, std::size_t end) {
+                             for (std::size_t i = begin; i < end; ++i) {
+                               g[i] *= scale;
+                             }
+                           });
+  }
+  return norm;
+}
+
+std::vector<double> ParameterGroup::snapshot() const {
+  return std::vector<double>(data_.get(), data_.get() + capacity_);
+}
+
+void ParameterGroup::restore(const std::vector<double>& snapshot) {
+  if (snapshot.size() != capacity_) {
+    throw std::invalid_argument(
+        "A snapshot can only be restored into a group with the same layout");
+  }
+  std::copy(snapshot.begin(), snapshot.end(), data_.get());
+  scatter_parameters();
+}
+
+}  // namespace ember
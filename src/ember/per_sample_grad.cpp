@@ -0,0 +1,123 @@
+#include <ember/autograd/engine.h>
+#include <ember/autograd/grad_mode.h>
+#include <ember/autograd/per_sample.h>
+#include <ember/parallel/parallel.h>
+#include <ember/per_sample_grad.h>
+#include <ember/tensor.h>
+
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+namespace ember {
+
+namespace {
+
+// Added to the norm of a sample's gradients before dividing by it.
+constexpr double kClipEpsilon = 1e-6;
+
+// Scales the gradients of each sample so that their norm is at most
+// `max_norm`. Each sample's rows are scaled right after their norm is
+// computed, while they are still in cache.
+void clip_per_sample(std::vector<Tensor>& grads, std::size_t batch_size,
+                     double max_norm) {
+  parallel::parallel_for(
+      0, batch_size, 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t n = begin; n < end; ++n) {
+          double squared = 0.0;
+          for (const Tensor& grad : grads) {
+            std::size_t row = grad.data_.size() / batch_size;
+            const double* values = grad.data_.data() + n * row;
+            for (std::size_t i = 0; i < row; ++i) {
+              squared += values[i] * values[i];
+            }
+          }
+          double scale =
+              std::min(1.0, max_norm / (std::sqrt(squared) + kClipEpsilon));
+          if (scale == 1.0) {
+            continue;
+          }
+          for (Tensor& grad : grads) {
+            std::size_t row = grad.data_.size() / batch_size;
+            double* values = grad.data_.data() + n * row;
+            for (std::size_t i = 0; i < row; ++i) {
+              values[i] *= scale;
+            }
+          }
+        }
+      });
+}
+
+}  // namespace
+
+std::vector<Tensor> per_sample_grad(const PerSampleLossFn& fn,
+                                    const TensorRefs& params,
+                                    const Tensor& batch,
+                                    std::optional<double> max_norm) {
+  if (batch.data_.dimension() == 0 || batch.data_.shape()[0] == 0) {
+    throw std::invalid_argument("The batch must have at least one sample");
+  }
+  for (const Tensor& param : params) {
+    if (!param.requires_grad()) {
+      throw std::invalid_argument(
+          "Per-sample gradients are only computed for parameters that "
+          "require gradients");
+    }
+  }
+  if (max_norm.has_value() && !(*max_norm > 0.0)) {
+    throw std::invalid_argument("The maximum norm must be positive");
+  }
+
+  std::size_t batch_size = batch.data_.shape()[0];
+  autograd::PerSampleState state{batch_size, {}};
+  {
+    autograd::PerSampleGuard guard(state);
+    autograd::GradModeGuard recording(true);
+    Tensor loss = fn(batch);
+    if (loss.data_.size() != batch_size && loss.data_.size() != 1) {
+      throw std::invalid_argument(
+          "The loss must have one element per sample, or be their sum");
+    }
+    if (loss.requires_grad()) {
+      autograd::Engine engine;
+      engine.backward(loss.get_gradient_fn(), Tensor::ones_like(loss));
+    }
+  }
+
+  std::vector<Tensor> grads;
+  for (const Tensor& param : params) {
+    xt::xarray<double>::shape_type shape(param.data_.dimension() + 1);
+    shape[0] = batch_size;
+    std::copy(param.data_.shape().begin(), param.data_.shape().end(),
+              shape.begin() + 1);
+    auto it = state.gradients.find(&param);
+    if (it == state.gradients.end()) {
+      grads.push_back(Tensor::from_xarray(xt::zeros<double>(shape)));
+      continue;
+    }
+    Tensor& grad = it->second;
+    // A batch of one sample broadcasts nothing, so the gradient of a
+    // parameter with a leading 1 (e.g. a (1, n) bias) comes without the
+    // sample axis.
+    if (batch_size == 1 && !grad.is_sparse() && !grad.is_csr() &&
+        grad.data_.shape() == param.data_.shape()) {
+      grad.data_.reshape(shape);
+    }
+    if (grad.is_sparse() || grad.is_csr() || grad.data_.shape() != shape) {
+      throw std::invalid_argument(
+          "An op has no per-sample gradient for one of the parameters");
+    }
+    grads.push_back(std::move(grad));
+  }
+
+  if (max_norm.has_value()) {
+    clip_per_sample(grads, batch_size, *max_norm);
+  }
+  return grads;
+}
+
+}  // namespace ember
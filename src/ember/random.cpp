@@ -0,0 +1,71 @@
+#include <ember/random.h>
+#include <xtensor/xrandom.hpp>
+
+#include <atomic>
+#include <sstream>
+
+namespace ember {
+
+namespace {
+
+// The seed and next unreserved offset of the stream used by ops.
+std::atomic<std::uint64_t> stream_seed{0};
+std::atomic<std::uint64_t> stream_offset{0};
+
+}  // namespace
+
+void manual_seed(std::uint64_t seed) {
+  stream_seed = seed;
+  stream_offset = 0;
+  xt::random::seed(seed);
+}
+
+std::uint64_t initial_seed() {
+  return stream_seed;
+}
+
+RngState get_rng_state() {
+  std::ostringstream engine;
+  engine << xt::random::get_default_random_engine();
+  return {{stream_seed, stream_offset}, engine.str()};
+}
+
+void set_rng_state(const RngState& state) {
+  stream_seed = state.stream.seed;
+  stream_offset = state.stream.offset;
+  std::istringstream engine(state.engine);
+  engine >> xt::random::get_default_random_engine();
+}
+
+}  // namespace ember
+
+namespace ember::random {
+
+// The multipliers and the key increments (the golden ratio and sqrt(3) - 1)
+// of Philox4x32.
+static constexpr std::uint32_t kMultiplier0 = 0xD2511F53;
+static constexpr std::uint32_t kMultiplier1 = 0xCD9E8D57;
+static constexpr std::uint32_t kWeyl0 = 0x9E3779B9;
+static constexpr std::uint32_t kWeyl1 = 0xBB67AE85;
+
+StreamPosition reserve(std::size_t count) {
+  std::uint64_t blocks = (count + 3) / 4;
+  return {stream_seed, stream_offset.fetch_add(4 * blocks)};
+}
+
+std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> counter,
+                                    std::array<std::uint32_t, 2> key) {
+  for (int round = 0; round < 10; ++round) {
+    std::uint64_t product0 = std::uint64_t{kMultiplier0} * counter[0];
+    std::uint64_t product1 = std::uint64_t{kMultiplier1} * counter[2];
+    counter = {static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+               static_cast<std::uint32_t>(product1),
+               static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+               static_cast<std::uint32_t>(product0)};
+    key[0] += kWeyl0;
+    key[1] += kWeyl1;
+  }
+  return counter;
+}
+
+}  // namespace ember::random
@@ -0,0 +1,188 @@
+#include <ember/sparse_csr.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace ember {
+
+CsrMatrix CsrMatrix::from_triplets(std::size_t rows, std::size_t cols,
+                                   const std::vector<std::size_t>& row_indices,
+                                   const std::vector<std::size_t>& col_indices,
+                                   const std::vector<double>& values) {
+  std::size_t count = values.size();
+  if (row_indices.size() != count || col_indices.size() != count) {
+    throw std::invalid_argument(
+        "A CSR matrix needs a row and a column index for each value");
+  }
+  // The elements grouped by row with a counting sort, and then sorted by
+  // column within each row. Both sorts are stable, so repeated coordinates
+  // are summed in the order they were given.
+  std::vector<std::size_t> offsets(rows + 1, 0);
+  for (std::size_t i = 0; i < count; ++i) {
+    if (row_indices[i] >= rows || col_indices[i] >= cols) {
+      throw std::invalid_argument(
+          "A coordinate of a CSR matrix is out of range");
+    }
+    offsets[row_indices[i] + 1] += 1;
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<std::size_t> order(count);
+  std::vector<std::size_t> next(offsets.begin(), offsets.end() - 1);
+  for (std::size_t i = 0; i < count; ++i) {
+    order[next[row_indices[i]]++] = i;
+  }
+
+  CsrMatrix result;
+  result.rows = rows;
+  result.cols = cols;
+  result.row_offsets.push_back(0);
+  for (std::size_t r = 0; r < rows; ++r) {
+    auto first = order.begin() + offsets[r];
+    auto last = order.begin() + offsets[r + 1];
+    std::stable_sort(first, last, [&](std::size_t a, std::size_t b) {
+      return col_indices[a] < col_indices[b];
+    });
+    std::size_t row_start = result.columns.size();
+    for (auto it = first; it != last; ++it) {
+      if (result.columns.size() > row_start &&
+          result.columns.back() == col_indices[*it]) {
+        result.values.back() += values[*it];
+      } else {
+        result.columns.push_back(col_indices[*it]);
+        result.values.push_back(values[*it]);
+      }
+    }
+    result.row_offsets.push_back(result.columns.size());
+  }
+  return result;
+}
+
+CsrMatrix CsrMatrix::from_dense(const xt::xarray<double>& dense) {
+  if (dense.dimension() != 2) {
+    throw std::invalid_argument(
+        "Only 2-dimensional arrays can be stored as CSR matrices");
+  }
+  CsrMatrix result;
+  result.rows = dense.shape()[0];
+  result.cols = dense.shape()[1];
+  result.row_offsets.push_back(0);
+  for (std::size_t r = 0; r < result.rows; ++r) {
+    for (std::size_t c = 0; c < result.cols; ++c) {
+      double value = dense.data()[r * result.cols + c];
+      if (value != 0.0) {
+        result.columns.push_back(c);
+        result.values.push_back(value);
+      }
+    }
+    result.row_offsets.push_back(result.columns.size());
+  }
+  return result;
+}
+
+void CsrMatrix::validate() const {
+  if (row_offsets.size() != rows + 1 || row_offsets.front() != 0 ||
+      row_offsets.back() != values.size() ||
+      columns.size() != values.size()) {
+    throw std::invalid_argument(
+        "A CSR matrix needs rows + 1 offsets from 0 to the number of values, "
+        "and a column for each value");
+  }
+  for (std::size_t r = 0; r < rows; ++r) {
+    if (row_offsets[r] > row_offsets[r + 1]) {
+      throw std::invalid_argument("The row offsets of a CSR matrix decrease");
+    }
+    for (std::size_t i = row_offsets[r]; i < row_offsets[r + 1]; ++i) {
+      if (columns[i] >= cols ||
+          (i > row_offsets[r] && columns[i] <= columns[i - 1])) {
+        throw std::invalid_argument(
+            "The columns of each row of a CSR matrix must be in range, "
+            "sorted and unique");
+      }
+    }
+  }
+}
+
+CsrMatrix CsrMatrix::transpose() const {
+  CsrMatrix result;
+  result.rows = cols;
+  result.cols = rows;
+  result.row_offsets.assign(cols + 1, 0);
+  for (std::size_t c : columns) {
+    result.row_offsets[c + 1] += 1;
+  }
+  std::partial_sum(result.row_offsets.begin(), result.row_offsets.end(),
+                   result.row_offsets.begin());
+  // Visiting the rows in order leaves the columns of each row of the
+  // transpose sorted.
+  result.columns.resize(nnz());
+  result.values.resize(nnz());
+  std::vector<std::size_t> next(result.row_offsets.begin(),
+                                result.row_offsets.end() - 1);
+  for (std::size_t r = 0; r < rows; ++r) {
+    for (std::size_t i = row_offsets[r]; i < row_offsets[r + 1]; ++i) {
+      std::size_t slot = next[columns[i]]++;
+      result.columns[slot] = r;
+      result.values[slot] = values[i];
+    }
+  }
+  return result;
+}
+
+void CsrMatrix::add(const CsrMatrix& other) {
+  if (other.rows != rows || other.cols != cols) {
+    throw std::invalid_argument(
+        "Only CSR matrices of the same shape can be added");
+  }
+  // Gradients of the same matrix share its sparsity pattern.
+  if (other.row_offsets == row_offsets && other.columns == columns) {
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      values[i] += other.values[i];
+    }
+    return;
+  }
+  CsrMatrix merged;
+  merged.rows = rows;
+  merged.cols = cols;
+  merged.row_offsets.push_back(0);
+  for (std::size_t r = 0; r < rows; ++r) {
+    std::size_t i = row_offsets[r], j = other.row_offsets[r];
+    std::size_t i_end = row_offsets[r + 1], j_end = other.row_offsets[r + 1];
+    while (i < i_end || j < j_end) {
+      if (j == j_end || (i < i_end && columns[i] < other.columns[j])) {
+        merged.columns.push_back(columns[i]);
+        merged.values.push_back(values[i++]);
+      } else if (i == i_end || other.columns[j] < columns[i]) {
+        merged.columns.push_back(other.columns[j]);
+        merged.values.push_back(other.values[j++]);
+      } else {
+        merged.columns.push_back(columns[i]);
+        merged.values.push_back(values[i++] + other.values[j++]);
+      }
+    }
+    merged.row_offsets.push_back(merged.columns.size());
+  }
+  *this = std::move(merged);
+}
+
+void CsrMatrix::add_to(xt::xarray<double>& dense) const {
+  if (dense.dimension() != 2 || dense.shape()[0] != rows ||
+      dense.shape()[1] != cols) {
+    throw std::invalid_argument(
+        "A CSR matrix can only be added to a tensor of its dense shape");
+  }
+  for (std::size_t r = 0; r < rows; ++r) {
+    for (std::size_t i = row_offsets[r]; i < row_offsets[r + 1]; ++i) {
+      dense.data()[r * cols + columns[i]] += values[i];
+    }
+  }
+}
+
+xt::xarray<double> CsrMatrix::to_dense() const {
+  xt::xarray<double> dense = xt::zeros<double>({rows, cols});
+  add_to(dense);
+  return dense;
+}
+
+}  // namespace ember
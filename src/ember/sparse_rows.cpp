@@ -0,0 +1,107 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/parallel/parallel.h>
+#include <ember/sparse_rows.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+
+namespace ember {
+
+// Returns the shape of `count` rows of a tensor of the given shape.
+static std::vector<std::size_t> rows_shape(
+    const std::vector<std::size_t>& shape, std::size_t count) {
+  std::vector<std::size_t> result(shape);
+  result[0] = count;
+  return result;
+}
+
+std::size_t SparseRows::row_size() const {
+  return std::accumulate(shape.begin() + 1, shape.end(), std::size_t{1},
+                         std::multiplies<std::size_t>());
+}
+
+void SparseRows::append(const SparseRows& other) {
+  if (other.shape != shape) {
+    throw std::invalid_argument(
+        "Only sparse rows of tensors of the same shape can be appended");
+  }
+  std::size_t size = row_size();
+  std::size_t count = indices.size();
+  auto merged = xt::xarray<double>::from_shape(
+      rows_shape(shape, count + other.indices.size()));
+  std::copy(values.data(), values.data() + count * size, merged.data());
+  std::copy(other.values.data(),
+            other.values.data() + other.indices.size() * size,
+            merged.data() + count * size);
+  values = std::move(merged);
+  indices.insert(indices.end(), other.indices.begin(), other.indices.end());
+}
+
+void SparseRows::coalesce() {
+  if (std::adjacent_find(indices.begin(), indices.end(),
+                         std::greater_equal<std::size_t>()) == indices.end()) {
+    return;  // Already sorted, with each index once.
+  }
+  std::size_t size = row_size();
+  // The rows in order of their index, with rows of the same index in the
+  // order they were added, so the sums don't depend on the thread count.
+  std::vector<std::size_t> order(indices.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [this](std::size_t a, std::size_t b) {
+                     return indices[a] < indices[b];
+                   });
+  std::vector<std::size_t> starts;
+  std::vector<std::size_t> unique;
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    if (i == 0 || indices[order[i]] != unique.back()) {
+      starts.push_back(i);
+      unique.push_back(indices[order[i]]);
+    }
+  }
+  starts.push_back(order.size());
+
+  auto summed =
+      xt::xarray<double>::from_shape(rows_shape(shape, unique.size()));
+  const kernels::KernelTable& k = kernels::active();
+  std::size_t grain = std::max<std::size_t>(
+      1, parallel::kGrainSize / std::max<std::size_t>(size, 1));
+  parallel::parallel_for(
+      0, unique.size(), grain, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t u = begin; u < end; ++u) {
+          double* out = summed.data() + u * size;
+          const double* first = values.data() + order[starts[u]] * size;
+          std::copy(first, first + size, out);
+          for (std::size_t i = starts[u] + 1; i < starts[u + 1]; ++i) {
+            k.axpy(1.0, values.data() + order[i] * size, out, size);
+          }
+        }
+      });
+  indices = std::move(unique);
+  values = std::move(summed);
+}
+
+void SparseRows::add_to(xt::xarray<double>& dense) const {
+  if (!std::equal(dense.shape().begin(), dense.shape().end(), shape.begin(),
+                  shape.end())) {
+    throw std::invalid_argument(
+        "Sparse rows can only be added to a tensor of their dense shape");
+  }
+  std::size_t size = row_size();
+  const kernels::KernelTable& k = kernels::active();
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    k.axpy(1.0, values.data() + i * size, dense.data() + indices[i] * size,
+           size);
+  }
+}
+
+xt::xarray<double> SparseRows::to_dense() const {
+  xt::xarray<double> dense = xt::zeros<double>(shape);
+  add_to(dense);
+  return dense;
+}
+
+}  // namespace ember
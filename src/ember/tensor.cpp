@@ -1,6 +1,8 @@
 #include <ember/tensor.h>
 
+#include <ember/autograd/grad_mode.h>
 #include <ember/autograd/node.h>
+#include <ember/autograd/offload.h>
 #include <xtensor/xrandom.hpp>
 
 #include <functional>
@@ -37,7 +39,9 @@ Tensor::Tensor(init_list<init_list<init_list<double>>> values,
 
 Tensor::Tensor(const Tensor& other)
     : data_(other.data_), gradient_fn(other.gradient_fn),
-      gradient_accumulator(other.gradient_accumulator) {
+      gradient_accumulator(other.gradient_accumulator),
+      sparse_rows_(other.sparse_rows_), csr_(other.csr_),
+      tangent_(other.tangent_) {
   requires_grad_ = other.requires_grad();
   if (other.gradient != nullptr) {
     gradient = new Tensor(*other.gradient);
@@ -64,9 +68,49 @@ autograd::Node* Tensor::get_gradient_fn() const {
 }
 
 void Tensor::set_gradient_fn(autograd::Node* gradient_fn) {
+  if (gradient_fn != nullptr && !autograd::is_grad_enabled()) {
+    // Every op records its node through here, so this is where recording is
+    // turned off: the output becomes a constant and the node is freed along
+    // with the values it saved.
+    delete gradient_fn;
+    delete gradient_accumulator;
+    gradient_accumulator = nullptr;
+    requires_grad_ = false;
+    autograd::count_discarded_node();
+    return;
+  }
+  if (gradient_fn != nullptr) {
+    autograd::count_saved_bytes(autograd::saved_bytes(*gradient_fn));
+    if (autograd::SavedTensorOffloader* offloader =
+            autograd::current_offloader()) {
+      offloader->offload(*gradient_fn);
+    }
+  }
   this->gradient_fn = gradient_fn;
 }
 
+Tensor& Tensor::set_tangent(Tensor tangent) {
+  if (is_sparse() || is_csr() || tangent.is_sparse() || tangent.is_csr()) {
+    throw std::invalid_argument("Only dense tensors have tangents");
+  }
+  if (tangent.data_.shape() != data_.shape()) {
+    throw std::invalid_argument(
+        "A tangent must have the shape of its tensor");
+  }
+  tangent_ = std::make_shared<const Tensor>(
+      Tensor::from_xarray(std::move(tangent.data_)));
+  return *this;
+}
+
+void Tensor::register_post_accumulate_hook(std::function<void(Tensor&)> hook) {
+  if (gradient_fn != nullptr || gradient_accumulator == nullptr) {
+    throw std::runtime_error(
+        "Only leaf tensors that require gradients accumulate gradients");
+  }
+  static_cast<autograd::Accumulator*>(gradient_accumulator)
+      ->add_post_hook(std::move(hook));
+}
+
 void Tensor::backward(const Tensor& gradient) {
   if (gradient_fn == nullptr) {
     throw std::runtime_error(
@@ -104,6 +148,95 @@ Tensor Tensor::exp() {
   return ember::exp(*this);
 }
 
+Tensor Tensor::log() {
+  return ember::log(*this);
+}
+
+Tensor Tensor::pow(const Tensor& exponent) {
+  return ember::pow(*this, exponent);
+}
+
+Tensor Tensor::sqrt() {
+  return ember::sqrt(*this);
+}
+
+Tensor Tensor::rsqrt() {
+  return ember::rsqrt(*this);
+}
+
+Tensor Tensor::tanh() {
+  return ember::tanh(*this);
+}
+
+Tensor Tensor::sigmoid() {
+  return ember::sigmoid(*this);
+}
+
+Tensor Tensor::relu() {
+  return ember::relu(*this);
+}
+
+Tensor Tensor::gelu() {
+  return ember::gelu(*this);
+}
+
+Tensor Tensor::sum() {
+  return ember::sum(*this);
+}
+
+Tensor Tensor::sum(const std::vector<std::ptrdiff_t>& axes, bool keepdims) {
+  return ember::sum(*this, axes, keepdims);
+}
+
+Tensor Tensor::mean() {
+  return ember::mean(*this);
+}
+
+Tensor Tensor::mean(const std::vector<std::ptrdiff_t>& axes, bool keepdims) {
+  return ember::mean(*this, axes, keepdims);
+}
+
+Tensor Tensor::max() {
+  return ember::max(*this);
+}
+
+Tensor Tensor::max(std::ptrdiff_t axis, bool keepdims) {
+  return ember::max(*this, axis, keepdims);
+}
+
+Tensor Tensor::min() {
+  return ember::min(*this);
+}
+
+Tensor Tensor::min(std::ptrdiff_t axis, bool keepdims) {
+  return ember::min(*this, axis, keepdims);
+}
+
+Tensor Tensor::logsumexp() {
+  return ember::logsumexp(*this);
+}
+
+Tensor Tensor::logsumexp(const std::vector<std::ptrdiff_t>& axes,
+                         bool keepdims) {
+  return ember::logsumexp(*this, axes, keepdims);
+}
+
+Tensor Tensor::argmax() {
+  return ember::argmax(*this);
+}
+
+Tensor Tensor::argmax(std::ptrdiff_t axis, bool keepdims) {
+  return ember::argmax(*this, axis, keepdims);
+}
+
+Tensor Tensor::softmax(std::ptrdiff_t axis) {
+  return ember::softmax(*this, axis);
+}
+
+Tensor Tensor::log_softmax(std::ptrdiff_t axis) {
+  return ember::log_softmax(*this, axis);
+}
+
 bool Tensor::equals(const Tensor& other) {
   return *this == other;
 }
@@ -122,6 +255,65 @@ Tensor Tensor::from_xarray(xt::xarray<double> data) {
   return t;
 }
 
+Tensor Tensor::from_sparse_rows(SparseRows rows) {
+  Tensor t;
+  t.sparse_rows_ = std::move(rows);
+  return t;
+}
+
+bool Tensor::is_sparse() const {
+  return sparse_rows_.has_value();
+}
+
+const SparseRows& Tensor::sparse_rows() const {
+  if (!sparse_rows_) {
+    throw std::runtime_error("sparse_rows called on a dense tensor");
+  }
+  return *sparse_rows_;
+}
+
+SparseRows& Tensor::sparse_rows() {
+  if (!sparse_rows_) {
+    throw std::runtime_error("sparse_rows called on a dense tensor");
+  }
+  return *sparse_rows_;
+}
+
+Tensor Tensor::from_csr(CsrMatrix matrix) {
+  matrix.validate();
+  Tensor t;
+  t.csr_ = std::move(matrix);
+  return t;
+}
+
+bool Tensor::is_csr() const {
+  return csr_.has_value();
+}
+
+const CsrMatrix& Tensor::csr() const {
+  if (!csr_) {
+    throw std::runtime_error("csr called on a tensor that isn't CSR");
+  }
+  return *csr_;
+}
+
+CsrMatrix& Tensor::csr() {
+  if (!csr_) {
+    throw std::runtime_error("csr called on a tensor that isn't CSR");
+  }
+  return *csr_;
+}
+
+Tensor Tensor::to_dense() const {
+  if (sparse_rows_) {
+    return Tensor::from_xarray(sparse_rows_->to_dense());
+  }
+  if (csr_) {
+    return Tensor::from_xarray(csr_->to_dense());
+  }
+  return Tensor::from_xarray(data_);
+}
+
 Tensor Tensor::from_shape(std::initializer_list<size_t> shape) {
   return Tensor::from_xarray(xt::xarray<double>::from_shape(shape));
 }
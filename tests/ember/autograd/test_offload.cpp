@@ -0,0 +1,169 @@
+#include <ember/autograd/node.h>
+#include <ember/autograd/offload.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include "../test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <system_error>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+class OffloadTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    manual_seed(0);
+    for (std::size_t i = 0; i < kLayers; ++i) {
+      weights_[i] = Tensor::randn({16, 16});
+      biases_[i] = Tensor::randn({16});
+      weights_[i].requires_grad(true);
+      biases_[i].requires_grad(true);
+    }
+    x_ = Tensor::randn({32, 16});
+  }
+
+  void TearDown() override { clear_gradients(params()); }
+
+  std::vector<Tensor*> params() {
+    std::vector<Tensor*> result;
+    for (std::size_t i = 0; i < kLayers; ++i) {
+      result.push_back(&weights_[i]);
+      result.push_back(&biases_[i]);
+    }
+    return result;
+  }
+
+  Tensor loss() {
+    Tensor output = x_;
+    for (std::size_t i = 0; i < kLayers; ++i) {
+      output = ember::tanh(ember::linear(output, weights_[i], biases_[i]));
+    }
+    return (output * output).sum();
+  }
+
+  static constexpr std::size_t kLayers = 3;
+  Tensor weights_[kLayers];
+  Tensor biases_[kLayers];
+  Tensor x_;
+};
+
+}  // namespace
+
+TEST_F(OffloadTest, GradientsMatchWithTheSavedTensorsOffloaded) {
+  loss().backward();
+  auto expected = take_gradients(params());
+
+  autograd::SavedTensorOffloader offloader(1, 2);
+  Tensor offloaded_loss;
+  {
+    autograd::OffloadGuard guard(offloader);
+    offloaded_loss = loss();
+  }
+  offloader.wait_for_writes();
+  EXPECT_GT(offloader.num_offloaded(), 0u);
+  EXPECT_GE(offloader.bytes_offloaded(), 32u * 16u * sizeof(double));
+  // The multiplication saved its inputs, which are now held by the offloader.
+  autograd::Node* node = offloaded_loss.get_gradient_fn()->edges[0].fn;
+  ASSERT_FALSE(node->ctx.saved_tensors.empty());
+  EXPECT_NE(node->ctx.saved_tensors[0].offloaded, nullptr);
+  EXPECT_EQ(node->ctx.saved_tensors[0].data_.size(), 0u);
+
+  offloaded_loss.backward();
+  expect_same(take_gradients(params()), expected);
+  EXPECT_EQ(node->ctx.saved_tensors[0].offloaded, nullptr);
+  EXPECT_EQ(node->ctx.saved_tensors[0].data_.size(), 32u * 16u);
+}
+
+TEST_F(OffloadTest, TensorsAreReadBackAheadOfTheirNodes) {
+  // Every tensor starts loading at the first node, in the order of the nodes,
+  // so the backward pass only waits for the first ones.
+  autograd::SavedTensorOffloader offloader(1, 1000);
+  Tensor l;
+  {
+    autograd::OffloadGuard guard(offloader);
+    l = loss();
+  }
+  offloader.wait_for_writes();
+  std::size_t offloaded = offloader.num_offloaded();
+  ASSERT_GT(offloaded, 1u);
+
+  l.backward();
+  EXPECT_LT(offloader.num_stalls(), offloaded);
+}
+
+TEST_F(OffloadTest, SmallTensorsStayInMemory) {
+  autograd::SavedTensorOffloader offloader(32 * 16 * sizeof(double) + 1);
+  autograd::OffloadGuard guard(offloader);
+  Tensor l = loss();
+
+  autograd::Node* node = l.get_gradient_fn()->edges[0].fn;
+  EXPECT_EQ(node->ctx.saved_tensors[0].offloaded, nullptr);
+  l.backward();
+  EXPECT_EQ(offloader.num_offloaded(), 0u);
+  EXPECT_EQ(offloader.num_stalls(), 0u);
+}
+
+TEST_F(OffloadTest, GraphsOutliveTheOffloader) {
+  loss().backward();
+  auto expected = take_gradients(params());
+
+  Tensor l;
+  {
+    autograd::SavedTensorOffloader offloader(1);
+    autograd::OffloadGuard guard(offloader);
+    l = loss();
+  }
+  EXPECT_EQ(autograd::current_offloader(), nullptr);
+  l.backward();
+  expect_same(take_gradients(params()), expected);
+}
+
+TEST(Offload, SavedArraysAreOffloaded) {
+  // Most of what `lstm` keeps for the backward pass are the gates and states
+  // of every timestep, in its saved data rather than its saved tensors.
+  manual_seed(0);
+  Tensor x = Tensor::randn({8, 4, 3});
+  LstmState initial{Tensor::randn({4, 5}), Tensor::randn({4, 5})};
+  Tensor w_ih = Tensor::randn({3, 20});
+  Tensor w_hh = Tensor::randn({5, 20});
+  Tensor bias = Tensor::randn({20});
+  std::vector<Tensor*> params = {&w_ih, &w_hh, &bias};
+  for (Tensor* t : params) {
+    t->requires_grad(true);
+  }
+  autograd::Node* node = nullptr;
+  auto loss = [&] {
+    Tensor hiddens = ember::lstm(x, initial, w_ih, w_hh, bias).first;
+    node = hiddens.get_gradient_fn()->edges[0].fn;
+    return (hiddens * hiddens).sum();
+  };
+  Tensor l = loss();
+  std::size_t resident = autograd::saved_bytes(*node);
+  l.backward();
+  auto expected = take_gradients(params);
+
+  autograd::SavedTensorOffloader offloader(1);
+  {
+    autograd::OffloadGuard guard(offloader);
+    l = loss();
+  }
+  offloader.wait_for_writes();
+  EXPECT_GT(resident, 0u);
+  EXPECT_EQ(autograd::saved_bytes(*node), 0u);
+  EXPECT_GE(offloader.bytes_offloaded(), resident);
+
+  l.backward();
+  expect_same(take_gradients(params), expected);
+  EXPECT_EQ(autograd::saved_bytes(*node), resident);
+}
+
+TEST(Offload, NeedsAWritableDirectory) {
+  EXPECT_THROW(autograd::SavedTensorOffloader(1, 4, "/nonexistent/scratch"),
+               std::system_error);
+}
@@ -0,0 +1,49 @@
+#ifndef EMBER_TESTS_DISTRIBUTED_RUN_GROUP_H
+#define EMBER_TESTS_DISTRIBUTED_RUN_GROUP_H
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using Worker = std::function<bool(const std::string& name, std::size_t rank)>;
+
+// Runs `worker` in a forked process for each rank of a new group, and returns
+// whether it returned true in all of them. A worker that throws or hangs
+// fails.
+inline bool run_group(std::size_t world_size, const Worker& worker) {
+  static int groups = 0;
+  std::string name = "test-" + std::to_string(::getpid()) + "-" +
+                     std::to_string(groups++);
+  std::cout.flush();
+  std::fflush(nullptr);
+  std::vector<pid_t> children;
+  for (std::size_t rank = 0; rank < world_size; ++rank) {
+    pid_t child = ::fork();
+    if (child == 0) {
+      ::alarm(60);
+      bool passed = false;
+      try {
+        passed = worker(name, rank);
+      } catch (...) {
+      }
+      std::_Exit(passed ? 0 : 1);
+    }
+    children.push_back(child);
+  }
+  bool passed = true;
+  for (pid_t child : children) {
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    passed = passed && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  return passed;
+}
+
+#endif  // !EMBER_TESTS_DISTRIBUTED_RUN_GROUP_H
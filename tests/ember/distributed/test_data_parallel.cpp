@@ -0,0 +1,149 @@
+#include <ember/distributed/data_parallel.h>
+#include <ember/optim/sgd.h>
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// The mean squared error of a linear model on a batch.
+Tensor mse(const std::vector<Tensor*>& parameters, const Tensor& x,
+           const Tensor& y) {
+  Tensor error = ember::linear(x, *parameters[0], *parameters[1]) - y;
+  return (error * error).mean();
+}
+
+class DataParallelTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    original_num_threads_ = get_num_threads();
+    set_num_threads(4);
+    x_ = Tensor::randn({16, 3});
+    y_ = Tensor::randn({16, 2});
+    x_shards_ = ember::chunk(x_, 4);
+    y_shards_ = ember::chunk(y_, 4);
+  }
+
+  void TearDown() override { set_num_threads(original_num_threads_); }
+
+  std::size_t original_num_threads_;
+  Tensor x_;
+  Tensor y_;
+  std::vector<Tensor> x_shards_;
+  std::vector<Tensor> y_shards_;
+};
+
+}  // namespace
+
+TEST_F(DataParallelTest, GradientsMatchTheFullBatchGradients) {
+  Tensor w = Tensor::randn({3, 2});
+  Tensor b = Tensor::randn({2});
+  w.requires_grad(true);
+  b.requires_grad(true);
+  Tensor expected_w = Tensor::from_xarray(w.data_);
+  Tensor expected_b = Tensor::from_xarray(b.data_);
+  expected_w.requires_grad(true);
+  expected_b.requires_grad(true);
+
+  for (std::size_t bucket_size : {std::size_t{1}, std::size_t{1} << 18}) {
+    delete w.gradient;
+    delete b.gradient;
+    w.gradient = b.gradient = nullptr;
+    distributed::DataParallel trainer({&w, &b}, 4, bucket_size);
+    EXPECT_EQ(trainer.num_buckets(), bucket_size == 1 ? 2u : 1u);
+
+    double loss = trainer.forward_backward(
+        [&](const std::vector<Tensor*>& parameters, std::size_t replica) {
+          return mse(parameters, x_shards_[replica], y_shards_[replica]);
+        });
+
+    Tensor full = mse({&expected_w, &expected_b}, x_, y_);
+    if (expected_w.gradient == nullptr) {
+      full.backward();
+    }
+    EXPECT_NEAR(loss, full.data_(0), 1e-12);
+    EXPECT_TRUE(w.gradient->equals_approx(*expected_w.gradient));
+    EXPECT_TRUE(b.gradient->equals_approx(*expected_b.gradient));
+  }
+}
+
+TEST_F(DataParallelTest, TrainingMatchesSingleThreadTraining) {
+  Tensor w = Tensor::randn({3, 2});
+  Tensor b = Tensor::randn({2});
+  w.requires_grad(true);
+  b.requires_grad(true);
+  Tensor single_w = Tensor::from_xarray(w.data_);
+  Tensor single_b = Tensor::from_xarray(b.data_);
+  single_w.requires_grad(true);
+  single_b.requires_grad(true);
+
+  distributed::DataParallel trainer({&w, &b}, 4);
+  optim::SGD sgd({&w, &b}, 0.1, 0.9);
+  optim::SGD single_sgd({&single_w, &single_b}, 0.1, 0.9);
+  for (int step = 0; step < 5; ++step) {
+    sgd.zero_grad();
+    trainer.forward_backward(
+        [&](const std::vector<Tensor*>& parameters, std::size_t replica) {
+          return mse(parameters, x_shards_[replica], y_shards_[replica]);
+        });
+    sgd.step();
+
+    single_sgd.zero_grad();
+    mse({&single_w, &single_b}, x_, y_).backward();
+    single_sgd.step();
+  }
+
+  EXPECT_TRUE(w.equals_approx(single_w));
+  EXPECT_TRUE(b.equals_approx(single_b));
+}
+
+TEST_F(DataParallelTest, SparseGradientsStaySparse) {
+  Tensor table = Tensor::randn({10, 3});
+  table.requires_grad(true);
+  std::vector<Tensor> indices = {Tensor({1.0, 4.0}), Tensor({4.0, 7.0})};
+
+  distributed::DataParallel trainer({&table}, 2);
+  trainer.forward_backward(
+      [&](const std::vector<Tensor*>& parameters, std::size_t replica) {
+        return ember::embedding(*parameters[0], indices[replica]).sum();
+      });
+
+  ASSERT_TRUE(table.gradient->is_sparse());
+  EXPECT_EQ(table.gradient->sparse_rows().indices,
+            (std::vector<std::size_t>{1, 4, 7}));
+  Tensor dense = table.gradient->to_dense();
+  EXPECT_DOUBLE_EQ(dense(1, 0), 0.5);
+  EXPECT_DOUBLE_EQ(dense(4, 0), 1.0);
+}
+
+TEST_F(DataParallelTest, ParametersUnusedByAReplicaAreStillReduced) {
+  Tensor a({1.0, 2.0}, true);
+  Tensor b({3.0}, true);
+
+  distributed::DataParallel trainer({&a, &b}, 2, 1);
+  trainer.forward_backward(
+      [&](const std::vector<Tensor*>& parameters, std::size_t replica) {
+        Tensor loss = parameters[0]->sum();
+        return replica == 0 ? loss : loss + *parameters[1];
+      });
+
+  EXPECT_TRUE(a.gradient->equals(Tensor({1.0, 1.0})));
+  EXPECT_TRUE(b.gradient->equals(Tensor({0.5})));
+}
+
+TEST_F(DataParallelTest, InvalidArgumentsAreRejected) {
+  Tensor a({1.0}, true);
+  Tensor no_grad({1.0});
+
+  EXPECT_THROW(distributed::DataParallel({&a}, 0), std::invalid_argument);
+  EXPECT_THROW(distributed::DataParallel({&a}, 2, 0), std::invalid_argument);
+  EXPECT_THROW(distributed::DataParallel({&no_grad}, 2),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::DataParallel({&a, &a}, 2), std::invalid_argument);
+}
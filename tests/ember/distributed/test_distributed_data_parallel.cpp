@@ -0,0 +1,169 @@
+#include <ember/distributed/distributed_data_parallel.h>
+#include <ember/distributed/process_group.h>
+#include <ember/tensor.h>
+
+#include "run_group.h"
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xview.hpp>
+
+#include <unistd.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// The mean squared error of a linear model on a batch.
+Tensor mse(Tensor& w, Tensor& b, const Tensor& x, const Tensor& y) {
+  Tensor error = ember::linear(x, w, b) - y;
+  return (error * error).mean();
+}
+
+// The same batch on every process, of 4 rows per process.
+void batch(std::size_t world_size, Tensor& x, Tensor& y) {
+  xt::xarray<double> x_values = xt::zeros<double>({4 * world_size, 3});
+  xt::xarray<double> y_values = xt::zeros<double>({4 * world_size, 2});
+  for (std::size_t i = 0; i < x_values.size(); ++i) {
+    x_values.flat(i) = static_cast<double>(i) / 10.0;
+  }
+  for (std::size_t i = 0; i < y_values.size(); ++i) {
+    y_values.flat(i) = std::cos(static_cast<double>(i));
+  }
+  x = Tensor::from_xarray(x_values);
+  y = Tensor::from_xarray(y_values);
+}
+
+}  // namespace
+
+TEST(DistributedDataParallelTest, GradientsMatchTheFullBatchGradients) {
+  for (std::size_t bucket_size : {std::size_t{1}, std::size_t{1} << 18}) {
+    bool passed = run_group(3, [&](const std::string& name,
+                                   std::size_t rank) {
+      distributed::ProcessGroup group(name, rank, 3, 4);
+      Tensor x;
+      Tensor y;
+      batch(3, x, y);
+      xt::xarray<double> w_values = {{0.1, -0.2}, {0.3, 0.4}, {-0.5, 0.6}};
+      xt::xarray<double> b_values = {0.7, -0.8};
+
+      Tensor expected_w = Tensor::from_xarray(w_values);
+      Tensor expected_b = Tensor::from_xarray(b_values);
+      expected_w.requires_grad(true);
+      expected_b.requires_grad(true);
+      mse(expected_w, expected_b, x, y).backward();
+
+      Tensor w = Tensor::from_xarray(w_values);
+      Tensor b = Tensor::from_xarray(b_values);
+      w.requires_grad(true);
+      b.requires_grad(true);
+      distributed::DistributedDataParallel trainer(group, {&w, &b},
+                                                   bucket_size);
+      if (trainer.num_buckets() != (bucket_size == 1 ? 2u : 1u)) {
+        return false;
+      }
+      // Two steps check that the trainer is ready again after synchronizing.
+      for (int step = 0; step < 2; ++step) {
+        delete w.gradient;
+        delete b.gradient;
+        w.gradient = b.gradient = nullptr;
+        auto rows = xt::range(4 * rank, 4 * (rank + 1));
+        Tensor x_shard = Tensor::from_xarray(xt::view(x.data_, rows));
+        Tensor y_shard = Tensor::from_xarray(xt::view(y.data_, rows));
+        mse(w, b, x_shard, y_shard).backward();
+        trainer.synchronize();
+        if (!xt::allclose(w.gradient->data_, expected_w.gradient->data_) ||
+            !xt::allclose(b.gradient->data_, expected_b.gradient->data_)) {
+          return false;
+        }
+      }
+      return true;
+    });
+    EXPECT_TRUE(passed) << "bucket size " << bucket_size;
+  }
+}
+
+TEST(DistributedDataParallelTest, UnusedParametersCountAsZeros) {
+  bool passed = run_group(2, [](const std::string& name, std::size_t rank) {
+    distributed::ProcessGroup group(name, rank, 2);
+    Tensor used({1.0, 2.0});
+    Tensor unused({3.0, 4.0});
+    used.requires_grad(true);
+    unused.requires_grad(true);
+    distributed::DistributedDataParallel trainer(group, {&used, &unused}, 1);
+    // Only the first process uses the second parameter.
+    Tensor loss = rank == 0 ? (used * unused).sum() : used.sum();
+    loss.backward();
+    trainer.synchronize();
+    return xt::allclose(used.gradient->data_,
+                        xt::xarray<double>({2.0, 2.5})) &&
+           xt::allclose(unused.gradient->data_,
+                        xt::xarray<double>({0.5, 1.0}));
+  });
+  EXPECT_TRUE(passed);
+}
+
+TEST(DistributedDataParallelTest, BroadcastParametersCopiesTheRoot) {
+  bool passed = run_group(3, [](const std::string& name, std::size_t rank) {
+    distributed::ProcessGroup group(name, rank, 3);
+    Tensor w = Tensor::from_xarray(xt::xarray<double>({1.0, 2.0}) +
+                                   static_cast<double>(rank));
+    w.requires_grad(true);
+    distributed::DistributedDataParallel trainer(group, {&w});
+    trainer.broadcast_parameters(1);
+    return xt::allclose(w.data_, xt::xarray<double>({2.0, 3.0}));
+  });
+  EXPECT_TRUE(passed);
+}
+
+TEST(DistributedDataParallelTest, HooksOutliveTheTrainer) {
+  distributed::ProcessGroup group("ddp-single-" + std::to_string(::getpid()),
+                                  0, 1);
+  Tensor w({1.0, 2.0});
+  w.requires_grad(true);
+  {
+    distributed::DistributedDataParallel trainer(group, {&w});
+    (w * w).sum().backward();
+    trainer.synchronize();
+    EXPECT_TRUE(xt::allclose(w.gradient->data_, xt::xarray<double>({2.0,
+                                                                    4.0})));
+  }
+  (w * w).sum().backward();
+  EXPECT_TRUE(
+      xt::allclose(w.gradient->data_, xt::xarray<double>({4.0, 8.0})));
+}
+
+TEST(DistributedDataParallelTest, AccumulatingTwiceBeforeSynchronizingThrows) {
+  distributed::ProcessGroup group("ddp-twice-" + std::to_string(::getpid()),
+                                  0, 1);
+  Tensor w({1.0, 2.0});
+  w.requires_grad(true);
+  distributed::DistributedDataParallel trainer(group, {&w});
+  w.sum().backward();
+  w.sum().backward();
+  EXPECT_THROW(trainer.synchronize(), std::runtime_error);
+  // The trainer can be used again.
+  w.sum().backward();
+  EXPECT_NO_THROW(trainer.synchronize());
+}
+
+TEST(DistributedDataParallelTest, InvalidArgumentsThrow) {
+  distributed::ProcessGroup group("ddp-invalid-" + std::to_string(::getpid()),
+                                  0, 1);
+  Tensor w({1.0, 2.0});
+  Tensor no_grad({1.0});
+  w.requires_grad(true);
+  EXPECT_THROW(distributed::DistributedDataParallel(group, {&w}, 0),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::DistributedDataParallel(group, {nullptr}),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::DistributedDataParallel(group, {&no_grad}),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::DistributedDataParallel(group, {&w, &w}),
+               std::invalid_argument);
+}
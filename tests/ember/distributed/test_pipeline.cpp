@@ -0,0 +1,155 @@
+#include <ember/distributed/pipeline.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include "../test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// A three-stage model: two hidden layers with tanh, then a linear layer.
+class PipelineTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    manual_seed(0);
+    for (auto shape : {std::vector<std::size_t>{3, 4},
+                       std::vector<std::size_t>{4, 4},
+                       std::vector<std::size_t>{4, 2}}) {
+      weights_.push_back(Tensor::from_xarray(
+          xt::random::randn<double>(shape)));
+      biases_.push_back(
+          Tensor::from_xarray(xt::random::randn<double>({shape[1]})));
+    }
+    for (std::size_t i = 0; i < 3; ++i) {
+      weights_[i].requires_grad(true);
+      biases_[i].requires_grad(true);
+    }
+    x_ = Tensor::randn({7, 3});
+    y_ = Tensor::randn({7, 2});
+  }
+
+  void TearDown() override { clear_gradients(params()); }
+
+  std::vector<Tensor*> params() {
+    std::vector<Tensor*> result;
+    for (std::size_t i = 0; i < 3; ++i) {
+      result.push_back(&weights_[i]);
+      result.push_back(&biases_[i]);
+    }
+    return result;
+  }
+
+  Tensor stage(std::size_t i, const Tensor& input) {
+    Tensor output = ember::linear(input, weights_[i], biases_[i]);
+    return i + 1 < 3 ? ember::tanh(output) : output;
+  }
+
+  std::vector<distributed::Pipeline::Stage> stages() {
+    std::vector<distributed::Pipeline::Stage> result;
+    for (std::size_t i = 0; i < 3; ++i) {
+      result.push_back([this, i](const Tensor& input) {
+        return stage(i, input);
+      });
+    }
+    return result;
+  }
+
+  static Tensor mse(const Tensor& output, const Tensor& target) {
+    Tensor error = output - target;
+    return (error * error).mean();
+  }
+
+  // The gradients of the whole batch through the unsplit model.
+  std::vector<xt::xarray<double>> expected_gradients(double& loss) {
+    Tensor value = mse(stage(2, stage(1, stage(0, x_))), y_);
+    value.backward();
+    loss = value.data_.data()[0];
+    return take_gradients(params());
+  }
+
+  std::vector<Tensor> weights_;
+  std::vector<Tensor> biases_;
+  Tensor x_;
+  Tensor y_;
+};
+
+}  // namespace
+
+TEST_F(PipelineTest, GradientsMatchTheFullBatchGradients) {
+  double expected_loss = 0.0;
+  std::vector<xt::xarray<double>> expected = expected_gradients(expected_loss);
+
+  for (auto schedule : {distributed::Schedule::GPipe,
+                        distributed::Schedule::OneForwardOneBackward}) {
+    // 3 micro-batches don't split 7 rows evenly.
+    for (std::size_t micro_batches : {1, 3, 7}) {
+      distributed::Pipeline pipeline(stages(), micro_batches, schedule);
+      double loss = pipeline.forward_backward(x_, y_, mse);
+
+      EXPECT_NEAR(loss, expected_loss, 1e-12);
+      expect_same(take_gradients(params()), expected);
+    }
+  }
+}
+
+TEST_F(PipelineTest, GradientsAccumulateAcrossCalls) {
+  double expected_loss = 0.0;
+  std::vector<xt::xarray<double>> expected = expected_gradients(expected_loss);
+
+  distributed::Pipeline pipeline(stages(), 2);
+  pipeline.forward_backward(x_, y_, mse);
+  pipeline.forward_backward(x_, y_, mse);
+
+  EXPECT_TRUE(xt::allclose(weights_[0].gradient->data_, 2.0 * expected[0]));
+  EXPECT_TRUE(xt::allclose(biases_[2].gradient->data_, 2.0 * expected[5]));
+}
+
+TEST_F(PipelineTest, SingleStage) {
+  distributed::Pipeline pipeline(
+      {[this](const Tensor& input) { return ember::linear(input, weights_[0],
+                                                          biases_[0]); }},
+      3);
+  Tensor target = Tensor::randn({7, 4});
+  double loss = pipeline.forward_backward(x_, target, mse);
+
+  Tensor expected_weight = Tensor::from_xarray(weights_[0].data_);
+  Tensor expected_bias = Tensor::from_xarray(biases_[0].data_);
+  expected_weight.requires_grad(true);
+  expected_bias.requires_grad(true);
+  Tensor expected =
+      mse(ember::linear(x_, expected_weight, expected_bias), target);
+  expected.backward();
+
+  EXPECT_NEAR(loss, expected.data_.data()[0], 1e-12);
+  EXPECT_TRUE(xt::allclose(weights_[0].gradient->data_,
+                           expected_weight.gradient->data_));
+  clear_gradients({&expected_weight, &expected_bias});
+}
+
+TEST_F(PipelineTest, ExceptionsInAStageAreRethrown) {
+  std::vector<distributed::Pipeline::Stage> failing = stages();
+  failing[1] = [](const Tensor&) -> Tensor {
+    throw std::runtime_error("stage failed");
+  };
+  distributed::Pipeline pipeline(failing, 3);
+
+  EXPECT_THROW(pipeline.forward_backward(x_, y_, mse), std::runtime_error);
+}
+
+TEST_F(PipelineTest, InvalidArgumentsThrow) {
+  EXPECT_THROW(distributed::Pipeline({}, 1), std::invalid_argument);
+  EXPECT_THROW(distributed::Pipeline(stages(), 0), std::invalid_argument);
+
+  distributed::Pipeline pipeline(stages(), 8);
+  // 7 rows can't be split into 8 micro-batches.
+  EXPECT_THROW(pipeline.forward_backward(x_, y_, mse), std::invalid_argument);
+  distributed::Pipeline two(stages(), 2);
+  EXPECT_THROW(two.forward_backward(x_, Tensor::randn({6, 2}), mse),
+               std::invalid_argument);
+}
@@ -0,0 +1,162 @@
+#include <ember/distributed/process_group.h>
+#include <ember/tensor.h>
+
+#include "run_group.h"
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <unistd.h>
+
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace ember;
+
+TEST(ProcessGroupTest, AllReduceSumsTheValuesOfEveryProcess) {
+  for (std::size_t world_size : {1, 2, 3, 4}) {
+    for (std::size_t n : {0, 1, 5, 37}) {
+      // Chunks of 3 values split most buffers into several chunks.
+      bool passed = run_group(world_size, [&](const std::string& name,
+                                              std::size_t rank) {
+        distributed::ProcessGroup group(name, rank, world_size, 3);
+        std::vector<double> data(n);
+        for (std::size_t i = 0; i < n; ++i) {
+          data[i] = static_cast<double>(rank * 100 + i);
+        }
+        group.all_reduce(data.data(), n);
+        for (std::size_t i = 0; i < n; ++i) {
+          double expected = static_cast<double>(
+              100 * world_size * (world_size - 1) / 2 + world_size * i);
+          if (data[i] != expected) {
+            return false;
+          }
+        }
+        return true;
+      });
+      EXPECT_TRUE(passed) << "world size " << world_size << ", n " << n;
+    }
+  }
+}
+
+TEST(ProcessGroupTest, AllReduceOfATensor) {
+  bool passed = run_group(3, [](const std::string& name, std::size_t rank) {
+    distributed::ProcessGroup group(name, rank, 3, 2);
+    Tensor t = Tensor::from_xarray(
+        xt::xarray<double>({{1.0, 2.0}, {3.0, 4.0}}) *
+        static_cast<double>(rank + 1));
+    group.all_reduce(t);
+    return xt::allclose(t.data_,
+                        xt::xarray<double>({{6.0, 12.0}, {18.0, 24.0}}));
+  });
+  EXPECT_TRUE(passed);
+}
+
+TEST(ProcessGroupTest, ConsecutiveCollectivesWithLargeBuffers) {
+  // More chunks than the mailboxes have slots, and several collectives in a
+  // row, so the processes drift apart.
+  bool passed = run_group(4, [](const std::string& name, std::size_t rank) {
+    distributed::ProcessGroup group(name, rank, 4, 8);
+    std::vector<double> data(1000);
+    for (int round = 0; round < 5; ++round) {
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<double>(rank + i + round);
+      }
+      group.all_reduce(data.data(), data.size());
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        if (data[i] != static_cast<double>(6 + 4 * (i + round))) {
+          return false;
+        }
+      }
+      group.barrier();
+    }
+    return true;
+  });
+  EXPECT_TRUE(passed);
+}
+
+TEST(ProcessGroupTest, BroadcastCopiesTheRootsValues) {
+  for (std::size_t root = 0; root < 3; ++root) {
+    bool passed = run_group(3, [&](const std::string& name,
+                                   std::size_t rank) {
+      distributed::ProcessGroup group(name, rank, 3, 4);
+      std::vector<double> data(19, static_cast<double>(rank));
+      group.broadcast(data.data(), data.size(), root);
+      for (double value : data) {
+        if (value != static_cast<double>(root)) {
+          return false;
+        }
+      }
+      return true;
+    });
+    EXPECT_TRUE(passed) << "root " << root;
+  }
+}
+
+TEST(ProcessGroupTest, BarrierCompletesOnEveryProcess) {
+  bool passed = run_group(3, [](const std::string& name, std::size_t rank) {
+    distributed::ProcessGroup group(name, rank, 3);
+    for (int i = 0; i < 10; ++i) {
+      group.barrier();
+    }
+    return true;
+  });
+  EXPECT_TRUE(passed);
+}
+
+TEST(ProcessGroupTest, MismatchedCollectivesThrow) {
+  bool passed = run_group(2, [](const std::string& name, std::size_t rank) {
+    distributed::ProcessGroup group(name, rank, 2);
+    std::vector<double> data(4 + rank);
+    try {
+      group.all_reduce(data.data(), data.size());
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  });
+  EXPECT_TRUE(passed);
+}
+
+TEST(ProcessGroupTest, SingleProcessGroup) {
+  distributed::ProcessGroup group("single-" + std::to_string(::getpid()), 0,
+                                  1);
+  EXPECT_EQ(group.rank(), 0u);
+  EXPECT_EQ(group.world_size(), 1u);
+  std::vector<double> data = {1.0, 2.0};
+  group.all_reduce(data.data(), data.size());
+  group.broadcast(data.data(), data.size(), 0);
+  group.barrier();
+  EXPECT_EQ(data, (std::vector<double>{1.0, 2.0}));
+}
+
+TEST(ProcessGroupTest, InvalidArgumentsThrow) {
+  EXPECT_THROW(distributed::ProcessGroup("invalid", 2, 2),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::ProcessGroup("invalid", 0, 2, 0),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::ProcessGroup("in/valid", 0, 1),
+               std::invalid_argument);
+  EXPECT_THROW(distributed::ProcessGroup("", 0, 1), std::invalid_argument);
+
+  distributed::ProcessGroup group("invalid", 0, 1);
+  std::vector<double> data = {1.0};
+  EXPECT_THROW(group.broadcast(data.data(), 1, 1), std::invalid_argument);
+  SparseRows rows;
+  rows.shape = {2, 1};
+  rows.indices = {1};
+  rows.values = xt::ones<double>({1, 1});
+  Tensor sparse = Tensor::from_sparse_rows(std::move(rows));
+  EXPECT_THROW(group.all_reduce(sparse), std::invalid_argument);
+}
+
+TEST(ProcessGroupTest, JoiningTimesOut) {
+  // The other process never joins.
+  EXPECT_THROW(
+      distributed::ProcessGroup("timeout-" + std::to_string(::getpid()), 0, 2,
+                                distributed::ProcessGroup::kDefaultChunkSize,
+                                std::chrono::milliseconds(20)),
+      std::system_error);
+}
@@ -0,0 +1,301 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <tuple>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+const std::vector<kernels::Isa> kAllIsas = {
+    kernels::Isa::Baseline, kernels::Isa::SSE42, kernels::Isa::AVX2,
+    kernels::Isa::AVX512};
+
+// An odd length so that every vector width has a remainder to handle.
+constexpr std::size_t kLength = 1031;
+
+// The distance between two doubles in units in the last place.
+std::uint64_t ulp_distance(double a, double b) {
+  if (a == b || (std::isnan(a) && std::isnan(b))) {
+    return 0;
+  }
+  auto ordered = [](double x) {
+    std::int64_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    return bits < 0 ? std::numeric_limits<std::int64_t>::min() - bits : bits;
+  };
+  std::int64_t x = ordered(a);
+  std::int64_t y = ordered(b);
+  return x > y ? std::uint64_t(x) - std::uint64_t(y)
+               : std::uint64_t(y) - std::uint64_t(x);
+}
+
+}  // namespace
+
+TEST(KernelDispatch, DetectedIsaIsSupported) {
+  EXPECT_TRUE(kernels::is_supported(kernels::detect_isa()));
+  EXPECT_TRUE(kernels::is_supported(kernels::Isa::Baseline));
+}
+
+TEST(KernelDispatch, SetIsaSwitchesActiveKernels) {
+  kernels::Isa original = kernels::active_isa();
+
+  kernels::set_isa(kernels::Isa::Baseline);
+  EXPECT_EQ(kernels::active_isa(), kernels::Isa::Baseline);
+  EXPECT_STREQ(kernels::active().name, "baseline");
+
+  kernels::set_isa(original);
+  EXPECT_EQ(kernels::active_isa(), original);
+}
+
+TEST(KernelDispatch, UnsupportedIsaIsRejected) {
+  for (kernels::Isa isa : kAllIsas) {
+    if (!kernels::is_supported(isa)) {
+      EXPECT_THROW(kernels::table(isa), std::invalid_argument);
+      EXPECT_THROW(kernels::set_isa(isa), std::invalid_argument);
+    }
+  }
+}
+
+TEST(KernelDispatch, EverySupportedIsaMatchesBaseline) {
+  xt::xarray<double> a = xt::random::randn<double>({kLength});
+  xt::xarray<double> b = xt::random::randn<double>({kLength}) + 3.0;
+  const kernels::KernelTable& baseline =
+      kernels::table(kernels::Isa::Baseline);
+
+  std::vector<double> expected(kLength);
+  std::vector<double> actual(kLength);
+  for (kernels::Isa isa : kAllIsas) {
+    if (!kernels::is_supported(isa)) {
+      continue;
+    }
+    const kernels::KernelTable& k = kernels::table(isa);
+    SCOPED_TRACE(k.name);
+
+    for (auto [expected_fn, actual_fn] :
+         {std::pair{baseline.add, k.add}, std::pair{baseline.sub, k.sub},
+          std::pair{baseline.mul, k.mul}, std::pair{baseline.div, k.div}}) {
+      expected_fn(a.data(), b.data(), expected.data(), kLength);
+      actual_fn(a.data(), b.data(), actual.data(), kLength);
+      EXPECT_EQ(expected, actual);
+    }
+
+    std::copy(b.begin(), b.end(), expected.begin());
+    std::copy(b.begin(), b.end(), actual.begin());
+    baseline.axpy(0.5, a.data(), expected.data(), kLength);
+    k.axpy(0.5, a.data(), actual.data(), kLength);
+    EXPECT_EQ(expected, actual);
+
+    // sqrt, rsqrt and log see |a| so that their results are never NaN.
+    xt::xarray<double> abs_a = xt::abs(a);
+    for (auto [expected_fn, actual_fn, input] :
+         {std::tuple{baseline.sqrt, k.sqrt, &abs_a},
+          std::tuple{baseline.rsqrt, k.rsqrt, &abs_a},
+          std::tuple{baseline.relu, k.relu, &a},
+          std::tuple{baseline.fast_exp, k.fast_exp, &a},
+          std::tuple{baseline.fast_log, k.fast_log, &abs_a},
+          std::tuple{baseline.fast_tanh, k.fast_tanh, &a},
+          std::tuple{baseline.fast_sigmoid, k.fast_sigmoid, &a}}) {
+      expected_fn(input->data(), expected.data(), kLength);
+      actual_fn(input->data(), actual.data(), kLength);
+      EXPECT_EQ(expected, actual);
+    }
+
+    EXPECT_EQ(baseline.sum(a.data(), kLength), k.sum(a.data(), kLength));
+
+    double expected_mean, expected_m2, actual_mean, actual_m2;
+    baseline.moments(a.data(), kLength, &expected_mean, &expected_m2);
+    k.moments(a.data(), kLength, &actual_mean, &actual_m2);
+    EXPECT_EQ(expected_mean, actual_mean);
+    EXPECT_EQ(expected_m2, actual_m2);
+
+    EXPECT_EQ(baseline.argmax(a.data(), kLength), k.argmax(a.data(), kLength));
+    EXPECT_EQ(baseline.argmin(a.data(), kLength), k.argmin(a.data(), kLength));
+
+    std::vector<std::size_t> expected_index(kLength, 0);
+    std::vector<std::size_t> actual_index(kLength, 0);
+    std::copy(b.begin(), b.end(), expected.begin());
+    std::copy(b.begin(), b.end(), actual.begin());
+    baseline.max_update(a.data(), expected.data(), expected_index.data(), 1,
+                        kLength);
+    k.max_update(a.data(), actual.data(), actual_index.data(), 1, kLength);
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(expected_index, actual_index);
+
+    for (bool nesterov : {false, true}) {
+      std::vector<double> expected_buffer(a.begin(), a.end());
+      std::vector<double> actual_buffer(a.begin(), a.end());
+      std::copy(b.begin(), b.end(), expected.begin());
+      std::copy(b.begin(), b.end(), actual.begin());
+      kernels::SgdStep sgd{0.1, 0.9, 0.0, 0.01, nesterov, false};
+      baseline.sgd(expected.data(), a.data(), expected_buffer.data(), kLength,
+                   sgd);
+      k.sgd(actual.data(), a.data(), actual_buffer.data(), kLength, sgd);
+      EXPECT_EQ(expected, actual);
+      EXPECT_EQ(expected_buffer, actual_buffer);
+    }
+
+    for (bool decoupled : {false, true}) {
+      std::vector<double> expected_m(a.begin(), a.end());
+      std::vector<double> actual_m(a.begin(), a.end());
+      std::vector<double> expected_v(kLength, 0.5);
+      std::vector<double> actual_v(kLength, 0.5);
+      std::copy(b.begin(), b.end(), expected.begin());
+      std::copy(b.begin(), b.end(), actual.begin());
+      kernels::AdamStep adam{0.01, 0.9, 0.999, 1e-8, 0.1, decoupled, 0.19,
+                             0.002};
+      baseline.adam(expected.data(), a.data(), expected_m.data(),
+                    expected_v.data(), kLength, adam);
+      k.adam(actual.data(), a.data(), actual_m.data(), actual_v.data(),
+             kLength, adam);
+      EXPECT_EQ(expected, actual);
+      EXPECT_EQ(expected_m, actual_m);
+      EXPECT_EQ(expected_v, actual_v);
+    }
+  }
+}
+
+TEST(KernelDispatch, ArgReductionsReturnFirstOfTiesAndNaNs) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  for (kernels::Isa isa : kAllIsas) {
+    if (!kernels::is_supported(isa)) {
+      continue;
+    }
+    const kernels::KernelTable& k = kernels::table(isa);
+    SCOPED_TRACE(k.name);
+
+    // The ties land in different vector lanes.
+    std::vector<double> values(kLength, 0.0);
+    values[21] = values[900] = values[5] = 2.0;
+    values[300] = values[13] = -2.0;
+    EXPECT_EQ(k.argmax(values.data(), kLength), 5);
+    EXPECT_EQ(k.argmin(values.data(), kLength), 13);
+
+    values[700] = values[402] = nan;
+    EXPECT_EQ(k.argmax(values.data(), kLength), 402);
+    EXPECT_EQ(k.argmin(values.data(), kLength), 402);
+  }
+}
+
+TEST(KernelDispatch, FastMathKernelsStayWithinTheirErrorBounds) {
+  xt::xarray<double> x = xt::random::randn<double>({kLength}) * 30.0;
+  xt::xarray<double> positive =
+      xt::exp(xt::random::randn<double>({kLength}) * 50.0);
+  std::vector<double> out(kLength);
+
+  // The references are computed in extended precision, so they are
+  // correctly rounded and the bounds below are the documented ones.
+  struct Case {
+    kernels::UnaryKernel kernel;
+    long double (*reference)(long double);
+    const xt::xarray<double>* input;
+    std::uint64_t max_ulps;
+  };
+  for (kernels::Isa isa : kAllIsas) {
+    if (!kernels::is_supported(isa)) {
+      continue;
+    }
+    const kernels::KernelTable& k = kernels::table(isa);
+    SCOPED_TRACE(k.name);
+
+    for (const Case& c :
+         {Case{k.fast_exp, [](long double v) { return std::exp(v); }, &x, 2},
+          Case{k.fast_log, [](long double v) { return std::log(v); },
+               &positive, 2},
+          Case{k.fast_tanh, [](long double v) { return std::tanh(v); }, &x, 3},
+          Case{k.fast_sigmoid,
+               [](long double v) { return 1.0L / (1.0L + std::exp(-v)); }, &x,
+               3}}) {
+      c.kernel(c.input->data(), out.data(), kLength);
+      for (std::size_t i = 0; i < kLength; ++i) {
+        double v = (*c.input)(i);
+        double expected = static_cast<double>(c.reference(v));
+        EXPECT_LE(ulp_distance(out[i], expected), c.max_ulps) << "at " << v;
+      }
+    }
+  }
+}
+
+TEST(KernelDispatch, FastMathKernelsHandleSpecialValues) {
+  double inf = std::numeric_limits<double>::infinity();
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  const kernels::KernelTable& k = kernels::active();
+  std::vector<double> x = {-inf, -1000.0, 0.0, 1000.0, inf, nan};
+  std::vector<double> out(x.size());
+
+  k.fast_exp(x.data(), out.data(), x.size());
+  EXPECT_EQ(out[0], 0.0);
+  EXPECT_EQ(out[1], 0.0);
+  EXPECT_EQ(out[2], 1.0);
+  EXPECT_EQ(out[3], inf);
+  EXPECT_EQ(out[4], inf);
+  EXPECT_TRUE(std::isnan(out[5]));
+
+  k.fast_tanh(x.data(), out.data(), x.size());
+  EXPECT_EQ(out[0], -1.0);
+  EXPECT_EQ(out[1], -1.0);
+  EXPECT_EQ(out[2], 0.0);
+  EXPECT_EQ(out[3], 1.0);
+  EXPECT_EQ(out[4], 1.0);
+  EXPECT_TRUE(std::isnan(out[5]));
+
+  std::vector<double> y = {-1.0, 0.0, 1.0, inf, nan};
+  k.fast_log(y.data(), out.data(), y.size());
+  EXPECT_TRUE(std::isnan(out[0]));
+  EXPECT_EQ(out[1], -inf);
+  EXPECT_EQ(out[2], 0.0);
+  EXPECT_EQ(out[3], inf);
+  EXPECT_TRUE(std::isnan(out[4]));
+}
+
+TEST(KernelDispatch, MomentsAreAccurateForLargeOffsets) {
+  const kernels::KernelTable& k = kernels::active();
+  for (std::size_t n : {0, 1, 5, 8, 9, 1000}) {
+    xt::xarray<double> x = xt::random::randn<double>({n}) + 1e9;
+    double mean, m2;
+    k.moments(x.data(), n, &mean, &m2);
+
+    // The offset is subtracted exactly before averaging, as a naive mean of
+    // values around 1e9 is itself off by several ulps.
+    double expected_mean = n == 0 ? 0.0 : xt::mean(x - 1e9)() + 1e9;
+    xt::xarray<double> centered = x - expected_mean;
+    double expected_m2 = xt::sum(centered * centered)();
+    EXPECT_NEAR(mean, expected_mean, 1e-6) << "n = " << n;
+    EXPECT_NEAR(m2, expected_m2, 1e-6 * std::max<double>(n, 1))
+        << "n = " << n;
+  }
+}
+
+TEST(KernelDispatch, SumHandlesShortInputs) {
+  const kernels::KernelTable& k = kernels::active();
+  std::vector<double> values = {1.0, 2.0, 3.0};
+  EXPECT_DOUBLE_EQ(k.sum(values.data(), 0), 0.0);
+  EXPECT_DOUBLE_EQ(k.sum(values.data(), 3), 6.0);
+}
+
+TEST(KernelDispatch, OpsProduceSameResultsForEveryIsa) {
+  kernels::Isa original = kernels::active_isa();
+  Tensor a = Tensor::randn({17, 33});
+  Tensor b = Tensor::randn({33});
+
+  kernels::set_isa(kernels::Isa::Baseline);
+  Tensor expected = (a * b + a) / (b * b + 1.0);
+
+  for (kernels::Isa isa : kAllIsas) {
+    if (kernels::is_supported(isa)) {
+      kernels::set_isa(isa);
+      EXPECT_EQ((a * b + a) / (b * b + 1.0), expected);
+    }
+  }
+  kernels::set_isa(original);
+}
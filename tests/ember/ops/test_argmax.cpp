@@ -0,0 +1,46 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xio.hpp>
+#include <xtensor/xrandom.hpp>
+#include <xtensor/xsort.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorArgmax, ArgmaxOfAllElementsIsAFlatIndex) {
+  Tensor a({{1.0, 7.0, 3.0}, {4.0, 9.0, 6.0}}, true);
+
+  Tensor b = a.argmax();
+
+  EXPECT_EQ(b.data_.dimension(), 0);
+  EXPECT_EQ(b(), 4.0);
+  EXPECT_FALSE(b.requires_grad());
+}
+
+TEST(TensorArgmax, ArgmaxAlongAxisIsFound) {
+  Tensor a({{1.0, 7.0, 3.0}, {4.0, 5.0, 6.0}});
+
+  EXPECT_EQ(a.argmax(0), Tensor({1.0, 0.0, 1.0}));
+  EXPECT_EQ(a.argmax(0, true), Tensor({{1.0, 0.0, 1.0}}));
+  EXPECT_EQ(a.argmax(-1), Tensor({1.0, 2.0}));
+}
+
+TEST(TensorArgmax, TiesAndNaNsGoToTheFirstPosition) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  Tensor a({{2.0, 5.0, 5.0, 1.0}, {3.0, nan, 3.0, nan}});
+
+  EXPECT_EQ(a.argmax(1), Tensor({1.0, 1.0}));
+}
+
+TEST(TensorArgmax, LongRowsMatchXtensor) {
+  // Long enough for the vectorized kernel to keep several running maxima.
+  xt::xarray<double> data = xt::random::randn<double>({3, 1001});
+  Tensor a = Tensor::from_xarray(data);
+
+  xt::xarray<double> expected = xt::argmax(data, 1);
+  EXPECT_EQ(a.argmax(1), Tensor::from_xarray(expected));
+}
@@ -0,0 +1,72 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// A tensor of shape (1, 1, height, width) holding the given rows.
+Tensor image(std::initializer_list<std::initializer_list<double>> rows) {
+  Tensor t(rows);
+  t.data_.reshape(std::vector<std::size_t>{1, 1, t.data_.shape()[0],
+                                           t.data_.shape()[1]});
+  return t;
+}
+
+}  // namespace
+
+TEST(TensorAvgPool2d, AvgPool2dIsCorrectlyComputed) {
+  Tensor x = image({{1.0, 5.0, 2.0, 0.0},
+                    {3.0, 4.0, 8.0, 1.0},
+                    {0.0, 2.0, 1.0, 1.0},
+                    {7.0, 6.0, 3.0, 9.0}});
+
+  EXPECT_TRUE(ember::avg_pool2d(x, {2, 2}).equals_approx(
+      image({{3.25, 2.75}, {3.75, 3.5}})));
+  EXPECT_TRUE(ember::avg_pool2d(x, {1, 4}, {{2, 1}})
+                  .equals_approx(image({{2.0}, {1.0}})));
+}
+
+TEST(TensorAvgPool2d, PaddingCountsAsZeros) {
+  Tensor x = image({{4.0, 8.0}, {12.0, 16.0}});
+
+  Tensor y = ember::avg_pool2d(x, {2, 2}, std::nullopt, {1, 1});
+
+  EXPECT_TRUE(y.equals_approx(image({{1.0, 2.0}, {3.0, 4.0}})));
+}
+
+TEST(TensorAvgPool2d, GradientIsSpreadOverEachWindow) {
+  Tensor x = Tensor::randn({2, 3, 3, 3});
+  x.requires_grad(true);
+
+  // The windows overlap in the middle row and column.
+  Tensor y = ember::avg_pool2d(x, {2, 2}, {{1, 1}});
+  y.backward();
+
+  Tensor expected = Tensor::from_xarray(xt::xarray<double>(
+      {{0.25, 0.5, 0.25}, {0.5, 1.0, 0.5}, {0.25, 0.5, 0.25}}));
+  for (std::size_t n = 0; n < 2; ++n) {
+    for (std::size_t c = 0; c < 3; ++c) {
+      for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+          EXPECT_DOUBLE_EQ((*x.gradient)(n, c, i, j), expected(i, j));
+        }
+      }
+    }
+  }
+}
+
+TEST(TensorAvgPool2d, InvalidWindowsAreRejected) {
+  Tensor x = Tensor::randn({1, 2, 4, 4});
+
+  EXPECT_THROW(ember::avg_pool2d(Tensor::randn({2, 4, 4}), {2, 2}),
+               std::invalid_argument);
+  EXPECT_THROW(ember::avg_pool2d(x, {2, 5}), std::invalid_argument);
+  EXPECT_THROW(ember::avg_pool2d(x, {2, 2}, std::nullopt, {0, 2}),
+               std::invalid_argument);
+}
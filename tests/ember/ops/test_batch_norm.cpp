@@ -0,0 +1,147 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmath.hpp>
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace ember;
+
+TEST(TensorBatchNorm, TrainingModeNormalizesEachChannel) {
+  Tensor x({{1.0, 10.0}, {2.0, 10.0}, {4.0, 10.0}});
+  Tensor w({1.0, 2.0});
+  Tensor b({0.0, 0.5});
+  Tensor running_mean({0.0, 0.0});
+  Tensor running_var({1.0, 1.0});
+
+  Tensor y = ember::batch_norm(x, w, b, running_mean, running_var, true);
+
+  EXPECT_TRUE(y.equals_approx(Tensor({{-1.0690415314502977, 0.5},
+                                      {-0.26726038286257453, 0.5},
+                                      {1.3363019143128718, 0.5}})));
+  // The running variance is updated with the unbiased variance, 7/3.
+  EXPECT_TRUE(running_mean.equals_approx(Tensor({0.7 / 3, 1.0})));
+  EXPECT_TRUE(
+      running_var.equals_approx(Tensor({0.9 + 0.1 * 7.0 / 3.0, 0.9})));
+}
+
+TEST(TensorBatchNorm, GradientsMatchComposedOps) {
+  Tensor x = Tensor::randn({9, 4}, 2.0, 3.0);
+  Tensor w = Tensor::randn({4});
+  Tensor b = Tensor::randn({4});
+  x.requires_grad(true);
+  w.requires_grad(true);
+  b.requires_grad(true);
+  Tensor upstream = Tensor::randn({9, 4});
+  Tensor running_mean({0.0, 0.0, 0.0, 0.0});
+  Tensor running_var({1.0, 1.0, 1.0, 1.0});
+
+  Tensor centered = x - ember::mean(x, {0}, true);
+  Tensor var = ember::mean(centered * centered, {0}, true);
+  Tensor expected = centered * ember::rsqrt(var + 1e-5) * w + b;
+  (expected * upstream).backward();
+  Tensor x_grad = *x.gradient, w_grad = *w.gradient, b_grad = *b.gradient;
+  delete x.gradient;
+  delete w.gradient;
+  delete b.gradient;
+  x.gradient = w.gradient = b.gradient = nullptr;
+
+  Tensor actual =
+      ember::batch_norm(x, w, b, running_mean, running_var, true);
+  (actual * upstream).backward();
+
+  EXPECT_TRUE(actual.equals_approx(expected));
+  EXPECT_TRUE(x.gradient->equals_approx(x_grad));
+  EXPECT_TRUE(w.gradient->equals_approx(w_grad));
+  EXPECT_TRUE(b.gradient->equals_approx(b_grad));
+}
+
+TEST(TensorBatchNorm, SpatialDimensionsShareStatistics) {
+  Tensor x = Tensor::randn({3, 2, 5}, 4.0, 2.0);
+  Tensor w = Tensor::from_xarray(xt::ones<double>({2}));
+  Tensor b = Tensor::from_xarray(xt::zeros<double>({2}));
+  Tensor running_mean = Tensor::from_xarray(xt::zeros<double>({2}));
+  Tensor running_var = Tensor::from_xarray(xt::ones<double>({2}));
+
+  Tensor y = ember::batch_norm(x, w, b, running_mean, running_var, true, 0.1,
+                               0.0);
+
+  for (std::size_t c = 0; c < 2; ++c) {
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    for (std::size_t n = 0; n < 3; ++n) {
+      for (std::size_t i = 0; i < 5; ++i) {
+        sum += y(n, c, i);
+        sum_squares += y(n, c, i) * y(n, c, i);
+      }
+    }
+    EXPECT_NEAR(sum / 15, 0.0, 1e-12);
+    EXPECT_NEAR(sum_squares / 15, 1.0, 1e-12);
+  }
+}
+
+TEST(TensorBatchNorm, SpatialGradientsMatchFiniteDifferences) {
+  Tensor x = Tensor::randn({2, 2, 3});
+  Tensor w({1.5, -0.5});
+  Tensor b({0.1, 0.2});
+  Tensor upstream = Tensor::randn({2, 2, 3});
+  Tensor running_mean({0.0, 0.0});
+  Tensor running_var({1.0, 1.0});
+  auto loss = [&](const Tensor& input) {
+    Tensor y =
+        ember::batch_norm(input, w, b, running_mean, running_var, true);
+    return xt::sum(y.data_ * upstream.data_)();
+  };
+
+  x.requires_grad(true);
+  (ember::batch_norm(x, w, b, running_mean, running_var, true) * upstream)
+      .backward();
+
+  double h = 1e-6;
+  for (std::size_t i = 0; i < x.data_.size(); ++i) {
+    Tensor plus = x;
+    Tensor minus = x;
+    plus.data_.data()[i] += h;
+    minus.data_.data()[i] -= h;
+    double numeric = (loss(plus) - loss(minus)) / (2 * h);
+    EXPECT_NEAR(x.gradient->data_.data()[i], numeric, 1e-6);
+  }
+}
+
+TEST(TensorBatchNorm, InferenceModeUsesRunningStatistics) {
+  Tensor x({{1.0, 2.0}, {3.0, 4.0}}, true);
+  Tensor w({2.0, 1.0});
+  Tensor b({0.0, 1.0});
+  Tensor running_mean({1.0, 2.0});
+  Tensor running_var({4.0, 0.25});
+
+  Tensor y = ember::batch_norm(x, w, b, running_mean, running_var, false, 0.1,
+                               0.0);
+
+  EXPECT_TRUE(y.equals_approx(Tensor({{0.0, 1.0}, {2.0, 5.0}})));
+  EXPECT_EQ(running_mean, Tensor({1.0, 2.0}));
+  EXPECT_EQ(running_var, Tensor({4.0, 0.25}));
+
+  y.backward();
+
+  // Each output depends only on its own input, scaled by w / sqrt(var).
+  EXPECT_TRUE(x.gradient->equals_approx(Tensor({{1.0, 2.0}, {1.0, 2.0}})));
+}
+
+TEST(TensorBatchNorm, InvalidInputsAreRejected) {
+  Tensor stats({0.0, 0.0});
+  Tensor ones({1.0, 1.0});
+
+  EXPECT_THROW(ember::batch_norm(Tensor({1.0, 2.0}), ones, stats, stats, ones,
+                                 true),
+               std::invalid_argument);
+  EXPECT_THROW(ember::batch_norm(Tensor::randn({3, 3}), ones, stats, stats,
+                                 ones, true),
+               std::invalid_argument);
+  // A single value per channel has no variance to normalize by.
+  EXPECT_THROW(ember::batch_norm(Tensor({{1.0, 2.0}}), ones, stats, stats,
+                                 ones, true),
+               std::invalid_argument);
+}
@@ -0,0 +1,117 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(TensorCat, CatIsCorrectlyComputed) {
+  Tensor a({{1.0, 2.0}, {3.0, 4.0}});
+  Tensor b({{5.0, 6.0}, {7.0, 8.0}});
+  Tensor c({{9.0, 10.0, 11.0}, {12.0, 13.0, 14.0}});
+
+  EXPECT_TRUE(ember::cat({a, b}).equals(
+      Tensor({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}, {7.0, 8.0}})));
+  EXPECT_TRUE(ember::cat({a, c}, -1).equals(
+      Tensor({{1.0, 2.0, 9.0, 10.0, 11.0}, {3.0, 4.0, 12.0, 13.0, 14.0}})));
+}
+
+TEST(TensorCat, StackIsCorrectlyComputed) {
+  Tensor a({1.0, 2.0});
+  Tensor b({3.0, 4.0});
+
+  EXPECT_TRUE(ember::stack({a, b}).equals(Tensor({{1.0, 2.0}, {3.0, 4.0}})));
+  EXPECT_TRUE(
+      ember::stack({a, b}, -1).equals(Tensor({{1.0, 3.0}, {2.0, 4.0}})));
+}
+
+TEST(TensorCat, GradientIsSlicedPerInput) {
+  Tensor a = Tensor::randn({2, 3, 2});
+  Tensor b = Tensor::randn({2, 1, 2});
+  Tensor c = Tensor::randn({2, 2, 2});
+  a.requires_grad(true);
+  c.requires_grad(true);
+  Tensor upstream = Tensor::randn({2, 6, 2});
+
+  (ember::cat({a, b, c}, 1) * upstream).backward();
+
+  auto pieces = ember::split(upstream, {3, 1, 2}, 1);
+  EXPECT_TRUE(a.gradient->equals(pieces[0]));
+  EXPECT_EQ(b.gradient, nullptr);
+  EXPECT_TRUE(c.gradient->equals(pieces[2]));
+}
+
+TEST(TensorCat, StackGradientHasTheShapeOfEachInput) {
+  Tensor a = Tensor::randn({2, 3});
+  Tensor b = Tensor::randn({2, 3});
+  a.requires_grad(true);
+  b.requires_grad(true);
+
+  (ember::stack({a, b}, 1) *
+   Tensor({{{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}},
+           {{7.0, 8.0, 9.0}, {10.0, 11.0, 12.0}}}))
+      .backward();
+
+  EXPECT_TRUE(a.gradient->equals(Tensor({{1.0, 2.0, 3.0}, {7.0, 8.0, 9.0}})));
+  EXPECT_TRUE(
+      b.gradient->equals(Tensor({{4.0, 5.0, 6.0}, {10.0, 11.0, 12.0}})));
+}
+
+TEST(TensorCat, CatIntoWritesIntoTheDestination) {
+  Tensor a = Tensor::randn({2, 3});
+  Tensor b = Tensor::randn({2, 1});
+  a.requires_grad(true);
+  Tensor out = Tensor::from_shape({2, 4});
+  const double* buffer = out.data_.data();
+
+  Tensor& result = ember::cat_into(out, {a, b}, 1);
+
+  EXPECT_EQ(&result, &out);
+  EXPECT_EQ(out.data_.data(), buffer);
+  EXPECT_TRUE(out.equals(ember::cat({a, b}, 1)));
+
+  Tensor upstream = Tensor::randn({2, 4});
+  (out * upstream).backward();
+  EXPECT_TRUE(a.gradient->equals(ember::split(upstream, {3, 1}, 1)[0]));
+}
+
+TEST(TensorCat, CatIntoReplacesTheDestinationsHistory) {
+  Tensor a = Tensor::randn({2, 2});
+  Tensor b = Tensor::randn({2, 2});
+  a.requires_grad(true);
+  Tensor out = Tensor::from_shape({4, 2});
+
+  ember::cat_into(out, {a, b});
+  EXPECT_TRUE(out.requires_grad());
+  ember::cat_into(out, {b, b});
+  EXPECT_FALSE(out.requires_grad());
+  EXPECT_TRUE(out.equals(ember::cat({b, b})));
+}
+
+TEST(TensorCat, CatIntoRejectsMismatchedDestinations) {
+  Tensor a = Tensor::randn({2, 3});
+  Tensor wrong = Tensor::from_shape({2, 6});
+  Tensor self = Tensor::from_shape({4, 3});
+  Tensor empty = Tensor::from_xarray(
+      xt::empty<double>(std::vector<std::size_t>{0, 3}));
+
+  EXPECT_THROW(ember::cat_into(wrong, {a, a}), std::invalid_argument);
+  EXPECT_NO_THROW(ember::cat_into(wrong, {a, a}, 1));
+  EXPECT_THROW(ember::cat_into(self, {self, empty}), std::invalid_argument);
+}
+
+TEST(TensorCat, MismatchedShapesAreRejected) {
+  Tensor a = Tensor::randn({2, 3});
+  Tensor b = Tensor::randn({3, 2});
+  Tensor c = Tensor::randn({2, 3, 1});
+
+  EXPECT_THROW(ember::cat({}), std::invalid_argument);
+  EXPECT_THROW(ember::cat({a, b}, 1), std::invalid_argument);
+  EXPECT_THROW(ember::cat({a, c}), std::invalid_argument);
+  EXPECT_THROW(ember::cat({a, a}, 2), std::invalid_argument);
+  EXPECT_THROW(ember::stack({a, b}), std::invalid_argument);
+  EXPECT_NO_THROW(ember::stack({a, a}, 2));
+  EXPECT_THROW(ember::stack({a, a}, 3), std::invalid_argument);
+}
@@ -0,0 +1,168 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+
+using namespace ember;
+
+namespace {
+
+// The convolution computed directly from its definition.
+xt::xarray<double> reference(const xt::xarray<double>& x,
+                             const xt::xarray<double>& w,
+                             const xt::xarray<double>& b,
+                             const Conv2dOptions& options) {
+  std::size_t batch = x.shape()[0];
+  std::size_t height = x.shape()[2], width = x.shape()[3];
+  std::size_t out_channels = w.shape()[0], group_in = w.shape()[1];
+  std::size_t kh = w.shape()[2], kw = w.shape()[3];
+  std::size_t group_out = out_channels / options.groups;
+  auto [sh, sw] = options.stride;
+  auto [ph, pw] = options.padding;
+  auto [dh, dw] = options.dilation;
+  std::size_t oh = (height + 2 * ph - dh * (kh - 1) - 1) / sh + 1;
+  std::size_t ow = (width + 2 * pw - dw * (kw - 1) - 1) / sw + 1;
+
+  xt::xarray<double> y = xt::zeros<double>({batch, out_channels, oh, ow});
+  for (std::size_t n = 0; n < batch; ++n) {
+    for (std::size_t o = 0; o < out_channels; ++o) {
+      std::size_t first_channel = o / group_out * group_in;
+      for (std::size_t i = 0; i < oh; ++i) {
+        for (std::size_t j = 0; j < ow; ++j) {
+          double total = b(o);
+          for (std::size_t c = 0; c < group_in; ++c) {
+            for (std::size_t k = 0; k < kh; ++k) {
+              for (std::size_t l = 0; l < kw; ++l) {
+                // Unsigned arithmetic wraps, so the padding is out of range.
+                std::size_t row = i * sh + k * dh - ph;
+                std::size_t col = j * sw + l * dw - pw;
+                if (row < height && col < width) {
+                  total += w(o, c, k, l) * x(n, first_channel + c, row, col);
+                }
+              }
+            }
+          }
+          y(n, o, i, j) = total;
+        }
+      }
+    }
+  }
+  return y;
+}
+
+/**
+ * Checks the forward pass and every gradient of a convolution against the
+ * reference, whose gradients of sum(y * upstream) are computed with central
+ * differences.
+ */
+void expect_matches_reference(std::initializer_list<std::size_t> input_shape,
+                              std::initializer_list<std::size_t> weight_shape,
+                              const Conv2dOptions& options) {
+  Tensor x = Tensor::randn(input_shape);
+  Tensor w = Tensor::randn(weight_shape);
+  Tensor b = Tensor::randn({*weight_shape.begin()});
+  x.requires_grad(true);
+  w.requires_grad(true);
+  b.requires_grad(true);
+
+  Tensor y = ember::conv2d(x, w, b, options);
+  xt::xarray<double> expected = reference(x.data_, w.data_, b.data_, options);
+  ASSERT_EQ(y.data_.shape(), expected.shape());
+  EXPECT_TRUE(xt::allclose(y.data_, expected));
+
+  Tensor upstream = Tensor::from_xarray(xt::random::randn<double>(
+      y.data_.shape()));
+  (y * upstream).backward();
+
+  double h = 1e-6;
+  for (Tensor* param : {&x, &w, &b}) {
+    xt::xarray<double> numerical = xt::zeros_like(param->data_);
+    for (std::size_t i = 0; i < param->data_.size(); ++i) {
+      double original = param->data_.data()[i];
+      param->data_.data()[i] = original + h;
+      xt::xarray<double> plus =
+          reference(x.data_, w.data_, b.data_, options) * upstream.data_;
+      param->data_.data()[i] = original - h;
+      xt::xarray<double> minus =
+          reference(x.data_, w.data_, b.data_, options) * upstream.data_;
+      param->data_.data()[i] = original;
+      numerical.data()[i] = xt::sum(plus - minus)() / (2 * h);
+    }
+    EXPECT_TRUE(xt::allclose(param->gradient->data_, numerical, 1e-5, 1e-6));
+  }
+}
+
+}  // namespace
+
+TEST(TensorConv2d, Conv2dIsCorrectlyComputed) {
+  xt::xarray<double> values = xt::arange<double>(1.0, 10.0);
+  values.reshape({1, 1, 3, 3});
+  Tensor x = Tensor::from_xarray(values);
+  Tensor w = Tensor::from_xarray(xt::ones<double>({1, 1, 2, 2}));
+
+  Tensor y = ember::conv2d(x, w, Tensor({0.5}));
+
+  EXPECT_TRUE(y.equals_approx(Tensor::from_xarray(
+      xt::xarray<double>({{{{12.5, 16.5}, {24.5, 28.5}}}}))));
+}
+
+TEST(TensorConv2d, GeneralConvolutionMatchesReference) {
+  expect_matches_reference({2, 3, 7, 6}, {4, 3, 3, 2}, {});
+  expect_matches_reference({2, 3, 7, 6}, {4, 3, 3, 2},
+                           {.stride = {2, 1}, .padding = {1, 2},
+                            .dilation = {2, 1}});
+}
+
+TEST(TensorConv2d, GroupedConvolutionMatchesReference) {
+  expect_matches_reference({2, 4, 5, 5}, {6, 2, 3, 3},
+                           {.padding = {1, 1}, .groups = 2});
+}
+
+TEST(TensorConv2d, DepthwiseConvolutionMatchesReference) {
+  expect_matches_reference({2, 3, 6, 5}, {6, 1, 3, 3},
+                           {.stride = {2, 2}, .padding = {1, 1},
+                            .groups = 3});
+}
+
+TEST(TensorConv2d, PointwiseConvolutionMatchesReference) {
+  expect_matches_reference({2, 4, 3, 5}, {3, 4, 1, 1}, {});
+  expect_matches_reference({2, 4, 3, 5}, {6, 2, 1, 1}, {.groups = 2});
+}
+
+TEST(TensorConv2d, InputGradientIsSkippedWhenNotRequired) {
+  Tensor x = Tensor::randn({1, 2, 4, 4});
+  Tensor w = Tensor::randn({3, 2, 3, 3});
+  w.requires_grad(true);
+
+  ember::conv2d(x, w).sum().backward();
+
+  EXPECT_EQ(x.gradient, nullptr);
+  ASSERT_NE(w.gradient, nullptr);
+  EXPECT_EQ(w.gradient->data_.shape(), w.data_.shape());
+}
+
+TEST(TensorConv2d, MismatchedShapesAreRejected) {
+  Tensor x = Tensor::randn({1, 4, 5, 5});
+
+  EXPECT_THROW(ember::conv2d(x, Tensor::randn({2, 3, 3, 3})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::conv2d(x, Tensor::randn({3, 2, 3, 3}),
+                             Conv2dOptions{.groups = 2}),
+               std::invalid_argument);
+  EXPECT_THROW(ember::conv2d(x, Tensor::randn({2, 4, 3, 3}),
+                             Tensor::randn({3})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::conv2d(x, Tensor::randn({2, 4, 7, 3})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::conv2d(x, Tensor::randn({2, 4, 3, 3}),
+                             Conv2dOptions{.stride = {0, 1}}),
+               std::invalid_argument);
+  EXPECT_THROW(ember::conv2d(Tensor::randn({4, 5, 5}),
+                             Tensor::randn({2, 4, 3, 3})),
+               std::invalid_argument);
+}
@@ -0,0 +1,60 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace ember;
+
+TEST(TensorCrossEntropy, CrossEntropyIsCorrectlyComputed) {
+  Tensor logits({{1.0, 2.0, 3.0}, {1.0, 1.0, 1.0}}, true);
+  Tensor targets({2.0, 0.0});
+
+  Tensor loss = ember::cross_entropy(logits, targets);
+
+  EXPECT_EQ(loss.data_.dimension(), 0);
+  EXPECT_DOUBLE_EQ(loss(), 0.7531091265562448);
+
+  loss.backward();
+
+  EXPECT_TRUE(logits.gradient->equals_approx(
+      Tensor({{0.04501528658519023, 0.12236423552739883, -0.16737952211258905},
+              {-0.33333333333333337, 0.16666666666666666,
+               0.16666666666666666}})));
+}
+
+TEST(TensorCrossEntropy, GradientMatchesComposedOps) {
+  Tensor logits = Tensor::randn({5, 4}, 0.0, 3.0);
+  logits.requires_grad(true);
+  Tensor targets({3.0, 0.0, 1.0, 1.0, 2.0});
+  Tensor onehot({{0.0, 0.0, 0.0, 1.0},
+                 {1.0, 0.0, 0.0, 0.0},
+                 {0.0, 1.0, 0.0, 0.0},
+                 {0.0, 1.0, 0.0, 0.0},
+                 {0.0, 0.0, 1.0, 0.0}});
+
+  Tensor expected = ember::mean(logits.log_softmax() * onehot) * -4.0;
+  expected.backward();
+  Tensor expected_grad = *logits.gradient;
+  delete logits.gradient;
+  logits.gradient = nullptr;
+
+  Tensor actual = ember::cross_entropy(logits, targets);
+  actual.backward();
+
+  EXPECT_NEAR(actual(), expected(), 1e-12);
+  EXPECT_TRUE(logits.gradient->equals_approx(expected_grad));
+}
+
+TEST(TensorCrossEntropy, InvalidTargetsAreRejected) {
+  Tensor logits = Tensor::randn({2, 3});
+
+  EXPECT_THROW(ember::cross_entropy(logits, Tensor({0.0, 3.0})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::cross_entropy(logits, Tensor({0.0, 1.5})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::cross_entropy(logits, Tensor({0.0, -1.0})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::cross_entropy(logits, Tensor({0.0})),
+               std::invalid_argument);
+}
@@ -0,0 +1,81 @@
+#include <ember/parallel/parallel.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <stdexcept>
+
+using namespace ember;
+
+TEST(TensorDropout, DropsAboutPAndScalesTheRest) {
+  manual_seed(0);
+  Tensor x = Tensor::from_xarray(xt::ones<double>({100, 100}));
+
+  Tensor y = ember::dropout(x, 0.3);
+
+  std::size_t dropped = 0;
+  for (double value : y.data_) {
+    if (value == 0.0) {
+      dropped += 1;
+    } else {
+      EXPECT_DOUBLE_EQ(value, 1.0 / 0.7);
+    }
+  }
+  EXPECT_NEAR(dropped / 10000.0, 0.3, 0.02);
+}
+
+TEST(TensorDropout, SameSeedGivesTheSameMask) {
+  Tensor x = Tensor::randn({30, 7});
+
+  manual_seed(42);
+  Tensor a = ember::dropout(x, 0.5);
+  Tensor b = ember::dropout(x, 0.5);
+  manual_seed(42);
+  Tensor c = ember::dropout(x, 0.5);
+
+  EXPECT_TRUE(a.equals(c));
+  EXPECT_FALSE(a.equals(b));
+}
+
+TEST(TensorDropout, GradientRegeneratesTheMask) {
+  Tensor x = Tensor::from_xarray(xt::ones<double>({13, 9}));
+  x.requires_grad(true);
+
+  Tensor y = ember::dropout(x, 0.4);
+  y.sum().backward();
+
+  EXPECT_TRUE(x.gradient->equals(y));
+}
+
+TEST(TensorDropout, MaskDoesntDependOnTheNumberOfThreads) {
+  Tensor x = Tensor::randn({300, 301});
+  std::size_t original_num_threads = get_num_threads();
+
+  set_num_threads(1);
+  manual_seed(5);
+  Tensor a = ember::dropout(x, 0.2);
+  set_num_threads(4);
+  manual_seed(5);
+  Tensor b = ember::dropout(x, 0.2);
+  set_num_threads(original_num_threads);
+
+  EXPECT_TRUE(a.equals(b));
+}
+
+TEST(TensorDropout, EvaluationAndExtremeProbabilities) {
+  Tensor x = Tensor::randn({4, 5});
+
+  EXPECT_TRUE(ember::dropout(x, 0.5, false).equals(x));
+  EXPECT_TRUE(ember::dropout(x, 0.0).equals(x));
+  EXPECT_TRUE(ember::dropout(x, 1.0).equals(
+      Tensor::from_xarray(xt::zeros<double>({4, 5}))));
+}
+
+TEST(TensorDropout, InvalidProbabilitiesAreRejected) {
+  Tensor x = Tensor::randn({2, 2});
+
+  EXPECT_THROW(ember::dropout(x, -0.1), std::invalid_argument);
+  EXPECT_THROW(ember::dropout(x, 1.5), std::invalid_argument);
+}
@@ -0,0 +1,139 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace ember;
+
+TEST(TensorEinsum, EinsumIsCorrectlyComputed) {
+  Tensor a({{1.0, 2.0}, {3.0, 4.0}});
+  Tensor b({{5.0, 6.0}, {7.0, 8.0}});
+  Tensor u({1.0, 2.0});
+  Tensor v({3.0, 4.0, 5.0});
+
+  EXPECT_TRUE(ember::einsum("ij,jk->ik", {a, b})
+                  .equals(Tensor({{19.0, 22.0}, {43.0, 50.0}})));
+  EXPECT_TRUE(ember::einsum("ij,jk", {a, b})
+                  .equals(Tensor({{19.0, 22.0}, {43.0, 50.0}})));
+  EXPECT_TRUE(ember::einsum("ij->ji", {a}).equals(
+      Tensor({{1.0, 3.0}, {2.0, 4.0}})));
+  EXPECT_TRUE(ember::einsum("ij -> i", {a}).equals(Tensor({3.0, 7.0})));
+  EXPECT_EQ(ember::einsum("ij,ij->", {a, b})(), 70.0);
+  EXPECT_TRUE(ember::einsum("i,j->ij", {u, v}).equals(
+      Tensor({{3.0, 4.0, 5.0}, {6.0, 8.0, 10.0}})));
+  EXPECT_TRUE(ember::einsum("ij,ij->ij", {a, b}).equals(a * b));
+}
+
+TEST(TensorEinsum, BatchedContractionMatchesMatmul) {
+  Tensor a = Tensor::randn({3, 2, 4});
+  Tensor b = Tensor::randn({3, 4, 5});
+
+  Tensor c = ember::einsum("bij,bjk->bik", {a, b});
+
+  for (std::size_t n = 0; n < 3; ++n) {
+    Tensor a_n = Tensor::from_xarray(xt::view(a.data_, n));
+    Tensor b_n = Tensor::from_xarray(xt::view(b.data_, n));
+    EXPECT_TRUE(Tensor::from_xarray(xt::view(c.data_, n))
+                    .equals_approx(ember::matmul(a_n, b_n)));
+  }
+}
+
+TEST(TensorEinsum, ChainMatchesComposedMatmuls) {
+  Tensor a = Tensor::randn({2, 30});
+  Tensor b = Tensor::randn({30, 40});
+  Tensor c = Tensor::randn({40, 3});
+  Tensor d = Tensor::randn({3, 50});
+  for (Tensor* t : {&a, &b, &c, &d}) {
+    t->requires_grad(true);
+  }
+  Tensor upstream = Tensor::randn({2, 50});
+
+  Tensor ab = ember::matmul(a, b);
+  Tensor cd = ember::matmul(c, d);
+  Tensor expected = ember::matmul(ab, cd);
+  (expected * upstream).backward();
+  Tensor grads[] = {*a.gradient, *b.gradient, *c.gradient, *d.gradient};
+  for (Tensor* t : {&a, &b, &c, &d}) {
+    delete t->gradient;
+    t->gradient = nullptr;
+  }
+
+  Tensor actual = ember::einsum("ij,jk,kl,lm->im", {a, b, c, d});
+  (actual * upstream).backward();
+
+  EXPECT_TRUE(actual.equals_approx(expected));
+  EXPECT_TRUE(a.gradient->equals_approx(grads[0]));
+  EXPECT_TRUE(b.gradient->equals_approx(grads[1]));
+  EXPECT_TRUE(c.gradient->equals_approx(grads[2]));
+  EXPECT_TRUE(d.gradient->equals_approx(grads[3]));
+}
+
+TEST(TensorEinsum, ManyOperandsAreContracted) {
+  // Too many operands to search every order of contractions.
+  Tensor x({1.0, 2.0, 3.0});
+  Tensor m = Tensor::randn({3, 3});
+  x.requires_grad(true);
+
+  Tensor y = ember::einsum("a,b,c,d,e,f,g,h,i,j,k,ab->",
+                           {x, x, x, x, x, x, x, x, x, x, x, m});
+  y.backward();
+
+  // The operands besides the first two vectors and the matrix are summed.
+  double quadratic = 0.0;
+  for (std::size_t a = 0; a < 3; ++a) {
+    for (std::size_t b = 0; b < 3; ++b) {
+      quadratic += x(a) * m(a, b) * x(b);
+    }
+  }
+  EXPECT_NEAR(y(), std::pow(6.0, 9) * quadratic, 1e-9 * std::abs(y()));
+  for (std::size_t a = 0; a < 3; ++a) {
+    double expected = 9.0 * std::pow(6.0, 8) * quadratic;
+    for (std::size_t b = 0; b < 3; ++b) {
+      expected += std::pow(6.0, 9) * (m(a, b) + m(b, a)) * x(b);
+    }
+    EXPECT_NEAR((*x.gradient)(a), expected, 1e-9 * std::abs(expected));
+  }
+}
+
+TEST(TensorEinsum, GradientIsBroadcastAlongSummedLabels) {
+  Tensor x = Tensor::randn({2, 3});
+  Tensor w = Tensor::randn({4});
+  x.requires_grad(true);
+  w.requires_grad(true);
+
+  // x's columns and w are each summed before they're multiplied.
+  ember::einsum("ij,k->i", {x, w}).backward();
+
+  EXPECT_TRUE(x.gradient->equals_approx(
+      Tensor::from_xarray(xt::ones<double>({2, 3}) * xt::sum(w.data_)())));
+  EXPECT_TRUE(w.gradient->equals_approx(
+      Tensor::from_xarray(xt::ones<double>({4}) * xt::sum(x.data_)())));
+}
+
+TEST(TensorEinsum, OnlyOperandsThatRequireGradientsGetOne) {
+  Tensor a = Tensor::randn({2, 3});
+  Tensor b = Tensor::randn({3, 4});
+  b.requires_grad(true);
+
+  ember::einsum("ij,jk->ik", {a, b}).backward();
+
+  Tensor ones = Tensor::from_xarray(xt::ones<double>({2, 4}));
+  EXPECT_EQ(a.gradient, nullptr);
+  EXPECT_TRUE(
+      b.gradient->equals_approx(ember::einsum("ij,ik->jk", {a, ones})));
+}
+
+TEST(TensorEinsum, InvalidEquationsAreRejected) {
+  Tensor a = Tensor::randn({2, 3});
+  Tensor b = Tensor::randn({4, 5});
+  Tensor s = Tensor::randn({3, 3});
+
+  EXPECT_THROW(ember::einsum("ij,jk->ik", {a}), std::invalid_argument);
+  EXPECT_THROW(ember::einsum("ijk->i", {a}), std::invalid_argument);
+  EXPECT_THROW(ember::einsum("ij,jk->ik", {a, b}), std::invalid_argument);
+  EXPECT_THROW(ember::einsum("ii->i", {s}), std::invalid_argument);
+  EXPECT_THROW(ember::einsum("ij->ik", {a}), std::invalid_argument);
+  EXPECT_THROW(ember::einsum("i1->i", {a}), std::invalid_argument);
+}
@@ -0,0 +1,88 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(TensorEmbedding, EmbeddingIsCorrectlyComputed) {
+  Tensor weight({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+  Tensor indices({{2.0, 0.0}, {2.0, 1.0}});
+
+  Tensor y = ember::embedding(weight, indices);
+
+  EXPECT_TRUE(y.equals(Tensor({{{5.0, 6.0}, {1.0, 2.0}},
+                               {{5.0, 6.0}, {3.0, 4.0}}})));
+}
+
+TEST(TensorEmbedding, WeightGradientHoldsOnlyTheRowsLookedUp) {
+  Tensor weight = Tensor::randn({1000, 3});
+  weight.requires_grad(true);
+  Tensor indices({7.0, 2.0, 7.0});
+
+  Tensor y = ember::embedding(weight, indices);
+  (y * Tensor({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}, {7.0, 8.0, 9.0}}))
+      .backward();
+
+  ASSERT_TRUE(weight.gradient->is_sparse());
+  const SparseRows& grad = weight.gradient->sparse_rows();
+  EXPECT_EQ(grad.indices, (std::vector<std::size_t>{2, 7}));
+  EXPECT_TRUE(xt::allclose(
+      grad.values, xt::xarray<double>{{4.0, 5.0, 6.0}, {8.0, 10.0, 12.0}}));
+}
+
+TEST(TensorEmbedding, GradientsOfSeveralLookupsStaySparse) {
+  Tensor weight = Tensor::randn({1000, 2});
+  weight.requires_grad(true);
+
+  // The engine adds the gradients of both lookups, and the second backward
+  // pass adds to the weight's gradient.
+  (ember::embedding(weight, Tensor({1.0, 5.0})).sum() +
+   ember::embedding(weight, Tensor({5.0, 9.0})).sum())
+      .backward();
+  ember::embedding(weight, Tensor({9.0, 0.0})).sum().backward();
+
+  ASSERT_TRUE(weight.gradient->is_sparse());
+  const SparseRows& grad = weight.gradient->sparse_rows();
+  EXPECT_EQ(grad.indices, (std::vector<std::size_t>{0, 1, 5, 9}));
+  EXPECT_TRUE(xt::allclose(grad.values, xt::xarray<double>{{1.0, 1.0},
+                                                           {1.0, 1.0},
+                                                           {2.0, 2.0},
+                                                           {2.0, 2.0}}));
+}
+
+TEST(TensorEmbedding, SparseGradientsAreAddedToDenseOnes) {
+  Tensor weight({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+  weight.requires_grad(true);
+
+  (ember::embedding(weight, Tensor({2.0, 2.0})).sum() + weight.sum())
+      .backward();
+
+  ASSERT_FALSE(weight.gradient->is_sparse());
+  EXPECT_TRUE(weight.gradient->equals(
+      Tensor({{1.0, 1.0}, {1.0, 1.0}, {3.0, 3.0}})));
+}
+
+TEST(TensorEmbedding, OpsReceiveDenseGradients) {
+  Tensor weight({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+  weight.requires_grad(true);
+
+  ember::embedding(weight * weight, Tensor({1.0, 1.0})).sum().backward();
+
+  ASSERT_FALSE(weight.gradient->is_sparse());
+  EXPECT_TRUE(weight.gradient->equals(
+      Tensor({{0.0, 0.0}, {12.0, 16.0}, {0.0, 0.0}})));
+}
+
+TEST(TensorEmbedding, InvalidIndicesAreRejected) {
+  Tensor weight = Tensor::randn({3, 2});
+
+  EXPECT_THROW(ember::embedding(weight, Tensor({0.0, 3.0})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::embedding(weight, Tensor({-1.0, 0.0})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::embedding(weight, Tensor({0.5, 0.0})),
+               std::invalid_argument);
+}
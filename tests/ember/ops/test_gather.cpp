@@ -0,0 +1,60 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(TensorGather, GatherIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+
+  // Along axis 1, each row picks its own columns.
+  EXPECT_TRUE(ember::gather(x, 1, Tensor({{2.0, 2.0}, {0.0, 1.0}}))
+                  .equals(Tensor({{3.0, 3.0}, {4.0, 5.0}})));
+  // Along axis 0, each column picks its own rows, and the index may be
+  // narrower than the input.
+  EXPECT_TRUE(ember::gather(x, 0, Tensor({{1.0, 0.0}, {1.0, 1.0},
+                                          {0.0, 0.0}}))
+                  .equals(Tensor({{4.0, 2.0}, {4.0, 5.0}, {1.0, 2.0}})));
+}
+
+TEST(TensorGather, GradientAddsToTheGatheredElements) {
+  Tensor x = Tensor::randn({2, 3});
+  x.requires_grad(true);
+
+  Tensor y = ember::gather(x, -1, Tensor({{2.0, 2.0}, {0.0, 1.0}}));
+  (y * Tensor({{1.0, 2.0}, {3.0, 4.0}})).backward();
+
+  ASSERT_FALSE(x.gradient->is_sparse());
+  EXPECT_TRUE(x.gradient->equals(
+      Tensor({{0.0, 0.0, 3.0}, {3.0, 4.0, 0.0}})));
+}
+
+TEST(TensorGather, GradientAlongTheFirstAxisIsSparse) {
+  Tensor x = Tensor::randn({100, 3});
+  x.requires_grad(true);
+
+  Tensor y = ember::gather(x, 0, Tensor({{50.0, 7.0}, {50.0, 50.0}}));
+  (y * Tensor({{1.0, 2.0}, {3.0, 4.0}})).backward();
+
+  ASSERT_TRUE(x.gradient->is_sparse());
+  EXPECT_EQ(x.gradient->sparse_rows().indices,
+            (std::vector<std::size_t>{7, 50}));
+  EXPECT_TRUE(xt::allclose(
+      x.gradient->sparse_rows().values,
+      xt::xarray<double>{{0.0, 2.0, 0.0}, {4.0, 4.0, 0.0}}));
+}
+
+TEST(TensorGather, InvalidArgumentsAreRejected) {
+  Tensor x = Tensor::randn({2, 3});
+
+  EXPECT_THROW(ember::gather(x, 1, Tensor({0.0, 1.0})), std::invalid_argument);
+  EXPECT_THROW(
+      ember::gather(x, 1, Tensor::from_xarray(xt::zeros<double>({3, 1}))),
+      std::invalid_argument);
+  EXPECT_THROW(ember::gather(x, 0, Tensor({{2.0, 0.0}})),
+               std::invalid_argument);
+}
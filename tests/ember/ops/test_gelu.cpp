@@ -0,0 +1,32 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+using namespace ember;
+
+TEST(TensorGelu, GeluIsCorrectlyComputed) {
+  Tensor a({-1.0, 0.0, 0.5, 2.0}, true);
+
+  Tensor b = a.gelu();
+
+  EXPECT_TRUE(b.equals_approx(Tensor(
+      {-0.15865525393145707, 0.0, 0.34573123063700656, 1.9544997361036416})));
+
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(Tensor(
+      {-0.08331547058768629, 0.5, 0.8674951246561629, 1.085231801078197})));
+}
+
+TEST(TensorGelu, GeluIsCorrectlyComputedForNestedOperations) {
+  Tensor a({{0.3, -0.7}}, true);
+
+  Tensor b = ember::gelu(ember::gelu(a));
+  b.backward();
+
+  // Checked against finite differences.
+  double h = 1e-6;
+  Tensor plus = ember::gelu(ember::gelu(Tensor({{0.3 + h, -0.7 + h}})));
+  Tensor minus = ember::gelu(ember::gelu(Tensor({{0.3 - h, -0.7 - h}})));
+  EXPECT_TRUE(a.gradient->equals_approx((plus - minus) / Tensor(2 * h)));
+}
@@ -0,0 +1,124 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// Returns block `index` of the blocks of `size` columns of a matrix (or
+// elements of a vector).
+Tensor block(const Tensor& t, std::size_t index, std::size_t size) {
+  const auto& a = t.data_;
+  std::size_t rows = a.dimension() == 1 ? 1 : a.shape()[0];
+  std::size_t cols = a.shape()[a.dimension() - 1];
+  auto result = a.dimension() == 1
+                    ? xt::xarray<double>::from_shape({size})
+                    : xt::xarray<double>::from_shape({rows, size});
+  for (std::size_t r = 0; r < rows; ++r) {
+    for (std::size_t c = 0; c < size; ++c) {
+      result.data()[r * size + c] = a.data()[r * cols + index * size + c];
+    }
+  }
+  return Tensor::from_xarray(result);
+}
+
+// Splits each fused parameter into one leaf per gate.
+std::vector<std::vector<Tensor>> split_gates(
+    const std::vector<Tensor*>& params, std::size_t hidden_size) {
+  std::vector<std::vector<Tensor>> gates;
+  for (const Tensor* param : params) {
+    // Each gradient accumulates into its leaf's address, so the leaves must
+    // not be moved once they require gradients.
+    gates.emplace_back();
+    gates.back().reserve(3);
+    for (std::size_t k = 0; k < 3; ++k) {
+      gates.back().push_back(block(*param, k, hidden_size));
+      gates.back().back().requires_grad(true);
+    }
+  }
+  return gates;
+}
+
+}  // namespace
+
+TEST(TensorGruCell, GruCellIsCorrectlyComputed) {
+  // With zero weights both sigmoid gates are 1/2 and the new gate is 0.
+  Tensor x({{1.0, 2.0}, {0.0, 1.0}});
+  Tensor h({{0.5, -1.0}, {2.0, 0.0}});
+  Tensor w_ih = Tensor::from_xarray(xt::zeros<double>({2, 6}));
+  Tensor w_hh = Tensor::from_xarray(xt::zeros<double>({2, 6}));
+  Tensor b = Tensor::from_xarray(xt::zeros<double>({6}));
+
+  Tensor y = ember::gru_cell(x, h, w_ih, w_hh, b, b);
+
+  EXPECT_TRUE(y.equals_approx(Tensor({{0.25, -0.5}, {1.0, 0.0}})));
+}
+
+TEST(TensorGruCell, GruCellMatchesComposedOps) {
+  std::size_t hidden_size = 4;
+  Tensor x = Tensor::randn({5, 3});
+  Tensor h = Tensor::randn({5, hidden_size});
+  Tensor w_ih = Tensor::randn({3, 3 * hidden_size});
+  Tensor w_hh = Tensor::randn({hidden_size, 3 * hidden_size});
+  Tensor b_ih = Tensor::randn({3 * hidden_size});
+  Tensor b_hh = Tensor::randn({3 * hidden_size});
+  std::vector<Tensor*> params = {&w_ih, &w_hh, &b_ih, &b_hh};
+  for (Tensor* t : {&x, &h, &w_ih, &w_hh, &b_ih, &b_hh}) {
+    t->requires_grad(true);
+  }
+  auto gates = split_gates(params, hidden_size);
+  auto input_part = [&](std::size_t k) {
+    return ember::matmul(x, gates[0][k]) + gates[2][k];
+  };
+  auto hidden_part = [&](std::size_t k) {
+    return ember::matmul(h, gates[1][k]) + gates[3][k];
+  };
+  Tensor upstream = Tensor::randn({5, hidden_size});
+
+  Tensor r = (input_part(0) + hidden_part(0)).sigmoid();
+  Tensor z = (input_part(1) + hidden_part(1)).sigmoid();
+  Tensor n = (input_part(2) + r * hidden_part(2)).tanh();
+  Tensor expected = n + z * (h - n);
+  (expected * upstream).backward();
+  Tensor x_grad = *x.gradient, h_grad = *h.gradient;
+  for (Tensor* t : {&x, &h}) {
+    delete t->gradient;
+    t->gradient = nullptr;
+  }
+
+  Tensor actual = ember::gru_cell(x, h, w_ih, w_hh, b_ih, b_hh);
+  (actual * upstream).backward();
+
+  EXPECT_TRUE(actual.equals_approx(expected));
+  EXPECT_TRUE(x.gradient->equals_approx(x_grad));
+  EXPECT_TRUE(h.gradient->equals_approx(h_grad));
+  for (std::size_t p = 0; p < params.size(); ++p) {
+    for (std::size_t k = 0; k < 3; ++k) {
+      EXPECT_TRUE(block(*params[p]->gradient, k, hidden_size)
+                      .equals_approx(*gates[p][k].gradient));
+    }
+  }
+}
+
+TEST(TensorGruCell, MismatchedShapesAreRejected) {
+  Tensor x = Tensor::randn({2, 3});
+  Tensor h = Tensor::randn({2, 4});
+  Tensor w_ih = Tensor::randn({3, 12});
+  Tensor w_hh = Tensor::randn({4, 12});
+  Tensor b = Tensor::randn({12});
+
+  EXPECT_THROW(ember::gru_cell(x, Tensor::randn({3, 4}), w_ih, w_hh, b, b),
+               std::invalid_argument);
+  EXPECT_THROW(ember::gru_cell(x, h, Tensor::randn({2, 12}), w_hh, b, b),
+               std::invalid_argument);
+  EXPECT_THROW(ember::gru_cell(x, h, w_ih, Tensor::randn({4, 16}), b, b),
+               std::invalid_argument);
+  EXPECT_THROW(ember::gru_cell(x, h, w_ih, w_hh, b, Tensor::randn({16})),
+               std::invalid_argument);
+}
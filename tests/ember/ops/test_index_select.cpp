@@ -0,0 +1,54 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(TensorIndexSelect, IndexSelectIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+
+  EXPECT_TRUE(ember::index_select(x, 1, Tensor({2.0, 0.0, 2.0}))
+                  .equals(Tensor({{3.0, 1.0, 3.0}, {6.0, 4.0, 6.0}})));
+  EXPECT_TRUE(ember::index_select(x, 0, Tensor({1.0, 1.0}))
+                  .equals(Tensor({{4.0, 5.0, 6.0}, {4.0, 5.0, 6.0}})));
+}
+
+TEST(TensorIndexSelect, GradientSumsRepeatedSlices) {
+  Tensor x = Tensor::randn({2, 3});
+  x.requires_grad(true);
+
+  Tensor y = ember::index_select(x, -1, Tensor({2.0, 0.0, 2.0}));
+  (y * Tensor({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}})).backward();
+
+  ASSERT_FALSE(x.gradient->is_sparse());
+  EXPECT_TRUE(x.gradient->equals(
+      Tensor({{2.0, 0.0, 4.0}, {5.0, 0.0, 10.0}})));
+}
+
+TEST(TensorIndexSelect, GradientAlongTheFirstAxisIsSparse) {
+  Tensor x = Tensor::randn({100, 2});
+  x.requires_grad(true);
+
+  Tensor y = ember::index_select(x, 0, Tensor({40.0, 3.0, 40.0}));
+  (y * Tensor({{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}})).backward();
+
+  ASSERT_TRUE(x.gradient->is_sparse());
+  EXPECT_EQ(x.gradient->sparse_rows().indices,
+            (std::vector<std::size_t>{3, 40}));
+  EXPECT_TRUE(xt::allclose(x.gradient->sparse_rows().values,
+                           xt::xarray<double>{{3.0, 4.0}, {6.0, 8.0}}));
+}
+
+TEST(TensorIndexSelect, InvalidArgumentsAreRejected) {
+  Tensor x = Tensor::randn({2, 3});
+
+  EXPECT_THROW(ember::index_select(x, 2, Tensor({0.0})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::index_select(x, 0, Tensor({0.0, 2.0})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::index_select(x, 0, Tensor({{0.0, 1.0}, {1.0, 0.0}})),
+               std::invalid_argument);
+}
@@ -0,0 +1,79 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <stdexcept>
+
+using namespace ember;
+
+namespace {
+
+// The layer norm computed from separate ops.
+Tensor composed(Tensor& x, Tensor& w, Tensor& b, double eps) {
+  Tensor centered = x - ember::mean(x, {-1}, true);
+  Tensor var = ember::mean(centered * centered, {-1}, true);
+  return centered * ember::rsqrt(var + eps) * w + b;
+}
+
+}  // namespace
+
+TEST(TensorLayerNorm, LayerNormIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0, 4.0}, {3.0, 3.0, 3.0}});
+  Tensor w({1.0, 2.0, 3.0});
+  Tensor b({0.0, 1.0, -1.0});
+
+  Tensor y = ember::layer_norm(x, w, b);
+
+  EXPECT_TRUE(y.equals_approx(
+      Tensor({{-1.0690415314502977, 1.0 - 2 * 0.26726038286257453,
+               -1.0 + 3 * 1.3363019143128718},
+              {0.0, 1.0, -1.0}})));
+}
+
+TEST(TensorLayerNorm, GradientsMatchComposedOps) {
+  Tensor x = Tensor::randn({2, 3, 7}, 1.0, 4.0);
+  Tensor w = Tensor::randn({7});
+  Tensor b = Tensor::randn({7});
+  x.requires_grad(true);
+  w.requires_grad(true);
+  b.requires_grad(true);
+  Tensor upstream = Tensor::randn({2, 3, 7});
+
+  Tensor expected = composed(x, w, b, 1e-5);
+  (expected * upstream).backward();
+  Tensor x_grad = *x.gradient, w_grad = *w.gradient, b_grad = *b.gradient;
+  delete x.gradient;
+  delete w.gradient;
+  delete b.gradient;
+  x.gradient = w.gradient = b.gradient = nullptr;
+
+  Tensor actual = ember::layer_norm(x, w, b);
+  (actual * upstream).backward();
+
+  EXPECT_TRUE(actual.equals_approx(expected));
+  EXPECT_TRUE(x.gradient->equals_approx(x_grad));
+  EXPECT_TRUE(w.gradient->equals_approx(w_grad));
+  EXPECT_TRUE(b.gradient->equals_approx(b_grad));
+}
+
+TEST(TensorLayerNorm, LargeOffsetsDontLosePrecision) {
+  // A naive E[x^2] - E[x]^2 variance cancels catastrophically here.
+  Tensor x = Tensor::randn({3, 64}, 1e8, 1.0);
+  Tensor w = Tensor::from_xarray(xt::ones<double>({64}));
+  Tensor b = Tensor::from_xarray(xt::zeros<double>({64}));
+
+  Tensor y = ember::layer_norm(x, w, b);
+  Tensor expected = ember::layer_norm(x - 1e8, w, b);
+
+  EXPECT_TRUE(xt::allclose(y.data_, expected.data_, 1e-5, 1e-6));
+}
+
+TEST(TensorLayerNorm, MismatchedShapesAreRejected) {
+  Tensor x = Tensor::randn({4, 6});
+
+  EXPECT_THROW(ember::layer_norm(x, Tensor::randn({4}), Tensor::randn({6})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::layer_norm(x, Tensor::randn({6}), Tensor::randn({1, 6})),
+               std::invalid_argument);
+}
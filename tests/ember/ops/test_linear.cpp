@@ -0,0 +1,119 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace ember;
+
+namespace {
+
+// The layer computed from separate ops.
+Tensor composed(Tensor& x, Tensor& w, Tensor& b, Activation activation) {
+  Tensor z = ember::matmul(x, w) + b;
+  switch (activation) {
+    case Activation::ReLU:
+      return z.relu();
+    case Activation::Sigmoid:
+      return z.sigmoid();
+    case Activation::Tanh:
+      return z.tanh();
+    case Activation::GELU:
+      return z.gelu();
+    default:
+      return z;
+  }
+}
+
+}  // namespace
+
+TEST(TensorLinear, LinearIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0}, {3.0, 4.0}}, true);
+  Tensor w({{1.0, -1.0, 0.5}, {2.0, 0.0, -1.0}}, true);
+  Tensor b({0.5, 1.0, -1.0}, true);
+
+  Tensor y = ember::linear(x, w, b, Activation::ReLU);
+
+  EXPECT_EQ(y, Tensor({{5.5, 0.0, 0.0}, {11.5, 0.0, 0.0}}));
+
+  y.backward();
+
+  EXPECT_EQ(*x.gradient, Tensor({{1.0, 2.0}, {1.0, 2.0}}));
+  EXPECT_EQ(*w.gradient, Tensor({{4.0, 0.0, 0.0}, {6.0, 0.0, 0.0}}));
+  EXPECT_EQ(*b.gradient, Tensor({2.0, 0.0, 0.0}));
+}
+
+TEST(TensorLinear, EveryActivationMatchesComposedOps) {
+  for (Activation activation :
+       {Activation::None, Activation::ReLU, Activation::Sigmoid,
+        Activation::Tanh, Activation::GELU}) {
+    Tensor x = Tensor::randn({7, 5});
+    Tensor w = Tensor::randn({5, 3});
+    Tensor b = Tensor::randn({3});
+    x.requires_grad(true);
+    w.requires_grad(true);
+    b.requires_grad(true);
+    Tensor upstream = Tensor::randn({7, 3});
+
+    Tensor expected = composed(x, w, b, activation);
+    (expected * upstream).backward();
+    Tensor x_grad = *x.gradient, w_grad = *w.gradient, b_grad = *b.gradient;
+    delete x.gradient;
+    delete w.gradient;
+    delete b.gradient;
+    x.gradient = w.gradient = b.gradient = nullptr;
+
+    Tensor actual = ember::linear(x, w, b, activation);
+    (actual * upstream).backward();
+
+    EXPECT_TRUE(actual.equals_approx(expected));
+    EXPECT_TRUE(x.gradient->equals_approx(x_grad));
+    EXPECT_TRUE(w.gradient->equals_approx(w_grad));
+    EXPECT_TRUE(b.gradient->equals_approx(b_grad));
+  }
+}
+
+TEST(TensorLinear, LinearWithoutBiasIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0}, {3.0, 4.0}});
+  Tensor w({{1.0, -1.0}, {2.0, 0.5}}, true);
+
+  Tensor y = ember::linear(x, w, Activation::Tanh);
+
+  EXPECT_TRUE(y.equals_approx(ember::matmul(x, w).tanh()));
+
+  y.backward();
+
+  // The input doesn't require a gradient, so none is computed for it.
+  EXPECT_EQ(x.gradient, nullptr);
+  Tensor t = ember::matmul(x, w).tanh();
+  Tensor expected_w_grad =
+      ember::matmul(Tensor({{1.0, 3.0}, {2.0, 4.0}}), 1.0 - t * t);
+  EXPECT_TRUE(w.gradient->equals_approx(expected_w_grad));
+}
+
+TEST(TensorLinear, FastMathMatchesFastMathOps) {
+  Tensor x = Tensor::randn({4, 6});
+  Tensor w = Tensor::randn({6, 5});
+  Tensor b = Tensor::randn({5});
+
+  kernels::set_fast_math(true);
+  Tensor actual = ember::linear(x, w, b, Activation::Sigmoid);
+  Tensor expected = (ember::matmul(x, w) + b).sigmoid();
+  kernels::set_fast_math(false);
+
+  EXPECT_TRUE(actual.equals_approx(expected));
+}
+
+TEST(TensorLinear, MismatchedShapesAreRejected) {
+  Tensor x = Tensor::randn({4, 6});
+  Tensor w = Tensor::randn({5, 3});
+  Tensor b = Tensor::randn({3});
+
+  EXPECT_THROW(ember::linear(x, w, b), std::invalid_argument);
+  EXPECT_THROW(ember::linear(Tensor::randn({6}), Tensor::randn({6, 3})),
+               std::invalid_argument);
+  EXPECT_THROW(
+      ember::linear(x, Tensor::randn({6, 3}), Tensor::randn({4})),
+      std::invalid_argument);
+}
@@ -0,0 +1,43 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorLog, LogIsCorrectlyComputed) {
+  Tensor a({0.5, 2.0, 10.0}, true);
+
+  Tensor b = a.log();
+
+  EXPECT_TRUE(b.equals_approx(
+      Tensor({-0.6931471805599453, 0.6931471805599453, 2.302585092994046})));
+
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(Tensor({2.0, 0.5, 0.1})));
+}
+
+TEST(TensorLog, ZeroAndNegativeInputsGiveInfinityAndNaN) {
+  Tensor b = ember::log(Tensor({0.0, -1.0}));
+
+  EXPECT_EQ(b(0), -std::numeric_limits<double>::infinity());
+  EXPECT_TRUE(std::isnan(b(1)));
+}
+
+TEST(TensorLog, FastMathIsCloseToExactResult) {
+  xt::xarray<double> data = xt::exp(xt::random::randn<double>({1000}) * 50.0);
+  Tensor a = Tensor::from_xarray(data);
+  Tensor exact = a.log();
+
+  kernels::set_fast_math(true);
+  Tensor fast = a.log();
+  kernels::set_fast_math(false);
+
+  EXPECT_TRUE(xt::allclose(fast.data_, exact.data_, 1e-15, 0.0));
+}
@@ -0,0 +1,62 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace ember;
+
+TEST(TensorLogSoftmax, LogSoftmaxIsCorrectlyComputed) {
+  Tensor a({1.0, 2.0, 3.0}, true);
+
+  Tensor b = a.log_softmax();
+
+  EXPECT_TRUE(b.equals_approx(Tensor(
+      {-2.40760596444438, -1.4076059644443801, -0.40760596444438013})));
+
+  // d/dx_i sum_j y_j = 1 - 3 softmax(x)_i
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({1.0 - 3 * 0.09003057317038046, 1.0 - 3 * 0.24472847105479767,
+              1.0 - 3 * 0.6652409557748219})));
+}
+
+TEST(TensorLogSoftmax, GradientMatchesComposedOps) {
+  for (std::ptrdiff_t axis : {0, 1}) {
+    Tensor a = Tensor::randn({6, 3});
+    a.requires_grad(true);
+    Tensor upstream = Tensor::randn({6, 3});
+
+    Tensor expected = a - ember::logsumexp(a, {axis}, true);
+    (expected * upstream).backward();
+    Tensor expected_grad = *a.gradient;
+    delete a.gradient;
+    a.gradient = nullptr;
+
+    Tensor actual = ember::log_softmax(a, axis);
+    (actual * upstream).backward();
+
+    EXPECT_TRUE(actual.equals_approx(expected));
+    EXPECT_TRUE(a.gradient->equals_approx(expected_grad));
+  }
+}
+
+TEST(TensorLogSoftmax, SmallProbabilitiesKeepTheirPrecision) {
+  Tensor b = ember::log_softmax(Tensor({0.0, -800.0}));
+
+  // softmax rounds e^-800 to 0, but its log is still representable.
+  EXPECT_TRUE(b.equals_approx(Tensor({0.0, -800.0})));
+}
+
+TEST(TensorLogSoftmax, FastMathIsCloseToExactResult) {
+  Tensor a = Tensor::randn({8, 100}, 0.0, 10.0);
+  Tensor exact = ember::log_softmax(a);
+
+  kernels::set_fast_math(true);
+  Tensor fast = ember::log_softmax(a);
+  kernels::set_fast_math(false);
+
+  EXPECT_TRUE(fast.equals_approx(exact));
+}
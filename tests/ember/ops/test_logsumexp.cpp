@@ -0,0 +1,67 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xio.hpp>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorLogSumExp, LogSumExpOfAllElementsIsComputed) {
+  Tensor a({{0.5, 1.0}, {-2.0, 3.0}}, true);
+
+  Tensor b = a.logsumexp();
+
+  double expected = std::log(std::exp(0.5) + std::exp(1.0) + std::exp(-2.0) +
+                             std::exp(3.0));
+  EXPECT_EQ(b.data_.dimension(), 0);
+  EXPECT_DOUBLE_EQ(b(), expected);
+
+  b.backward();
+
+  // The gradient is the softmax of the input.
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor::from_xarray(xt::exp(a.data_ - expected))));
+}
+
+TEST(TensorLogSumExp, LogSumExpOverAxesIsComputed) {
+  xt::xarray<double> data = xt::random::randn<double>({4, 5, 6});
+  Tensor a = Tensor::from_xarray(data);
+  a.requires_grad(true);
+
+  Tensor b = ember::logsumexp(a, {0, 2}, true);
+
+  xt::xarray<double> expected = xt::log(xt::sum(xt::exp(data), {0, 2}));
+  expected.reshape({1, 5, 1});
+  EXPECT_TRUE(b.equals_approx(Tensor::from_xarray(expected)));
+
+  b.backward();
+
+  // The gradient of each block sums to 1.
+  EXPECT_TRUE(ember::sum(*a.gradient, {0, 2})
+                  .equals_approx(Tensor({1.0, 1.0, 1.0, 1.0, 1.0})));
+}
+
+TEST(TensorLogSumExp, LargeValuesDoNotOverflow) {
+  Tensor a({{1000.0, 1000.0}, {-1000.0, -1001.0}});
+
+  Tensor b = a.logsumexp({1});
+
+  EXPECT_TRUE(b.equals_approx(Tensor(
+      {1000.0 + std::log(2.0), -1000.0 + std::log(1.0 + std::exp(-1.0))})));
+}
+
+TEST(TensorLogSumExp, InfinitiesArePropagated) {
+  double inf = std::numeric_limits<double>::infinity();
+  Tensor a({{-inf, -inf}, {inf, 1.0}, {-inf, 0.0}});
+
+  Tensor b = a.logsumexp({1});
+
+  EXPECT_EQ(b(0), -inf);
+  EXPECT_EQ(b(1), inf);
+  EXPECT_DOUBLE_EQ(b(2), 0.0);
+}
@@ -0,0 +1,228 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// Returns block `index` of the blocks of `size` columns of a matrix (or
+// elements of a vector).
+Tensor block(const Tensor& t, std::size_t index, std::size_t size) {
+  const auto& a = t.data_;
+  std::size_t rows = a.dimension() == 1 ? 1 : a.shape()[0];
+  std::size_t cols = a.shape()[a.dimension() - 1];
+  auto result = a.dimension() == 1
+                    ? xt::xarray<double>::from_shape({size})
+                    : xt::xarray<double>::from_shape({rows, size});
+  for (std::size_t r = 0; r < rows; ++r) {
+    for (std::size_t c = 0; c < size; ++c) {
+      result.data()[r * size + c] = a.data()[r * cols + index * size + c];
+    }
+  }
+  return Tensor::from_xarray(result);
+}
+
+// Returns slot `s` of the first dimension of a 3-dimensional tensor.
+Tensor slot(const Tensor& t, std::size_t s) {
+  std::size_t rows = t.data_.shape()[1];
+  std::size_t cols = t.data_.shape()[2];
+  auto result = xt::xarray<double>::from_shape({rows, cols});
+  const double* start = t.data_.data() + s * rows * cols;
+  std::copy(start, start + rows * cols, result.begin());
+  return Tensor::from_xarray(result);
+}
+
+// The weights of an LSTM, both fused and split into one leaf per gate.
+struct Weights {
+  Tensor w_ih, w_hh, bias;
+  std::vector<Tensor> gate_ih, gate_hh, gate_bias;
+
+  Weights(std::size_t input_size, std::size_t hidden_size)
+      : w_ih(Tensor::randn({input_size, 4 * hidden_size})),
+        w_hh(Tensor::randn({hidden_size, 4 * hidden_size})),
+        bias(Tensor::randn({4 * hidden_size})) {
+    for (std::size_t k = 0; k < 4; ++k) {
+      gate_ih.push_back(block(w_ih, k, hidden_size));
+      gate_hh.push_back(block(w_hh, k, hidden_size));
+      gate_bias.push_back(block(bias, k, hidden_size));
+    }
+    for (Tensor* t : {&w_ih, &w_hh, &bias}) {
+      t->requires_grad(true);
+    }
+    for (std::size_t k = 0; k < 4; ++k) {
+      gate_ih[k].requires_grad(true);
+      gate_hh[k].requires_grad(true);
+      gate_bias[k].requires_grad(true);
+    }
+  }
+
+  // Checks the gradients of the fused weights against the per-gate ones.
+  void expect_gradients_match() const {
+    std::size_t hidden_size = w_hh.data_.shape()[0];
+    for (std::size_t k = 0; k < 4; ++k) {
+      EXPECT_TRUE(block(*w_ih.gradient, k, hidden_size)
+                      .equals_approx(*gate_ih[k].gradient));
+      EXPECT_TRUE(block(*w_hh.gradient, k, hidden_size)
+                      .equals_approx(*gate_hh[k].gradient));
+      EXPECT_TRUE(block(*bias.gradient, k, hidden_size)
+                      .equals_approx(*gate_bias[k].gradient));
+    }
+  }
+};
+
+// The cell computed from separate ops.
+LstmState composed(Tensor& x, LstmState& state, Weights& w) {
+  auto gate = [&](std::size_t k) {
+    return ember::matmul(x, w.gate_ih[k]) +
+           ember::matmul(state.first, w.gate_hh[k]) + w.gate_bias[k];
+  };
+  Tensor i = gate(0).sigmoid();
+  Tensor f = gate(1).sigmoid();
+  Tensor g = gate(2).tanh();
+  Tensor o = gate(3).sigmoid();
+  Tensor c = f * state.second + i * g;
+  return {o * c.tanh(), c};
+}
+
+}  // namespace
+
+TEST(TensorLstm, LstmCellIsCorrectlyComputed) {
+  // With zero weights every sigmoid gate is 1/2 and the cell gate is 0.
+  Tensor x({{1.0, 2.0}, {0.0, 1.0}});
+  LstmState state{Tensor({{0.5, -1.0}, {0.0, 0.0}}),
+                  Tensor({{2.0, -4.0}, {1.0, 0.0}})};
+  Tensor w_ih = Tensor::from_xarray(xt::zeros<double>({2, 8}));
+  Tensor w_hh = Tensor::from_xarray(xt::zeros<double>({2, 8}));
+  Tensor bias = Tensor::from_xarray(xt::zeros<double>({8}));
+
+  LstmState next = ember::lstm_cell(x, state, w_ih, w_hh, bias);
+
+  EXPECT_TRUE(next.second.equals_approx(Tensor({{1.0, -2.0}, {0.5, 0.0}})));
+  EXPECT_TRUE(next.first.equals_approx(
+      Tensor({{0.5 * std::tanh(1.0), 0.5 * std::tanh(-2.0)},
+              {0.5 * std::tanh(0.5), 0.0}})));
+}
+
+TEST(TensorLstm, LstmCellMatchesComposedOps) {
+  Tensor x = Tensor::randn({5, 3});
+  LstmState state{Tensor::randn({5, 4}), Tensor::randn({5, 4})};
+  for (Tensor* t : {&x, &state.first, &state.second}) {
+    t->requires_grad(true);
+  }
+  Weights w(3, 4);
+  Tensor hidden_upstream = Tensor::randn({5, 4});
+  Tensor cell_upstream = Tensor::randn({5, 4});
+
+  LstmState expected = composed(x, state, w);
+  ((expected.first * hidden_upstream).sum() +
+   (expected.second * cell_upstream).sum())
+      .backward();
+  Tensor x_grad = *x.gradient;
+  Tensor h_grad = *state.first.gradient, c_grad = *state.second.gradient;
+  for (Tensor* t : {&x, &state.first, &state.second}) {
+    delete t->gradient;
+    t->gradient = nullptr;
+  }
+
+  LstmState actual = ember::lstm_cell(x, state, w.w_ih, w.w_hh, w.bias);
+  ((actual.first * hidden_upstream).sum() +
+   (actual.second * cell_upstream).sum())
+      .backward();
+
+  EXPECT_TRUE(actual.first.equals_approx(expected.first));
+  EXPECT_TRUE(actual.second.equals_approx(expected.second));
+  EXPECT_TRUE(x.gradient->equals_approx(x_grad));
+  EXPECT_TRUE(state.first.gradient->equals_approx(h_grad));
+  EXPECT_TRUE(state.second.gradient->equals_approx(c_grad));
+  w.expect_gradients_match();
+}
+
+TEST(TensorLstm, LstmMatchesRepeatedCells) {
+  std::size_t steps = 4;
+  Tensor x = Tensor::randn({steps, 3, 2});
+  LstmState initial{Tensor::randn({3, 5}), Tensor::randn({3, 5})};
+  Tensor w_ih = Tensor::randn({2, 20});
+  Tensor w_hh = Tensor::randn({5, 20});
+  Tensor bias = Tensor::randn({20});
+  for (Tensor* t : {&x, &initial.first, &initial.second, &w_ih, &w_hh, &bias}) {
+    t->requires_grad(true);
+  }
+  Tensor upstream = Tensor::randn({steps, 3, 5});
+  Tensor hidden_upstream = Tensor::randn({3, 5});
+  Tensor cell_upstream = Tensor::randn({3, 5});
+
+  // Each timestep's input is a separate leaf, so its gradient can be
+  // compared with the corresponding slot of the sequence's.
+  std::vector<Tensor> inputs;
+  inputs.reserve(steps);
+  for (std::size_t t = 0; t < steps; ++t) {
+    inputs.push_back(slot(x, t));
+    inputs.back().requires_grad(true);
+  }
+  std::vector<Tensor> hiddens;
+  LstmState state = initial;
+  Tensor loss(0.0);
+  for (std::size_t t = 0; t < steps; ++t) {
+    state = ember::lstm_cell(inputs[t], state, w_ih, w_hh, bias);
+    hiddens.push_back(state.first);
+    loss = loss + (state.first * slot(upstream, t)).sum();
+  }
+  loss = loss + (state.first * hidden_upstream).sum() +
+         (state.second * cell_upstream).sum();
+  loss.backward();
+  std::vector<Tensor> expected_grads;
+  for (Tensor* t : {&initial.first, &initial.second, &w_ih, &w_hh, &bias}) {
+    expected_grads.push_back(*t->gradient);
+    delete t->gradient;
+    t->gradient = nullptr;
+  }
+
+  auto actual = ember::lstm(x, initial, w_ih, w_hh, bias);
+  ((actual.first * upstream).sum() +
+   (actual.second.first * hidden_upstream).sum() +
+   (actual.second.second * cell_upstream).sum())
+      .backward();
+
+  for (std::size_t t = 0; t < steps; ++t) {
+    EXPECT_TRUE(slot(actual.first, t).equals_approx(hiddens[t]));
+    EXPECT_TRUE(slot(*x.gradient, t).equals_approx(*inputs[t].gradient));
+  }
+  EXPECT_TRUE(actual.second.first.equals_approx(state.first));
+  EXPECT_TRUE(actual.second.second.equals_approx(state.second));
+  std::size_t i = 0;
+  for (Tensor* t : {&initial.first, &initial.second, &w_ih, &w_hh, &bias}) {
+    EXPECT_TRUE(t->gradient->equals_approx(expected_grads[i++]));
+  }
+}
+
+TEST(TensorLstm, MismatchedShapesAreRejected) {
+  Tensor x = Tensor::randn({2, 3});
+  LstmState state{Tensor::randn({2, 4}), Tensor::randn({2, 4})};
+  Tensor w_ih = Tensor::randn({3, 16});
+  Tensor w_hh = Tensor::randn({4, 16});
+  Tensor bias = Tensor::randn({16});
+
+  EXPECT_THROW(ember::lstm_cell(x, state, Tensor::randn({2, 16}), w_hh, bias),
+               std::invalid_argument);
+  EXPECT_THROW(ember::lstm_cell(x, state, w_ih, Tensor::randn({4, 12}), bias),
+               std::invalid_argument);
+  EXPECT_THROW(ember::lstm_cell(x, state, w_ih, w_hh, Tensor::randn({12})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::lstm_cell(x, {Tensor::randn({3, 4}), state.second}, w_ih,
+                                w_hh, bias),
+               std::invalid_argument);
+  EXPECT_THROW(ember::lstm_cell(x, {state.first, Tensor::randn({2, 5})},
+                                w_ih, w_hh, bias),
+               std::invalid_argument);
+  EXPECT_THROW(ember::lstm(x, state, w_ih, w_hh, bias), std::invalid_argument);
+  EXPECT_THROW(ember::lstm_cell(Tensor::randn({1, 2, 3}), state, w_ih, w_hh,
+                                bias),
+               std::invalid_argument);
+}
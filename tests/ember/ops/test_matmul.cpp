@@ -2,6 +2,8 @@
 
 #include "gtest/gtest.h"
 
+#include <stdexcept>
+
 using namespace ember;
 
 TEST(TensorDot, DotProductIsCorrectlyCalculated) {
@@ -21,3 +23,53 @@ TEST(TensorDot, DotProductIsCorrectlyCalculated) {
   ASSERT_TRUE(b.requires_grad() && b.gradient != nullptr);
   EXPECT_TRUE(b.gradient->equals_approx(Tensor({{7.0, 7.0}, {6.0, 6.0}})));
 }
+
+TEST(TensorDot, CsrMatrixProductMatchesDenseProduct) {
+  Tensor dense({{0.0, 2.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 0.0, 0.0},
+                {4.0, 0.0, 3.0}});
+  Tensor a = Tensor::from_csr(CsrMatrix::from_dense(dense.data_));
+  Tensor b = Tensor::randn({3, 5});
+  Tensor v({1.0, 2.0, 3.0});
+
+  EXPECT_TRUE(ember::matmul(a, b).equals_approx(ember::matmul(dense, b)));
+  EXPECT_TRUE(ember::matmul(a, v).equals(Tensor({4.0, 1.0, 0.0, 13.0})));
+}
+
+TEST(TensorDot, CsrMatrixGradientIsOnItsSparsityPattern) {
+  Tensor dense({{0.0, 2.0, 0.0}, {1.0, 0.0, -1.0}});
+  Tensor a = Tensor::from_csr(CsrMatrix::from_dense(dense.data_));
+  Tensor b = Tensor::randn({3, 4});
+  a.requires_grad(true);
+  b.requires_grad(true);
+  dense.requires_grad(true);
+  Tensor upstream = Tensor::randn({2, 4});
+
+  (ember::matmul(dense, b) * upstream).backward();
+  Tensor dense_grad = *dense.gradient, b_grad = *b.gradient;
+  delete b.gradient;
+  b.gradient = nullptr;
+  (ember::matmul(a, b) * upstream).backward();
+
+  EXPECT_TRUE(b.gradient->equals_approx(b_grad));
+  ASSERT_TRUE(a.gradient->is_csr());
+  EXPECT_EQ(a.gradient->csr().columns, a.csr().columns);
+  EXPECT_EQ(a.gradient->csr().row_offsets, a.csr().row_offsets);
+  EXPECT_NEAR(a.gradient->csr().values[0], dense_grad(0, 1), 1e-12);
+  EXPECT_NEAR(a.gradient->csr().values[1], dense_grad(1, 0), 1e-12);
+  EXPECT_NEAR(a.gradient->csr().values[2], dense_grad(1, 2), 1e-12);
+
+  // Gradients of the same CSR matrix are summed on its pattern.
+  (ember::matmul(a, b) * upstream).backward();
+  EXPECT_TRUE(a.gradient->is_csr());
+  EXPECT_NEAR(a.gradient->csr().values[0], 2.0 * dense_grad(0, 1), 1e-12);
+}
+
+TEST(TensorDot, CsrMatrixShapesAreChecked) {
+  Tensor a = Tensor::from_csr(CsrMatrix::from_triplets(2, 3, {0}, {1}, {1.0}));
+  Tensor b = Tensor::randn({2, 2});
+
+  EXPECT_THROW(ember::matmul(a, b), std::invalid_argument);
+  EXPECT_THROW(ember::matmul(b, a), std::invalid_argument);
+  EXPECT_THROW(ember::matmul(a, Tensor::randn({3, 2, 2})),
+               std::invalid_argument);
+}
@@ -0,0 +1,84 @@
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xio.hpp>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorMax, MaxOfAllElementsIsFound) {
+  Tensor a({{1.0, 7.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor b = a.max();
+
+  EXPECT_EQ(b.data_.dimension(), 0);
+  EXPECT_DOUBLE_EQ(b(), 7.0);
+
+  b.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{0.0, 1.0, 0.0}, {0.0, 0.0, 0.0}}));
+}
+
+TEST(TensorMax, MaxAlongAxisIsFound) {
+  Tensor a({{1.0, 7.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor columns = a.max(0);
+  Tensor rows = a.max(-1);
+
+  EXPECT_EQ(columns, Tensor({4.0, 7.0, 6.0}));
+  EXPECT_EQ(rows, Tensor({7.0, 6.0}));
+  EXPECT_EQ(a.max(-2, true), Tensor({{4.0, 7.0, 6.0}}));
+
+  (columns * Tensor({1.0, 2.0, 3.0})).sum().backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{0.0, 2.0, 0.0}, {1.0, 0.0, 3.0}}));
+}
+
+TEST(TensorMax, GradientFlowsToFirstOfTiedElements) {
+  Tensor a({{2.0, 5.0, 5.0}, {3.0, 3.0, 1.0}}, true);
+
+  Tensor b = a.max(1);
+  b.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{0.0, 1.0, 0.0}, {1.0, 0.0, 0.0}}));
+}
+
+TEST(TensorMax, NaNsArePropagated) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  Tensor a({{1.0, nan, 3.0}, {4.0, 5.0, 6.0}});
+
+  Tensor b = a.max(1);
+
+  EXPECT_TRUE(std::isnan(b(0)));
+  EXPECT_DOUBLE_EQ(b(1), 6.0);
+  EXPECT_TRUE(std::isnan(a.max()()));
+}
+
+TEST(TensorMax, LargeTensorsMatchXtensor) {
+  xt::xarray<double> data = xt::random::randn<double>({40, 500, 3});
+  Tensor a = Tensor::from_xarray(data);
+  std::size_t original_num_threads = get_num_threads();
+
+  for (std::size_t num_threads : {1, 4}) {
+    set_num_threads(num_threads);
+    for (std::ptrdiff_t axis : {0, 1, 2}) {
+      EXPECT_EQ(a.max(axis), Tensor::from_xarray(xt::amax(data, {axis})))
+          << "axis " << axis;
+    }
+    EXPECT_EQ(a.max()(), xt::amax(data)());
+  }
+  set_num_threads(original_num_threads);
+}
+
+TEST(TensorMax, EmptyAxesAreRejected) {
+  Tensor a = Tensor::from_xarray(xt::xarray<double>::from_shape({2, 0}));
+
+  EXPECT_THROW(a.max(1), std::invalid_argument);
+  EXPECT_THROW(a.max(), std::invalid_argument);
+}
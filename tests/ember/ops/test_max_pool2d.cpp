@@ -0,0 +1,83 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// A tensor of shape (1, 1, height, width) holding the given rows.
+Tensor image(std::initializer_list<std::initializer_list<double>> rows) {
+  Tensor t(rows);
+  t.data_.reshape(std::vector<std::size_t>{1, 1, t.data_.shape()[0],
+                                           t.data_.shape()[1]});
+  return t;
+}
+
+}  // namespace
+
+TEST(TensorMaxPool2d, MaxPool2dIsCorrectlyComputed) {
+  Tensor x = image({{1.0, 5.0, 2.0, 0.0},
+                    {3.0, 4.0, 8.0, 1.0},
+                    {0.0, 2.0, 1.0, 1.0},
+                    {7.0, 6.0, 3.0, 9.0}});
+
+  EXPECT_TRUE(ember::max_pool2d(x, {2, 2}).equals(image({{5.0, 8.0},
+                                                          {7.0, 9.0}})));
+  EXPECT_TRUE(ember::max_pool2d(x, {2, 2}, {{1, 2}})
+                  .equals(image({{5.0, 8.0}, {4.0, 8.0}, {7.0, 9.0}})));
+}
+
+TEST(TensorMaxPool2d, PaddingIsNeverSelected) {
+  Tensor x = image({{-1.0, -2.0}, {-3.0, -4.0}});
+
+  Tensor y = ember::max_pool2d(x, {2, 2}, std::nullopt, {1, 1});
+
+  EXPECT_TRUE(y.equals(image({{-1.0, -2.0}, {-3.0, -4.0}})));
+}
+
+TEST(TensorMaxPool2d, GradientFlowsToTheFirstLargestElement) {
+  Tensor x = image({{1.0, 3.0, 3.0},
+                    {2.0, 0.0, 1.0},
+                    {3.0, 1.0, 2.0}});
+  x.requires_grad(true);
+
+  // The windows overlap, so the 3 in the middle of the top row is selected
+  // twice, and wins the tie with the 3 to its right.
+  Tensor y = ember::max_pool2d(x, {2, 2}, {{1, 1}});
+  y.backward(image({{1.0, 10.0}, {100.0, 1000.0}}));
+
+  EXPECT_TRUE(x.gradient->equals(image({{0.0, 11.0, 0.0},
+                                        {0.0, 0.0, 0.0},
+                                        {100.0, 0.0, 1000.0}})));
+}
+
+TEST(TensorMaxPool2d, NaNsArePropagated) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  Tensor x = image({{1.0, nan}, {3.0, 2.0}});
+  x.requires_grad(true);
+
+  Tensor y = ember::max_pool2d(x, {2, 2});
+  y.backward();
+
+  EXPECT_TRUE(std::isnan(y(0, 0, 0, 0)));
+  EXPECT_TRUE(x.gradient->equals(image({{0.0, 1.0}, {0.0, 0.0}})));
+}
+
+TEST(TensorMaxPool2d, InvalidWindowsAreRejected) {
+  Tensor x = Tensor::randn({1, 2, 4, 4});
+
+  EXPECT_THROW(ember::max_pool2d(Tensor::randn({2, 4, 4}), {2, 2}),
+               std::invalid_argument);
+  EXPECT_THROW(ember::max_pool2d(x, {5, 2}), std::invalid_argument);
+  EXPECT_THROW(ember::max_pool2d(x, {0, 2}), std::invalid_argument);
+  EXPECT_THROW(ember::max_pool2d(x, {2, 2}, {{2, 0}}), std::invalid_argument);
+  EXPECT_THROW(ember::max_pool2d(x, {2, 2}, std::nullopt, {2, 0}),
+               std::invalid_argument);
+}
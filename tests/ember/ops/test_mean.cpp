@@ -0,0 +1,55 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xio.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+
+using namespace ember;
+
+TEST(TensorMean, MeanOfAllElementsIsComputed) {
+  Tensor a({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor b = a.mean();
+
+  EXPECT_EQ(b.data_.dimension(), 0);
+  EXPECT_DOUBLE_EQ(b(), 3.5);
+
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({{1.0, 1.0, 1.0}, {1.0, 1.0, 1.0}}) / Tensor(6.0)));
+}
+
+TEST(TensorMean, MeanOverAxesIsComputed) {
+  Tensor a({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor b = ember::mean(a, {0}, true);
+
+  EXPECT_EQ(b, Tensor({{2.5, 3.5, 4.5}}));
+
+  (b * Tensor({{1.0, 2.0, 3.0}})).sum().backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({{0.5, 1.0, 1.5}, {0.5, 1.0, 1.5}})));
+}
+
+TEST(TensorMean, MeanMatchesXtensor) {
+  xt::xarray<double> data = xt::random::randn<double>({6, 7, 8});
+  Tensor a = Tensor::from_xarray(data);
+
+  EXPECT_TRUE(ember::mean(a, {2, 0})
+                  .equals_approx(Tensor::from_xarray(xt::mean(data, {0, 2}))));
+}
+
+TEST(TensorMean, MeanOfNoElementsIsNaN) {
+  Tensor a = Tensor::from_xarray(xt::xarray<double>::from_shape({2, 0}));
+
+  Tensor b = a.mean({1});
+
+  ASSERT_EQ(b.data_.size(), 2);
+  EXPECT_TRUE(std::isnan(b(0)));
+  EXPECT_TRUE(std::isnan(b(1)));
+}
@@ -0,0 +1,84 @@
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xio.hpp>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorMin, MinOfAllElementsIsFound) {
+  Tensor a({{4.0, 7.0, 3.0}, {1.0, 5.0, 6.0}}, true);
+
+  Tensor b = a.min();
+
+  EXPECT_EQ(b.data_.dimension(), 0);
+  EXPECT_DOUBLE_EQ(b(), 1.0);
+
+  b.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{0.0, 0.0, 0.0}, {1.0, 0.0, 0.0}}));
+}
+
+TEST(TensorMin, MinAlongAxisIsFound) {
+  Tensor a({{1.0, 7.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor columns = a.min(0);
+  Tensor rows = a.min(-1);
+
+  EXPECT_EQ(columns, Tensor({1.0, 5.0, 3.0}));
+  EXPECT_EQ(rows, Tensor({1.0, 4.0}));
+  EXPECT_EQ(a.min(-2, true), Tensor({{1.0, 5.0, 3.0}}));
+
+  (columns * Tensor({1.0, 2.0, 3.0})).sum().backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{1.0, 0.0, 3.0}, {0.0, 2.0, 0.0}}));
+}
+
+TEST(TensorMin, GradientFlowsToFirstOfTiedElements) {
+  Tensor a({{2.0, 1.0, 1.0}, {3.0, 3.0, 4.0}}, true);
+
+  Tensor b = a.min(1);
+  b.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{0.0, 1.0, 0.0}, {1.0, 0.0, 0.0}}));
+}
+
+TEST(TensorMin, NaNsArePropagated) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  Tensor a({{1.0, nan, 3.0}, {4.0, 5.0, 6.0}});
+
+  Tensor b = a.min(1);
+
+  EXPECT_TRUE(std::isnan(b(0)));
+  EXPECT_DOUBLE_EQ(b(1), 4.0);
+  EXPECT_TRUE(std::isnan(a.min()()));
+}
+
+TEST(TensorMin, LargeTensorsMatchXtensor) {
+  xt::xarray<double> data = xt::random::randn<double>({40, 500, 3});
+  Tensor a = Tensor::from_xarray(data);
+  std::size_t original_num_threads = get_num_threads();
+
+  for (std::size_t num_threads : {1, 4}) {
+    set_num_threads(num_threads);
+    for (std::ptrdiff_t axis : {0, 1, 2}) {
+      EXPECT_EQ(a.min(axis), Tensor::from_xarray(xt::amin(data, {axis})))
+          << "axis " << axis;
+    }
+    EXPECT_EQ(a.min()(), xt::amin(data)());
+  }
+  set_num_threads(original_num_threads);
+}
+
+TEST(TensorMin, EmptyAxesAreRejected) {
+  Tensor a = Tensor::from_xarray(xt::xarray<double>::from_shape({2, 0}));
+
+  EXPECT_THROW(a.min(1), std::invalid_argument);
+  EXPECT_THROW(a.min(), std::invalid_argument);
+}
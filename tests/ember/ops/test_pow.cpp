@@ -0,0 +1,48 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace ember;
+
+TEST(TensorPow, PowIsCorrectlyComputed) {
+  Tensor a({2.0, 3.0}, true);
+  Tensor b({3.0, 2.0}, true);
+
+  Tensor c = a.pow(b);
+
+  EXPECT_TRUE(c.equals_approx(Tensor({8.0, 9.0})));
+
+  c.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(Tensor({12.0, 6.0})));
+  EXPECT_TRUE(b.gradient->equals_approx(
+      Tensor({8.0 * std::log(2.0), 9.0 * std::log(3.0)})));
+}
+
+TEST(TensorPow, ScalarExponentIsBroadcast) {
+  Tensor a({{1.0, 2.0}, {3.0, 4.0}}, true);
+  Tensor b(2.0, true);
+
+  Tensor c = ember::pow(a, b);
+
+  EXPECT_TRUE(c.equals_approx(Tensor({{1.0, 4.0}, {9.0, 16.0}})));
+
+  c.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(Tensor({{2.0, 4.0}, {6.0, 8.0}})));
+  double expected_b_grad =
+      4.0 * std::log(2.0) + 9.0 * std::log(3.0) + 16.0 * std::log(4.0);
+  EXPECT_TRUE(b.gradient->equals_approx(Tensor(expected_b_grad)));
+}
+
+TEST(TensorPow, ExponentGradientIsZeroForZeroBase) {
+  Tensor a({0.0, 2.0});
+  Tensor b({2.0, 1.0}, true);
+
+  Tensor c = ember::pow(a, b);
+  c.backward();
+
+  EXPECT_TRUE(b.gradient->equals_approx(Tensor({0.0, 2.0 * std::log(2.0)})));
+}
@@ -0,0 +1,26 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorRelu, ReluIsCorrectlyComputed) {
+  Tensor a({{-2.0, 0.0}, {0.5, 3.0}}, true);
+
+  Tensor b = a.relu();
+
+  EXPECT_EQ(b, Tensor({{0.0, 0.0}, {0.5, 3.0}}));
+
+  (b * Tensor({{1.0, 2.0}, {3.0, 4.0}})).backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{0.0, 0.0}, {3.0, 4.0}}));
+}
+
+TEST(TensorRelu, NaNsArePropagated) {
+  Tensor b = ember::relu(Tensor({std::numeric_limits<double>::quiet_NaN()}));
+
+  EXPECT_TRUE(std::isnan(b(0)));
+}
@@ -0,0 +1,28 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorRsqrt, RsqrtIsCorrectlyComputed) {
+  Tensor a({4.0, 0.25, 2.0}, true);
+
+  Tensor b = a.rsqrt();
+
+  EXPECT_TRUE(b.equals_approx(Tensor({0.5, 2.0, 1.0 / std::sqrt(2.0)})));
+
+  b.backward();
+
+  // d/dx x^(-1/2) = -x^(-3/2) / 2
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({-0.0625, -4.0, -0.5 * std::pow(2.0, -1.5)})));
+}
+
+TEST(TensorRsqrt, ZeroGivesInfinity) {
+  Tensor b = ember::rsqrt(Tensor({0.0}));
+
+  EXPECT_EQ(b(0), std::numeric_limits<double>::infinity());
+}
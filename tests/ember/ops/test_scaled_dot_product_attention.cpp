@@ -0,0 +1,176 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmanipulation.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+const double kInf = std::numeric_limits<double>::infinity();
+
+/**
+ * Checks the output and gradients of attention over 2-dimensional inputs
+ * against the composed ops, where `mask` is 0 where a key is masked and 1
+ * elsewhere.
+ */
+void expect_matches_composed_ops(std::size_t queries, std::size_t keys,
+                                 std::size_t dim, std::size_t value_dim,
+                                 const xt::xarray<double>& mask,
+                                 bool causal) {
+  Tensor q = Tensor::randn({queries, dim});
+  Tensor k = Tensor::randn({keys, dim});
+  Tensor v = Tensor::randn({keys, value_dim});
+  Tensor k_t = Tensor::from_xarray(xt::transpose(k.data_));
+  for (Tensor* t : {&q, &k, &v, &k_t}) {
+    t->requires_grad(true);
+  }
+  Tensor upstream = Tensor::randn({queries, value_dim});
+
+  Tensor bias = Tensor::zeros_like(Tensor::from_xarray(mask));
+  for (std::size_t i = 0; i < mask.size(); ++i) {
+    if (mask.data()[i] == 0.0) {
+      bias.data_.data()[i] = -kInf;
+    }
+  }
+  Tensor scale(1.0 / std::sqrt(static_cast<double>(dim)));
+  Tensor scores = ember::matmul(q, k_t) * scale + bias;
+  Tensor expected = ember::matmul(scores.softmax(), v);
+  (expected * upstream).backward();
+  Tensor q_grad = *q.gradient, v_grad = *v.gradient;
+  Tensor k_grad = Tensor::from_xarray(xt::transpose(k_t.gradient->data_));
+  delete q.gradient;
+  delete v.gradient;
+  q.gradient = v.gradient = nullptr;
+
+  Tensor actual =
+      causal ? ember::scaled_dot_product_attention(q, k, v, true)
+             : ember::scaled_dot_product_attention(q, k, v,
+                                                   Tensor::from_xarray(mask));
+  (actual * upstream).backward();
+
+  EXPECT_TRUE(actual.equals_approx(expected));
+  EXPECT_TRUE(q.gradient->equals_approx(q_grad));
+  EXPECT_TRUE(k.gradient->equals_approx(k_grad));
+  EXPECT_TRUE(v.gradient->equals_approx(v_grad));
+}
+
+// Returns sequence `b` of a 3-dimensional tensor as a 2-dimensional one.
+Tensor sequence(const Tensor& t, std::size_t b) {
+  std::size_t rows = t.data_.shape()[1];
+  std::size_t cols = t.data_.shape()[2];
+  auto result = xt::xarray<double>::from_shape({rows, cols});
+  const double* start = t.data_.data() + b * rows * cols;
+  std::copy(start, start + rows * cols, result.begin());
+  return Tensor::from_xarray(result);
+}
+
+}  // namespace
+
+TEST(TensorScaledDotProductAttention, AttentionIsCorrectlyComputed) {
+  // The first query scores both keys 0, and the second scores them
+  // 1 / sqrt(2) and 0.
+  Tensor q({{0.0, 0.0}, {1.0, 0.0}});
+  Tensor k({{1.0, 0.0}, {0.0, 0.0}});
+  Tensor v({{2.0, 0.0}, {0.0, 4.0}});
+
+  Tensor y = ember::scaled_dot_product_attention(q, k, v);
+
+  double p = 1.0 / (1.0 + std::exp(-1.0 / std::sqrt(2.0)));
+  EXPECT_TRUE(y.equals_approx(Tensor({{1.0, 2.0}, {2 * p, 4 * (1 - p)}})));
+}
+
+TEST(TensorScaledDotProductAttention, UnmaskedAttentionMatchesComposedOps) {
+  // Neither sequence length is a multiple of the tile size.
+  expect_matches_composed_ops(70, 130, 16, 8, xt::ones<double>({70, 130}),
+                              false);
+}
+
+TEST(TensorScaledDotProductAttention, CausalAttentionMatchesComposedOps) {
+  std::size_t n = 150;
+  xt::xarray<double> mask = xt::zeros<double>({n, n});
+  for (std::size_t i = 0; i < n; ++i) {
+    for (std::size_t j = 0; j <= i; ++j) {
+      mask(i, j) = 1.0;
+    }
+  }
+  expect_matches_composed_ops(n, n, 8, 12, mask, true);
+}
+
+TEST(TensorScaledDotProductAttention, MaskedAttentionMatchesComposedOps) {
+  // Roughly half of the keys are masked, but never the query's own.
+  xt::xarray<double> mask = xt::random::randn<double>({90, 100});
+  for (std::size_t i = 0; i < 90; ++i) {
+    for (std::size_t j = 0; j < 100; ++j) {
+      mask(i, j) = i == j || mask(i, j) > 0.0 ? 1.0 : 0.0;
+    }
+  }
+  expect_matches_composed_ops(90, 100, 8, 8, mask, false);
+}
+
+TEST(TensorScaledDotProductAttention, BatchedAttentionMatchesEachSequence) {
+  Tensor q = Tensor::randn({3, 80, 4});
+  Tensor k = Tensor::randn({3, 80, 4});
+  Tensor v = Tensor::randn({3, 80, 5});
+  q.requires_grad(true);
+
+  Tensor y = ember::scaled_dot_product_attention(q, k, v, true);
+  y.backward();
+
+  for (std::size_t b = 0; b < 3; ++b) {
+    Tensor q_b = sequence(q, b);
+    q_b.requires_grad(true);
+    Tensor y_b = ember::scaled_dot_product_attention(q_b, sequence(k, b),
+                                                     sequence(v, b), true);
+    y_b.backward();
+
+    EXPECT_TRUE(sequence(y, b).equals_approx(y_b));
+    EXPECT_TRUE(sequence(*q.gradient, b).equals_approx(*q_b.gradient));
+  }
+}
+
+TEST(TensorScaledDotProductAttention, FullyMaskedQueriesGetZeros) {
+  Tensor q = Tensor::randn({2, 3});
+  Tensor k = Tensor::randn({4, 3});
+  Tensor v = Tensor::randn({4, 2});
+  q.requires_grad(true);
+  Tensor mask({{0.0, 0.0, 0.0, 0.0}, {1.0, 0.0, 1.0, 0.0}});
+
+  Tensor y = ember::scaled_dot_product_attention(q, k, v, mask);
+  y.backward();
+
+  EXPECT_EQ(y(0, 0), 0.0);
+  EXPECT_EQ(y(0, 1), 0.0);
+  EXPECT_EQ((*q.gradient)(0, 0), 0.0);
+  EXPECT_FALSE(std::isnan((*q.gradient)(1, 0)));
+}
+
+TEST(TensorScaledDotProductAttention, MismatchedShapesAreRejected) {
+  Tensor q = Tensor::randn({2, 5, 4});
+  Tensor k = Tensor::randn({2, 6, 4});
+  Tensor v = Tensor::randn({2, 6, 3});
+
+  Tensor wrong_features = Tensor::randn({2, 6, 3});
+  Tensor wrong_values = Tensor::randn({2, 5, 3});
+  Tensor wrong_batch = Tensor::randn({3, 6, 4});
+
+  EXPECT_THROW(ember::scaled_dot_product_attention(q, wrong_features, v),
+               std::invalid_argument);
+  EXPECT_THROW(ember::scaled_dot_product_attention(q, k, wrong_values),
+               std::invalid_argument);
+  EXPECT_THROW(ember::scaled_dot_product_attention(q, wrong_batch, v),
+               std::invalid_argument);
+  EXPECT_THROW(
+      ember::scaled_dot_product_attention(q, k, v, Tensor::randn({6, 5})),
+      std::invalid_argument);
+  EXPECT_THROW(
+      ember::scaled_dot_product_attention(q, k, v, Tensor::randn({3, 5, 6})),
+      std::invalid_argument);
+}
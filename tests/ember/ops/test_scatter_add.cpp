@@ -0,0 +1,48 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+using namespace ember;
+
+TEST(TensorScatterAdd, ScatterAddIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+  Tensor index({{2.0, 2.0}, {0.0, 1.0}});
+  Tensor source({{10.0, 20.0}, {30.0, 40.0}});
+
+  EXPECT_TRUE(ember::scatter_add(x, 1, index, source)
+                  .equals(Tensor({{1.0, 2.0, 33.0}, {34.0, 45.0, 6.0}})));
+  EXPECT_TRUE(ember::scatter_add(x, 0, Tensor({{1.0, 0.0}, {1.0, 1.0}}),
+                                 source)
+                  .equals(Tensor({{1.0, 22.0, 3.0}, {44.0, 45.0, 6.0}})));
+}
+
+TEST(TensorScatterAdd, GradientsAreCorrectlyComputed) {
+  Tensor x = Tensor::randn({2, 3});
+  Tensor source = Tensor::randn({2, 2});
+  x.requires_grad(true);
+  source.requires_grad(true);
+  Tensor upstream({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+
+  Tensor y = ember::scatter_add(x, 1, Tensor({{2.0, 2.0}, {0.0, 1.0}}),
+                                source);
+  (y * upstream).backward();
+
+  EXPECT_TRUE(x.gradient->equals(upstream));
+  EXPECT_TRUE(source.gradient->equals(Tensor({{3.0, 3.0}, {4.0, 5.0}})));
+}
+
+TEST(TensorScatterAdd, InvalidArgumentsAreRejected) {
+  Tensor x = Tensor::randn({2, 3});
+
+  EXPECT_THROW(ember::scatter_add(x, 1, Tensor({{0.0, 1.0}}),
+                                  Tensor({{1.0, 2.0}, {3.0, 4.0}})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::scatter_add(x, 1, Tensor({{0.0, 3.0}}),
+                                  Tensor({{1.0, 2.0}})),
+               std::invalid_argument);
+  EXPECT_THROW(ember::scatter_add(x, 2, Tensor({{0.0, 1.0}}),
+                                  Tensor({{1.0, 2.0}})),
+               std::invalid_argument);
+}
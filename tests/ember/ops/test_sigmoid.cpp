@@ -0,0 +1,44 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorSigmoid, SigmoidIsCorrectlyComputed) {
+  Tensor a({-2.0, 0.0, 3.0}, true);
+
+  Tensor b = a.sigmoid();
+
+  EXPECT_TRUE(b.equals_approx(
+      Tensor({0.11920292202211755, 0.5, 0.9525741268224334})));
+
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({0.1049935854035065, 0.25, 0.045176659730912})));
+}
+
+TEST(TensorSigmoid, SaturatesForLargeInputs) {
+  double inf = std::numeric_limits<double>::infinity();
+  Tensor b = ember::sigmoid(Tensor({-inf, -800.0, 800.0, inf}));
+
+  EXPECT_EQ(b, Tensor({0.0, 0.0, 1.0, 1.0}));
+}
+
+TEST(TensorSigmoid, FastMathIsCloseToExactResult) {
+  xt::xarray<double> data = xt::random::randn<double>({1000}) * 20.0;
+  Tensor a = Tensor::from_xarray(data);
+  Tensor exact = a.sigmoid();
+
+  kernels::set_fast_math(true);
+  Tensor fast = a.sigmoid();
+  kernels::set_fast_math(false);
+
+  EXPECT_TRUE(xt::allclose(fast.data_, exact.data_, 1e-15, 0.0));
+}
@@ -0,0 +1,63 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorSoftmax, SoftmaxIsCorrectlyComputed) {
+  Tensor a({1.0, 2.0, 3.0}, true);
+
+  Tensor b = a.softmax();
+
+  EXPECT_TRUE(b.equals_approx(
+      Tensor({0.09003057317038046, 0.24472847105479767, 0.6652409557748219})));
+
+  // The outputs always sum to 1, so the gradient of their sum is 0.
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(Tensor({0.0, 0.0, 0.0})));
+}
+
+TEST(TensorSoftmax, GradientMatchesComposedOps) {
+  for (std::ptrdiff_t axis : {0, 1, -1}) {
+    Tensor a = Tensor::randn({4, 5});
+    a.requires_grad(true);
+    Tensor upstream = Tensor::randn({4, 5});
+
+    Tensor expected =
+        (a - ember::logsumexp(a, {axis}, true)).exp();
+    (expected * upstream).backward();
+    Tensor expected_grad = *a.gradient;
+    delete a.gradient;
+    a.gradient = nullptr;
+
+    Tensor actual = ember::softmax(a, axis);
+    (actual * upstream).backward();
+
+    EXPECT_TRUE(actual.equals_approx(expected));
+    EXPECT_TRUE(a.gradient->equals_approx(expected_grad));
+  }
+}
+
+TEST(TensorSoftmax, SoftmaxOverMiddleAxisOfThreeDimensions) {
+  Tensor a = Tensor::randn({2, 3, 4});
+
+  Tensor b = ember::softmax(a, 1);
+
+  EXPECT_TRUE(ember::sum(b, {1}).equals_approx(Tensor({{1.0, 1.0, 1.0, 1.0},
+                                                       {1.0, 1.0, 1.0, 1.0}})));
+  EXPECT_TRUE(b.equals_approx((a - ember::logsumexp(a, {1}, true)).exp()));
+}
+
+TEST(TensorSoftmax, LargeLogitsDontOverflow) {
+  Tensor b = ember::softmax(Tensor({1000.0, 1000.0, -1000.0}));
+
+  EXPECT_TRUE(b.equals_approx(Tensor({0.5, 0.5, 0.0})));
+}
+
+TEST(TensorSoftmax, InvalidAxisIsRejected) {
+  EXPECT_THROW(ember::softmax(Tensor({1.0, 2.0}), 1), std::invalid_argument);
+}
@@ -0,0 +1,68 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(TensorSplit, SplitIsCorrectlyComputed) {
+  Tensor x({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+
+  auto rows = ember::split(x, {1, 1});
+  ASSERT_EQ(rows.size(), 2);
+  EXPECT_TRUE(rows[0].equals(Tensor({{1.0, 2.0, 3.0}})));
+  EXPECT_TRUE(rows[1].equals(Tensor({{4.0, 5.0, 6.0}})));
+
+  auto columns = ember::split(x, {2, 0, 1}, -1);
+  ASSERT_EQ(columns.size(), 3);
+  EXPECT_TRUE(columns[0].equals(Tensor({{1.0, 2.0}, {4.0, 5.0}})));
+  EXPECT_EQ(columns[1].data_.shape()[1], 0);
+  ASSERT_EQ(columns[2].data_.shape()[1], 1);
+  EXPECT_EQ(columns[2](0, 0), 3.0);
+  EXPECT_EQ(columns[2](1, 0), 6.0);
+}
+
+TEST(TensorSplit, ChunkRoundsThePieceSizeUp) {
+  Tensor x({1.0, 2.0, 3.0, 4.0, 5.0});
+
+  auto pieces = ember::chunk(x, 4);
+
+  ASSERT_EQ(pieces.size(), 3);
+  EXPECT_TRUE(pieces[0].equals(Tensor({1.0, 2.0})));
+  EXPECT_TRUE(pieces[1].equals(Tensor({3.0, 4.0})));
+  EXPECT_TRUE(pieces[2].equals(Tensor({5.0})));
+}
+
+TEST(TensorSplit, GradientsOfThePiecesAreCombined) {
+  Tensor x = Tensor::randn({2, 5, 3});
+  x.requires_grad(true);
+  Tensor upstream = Tensor::randn({2, 5, 3});
+
+  auto pieces = ember::chunk(x, 2, 1);
+  auto slices = ember::chunk(upstream, 2, 1);
+  ((pieces[0] * slices[0]).sum() + (pieces[1] * slices[1]).sum()).backward();
+
+  EXPECT_TRUE(x.gradient->equals(upstream));
+}
+
+TEST(TensorSplit, CatUndoesSplit) {
+  Tensor x = Tensor::randn({4, 3, 2});
+  x.requires_grad(true);
+
+  auto pieces = ember::split(x, {1, 2}, 1);
+  Tensor y = ember::cat({pieces[1], pieces[0]}, 1);
+  y.backward();
+
+  EXPECT_TRUE(ember::cat({pieces[0], pieces[1]}, 1).equals(x));
+  EXPECT_TRUE(x.gradient->equals(Tensor::ones_like(x)));
+}
+
+TEST(TensorSplit, InvalidArgumentsAreRejected) {
+  Tensor x = Tensor::randn({2, 3});
+
+  EXPECT_THROW(ember::split(x, {1, 1}, 1), std::invalid_argument);
+  EXPECT_THROW(ember::split(x, {2}, 2), std::invalid_argument);
+  EXPECT_THROW(ember::chunk(x, 0), std::invalid_argument);
+}
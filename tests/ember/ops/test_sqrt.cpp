@@ -0,0 +1,27 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+using namespace ember;
+
+TEST(TensorSqrt, SqrtIsCorrectlyComputed) {
+  Tensor a({{4.0, 9.0}, {0.25, 2.0}}, true);
+
+  Tensor b = a.sqrt();
+
+  EXPECT_TRUE(b.equals_approx(Tensor({{2.0, 3.0}, {0.5, std::sqrt(2.0)}})));
+
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({{0.25, 1.0 / 6.0}, {1.0, 0.5 / std::sqrt(2.0)}})));
+}
+
+TEST(TensorSqrt, NegativeInputsGiveNaN) {
+  Tensor b = ember::sqrt(Tensor({-1.0, 0.0}));
+
+  EXPECT_TRUE(std::isnan(b(0)));
+  EXPECT_EQ(b(1), 0.0);
+}
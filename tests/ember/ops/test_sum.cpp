@@ -0,0 +1,94 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xio.hpp>
+#include <xtensor/xrandom.hpp>
+
+using namespace ember;
+
+TEST(TensorSum, AllElementsCanBeSummed) {
+  Tensor a({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor b = a.sum();
+
+  EXPECT_EQ(b.data_.dimension(), 0);
+  EXPECT_DOUBLE_EQ(b(), 21.0);
+
+  b.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{1.0, 1.0, 1.0}, {1.0, 1.0, 1.0}}));
+}
+
+TEST(TensorSum, SingleAxisCanBeSummed) {
+  Tensor a({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor rows = ember::sum(a, {1});
+  Tensor columns = ember::sum(a, {0});
+
+  EXPECT_EQ(rows, Tensor({6.0, 15.0}));
+  EXPECT_EQ(columns, Tensor({5.0, 7.0, 9.0}));
+
+  Tensor total = (rows * Tensor({1.0, 2.0})).sum();
+  total.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor({{1.0, 1.0, 1.0}, {2.0, 2.0, 2.0}}));
+}
+
+TEST(TensorSum, NegativeAxesCountFromTheEnd) {
+  Tensor a({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+
+  EXPECT_EQ(a.sum({-1}), a.sum({1}));
+  EXPECT_EQ(a.sum({-2}), a.sum({0}));
+}
+
+TEST(TensorSum, KeepdimsKeepsReducedAxes) {
+  Tensor a({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}}, true);
+
+  Tensor b = a.sum({1}, true);
+
+  EXPECT_EQ(b.data_.shape(), (xt::xarray<double>::shape_type{2, 1}));
+  EXPECT_DOUBLE_EQ(b(0, 0), 6.0);
+  EXPECT_DOUBLE_EQ(b(1, 0), 15.0);
+
+  Tensor c = (a / b).sum();
+  c.backward();
+
+  // Each row of a / b sums to 1 regardless of a, so the gradient is 0.
+  EXPECT_TRUE(a.gradient->equals_approx(Tensor::zeros_like(a)));
+}
+
+TEST(TensorSum, NonContiguousAxesCanBeSummed) {
+  xt::xarray<double> data = xt::random::randn<double>({3, 4, 5, 6});
+  Tensor a = Tensor::from_xarray(data);
+  a.requires_grad(true);
+
+  Tensor b = ember::sum(a, {0, 2});
+
+  EXPECT_EQ(b.data_.shape(), (xt::xarray<double>::shape_type{4, 6}));
+  EXPECT_TRUE(b.equals_approx(Tensor::from_xarray(xt::sum(data, {0, 2}))));
+
+  b.backward();
+
+  EXPECT_EQ(*a.gradient, Tensor::ones_like(a));
+}
+
+TEST(TensorSum, LargeTensorsMatchXtensor) {
+  xt::xarray<double> data = xt::random::randn<double>({70, 300, 9});
+  Tensor a = Tensor::from_xarray(data);
+
+  for (std::ptrdiff_t axis : {0, 1, 2}) {
+    EXPECT_TRUE(ember::sum(a, {axis}).equals_approx(
+        Tensor::from_xarray(xt::sum(data, {axis}))))
+        << "axis " << axis;
+  }
+  EXPECT_NEAR(a.sum()(), xt::sum(data)(), 1e-8);
+}
+
+TEST(TensorSum, InvalidAxesAreRejected) {
+  Tensor a({{1.0, 2.0}, {3.0, 4.0}});
+
+  EXPECT_THROW(a.sum({2}), std::invalid_argument);
+  EXPECT_THROW(a.sum({-3}), std::invalid_argument);
+  EXPECT_THROW(a.sum({0, -2}), std::invalid_argument);
+}
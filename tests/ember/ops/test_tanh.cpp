@@ -0,0 +1,44 @@
+#include <ember/kernels/dispatch.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace ember;
+
+TEST(TensorTanh, TanhIsCorrectlyComputed) {
+  Tensor a({-1.5, 0.0, 0.3}, true);
+
+  Tensor b = a.tanh();
+
+  EXPECT_TRUE(
+      b.equals_approx(Tensor({-0.9051482536448664, 0.0, 0.2913126124515909})));
+
+  b.backward();
+
+  EXPECT_TRUE(a.gradient->equals_approx(
+      Tensor({0.18070663892364858, 1.0, 0.9151369618266292})));
+}
+
+TEST(TensorTanh, SaturatesForLargeInputs) {
+  double inf = std::numeric_limits<double>::infinity();
+  Tensor b = ember::tanh(Tensor({-inf, -50.0, 50.0, inf}));
+
+  EXPECT_EQ(b, Tensor({-1.0, -1.0, 1.0, 1.0}));
+}
+
+TEST(TensorTanh, FastMathIsCloseToExactResult) {
+  xt::xarray<double> data = xt::random::randn<double>({1000}) * 5.0;
+  Tensor a = Tensor::from_xarray(data);
+  Tensor exact = a.tanh();
+
+  kernels::set_fast_math(true);
+  Tensor fast = a.tanh();
+  kernels::set_fast_math(false);
+
+  EXPECT_TRUE(xt::allclose(fast.data_, exact.data_, 1e-15, 0.0));
+}
@@ -0,0 +1,104 @@
+#include <ember/optim/adam.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xmath.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+void set_gradient(Tensor& parameter, const xt::xarray<double>& gradient) {
+  delete parameter.gradient;
+  parameter.gradient = new Tensor(Tensor::from_xarray(gradient));
+}
+
+// Runs three steps of Adam (or AdamW) and of the reference update.
+void expect_matches_reference(bool decoupled) {
+  double lr = 0.01, beta1 = 0.8, beta2 = 0.95, eps = 1e-6, decay = 0.1;
+  Tensor p = Tensor::randn({4, 5});
+  xt::xarray<double> expected = p.data_;
+  xt::xarray<double> m = xt::zeros<double>({4, 5});
+  xt::xarray<double> v = xt::zeros<double>({4, 5});
+  std::unique_ptr<optim::Adam> adam;
+  if (decoupled) {
+    adam = std::make_unique<optim::AdamW>(std::vector<Tensor*>{&p}, lr, beta1,
+                                          beta2, eps, decay);
+  } else {
+    adam = std::make_unique<optim::Adam>(std::vector<Tensor*>{&p}, lr, beta1,
+                                         beta2, eps, decay);
+  }
+
+  for (int t = 1; t <= 3; ++t) {
+    xt::xarray<double> grad = xt::random::randn<double>({4, 5});
+    set_gradient(p, grad);
+    adam->step();
+
+    xt::xarray<double> g = decoupled ? grad : xt::eval(grad + decay * expected);
+    if (decoupled) {
+      expected *= 1.0 - lr * decay;
+    }
+    m = beta1 * m + (1.0 - beta1) * g;
+    v = beta2 * v + (1.0 - beta2) * g * g;
+    xt::xarray<double> m_hat = m / (1.0 - std::pow(beta1, t));
+    xt::xarray<double> v_hat = v / (1.0 - std::pow(beta2, t));
+    expected -= lr * m_hat / (xt::sqrt(v_hat) + eps);
+  }
+  EXPECT_TRUE(p.equals_approx(Tensor::from_xarray(expected)));
+}
+
+}  // namespace
+
+TEST(OptimAdam, AdamMatchesTheReference) {
+  expect_matches_reference(false);
+}
+
+TEST(OptimAdam, AdamWMatchesTheReference) {
+  expect_matches_reference(true);
+}
+
+TEST(OptimAdam, FirstStepMovesEachElementByTheLearningRate) {
+  Tensor p({1.0, 1.0, 1.0}, true);
+  optim::Adam adam({&p}, 0.1);
+
+  (p * Tensor({2.0, -0.5, 1000.0})).sum().backward();
+  adam.step();
+
+  EXPECT_TRUE(p.equals_approx(Tensor({0.9, 1.1, 0.9})));
+}
+
+TEST(OptimAdam, ParametersWithoutGradientsAreSkipped) {
+  Tensor a({1.0}, true);
+  Tensor b({1.0}, true);
+  optim::Adam adam({&a, &b}, 0.1);
+
+  (a * Tensor({1.0})).sum().backward();
+  adam.step();
+  EXPECT_TRUE(b.equals(Tensor({1.0})));
+
+  // b's first step is bias corrected as a first step too.
+  adam.zero_grad(true);
+  (b * Tensor({1.0})).sum().backward();
+  adam.step();
+  EXPECT_TRUE(a.equals_approx(Tensor({0.9})));
+  EXPECT_TRUE(b.equals_approx(Tensor({0.9})));
+}
+
+TEST(OptimAdam, InvalidHyperparametersAreRejected) {
+  Tensor p({1.0});
+
+  EXPECT_THROW(optim::Adam({&p}, -1.0), std::invalid_argument);
+  EXPECT_THROW(optim::Adam({&p}, 0.1, 1.0), std::invalid_argument);
+  EXPECT_THROW(optim::AdamW({&p}, 0.1, 0.9, -0.1), std::invalid_argument);
+  EXPECT_THROW(optim::AdamW({&p}, 0.1, 0.9, 0.999, 1e-8, -1.0),
+               std::invalid_argument);
+  EXPECT_THROW(optim::Adam({nullptr}), std::invalid_argument);
+}
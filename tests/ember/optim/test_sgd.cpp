@@ -0,0 +1,150 @@
+#include <ember/optim/sgd.h>
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+#include <xtensor/xbuilder.hpp>
+#include <xtensor/xrandom.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+void set_gradient(Tensor& parameter, const xt::xarray<double>& gradient) {
+  delete parameter.gradient;
+  parameter.gradient = new Tensor(Tensor::from_xarray(gradient));
+}
+
+}  // namespace
+
+TEST(OptimSGD, MatchesTheReferenceWithMomentumAndWeightDecay) {
+  for (bool nesterov : {false, true}) {
+    Tensor p = Tensor::randn({3, 4});
+    xt::xarray<double> expected = p.data_;
+    xt::xarray<double> buffer = xt::zeros<double>({3, 4});
+    double dampening = nesterov ? 0.0 : 0.1;
+    optim::SGD sgd({&p}, 0.1, 0.9, dampening, 0.01, nesterov);
+
+    for (int t = 0; t < 3; ++t) {
+      xt::xarray<double> grad = xt::random::randn<double>({3, 4});
+      set_gradient(p, grad);
+      sgd.step();
+
+      xt::xarray<double> g = grad + 0.01 * expected;
+      buffer = t == 0 ? g : xt::eval(0.9 * buffer + (1.0 - dampening) * g);
+      expected -= 0.1 * (nesterov ? xt::eval(g + 0.9 * buffer) : buffer);
+    }
+    EXPECT_TRUE(p.equals_approx(Tensor::from_xarray(expected)))
+        << "nesterov " << nesterov;
+  }
+}
+
+TEST(OptimSGD, SparseGradientsGiveTheSameResultAsDenseOnes) {
+  Tensor table = Tensor::randn({6, 3});
+  table.requires_grad(true);
+  Tensor dense_table = table;
+  dense_table.requires_grad(true);
+  optim::SGD sparse_sgd({&table}, 0.5, 0.9);
+  optim::SGD dense_sgd({&dense_table}, 0.5, 0.9);
+
+  for (int t = 0; t < 2; ++t) {
+    Tensor indices({4.0, 1.0, 4.0});
+    ember::embedding(table, indices).sum().backward();
+    ASSERT_TRUE(table.gradient->is_sparse());
+    set_gradient(dense_table, table.gradient->to_dense().data_);
+    sparse_sgd.step();
+    dense_sgd.step();
+    sparse_sgd.zero_grad();
+  }
+
+  EXPECT_TRUE(table.equals(dense_table));
+}
+
+TEST(OptimSGD, UpdatesOnlyTheStoredElementsOfCsrParameters) {
+  Tensor adjacency = Tensor::from_csr(
+      CsrMatrix::from_triplets(3, 3, {0, 2}, {1, 0}, {1.0, 2.0}));
+  adjacency.requires_grad(true);
+  Tensor x({1.0, 2.0, 3.0});
+  optim::SGD sgd({&adjacency}, 0.5);
+
+  ember::matmul(adjacency, x).sum().backward();
+  ASSERT_TRUE(adjacency.gradient->is_csr());
+  sgd.step();
+
+  // The gradient of element (i, j) is x_j.
+  EXPECT_EQ(adjacency.csr().values, (std::vector<double>{0.0, 1.5}));
+}
+
+TEST(OptimSGD, GradientsOfAnotherShapeAreRejected) {
+  Tensor p = Tensor::randn({2, 3});
+  optim::SGD sgd({&p}, 0.1);
+
+  set_gradient(p, xt::ones<double>({2, 4}));
+  EXPECT_THROW(sgd.step(), std::invalid_argument);
+  set_gradient(p, xt::ones<double>({3, 2}));
+  EXPECT_THROW(sgd.step(), std::invalid_argument);
+  delete p.gradient;
+  p.gradient = new Tensor(Tensor::from_sparse_rows(
+      SparseRows{{4, 3}, {1}, xt::ones<double>({1, 3})}));
+  EXPECT_THROW(sgd.step(), std::invalid_argument);
+  set_gradient(p, xt::ones<double>({2, 3}));
+  EXPECT_NO_THROW(sgd.step());
+  delete p.gradient;
+}
+
+TEST(OptimSGD, ZeroGradKeepsOrFreesTheGradients) {
+  Tensor p({1.0, 2.0}, true);
+  optim::SGD sgd({&p}, 0.1);
+
+  (p * Tensor({3.0, 4.0})).sum().backward();
+  Tensor* gradient = p.gradient;
+  sgd.zero_grad();
+  EXPECT_EQ(p.gradient, gradient);
+  EXPECT_TRUE(p.gradient->equals(Tensor({0.0, 0.0})));
+
+  (p * Tensor({3.0, 4.0})).sum().backward();
+  EXPECT_EQ(p.gradient, gradient);
+  EXPECT_TRUE(p.gradient->equals(Tensor({3.0, 4.0})));
+
+  sgd.zero_grad(true);
+  EXPECT_EQ(p.gradient, nullptr);
+  sgd.step();
+  EXPECT_TRUE(p.equals(Tensor({1.0, 2.0})));
+}
+
+TEST(OptimSGD, ResultDoesntDependOnTheNumberOfThreads) {
+  xt::xarray<double> initial = xt::random::randn<double>({300, 250});
+  xt::xarray<double> grad = xt::random::randn<double>({300, 250});
+  std::size_t original_num_threads = get_num_threads();
+
+  std::vector<Tensor> results;
+  for (std::size_t num_threads : {1, 4}) {
+    set_num_threads(num_threads);
+    Tensor large = Tensor::from_xarray(initial);
+    Tensor small({1.0, 2.0});
+    optim::SGD sgd({&large, &small}, 0.1, 0.9, 0.0, 0.01, true);
+    for (int t = 0; t < 2; ++t) {
+      set_gradient(large, grad);
+      set_gradient(small, xt::xarray<double>({1.0, -1.0}));
+      sgd.step();
+    }
+    results.push_back(large);
+  }
+  set_num_threads(original_num_threads);
+
+  EXPECT_TRUE(results[0].equals(results[1]));
+}
+
+TEST(OptimSGD, InvalidHyperparametersAreRejected) {
+  Tensor p({1.0});
+
+  EXPECT_THROW(optim::SGD({&p}, -0.1), std::invalid_argument);
+  EXPECT_THROW(optim::SGD({&p}, 0.1, 0.9, 1.0), std::invalid_argument);
+  EXPECT_THROW(optim::SGD({&p}, 0.1, 0.0, 0.0, 0.0, true),
+               std::invalid_argument);
+  EXPECT_THROW(optim::SGD({&p, &p}, 0.1), std::invalid_argument);
+}
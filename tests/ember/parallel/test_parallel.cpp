@@ -0,0 +1,194 @@
+#include <ember/ops/utils.h>
+#include <ember/parallel/parallel.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xrandom.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// Restores the number of threads when a test finishes.
+struct NumThreadsGuard {
+  std::size_t original = get_num_threads();
+  ~NumThreadsGuard() { set_num_threads(original); }
+};
+
+}  // namespace
+
+TEST(ThreadPool, RunsEveryTaskExactlyOnce) {
+  parallel::ThreadPool pool(4);
+  std::vector<std::atomic<int>> counts(1000);
+
+  pool.run(counts.size(), [&](std::size_t task) { counts[task]++; });
+
+  for (const auto& count : counts) {
+    EXPECT_EQ(count.load(), 1);
+  }
+}
+
+TEST(ThreadPool, RethrowsExceptionsFromTasks) {
+  parallel::ThreadPool pool(4);
+  std::atomic<int> completed = 0;
+
+  EXPECT_THROW(pool.run(8,
+                        [&](std::size_t task) {
+                          if (task == 3) {
+                            throw std::runtime_error("task failed");
+                          }
+                          completed++;
+                        }),
+               std::runtime_error);
+  EXPECT_EQ(completed.load(), 7);
+
+  // The pool is still usable afterwards.
+  pool.run(8, [&](std::size_t) { completed++; });
+  EXPECT_EQ(completed.load(), 15);
+}
+
+TEST(ThreadPool, ZeroThreadsIsRejected) {
+  EXPECT_THROW(parallel::ThreadPool(0), std::invalid_argument);
+}
+
+TEST(ParallelFor, SetNumThreadsChangesThreadCount) {
+  NumThreadsGuard guard;
+
+  set_num_threads(3);
+  EXPECT_EQ(get_num_threads(), 3);
+  EXPECT_EQ(parallel::get_thread_pool().num_threads(), 3);
+
+  EXPECT_THROW(set_num_threads(0), std::invalid_argument);
+}
+
+TEST(ParallelFor, CoversRangeWithoutOverlap) {
+  NumThreadsGuard guard;
+  set_num_threads(4);
+  std::vector<int> visits(100003, 0);
+
+  parallel::parallel_for(3, visits.size(), 1000,
+                         [&](std::size_t begin, std::size_t end) {
+                           for (std::size_t i = begin; i < end; ++i) {
+                             visits[i]++;
+                           }
+                         });
+
+  for (std::size_t i = 0; i < visits.size(); ++i) {
+    EXPECT_EQ(visits[i], i < 3 ? 0 : 1) << "at index " << i;
+  }
+}
+
+TEST(ParallelFor, SmallRangesStayOnCallingThread) {
+  NumThreadsGuard guard;
+  set_num_threads(4);
+  std::thread::id caller = std::this_thread::get_id();
+  int calls = 0;
+
+  parallel::parallel_for(0, 100, parallel::kGrainSize,
+                         [&](std::size_t begin, std::size_t end) {
+                           EXPECT_EQ(std::this_thread::get_id(), caller);
+                           EXPECT_EQ(begin, 0);
+                           EXPECT_EQ(end, 100);
+                           calls++;
+                         });
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ParallelFor, ThreadsAreReusedAcrossCalls) {
+  NumThreadsGuard guard;
+  set_num_threads(4);
+  std::mutex mutex;
+  std::set<std::thread::id> threads;
+
+  for (int i = 0; i < 20; ++i) {
+    parallel::parallel_for(0, 4, 1, [&](std::size_t, std::size_t) {
+      std::lock_guard<std::mutex> lock(mutex);
+      threads.insert(std::this_thread::get_id());
+    });
+  }
+  EXPECT_LE(threads.size(), 4);
+}
+
+TEST(ParallelFor, NestedCallsRunInline) {
+  NumThreadsGuard guard;
+  set_num_threads(4);
+  std::atomic<int> inner_chunks = 0;
+
+  parallel::parallel_for(0, 4, 1, [&](std::size_t, std::size_t) {
+    EXPECT_TRUE(parallel::ThreadPool::in_parallel_region());
+    parallel::parallel_for(0, 1000, 1,
+                           [&](std::size_t, std::size_t) { inner_chunks++; });
+  });
+  EXPECT_EQ(inner_chunks.load(), 4);
+  EXPECT_FALSE(parallel::ThreadPool::in_parallel_region());
+}
+
+TEST(ParallelReduce, IsDeterministicForFixedThreadCount) {
+  NumThreadsGuard guard;
+  set_num_threads(4);
+  xt::xarray<double> values = xt::random::randn<double>({200000});
+  auto sum = [&] {
+    return parallel::parallel_reduce(
+        0, values.size(), 1000, 0.0,
+        [&](std::size_t begin, std::size_t end) {
+          double partial = 0.0;
+          for (std::size_t i = begin; i < end; ++i) {
+            partial += values(i);
+          }
+          return partial;
+        },
+        [](double a, double b) { return a + b; });
+  };
+
+  double first = sum();
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(sum(), first);
+  }
+  EXPECT_NEAR(first, xt::sum(values)(), 1e-8);
+}
+
+TEST(ParallelOps, LargeOpsMatchSingleThreadedResults) {
+  NumThreadsGuard guard;
+  Tensor a = Tensor::randn({300, 400}, 0.0, 1.0);
+  Tensor b = Tensor::randn({400}, 0.0, 1.0);
+  Tensor c = Tensor::randn({300, 1}, 2.0, 0.1);
+  a.requires_grad(true);
+  b.requires_grad(true);
+
+  set_num_threads(1);
+  Tensor expected = (a * b + c) / c;
+  expected.backward();
+  Tensor expected_grad_b = *b.gradient;
+
+  for (std::size_t num_threads : {2, 3, 4}) {
+    set_num_threads(num_threads);
+    delete b.gradient;
+    b.gradient = nullptr;
+
+    Tensor actual = (a * b + c) / c;
+    EXPECT_EQ(actual, expected);
+    actual.backward();
+    EXPECT_TRUE(b.gradient->equals_approx(expected_grad_b));
+  }
+}
+
+TEST(ParallelOps, ReduceBroadcastIsDeterministicForFixedThreadCount) {
+  NumThreadsGuard guard;
+  set_num_threads(4);
+  xt::xarray<double> grad = xt::random::randn<double>({5000, 16});
+  xt::xarray<double>::shape_type target_shape = {16};
+
+  xt::xarray<double> first = reduce_broadcast(grad, target_shape);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(xt::all(xt::equal(reduce_broadcast(grad, target_shape),
+                                  first)));
+  }
+  EXPECT_TRUE(xt::allclose(first, xt::sum(grad, {0})));
+}
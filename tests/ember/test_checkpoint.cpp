@@ -0,0 +1,287 @@
+#include <ember/checkpoint.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include "test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+class CheckpointTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    manual_seed(0);
+    w_ = Tensor::randn({3, 3});
+    b_ = Tensor::randn({3});
+    x_ = Tensor::randn({4, 3});
+    w_.requires_grad(true);
+    b_.requires_grad(true);
+  }
+
+  void TearDown() override { clear_gradients({&w_, &b_, &x_}); }
+
+  // Two layers, with dropout in between.
+  Tensor block(const Tensor& x) {
+    Tensor hidden = ember::dropout(ember::tanh(ember::linear(x, w_, b_)), 0.5);
+    return ember::tanh(ember::linear(hidden, w_, b_));
+  }
+
+  // Runs `forward` from seed 1 and returns the loss and the gradients of the
+  // input and the parameters.
+  std::vector<xt::xarray<double>> run(
+      const std::function<Tensor(const Tensor&)>& forward) {
+    TearDown();
+    manual_seed(1);
+    Tensor loss = (forward(x_) * forward(x_)).sum();
+    loss.backward();
+    std::vector<xt::xarray<double>> result = {loss.data_};
+    for (Tensor* t : {&x_, &w_, &b_}) {
+      result.push_back(t->gradient == nullptr ? xt::xarray<double>()
+                                              : t->gradient->data_);
+    }
+    // The values drawn after the backward pass.
+    result.push_back(Tensor::randn({2}).data_);
+    return result;
+  }
+
+  Tensor w_;
+  Tensor b_;
+  Tensor x_;
+};
+
+}  // namespace
+
+TEST_F(CheckpointTest, GradientsMatchTheUncheckpointedSegment) {
+  x_.requires_grad(true);
+  auto expected = run([&](const Tensor& x) { return block(x); });
+  auto actual = run([&](const Tensor& x) {
+    return checkpoint([&](const Tensor& input) { return block(input); }, x);
+  });
+
+  expect_same(actual, expected);
+}
+
+TEST_F(CheckpointTest, ParametersGetGradientsWhenTheInputDoesNot) {
+  auto expected = run([&](const Tensor& x) { return block(x); });
+  auto actual = run([&](const Tensor& x) {
+    return checkpoint([&](const Tensor& input) { return block(input); }, x);
+  });
+
+  EXPECT_EQ(x_.gradient, nullptr);
+  expect_same(actual, expected);
+}
+
+TEST_F(CheckpointTest, OnlyTheInputsAreKeptForTheBackwardPass) {
+  x_.requires_grad(true);
+  Tensor y = checkpoint([&](const Tensor& input) { return block(input); }, x_);
+
+  ASSERT_TRUE(y.requires_grad());
+  autograd::Node* node = y.get_gradient_fn();
+  ASSERT_EQ(node->edges.size(), 1u);
+  EXPECT_EQ(node->edges[0].fn, x_.get_gradient_fn());
+  ASSERT_EQ(node->saved_tensors.size(), 1u);
+  EXPECT_TRUE(xt::allclose(node->saved_tensors[0].data_, x_.data_));
+}
+
+TEST_F(CheckpointTest, SeveralInputsThroughTheListForm) {
+  Tensor a({1.0, 2.0}, true);
+  Tensor b({3.0, 4.0}, true);
+  Tensor c({5.0, 6.0});
+  Tensor y = checkpoint(
+      [](const TensorRefs& in) {
+        return in[0].get() * in[1].get() + in[2].get();
+      },
+      {a, b, c});
+  y.sum().backward();
+
+  EXPECT_TRUE(xt::allclose(a.gradient->data_, b.data_));
+  EXPECT_TRUE(xt::allclose(b.gradient->data_, a.data_));
+  EXPECT_FALSE(c.requires_grad());
+  delete a.gradient;
+  delete b.gradient;
+}
+
+TEST_F(CheckpointTest, SegmentsReturningAnInput) {
+  Tensor a({1.0, 2.0}, true);
+  Tensor y = checkpoint([](const Tensor& input) { return input; }, a);
+  (y * y).sum().backward();
+
+  EXPECT_TRUE(xt::allclose(a.gradient->data_, 2.0 * a.data_));
+  delete a.gradient;
+}
+
+TEST_F(CheckpointTest, ConstantSegmentsAreReturnedAsIs) {
+  Tensor y = checkpoint([](const Tensor& input) { return input * input; },
+                        Tensor({2.0}));
+
+  EXPECT_FALSE(y.requires_grad());
+  EXPECT_EQ(y.data_(0), 4.0);
+}
+
+TEST_F(CheckpointTest, RunningStatisticsAreUpdatedOnce) {
+  Tensor weight({1.0, 1.0, 1.0});
+  Tensor bias({0.0, 0.0, 0.0});
+  std::vector<Tensor> running;
+  for (bool checkpointed : {false, true}) {
+    Tensor mean({0.0, 0.0, 0.0});
+    Tensor var({1.0, 1.0, 1.0});
+    auto segment = [&](const Tensor& input) {
+      return ember::batch_norm(ember::linear(input, w_, b_), weight, bias,
+                               mean, var, true);
+    };
+    Tensor y = checkpointed ? checkpoint(segment, x_) : segment(x_);
+    (y * y).sum().backward();
+    clear_gradients({&w_, &b_});
+    running.push_back(mean);
+    running.push_back(var);
+  }
+
+  EXPECT_TRUE(xt::allclose(running[2].data_, running[0].data_));
+  EXPECT_TRUE(xt::allclose(running[3].data_, running[1].data_));
+}
+
+namespace {
+
+class CheckpointPlannerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    manual_seed(0);
+    for (std::size_t i = 0; i < kLayers; ++i) {
+      weights_[i] = Tensor::randn({16, 16});
+      biases_[i] = Tensor::randn({16});
+      weights_[i].requires_grad(true);
+      biases_[i].requires_grad(true);
+      layers_.push_back([this, i](const Tensor& x) {
+        return ember::tanh(ember::linear(x, weights_[i], biases_[i]));
+      });
+    }
+    x_ = Tensor::randn({8, 16});
+  }
+
+  void TearDown() override { clear_gradients(params()); }
+
+  std::vector<Tensor*> params() {
+    std::vector<Tensor*> result;
+    for (std::size_t i = 0; i < kLayers; ++i) {
+      result.push_back(&weights_[i]);
+      result.push_back(&biases_[i]);
+    }
+    return result;
+  }
+
+  // Runs an iteration and returns the gradients of the parameters.
+  std::vector<xt::xarray<double>> iteration(CheckpointPlanner& planner) {
+    planner.forward(x_).sum().backward();
+    return take_gradients(params());
+  }
+
+  // The bytes the layers save without checkpointing.
+  std::size_t total_saved_bytes() {
+    std::size_t before = autograd::num_saved_bytes();
+    Tensor output = x_;
+    for (const auto& layer : layers_) {
+      output = layer(output);
+    }
+    return autograd::num_saved_bytes() - before;
+  }
+
+  static constexpr std::size_t kLayers = 4;
+  Tensor weights_[kLayers];
+  Tensor biases_[kLayers];
+  std::vector<CheckpointPlanner::Layer> layers_;
+  Tensor x_;
+};
+
+}  // namespace
+
+TEST_F(CheckpointPlannerTest, NothingIsCheckpointedWithinTheBudget) {
+  std::size_t total = total_saved_bytes();
+  CheckpointPlanner planner(layers_, total);
+  iteration(planner);
+  iteration(planner);
+
+  ASSERT_TRUE(planner.planned());
+  EXPECT_EQ(planner.checkpointed(), std::vector<bool>(kLayers, false));
+  EXPECT_EQ(planner.predicted_recompute_seconds(), 0.0);
+  EXPECT_EQ(planner.report().predicted_peak_bytes, total);
+  EXPECT_EQ(planner.report().actual_peak_bytes, total);
+}
+
+TEST_F(CheckpointPlannerTest, CheckpointingKeepsThePeakWithinTheBudget) {
+  std::size_t total = total_saved_bytes();
+  CheckpointPlanner planner(layers_, total * 3 / 4);
+  auto expected = iteration(planner);
+
+  EXPECT_EQ(planner.report().predicted_peak_bytes, total);
+  EXPECT_EQ(planner.report().actual_peak_bytes, total);
+  ASSERT_TRUE(planner.planned());
+  EXPECT_GT(std::count(planner.checkpointed().begin(),
+                       planner.checkpointed().end(), true),
+            0);
+  EXPECT_LT(std::count(planner.checkpointed().begin(),
+                       planner.checkpointed().end(), true),
+            static_cast<std::ptrdiff_t>(kLayers));
+
+  auto actual = iteration(planner);
+  MemoryReport report = planner.report();
+  EXPECT_LE(report.predicted_peak_bytes, planner.memory_budget_bytes());
+  EXPECT_EQ(report.actual_peak_bytes, report.predicted_peak_bytes);
+  expect_same(actual, expected);
+}
+
+TEST_F(CheckpointPlannerTest, TheLowestPeakIsPickedWhenNothingFits) {
+  CheckpointPlanner planner(layers_, 1);
+  auto expected = iteration(planner);
+  auto actual = iteration(planner);
+
+  EXPECT_EQ(planner.checkpointed(), std::vector<bool>(kLayers, true));
+  MemoryReport report = planner.report();
+  EXPECT_GT(report.predicted_peak_bytes, planner.memory_budget_bytes());
+  EXPECT_EQ(report.actual_peak_bytes, report.predicted_peak_bytes);
+  expect_same(actual, expected);
+}
+
+TEST(CheckpointPlanner, SegmentsSpanLayersThatOnlyPayOffTogether) {
+  // Each layer saves as much as its input, so checkpointing one alone saves
+  // nothing, but checkpointing a run of them keeps only the first input.
+  manual_seed(0);
+  Tensor x = Tensor::randn({8, 16});
+  x.requires_grad(true);
+  std::vector<CheckpointPlanner::Layer> layers(
+      8, [](const Tensor& input) { return ember::tanh(input); });
+  std::size_t total = 0;
+  {
+    std::size_t before = autograd::num_saved_bytes();
+    Tensor output = x;
+    for (const auto& layer : layers) {
+      output = layer(output);
+    }
+    total = autograd::num_saved_bytes() - before;
+  }
+  CheckpointPlanner planner(layers, total * 3 / 4);
+  planner.forward(x).sum().backward();
+  auto expected = take_gradients({&x});
+  planner.forward(x).sum().backward();
+  auto actual = take_gradients({&x});
+
+  ASSERT_FALSE(planner.segments().empty());
+  for (const auto& segment : planner.segments()) {
+    EXPECT_GT(segment.end - segment.begin, 1u);
+  }
+  MemoryReport report = planner.report();
+  EXPECT_LE(report.predicted_peak_bytes, planner.memory_budget_bytes());
+  EXPECT_EQ(report.actual_peak_bytes, report.predicted_peak_bytes);
+  expect_same(actual, expected);
+}
+
+TEST(CheckpointPlanner, NeedsALayer) {
+  EXPECT_THROW(CheckpointPlanner({}, 1), std::invalid_argument);
+}
@@ -0,0 +1,342 @@
+#include <ember/jvp.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// A tensor of the given shape with fixed, distinct values.
+Tensor pattern(const xt::xarray<double>::shape_type& shape, double offset) {
+  auto values = xt::xarray<double>::from_shape(shape);
+  for (std::size_t i = 0; i < values.size(); ++i) {
+    values.data()[i] = std::sin(offset + 1.7 * static_cast<double>(i));
+  }
+  return Tensor::from_xarray(std::move(values));
+}
+
+double dot(const xt::xarray<double>& a, const xt::xarray<double>& b) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    sum += a.data()[i] * b.data()[i];
+  }
+  return sum;
+}
+
+/**
+ * Checks `jvp` against a backward pass through `fn`: for a cotangent u, the
+ * product u . (J t) of the forward pass must equal (u J) . t, where u J is
+ * the gradient of u . fn(primals).
+ */
+void expect_matches_reverse(const JvpFn& fn, std::vector<Tensor> primals) {
+  std::vector<Tensor> tangents;
+  for (std::size_t i = 0; i < primals.size(); ++i) {
+    tangents.push_back(pattern(primals[i].data_.shape(), 0.3 + i));
+  }
+  manual_seed(7);
+  auto [output, tangent] =
+      jvp(fn, TensorRefs(primals.begin(), primals.end()),
+          TensorRefs(tangents.begin(), tangents.end()));
+
+  for (Tensor& primal : primals) {
+    primal.requires_grad(true);
+  }
+  manual_seed(7);
+  Tensor expected = fn(TensorRefs(primals.begin(), primals.end()));
+  ASSERT_EQ(output.data_.shape(), expected.data_.shape());
+  EXPECT_TRUE(xt::allclose(output.data_, expected.data_));
+  ASSERT_EQ(tangent.data_.shape(), expected.data_.shape());
+  EXPECT_FALSE(output.requires_grad());
+
+  Tensor cotangent = pattern(expected.data_.shape(), 2.0);
+  (expected * cotangent).sum().backward();
+  double reverse = 0.0;
+  for (std::size_t i = 0; i < primals.size(); ++i) {
+    Tensor* grad = primals[i].gradient;
+    if (grad != nullptr) {
+      reverse += dot(grad->to_dense().data_, tangents[i].data_);
+    }
+    delete grad;
+    primals[i].gradient = nullptr;
+  }
+  double forward = dot(cotangent.data_, tangent.data_);
+  EXPECT_NEAR(forward, reverse, 1e-8 * (1.0 + std::abs(reverse)));
+}
+
+Tensor positive(const xt::xarray<double>::shape_type& shape) {
+  return Tensor::from_xarray(xt::abs(pattern(shape, 0.1).data_) + 0.5);
+}
+
+}  // namespace
+
+TEST(Jvp, GivesTheDirectionalDerivative) {
+  Tensor x({1.0, 2.0, 3.0});
+  Tensor t({1.0, 0.0, -1.0});
+  auto [y, ty] = jvp(
+      [](const TensorRefs& in) { return in[0].get() * in[0].get(); }, {x},
+      {t});
+
+  EXPECT_TRUE(xt::allclose(y.data_, xt::xarray<double>{1.0, 4.0, 9.0}));
+  EXPECT_TRUE(xt::allclose(ty.data_, xt::xarray<double>{2.0, 0.0, -6.0}));
+  EXPECT_EQ(x.tangent(), nullptr);
+  EXPECT_EQ(y.tangent(), nullptr);
+}
+
+TEST(Jvp, NothingIsRecorded) {
+  Tensor w({{1.0, 2.0}, {3.0, 4.0}}, true);
+  Tensor x({{1.0, -1.0}});
+  Tensor t({{0.5, 0.5}});
+  std::size_t saved = autograd::num_saved_bytes();
+  auto [y, ty] = jvp(
+      [&](const TensorRefs& in) { return ember::tanh(matmul(in[0], w)); },
+      {x}, {t});
+
+  EXPECT_FALSE(y.requires_grad());
+  EXPECT_EQ(autograd::num_saved_bytes(), saved);
+  EXPECT_EQ(w.gradient, nullptr);
+}
+
+TEST(Jvp, ConstantOutputsHaveZeroTangents) {
+  Tensor c({1.0, 2.0});
+  Tensor x({3.0});
+  auto [y, ty] = jvp([&](const TensorRefs&) { return c * c; }, {x}, {x});
+
+  EXPECT_TRUE(xt::allclose(ty.data_, xt::xarray<double>{0.0, 0.0}));
+}
+
+TEST(Jvp, TensorsCanCarryTheirOwnTangents) {
+  Tensor w({2.0, 3.0});
+  w.set_tangent(Tensor({1.0, 1.0}));
+  Tensor x({5.0, 7.0});
+  Tensor t({0.0, 0.0});
+  auto [y, ty] =
+      jvp([&](const TensorRefs& in) { return in[0].get() * w; }, {x}, {t});
+
+  EXPECT_TRUE(xt::allclose(ty.data_, xt::xarray<double>{5.0, 7.0}));
+}
+
+TEST(Jvp, ChecksTheTangents) {
+  JvpFn identity = [](const TensorRefs& in) { return in[0].get(); };
+  Tensor x({1.0, 2.0});
+  Tensor t({1.0});
+  EXPECT_THROW(jvp(identity, {x}, TensorRefs()), std::invalid_argument);
+  EXPECT_THROW(jvp(identity, {x}, {t}), std::invalid_argument);
+  EXPECT_THROW(x.set_tangent(Tensor({1.0, 2.0, 3.0})), std::invalid_argument);
+}
+
+TEST(Jvp, ElementwiseOps) {
+  for (auto op : {ember::exp, ember::tanh, ember::sigmoid, ember::relu,
+                  ember::gelu}) {
+    expect_matches_reverse([&](const TensorRefs& in) { return op(in[0]); },
+                           {pattern({3, 4}, 0.0)});
+  }
+  for (auto op : {ember::log, ember::sqrt, ember::rsqrt}) {
+    expect_matches_reverse([&](const TensorRefs& in) { return op(in[0]); },
+                           {positive({3, 4})});
+  }
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::dropout(in[0], 0.5); },
+      {pattern({4, 4}, 0.0)});
+}
+
+TEST(Jvp, BroadcastingBinaryOps) {
+  auto a = pattern({3, 4}, 0.0);
+  auto b = pattern({4}, 1.0);
+  for (auto op : {ember::add, ember::sub, ember::mul}) {
+    expect_matches_reverse(
+        [&](const TensorRefs& in) { return op(in[0], in[1]); }, {a, b});
+  }
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::div(in[0], in[1]); },
+      {a, positive({4})});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::pow(in[0], in[1]); },
+      {positive({3, 4}), b});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return matmul(in[0], in[1]); },
+      {a, pattern({4, 2}, 1.0)});
+}
+
+TEST(Jvp, Reductions) {
+  auto x = pattern({3, 4}, 0.0);
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::sum(in[0], {1}, true); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::mean(in[0], {0}); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::max(in[0], 1); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::min(in[0], 0, true); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::logsumexp(in[0], {1}); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::softmax(in[0]); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::log_softmax(in[0], 0); }, {x});
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::cross_entropy(in[0], Tensor({1.0, 0.0, 3.0}));
+      },
+      {x});
+}
+
+TEST(Jvp, ShapeAndIndexingOps) {
+  auto a = pattern({3, 4}, 0.0);
+  auto b = pattern({3, 4}, 1.0);
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::cat(in, 1); }, {a, b});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::stack(in, 0); }, {a, b});
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        auto pieces = ember::split(in[0], {1, 3}, 1);
+        return ember::sum(pieces[0]) * pieces[1];
+      },
+      {a});
+  Tensor index({{2.0, 0.0, 1.0, 1.0}, {0.0, 0.0, 2.0, 1.0}});
+  expect_matches_reverse(
+      [&](const TensorRefs& in) { return ember::gather(in[0], 0, index); },
+      {a});
+  expect_matches_reverse(
+      [&](const TensorRefs& in) {
+        return ember::scatter_add(in[0], 0, index, in[1]);
+      },
+      {a, pattern({2, 4}, 1.0)});
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::index_select(in[0], 1, Tensor({3.0, 0.0, 3.0}));
+      },
+      {a});
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::embedding(in[0], Tensor({{2.0, 0.0}, {2.0, 1.0}}));
+      },
+      {a});
+}
+
+TEST(Jvp, LayerOps) {
+  auto x = pattern({3, 4}, 0.0);
+  auto w = pattern({4, 5}, 1.0);
+  auto b = pattern({5}, 2.0);
+  for (auto activation : {Activation::None, Activation::ReLU,
+                          Activation::Sigmoid, Activation::Tanh,
+                          Activation::GELU}) {
+    expect_matches_reverse(
+        [&](const TensorRefs& in) {
+          return ember::linear(in[0], in[1], in[2], activation);
+        },
+        {x, w, b});
+  }
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::einsum("ij,jk,k->i", in);
+      },
+      {x, w, b});
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::layer_norm(in[0], in[1], in[2]);
+      },
+      {x, pattern({4}, 1.0), pattern({4}, 2.0)});
+  for (bool training : {true, false}) {
+    expect_matches_reverse(
+        [&](const TensorRefs& in) {
+          Tensor mean = Tensor::zeros_like(in[1]);
+          Tensor var = Tensor::ones_like(in[1]);
+          return ember::batch_norm(in[0], in[1], in[2], mean, var, training);
+        },
+        {pattern({4, 3, 2, 2}, 0.0), pattern({3}, 1.0), pattern({3}, 2.0)});
+  }
+}
+
+TEST(Jvp, ConvolutionAndPooling) {
+  auto images = pattern({2, 2, 5, 5}, 0.0);
+  Conv2dOptions options;
+  options.padding = {1, 1};
+  expect_matches_reverse(
+      [&](const TensorRefs& in) {
+        return ember::conv2d(in[0], in[1], in[2], options);
+      },
+      {images, pattern({3, 2, 3, 3}, 1.0), pattern({3}, 2.0)});
+  expect_matches_reverse(
+      [](const TensorRefs& in) { return ember::max_pool2d(in[0], {2, 2}); },
+      {images});
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::avg_pool2d(in[0], {3, 3}, {{2, 2}}, {1, 1});
+      },
+      {images});
+}
+
+TEST(Jvp, RecurrentCells) {
+  auto x = pattern({2, 3}, 0.0);
+  auto h = pattern({2, 4}, 1.0);
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::gru_cell(in[0], in[1], in[2], in[3], in[4], in[5]);
+      },
+      {x, h, pattern({3, 12}, 2.0), pattern({4, 12}, 3.0),
+       pattern({12}, 4.0), pattern({12}, 5.0)});
+
+  std::vector<Tensor> lstm_inputs = {
+      pattern({3, 2, 3}, 0.0), h,
+      pattern({2, 4}, 6.0),    pattern({3, 16}, 2.0),
+      pattern({4, 16}, 3.0),   pattern({16}, 4.0)};
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        auto [outputs, state] =
+            ember::lstm(in[0], {in[1], in[2]}, in[3], in[4], in[5]);
+        return outputs * state.second;
+      },
+      lstm_inputs);
+  lstm_inputs[0] = x;
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        auto [hidden, cell] =
+            ember::lstm_cell(in[0], {in[1], in[2]}, in[3], in[4], in[5]);
+        return hidden * cell;
+      },
+      lstm_inputs);
+}
+
+TEST(Jvp, Attention) {
+  std::vector<Tensor> qkv = {pattern({2, 5, 3}, 0.0), pattern({2, 6, 3}, 1.0),
+                             pattern({2, 6, 2}, 2.0)};
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::scaled_dot_product_attention(in[0], in[1], in[2]);
+      },
+      qkv);
+  Tensor mask = Tensor::ones_like(Tensor::randn({5, 6}));
+  mask.data_(0, 1) = 0.0;
+  mask.data_(3, 4) = 0.0;
+  expect_matches_reverse(
+      [&](const TensorRefs& in) {
+        return ember::scaled_dot_product_attention(in[0], in[1], in[2], mask);
+      },
+      qkv);
+  qkv[1] = pattern({2, 5, 3}, 1.0);
+  qkv[2] = pattern({2, 5, 2}, 2.0);
+  expect_matches_reverse(
+      [](const TensorRefs& in) {
+        return ember::scaled_dot_product_attention(in[0], in[1], in[2], true);
+      },
+      qkv);
+}
+
+TEST(Jvp, ThroughCheckpointedSegments) {
+  Tensor w = pattern({4, 4}, 1.0);
+  expect_matches_reverse(
+      [&](const TensorRefs& in) {
+        return checkpoint(
+            [&](const Tensor& x) { return ember::tanh(matmul(x, w)); },
+            in[0].get());
+      },
+      {pattern({3, 4}, 0.0)});
+}
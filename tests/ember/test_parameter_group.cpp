@@ -0,0 +1,124 @@
+#include <ember/parameter_group.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(ParameterGroup, LaysOutAlignedParameters) {
+  Tensor w({{1.0, 2.0, 3.0}, {4.0, 5.0, 6.0}});
+  Tensor b({7.0, 8.0});
+  ParameterGroup group({&w, &b});
+
+  EXPECT_EQ(group.numel(), 8u);
+  EXPECT_EQ(group.offset(0), 0u);
+  EXPECT_EQ(group.offset(1), 8u);
+  EXPECT_EQ(group.capacity(), 16u);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(group.data()) %
+                ParameterGroup::kAlignment,
+            0u);
+  EXPECT_EQ(group.data()[5], 6.0);
+  EXPECT_EQ(group.data()[6], 0.0);
+  EXPECT_EQ(group.data()[9], 8.0);
+}
+
+TEST(ParameterGroup, ScattersUpdatedParameters) {
+  Tensor w({{1.0, 2.0}, {3.0, 4.0}}, true);
+  Tensor b({1.0, -1.0}, true);
+  ParameterGroup group({&w, &b});
+
+  Tensor x({{1.0, 2.0}});
+  ember::linear(x, w, b).sum().backward();
+  group.gather_gradients();
+  for (std::size_t i = 0; i < group.capacity(); ++i) {
+    group.data()[i] -= 0.5 * group.grad()[i];
+  }
+  group.scatter_parameters();
+
+  EXPECT_TRUE(w.equals(Tensor({{0.5, 1.5}, {2.0, 3.0}})));
+  EXPECT_TRUE(b.equals(Tensor({0.5, -1.5})));
+}
+
+TEST(ParameterGroup, GathersSparseGradients) {
+  Tensor table = Tensor::randn({5, 2});
+  table.requires_grad(true);
+  ParameterGroup group({&table});
+
+  Tensor indices({3.0, 1.0, 3.0});
+  ember::embedding(table, indices).sum().backward();
+  ASSERT_TRUE(table.gradient->is_sparse());
+  group.gather_gradients();
+
+  std::vector<double> grad(group.grad(), group.grad() + 10);
+  EXPECT_EQ(grad, (std::vector<double>{0, 0, 1, 1, 0, 0, 2, 2, 0, 0}));
+}
+
+TEST(ParameterGroup, RejectsGradientsOfTheWrongShape) {
+  Tensor w = Tensor::randn({2, 2});
+  ParameterGroup group({&w});
+
+  w.gradient = new Tensor(Tensor::randn({3}));
+  EXPECT_THROW(group.gather_gradients(), std::invalid_argument);
+  delete w.gradient;
+  // Even a gradient of the same size is rejected if its shape differs.
+  w.gradient = new Tensor(Tensor::randn({4}));
+  EXPECT_THROW(group.gather_gradients(), std::invalid_argument);
+  delete w.gradient;
+  w.gradient = nullptr;
+}
+
+TEST(ParameterGroup, ZeroGradAndClipGradNorm) {
+  Tensor a({1.0, 2.0}, true);
+  Tensor b({3.0}, true);
+  ParameterGroup group({&a, &b});
+
+  (a * Tensor({3.0, 0.0})).sum().backward();
+  (b * Tensor({4.0})).sum().backward();
+  group.gather_gradients();
+
+  EXPECT_DOUBLE_EQ(group.grad_norm(), 5.0);
+  EXPECT_DOUBLE_EQ(group.clip_grad_norm(1.0), 5.0);
+  EXPECT_DOUBLE_EQ(group.grad_norm(), 1.0);
+  EXPECT_DOUBLE_EQ(group.grad()[0], 0.6);
+
+  Tensor* gradient = a.gradient;
+  group.zero_grad();
+  EXPECT_EQ(a.gradient, gradient);
+  EXPECT_TRUE(a.gradient->equals(Tensor({0.0, 0.0})));
+  EXPECT_EQ(group.grad_norm(), 0.0);
+  EXPECT_THROW(group.clip_grad_norm(-1.0), std::invalid_argument);
+}
+
+TEST(ParameterGroup, SnapshotsAndRestoresParameters) {
+  Tensor a = Tensor::randn({3, 4});
+  Tensor b = Tensor::randn({5});
+  Tensor original_a = a;
+  ParameterGroup group({&a, &b});
+
+  std::vector<double> snapshot = group.snapshot();
+  std::fill(group.data(), group.data() + group.capacity(), 1.0);
+  group.scatter_parameters();
+  EXPECT_EQ(a(0, 0), 1.0);
+  group.restore(snapshot);
+
+  EXPECT_TRUE(a.equals(original_a));
+  EXPECT_THROW(group.restore({1.0}), std::invalid_argument);
+}
+
+TEST(ParameterGroup, AddingParametersRelaysOutTheBuffers) {
+  Tensor a({1.0, 2.0});
+  Tensor b({3.0});
+  ParameterGroup group({&a});
+  group.add(b);
+
+  EXPECT_EQ(group.parameters().size(), 2u);
+  EXPECT_EQ(group.data()[0], 1.0);
+  EXPECT_EQ(group.data()[8], 3.0);
+  EXPECT_THROW(group.add(a), std::invalid_argument);
+  EXPECT_THROW(ParameterGroup({nullptr}), std::invalid_argument);
+}
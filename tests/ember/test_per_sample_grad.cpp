@@ -0,0 +1,169 @@
+#include <ember/per_sample_grad.h>
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include "test_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+class PerSampleGradTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    manual_seed(0);
+    w1_ = Tensor::randn({3, 4});
+    b1_ = Tensor::randn({4});
+    w2_ = Tensor::randn({4, 2});
+    b2_ = Tensor::randn({1, 2});
+    for (Tensor* t : {&w1_, &b1_, &w2_, &b2_}) {
+      t->requires_grad(true);
+    }
+    x_ = Tensor::randn({kBatch, 3});
+  }
+
+  void TearDown() override { clear_gradients({&w1_, &b1_, &w2_, &b2_}); }
+
+  // A fused layer, then a matmul and a broadcast bias, with the loss of each
+  // sample in its own row.
+  Tensor loss(const Tensor& x) {
+    Tensor hidden = ember::linear(x, w1_, b1_, Activation::Tanh);
+    Tensor output = ember::matmul(hidden, w2_) + b2_;
+    return (output * output).sum({1});
+  }
+
+  TensorRefs params() { return {w1_, b1_, w2_, b2_}; }
+
+  // Sample `n` of the batch, as a batch of one sample.
+  Tensor sample(std::size_t n) {
+    Tensor row = Tensor::from_shape({1, 3});
+    for (std::size_t j = 0; j < 3; ++j) {
+      row.data_(0, j) = x_.data_(n, j);
+    }
+    return row;
+  }
+
+  // The gradients of each sample, from a backward pass per sample.
+  std::vector<std::vector<xt::xarray<double>>> one_at_a_time() {
+    std::vector<std::vector<xt::xarray<double>>> grads;
+    for (std::size_t n = 0; n < kBatch; ++n) {
+      loss(sample(n)).sum().backward();
+      grads.push_back(take_gradients({&w1_, &b1_, &w2_, &b2_}));
+    }
+    return grads;
+  }
+
+  static xt::xarray<double> row(const Tensor& grad, std::size_t n) {
+    std::size_t size = grad.data_.size() / grad.data_.shape()[0];
+    xt::xarray<double> values = xt::zeros<double>({size});
+    for (std::size_t i = 0; i < size; ++i) {
+      values(i) = grad.data_.data()[n * size + i];
+    }
+    return values;
+  }
+
+  static xt::xarray<double> flat(const xt::xarray<double>& values) {
+    xt::xarray<double> copy = values;
+    copy.reshape({values.size()});
+    return copy;
+  }
+
+  static constexpr std::size_t kBatch = 5;
+  Tensor w1_;
+  Tensor b1_;
+  Tensor w2_;
+  Tensor b2_;
+  Tensor x_;
+};
+
+}  // namespace
+
+TEST_F(PerSampleGradTest, MatchesABackwardPassPerSample) {
+  auto expected = one_at_a_time();
+  std::vector<Tensor> grads =
+      per_sample_grad([&](const Tensor& x) { return loss(x); }, params(), x_);
+
+  ASSERT_EQ(grads.size(), 4u);
+  EXPECT_EQ(grads[0].data_.shape(),
+            (xt::xarray<double>::shape_type{kBatch, 3, 4}));
+  EXPECT_EQ(grads[3].data_.shape(),
+            (xt::xarray<double>::shape_type{kBatch, 1, 2}));
+  for (std::size_t n = 0; n < kBatch; ++n) {
+    for (std::size_t p = 0; p < grads.size(); ++p) {
+      EXPECT_TRUE(xt::allclose(row(grads[p], n), flat(expected[n][p])))
+          << "sample " << n << ", parameter " << p;
+    }
+  }
+
+  // A batch of one sample broadcasts nothing, but still gets a sample axis.
+  std::vector<Tensor> single = per_sample_grad(
+      [&](const Tensor& x) { return loss(x); }, params(), sample(1));
+  ASSERT_EQ(single.size(), 4u);
+  EXPECT_EQ(single[3].data_.shape(),
+            (xt::xarray<double>::shape_type{1, 1, 2}));
+  for (std::size_t p = 0; p < single.size(); ++p) {
+    EXPECT_TRUE(xt::allclose(row(single[p], 0), flat(expected[1][p])))
+        << "parameter " << p;
+  }
+}
+
+TEST_F(PerSampleGradTest, LeavesTheParametersGradientsAlone) {
+  bool hooked = false;
+  w1_.register_post_accumulate_hook([&](Tensor&) { hooked = true; });
+  per_sample_grad([&](const Tensor& x) { return loss(x).sum(); }, params(),
+                  x_);
+
+  EXPECT_FALSE(hooked);
+  for (const Tensor& param : params()) {
+    EXPECT_EQ(param.gradient, nullptr);
+  }
+}
+
+TEST_F(PerSampleGradTest, ClipsTheGradientsOfEachSample) {
+  std::vector<Tensor> unclipped =
+      per_sample_grad([&](const Tensor& x) { return loss(x); }, params(), x_);
+  std::vector<double> norms(kBatch, 0.0);
+  for (std::size_t n = 0; n < kBatch; ++n) {
+    for (const Tensor& grad : unclipped) {
+      norms[n] += xt::sum(row(grad, n) * row(grad, n))();
+    }
+    norms[n] = std::sqrt(norms[n]);
+  }
+  std::vector<double> sorted = norms;
+  std::sort(sorted.begin(), sorted.end());
+  double max_norm = sorted[kBatch / 2];
+
+  std::vector<Tensor> clipped = per_sample_grad(
+      [&](const Tensor& x) { return loss(x); }, params(), x_, max_norm);
+  for (std::size_t n = 0; n < kBatch; ++n) {
+    double scale = std::min(1.0, max_norm / (norms[n] + 1e-6));
+    for (std::size_t p = 0; p < clipped.size(); ++p) {
+      EXPECT_TRUE(
+          xt::allclose(row(clipped[p], n), scale * row(unclipped[p], n)))
+          << "sample " << n << ", parameter " << p;
+    }
+  }
+}
+
+TEST_F(PerSampleGradTest, RejectsOpsWithoutPerSampleGradients) {
+  Tensor scale = Tensor::randn({3});
+  Tensor shift = Tensor::randn({3});
+  scale.requires_grad(true);
+  auto fn = [&](const Tensor& x) {
+    return ember::layer_norm(x, scale, shift).sum();
+  };
+
+  EXPECT_THROW(per_sample_grad(fn, {scale}, x_), std::invalid_argument);
+  EXPECT_THROW(per_sample_grad(fn, {shift}, x_), std::invalid_argument);
+  EXPECT_THROW(per_sample_grad([&](const Tensor& x) { return loss(x); },
+                               params(), x_, 0.0),
+               std::invalid_argument);
+}
@@ -0,0 +1,58 @@
+#include <ember/random.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+using namespace ember;
+
+TEST(Random, PhiloxMatchesTheKnownAnswers) {
+  // The known answer tests of the reference implementation (Random123).
+  EXPECT_EQ(random::philox({0, 0, 0, 0}, {0, 0}),
+            (std::array<std::uint32_t, 4>{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                          0x9b00dbd8}));
+  EXPECT_EQ(random::philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                           {0xffffffff, 0xffffffff}),
+            (std::array<std::uint32_t, 4>{0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+                                          0x6d5451fd}));
+}
+
+TEST(Random, ReservedBlocksDontOverlap) {
+  manual_seed(7);
+  auto first = random::reserve(5);
+  auto second = random::reserve(1);
+
+  EXPECT_EQ(first.seed, 7u);
+  EXPECT_EQ(first.offset, 0u);
+  EXPECT_EQ(second.offset, 8u);
+  EXPECT_EQ(initial_seed(), 7u);
+
+  manual_seed(7);
+  EXPECT_EQ(random::reserve(1).offset, 0u);
+}
+
+TEST(Random, ManualSeedMakesRandnReproducible) {
+  manual_seed(3);
+  Tensor a = Tensor::randn({4, 4});
+  manual_seed(3);
+  Tensor b = Tensor::randn({4, 4});
+
+  EXPECT_TRUE(a.equals(b));
+}
+
+TEST(Random, RestoringTheStateReplaysTheSameValues) {
+  manual_seed(5);
+  random::reserve(3);
+  RngState state = get_rng_state();
+  auto position = random::reserve(8);
+  Tensor a = Tensor::randn({3});
+
+  random::reserve(100);
+  Tensor::randn({10});
+  set_rng_state(state);
+
+  EXPECT_EQ(random::reserve(8).offset, position.offset);
+  EXPECT_TRUE(xt::allclose(Tensor::randn({3}).data_, a.data_));
+}
@@ -0,0 +1,88 @@
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+TEST(CsrMatrix, TripletsAreSortedAndRepeatedOnesSummed) {
+  CsrMatrix m = CsrMatrix::from_triplets(3, 4, {2, 0, 2, 0, 2},
+                                         {1, 3, 0, 3, 1},
+                                         {1.0, 2.0, 3.0, 4.0, 5.0});
+
+  EXPECT_EQ(m.row_offsets, (std::vector<std::size_t>{0, 1, 1, 3}));
+  EXPECT_EQ(m.columns, (std::vector<std::size_t>{3, 0, 1}));
+  EXPECT_EQ(m.values, (std::vector<double>{6.0, 3.0, 6.0}));
+  EXPECT_TRUE(xt::allclose(m.to_dense(),
+                           xt::xarray<double>{{0.0, 0.0, 0.0, 6.0},
+                                              {0.0, 0.0, 0.0, 0.0},
+                                              {3.0, 6.0, 0.0, 0.0}}));
+}
+
+TEST(CsrMatrix, DenseMatricesRoundTrip) {
+  xt::xarray<double> dense = {{0.0, 1.5, 0.0}, {-2.0, 0.0, 3.0}};
+
+  CsrMatrix m = CsrMatrix::from_dense(dense);
+
+  EXPECT_EQ(m.nnz(), 3);
+  EXPECT_TRUE(xt::allclose(m.to_dense(), dense));
+  EXPECT_TRUE(xt::allclose(m.transpose().to_dense(), xt::transpose(dense)));
+  EXPECT_THROW(CsrMatrix::from_dense(xt::zeros<double>({2})),
+               std::invalid_argument);
+}
+
+TEST(CsrMatrix, AddMergesSparsityPatterns) {
+  CsrMatrix a = CsrMatrix::from_triplets(2, 3, {0, 1}, {0, 2}, {1.0, 2.0});
+  CsrMatrix b = CsrMatrix::from_triplets(2, 3, {0, 0}, {0, 1}, {3.0, 4.0});
+  xt::xarray<double> expected = a.to_dense() + b.to_dense();
+
+  a.add(b);
+
+  EXPECT_EQ(a.nnz(), 3);
+  EXPECT_TRUE(xt::allclose(a.to_dense(), expected));
+  EXPECT_THROW(a.add(CsrMatrix::from_triplets(3, 3, {}, {}, {})),
+               std::invalid_argument);
+}
+
+TEST(CsrMatrix, InvalidMatricesAreRejected) {
+  EXPECT_THROW(CsrMatrix::from_triplets(2, 2, {2}, {0}, {1.0}),
+               std::invalid_argument);
+  EXPECT_THROW(CsrMatrix::from_triplets(2, 2, {0, 1}, {0}, {1.0, 2.0}),
+               std::invalid_argument);
+
+  CsrMatrix unsorted;
+  unsorted.rows = 1;
+  unsorted.cols = 3;
+  unsorted.row_offsets = {0, 2};
+  unsorted.columns = {2, 1};
+  unsorted.values = {1.0, 2.0};
+  EXPECT_THROW(Tensor::from_csr(unsorted), std::invalid_argument);
+  unsorted.columns = {1, 2};
+  EXPECT_TRUE(Tensor::from_csr(unsorted).is_csr());
+}
+
+TEST(CsrMatrix, OnlyMatmulTakesSparseInputs) {
+  Tensor csr =
+      Tensor::from_csr(CsrMatrix::from_triplets(2, 2, {0}, {1}, {1.0}));
+  SparseRows rows;
+  rows.shape = {2, 2};
+  rows.indices = {1};
+  rows.values = {{1.0, 2.0}};
+  Tensor sparse = Tensor::from_sparse_rows(rows);
+  Tensor dense = Tensor::randn({2, 2});
+
+  for (const Tensor& input : {csr, sparse}) {
+    EXPECT_THROW(ember::exp(input), std::invalid_argument);
+    EXPECT_THROW(input + dense, std::invalid_argument);
+    EXPECT_THROW(dense * input, std::invalid_argument);
+    EXPECT_THROW(ember::sum(input), std::invalid_argument);
+    EXPECT_THROW(ember::softmax(input, 1), std::invalid_argument);
+    EXPECT_THROW(ember::cat({dense, input}), std::invalid_argument);
+  }
+  EXPECT_THROW(ember::matmul(sparse, dense), std::invalid_argument);
+  EXPECT_NO_THROW(ember::matmul(csr, dense));
+  EXPECT_NO_THROW(ember::sum(csr.to_dense()));
+}
@@ -0,0 +1,100 @@
+#include <ember/autograd/engine.h>
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xbuilder.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using namespace ember;
+
+namespace {
+
+// Rows of a (4, 2) tensor.
+SparseRows rows(std::vector<std::size_t> indices, xt::xarray<double> values) {
+  SparseRows result;
+  result.shape = {4, 2};
+  result.indices = std::move(indices);
+  result.values = std::move(values);
+  return result;
+}
+
+}  // namespace
+
+TEST(SparseRows, CoalesceSortsRowsAndSumsRepeatedOnes) {
+  SparseRows r = rows({3, 1, 3}, {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+
+  r.coalesce();
+
+  EXPECT_EQ(r.indices, (std::vector<std::size_t>{1, 3}));
+  EXPECT_TRUE(xt::allclose(r.values, xt::xarray<double>{{3.0, 4.0},
+                                                        {6.0, 8.0}}));
+}
+
+TEST(SparseRows, CoalescedRowsAreLeftAsTheyAre) {
+  SparseRows r = rows({0, 2}, {{1.0, 2.0}, {3.0, 4.0}});
+  const double* values = r.values.data();
+
+  r.coalesce();
+
+  EXPECT_EQ(r.indices, (std::vector<std::size_t>{0, 2}));
+  EXPECT_EQ(r.values.data(), values);
+}
+
+TEST(SparseRows, SparseGradientsAreAppendedWhenAccumulated) {
+  Tensor total = Tensor::from_sparse_rows(rows({3, 1}, {{1.0, 2.0},
+                                                         {3.0, 4.0}}));
+
+  autograd::accumulate_gradient(
+      total, Tensor::from_sparse_rows(rows({1}, {{5.0, 6.0}})));
+
+  // The rows are only merged once the sum is complete.
+  EXPECT_EQ(total.sparse_rows().indices, (std::vector<std::size_t>{3, 1, 1}));
+  EXPECT_TRUE(xt::allclose(
+      total.to_dense().data_, xt::xarray<double>{{0.0, 0.0}, {8.0, 10.0},
+                                                 {0.0, 0.0}, {1.0, 2.0}}));
+}
+
+TEST(SparseRows, RowsAreAddedToDenseTensors) {
+  SparseRows r = rows({2, 0, 2}, {{1.0, 2.0}, {3.0, 4.0}, {5.0, 6.0}});
+  xt::xarray<double> dense = xt::ones<double>({4, 2});
+
+  r.add_to(dense);
+
+  EXPECT_TRUE(xt::allclose(
+      dense, xt::xarray<double>{{4.0, 5.0}, {1.0, 1.0}, {7.0, 9.0},
+                                {1.0, 1.0}}));
+  EXPECT_TRUE(xt::allclose(r.to_dense(), dense - 1.0));
+}
+
+TEST(SparseRows, AppendedRowsKeepTheirIndices) {
+  SparseRows r = rows({1}, {{1.0, 2.0}});
+
+  r.append(rows({0, 1}, {{3.0, 4.0}, {5.0, 6.0}}));
+
+  EXPECT_EQ(r.indices, (std::vector<std::size_t>{1, 0, 1}));
+  EXPECT_TRUE(xt::allclose(
+      r.to_dense(), xt::xarray<double>{{3.0, 4.0}, {6.0, 8.0}, {0.0, 0.0},
+                                       {0.0, 0.0}}));
+}
+
+TEST(SparseRows, MismatchedShapesAreRejected) {
+  SparseRows r = rows({1}, {{1.0, 2.0}});
+  SparseRows other = r;
+  other.shape = {5, 2};
+  xt::xarray<double> dense = xt::zeros<double>({5, 2});
+
+  EXPECT_THROW(r.append(other), std::invalid_argument);
+  EXPECT_THROW(r.add_to(dense), std::invalid_argument);
+}
+
+TEST(SparseRows, SparseTensorsConvertToDense) {
+  Tensor t = Tensor::from_sparse_rows(rows({0}, {{1.0, 2.0}}));
+
+  EXPECT_TRUE(t.is_sparse());
+  EXPECT_FALSE(t.to_dense().is_sparse());
+  EXPECT_TRUE(t.to_dense().equals_approx(
+      Tensor({{1.0, 2.0}, {0.0, 0.0}, {0.0, 0.0}, {0.0, 0.0}})));
+  EXPECT_THROW(Tensor({1.0, 2.0}).sparse_rows(), std::runtime_error);
+}
@@ -3,6 +3,9 @@
 #include <gtest/gtest.h>
 #include <xtensor/xio.hpp>
 
+#include <stdexcept>
+#include <vector>
+
 using namespace ember;
 
 TEST(TensorConstructors, DefaultConstructorCreatesEmptyTensor) {
@@ -117,4 +120,41 @@ TEST(TensorCreation, RandnShapeIsCorrect) {
   EXPECT_EQ(t.data_.shape()[0], 3);
   EXPECT_EQ(t.data_.shape()[1], 4);
   EXPECT_EQ(t.data_.shape()[2], 5);
-}
\ No newline at end of file
+}
+
+TEST(TensorHooks, PostAccumulateHooksRunOncePerBackwardPass) {
+  Tensor a({1.0, 2.0}, true);
+  std::vector<double> seen;
+  a.register_post_accumulate_hook(
+      [&](Tensor& t) { seen.push_back(t.gradient->data_(0)); });
+
+  // a is used twice, but its gradient is accumulated once.
+  (a * a + a).sum().backward();
+  EXPECT_EQ(seen, (std::vector<double>{3.0}));
+
+  Tensor b = a * Tensor({2.0, 2.0});
+  EXPECT_THROW(b.register_post_accumulate_hook([](Tensor&) {}),
+               std::runtime_error);
+}
+
+TEST(TensorGradMode, OpsDontRecordTheGraphWithoutGrad) {
+  Tensor a({1.0, 2.0}, true);
+  {
+    autograd::NoGradGuard guard;
+    EXPECT_FALSE(autograd::is_grad_enabled());
+    std::size_t discarded = autograd::num_discarded_nodes();
+    Tensor b = (a * a).sum();
+    EXPECT_FALSE(b.requires_grad());
+    EXPECT_EQ(b.get_gradient_fn(), nullptr);
+    EXPECT_EQ(b.data_(0), 5.0);
+    // Only the product had an input that required gradients.
+    EXPECT_EQ(autograd::num_discarded_nodes(), discarded + 1);
+    {
+      autograd::GradModeGuard enable(true);
+      EXPECT_TRUE((a * a).requires_grad());
+    }
+    EXPECT_FALSE(autograd::is_grad_enabled());
+  }
+  EXPECT_TRUE(autograd::is_grad_enabled());
+  EXPECT_TRUE((a * a).requires_grad());
+}
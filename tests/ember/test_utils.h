@@ -0,0 +1,46 @@
+#ifndef EMBER_TESTS_TEST_UTILS_H
+#define EMBER_TESTS_TEST_UTILS_H
+
+#include <ember/tensor.h>
+
+#include <gtest/gtest.h>
+#include <xtensor/xarray.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// Frees the gradients of `tensors`, so that the next backward pass starts
+// from none.
+inline void clear_gradients(const std::vector<ember::Tensor*>& tensors) {
+  for (ember::Tensor* t : tensors) {
+    delete t->gradient;
+    t->gradient = nullptr;
+  }
+}
+
+// Returns the gradients of `tensors`, which must all have one, and frees
+// them.
+inline std::vector<xt::xarray<double>> take_gradients(
+    const std::vector<ember::Tensor*>& tensors) {
+  std::vector<xt::xarray<double>> grads;
+  for (ember::Tensor* t : tensors) {
+    grads.push_back(t->gradient->data_);
+  }
+  clear_gradients(tensors);
+  return grads;
+}
+
+// Expects each array of `actual` to have the shape of the matching array of
+// `expected` and to be close to it.
+inline void expect_same(const std::vector<xt::xarray<double>>& actual,
+                        const std::vector<xt::xarray<double>>& expected) {
+  ASSERT_EQ(actual.size(), expected.size());
+  for (std::size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_EQ(actual[i].shape(), expected[i].shape()) << i;
+    if (actual[i].shape() == expected[i].shape()) {
+      EXPECT_TRUE(xt::allclose(actual[i], expected[i])) << i;
+    }
+  }
+}
+
+#endif  // !EMBER_TESTS_TEST_UTILS_H